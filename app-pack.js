@@ -0,0 +1,105 @@
+// app-pack.js
+// Packs an app folder into a single archive (app.mwpk) plus a manifest.txt for delta updates.
+// Usage:
+//   node app-pack.js <appDir> [outDir]
+//
+// Files: entry.lua, icon-20x20.raw, name.txt, version.txt and every file listed in pkg.txt
+// (or, without pkg.txt, every file in the folder). Each entry is stored raw-deflated when
+// that is smaller, otherwise uncompressed. See src/sys-apps/pkg-archive.hpp for the layout.
+
+const fs = require("fs");
+const path = require("path");
+const zlib = require("zlib");
+const crypto = require("crypto");
+
+const CORE = ["entry.lua", "icon-20x20.raw", "name.txt", "version.txt"];
+const OUTPUTS = ["app.mwpk", "manifest.txt"];
+
+function walk(dir, base = "") {
+  let out = [];
+  for (const name of fs.readdirSync(dir)) {
+    const rel = base ? base + "/" + name : name;
+    const p = path.join(dir, name);
+    if (fs.statSync(p).isDirectory()) out = out.concat(walk(p, rel));
+    else out.push(rel);
+  }
+  return out;
+}
+
+function listFiles(appDir) {
+  const pkgTxt = path.join(appDir, "pkg.txt");
+  let files;
+  if (fs.existsSync(pkgTxt)) {
+    const extras = fs
+      .readFileSync(pkgTxt, "utf-8")
+      .split("\n")
+      .map((l) => l.trim())
+      .filter((l) => l.length > 0);
+    files = CORE.concat(extras);
+  } else {
+    files = walk(appDir).filter((f) => !OUTPUTS.includes(f) && f !== "pkg.txt");
+  }
+  return [...new Set(files)];
+}
+
+function pack(appDir, outDir) {
+  const files = listFiles(appDir);
+  for (const f of CORE) {
+    if (!files.includes(f) || !fs.existsSync(path.join(appDir, f))) {
+      throw new Error("missing required file: " + f);
+    }
+  }
+
+  const parts = [];
+  const header = Buffer.alloc(8);
+  header.write("MWPK", 0, "ascii");
+  header.writeUInt8(1, 4); // version
+  header.writeUInt8(0, 5); // flags
+  header.writeUInt16LE(files.length, 6);
+  parts.push(header);
+
+  let manifest = "";
+  let rawTotal = 0;
+  for (const rel of files) {
+    const raw = fs.readFileSync(path.join(appDir, rel));
+    const hash = crypto.createHash("sha256").update(raw).digest();
+    const deflated = zlib.deflateRawSync(raw, { level: 9 });
+    const useDeflate = deflated.length < raw.length;
+    const data = useDeflate ? deflated : raw;
+    const name = Buffer.from(rel, "utf-8");
+    if (name.length === 0 || name.length > 255) throw new Error("bad path: " + rel);
+
+    const head = Buffer.alloc(44);
+    head.writeUInt16LE(name.length, 0);
+    head.writeUInt8(useDeflate ? 1 : 0, 2);
+    head.writeUInt8(0, 3);
+    head.writeUInt32LE(raw.length, 4);
+    head.writeUInt32LE(data.length, 8);
+    hash.copy(head, 12);
+    parts.push(head, name, data);
+
+    manifest += hash.toString("hex") + " " + raw.length + " " + rel + "\n";
+    rawTotal += raw.length;
+  }
+  manifest += "# " + files.length + "\n";
+
+  const archive = Buffer.concat(parts);
+  fs.mkdirSync(outDir, { recursive: true });
+  fs.writeFileSync(path.join(outDir, "app.mwpk"), archive);
+  fs.writeFileSync(path.join(outDir, "manifest.txt"), manifest);
+
+  console.log(
+    `${files.length} files, ${rawTotal} bytes -> app.mwpk ${archive.length} bytes (${((archive.length * 100) / Math.max(rawTotal, 1)).toFixed(1)}%)`
+  );
+}
+
+if (require.main === module) {
+  const [appDir, outDir] = process.argv.slice(2);
+  if (!appDir) {
+    console.log("usage: node app-pack.js <appDir> [outDir]");
+    process.exit(1);
+  }
+  pack(appDir, outDir || appDir);
+}
+
+module.exports = { pack };
@@ -12,13 +12,18 @@ local function int(n) return math.floor(tonumber(n) or 0) end
 local lastText = "Tap to search (click)"
 local function doSearch(q)
     local url = "https://api.duckduckgo.com/?q="..urlencode(q).."&format=json&no_html=1&skip_disambig=1"
-    local res = httpsReq{ method="GET", url=url }
-    if not res or not res.body then lastText = "Network error"; return end
-    local body = res.body
-    local abstract = body:match('"AbstractText"%s*:%s*"(.-)"') or ""
-    if abstract ~= "" then lastText = abstract; return end
-    local rel = body:match('"Text"%s*:%s*"(.-)"') or ""
-    if rel ~= "" then lastText = rel; return end
+    -- stream the JSON through a sliding window instead of holding the whole answer in RAM
+    local window, abstract, rel = "", nil, nil
+    local res = httpsReq{ method="GET", url=url, onChunk=function(chunk)
+        window = window .. chunk
+        abstract = abstract or window:match('"AbstractText"%s*:%s*"(.-)"')
+        if abstract and abstract ~= "" then return false end -- got it, stop downloading
+        rel = rel or window:match('"Text"%s*:%s*"(.-)"')
+        if #window > 4096 then window = window:sub(-2048) end
+    end }
+    if abstract and abstract ~= "" then lastText = abstract; return end
+    if not res or res.status < 0 then lastText = "Network error"; return end
+    if rel and rel ~= "" then lastText = rel; return end
     lastText = "No quick answer."
 end
 
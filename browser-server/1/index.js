@@ -1,23 +1,262 @@
 // File: server.js
-// Simple Node.js test server for the Browser WebSocket protocol (MWOSP-v1).
+// Simple Node.js test server for the Browser WebSocket protocol (MWOSP-v1 / v2).
 // Usage:
 //   npm install ws
 //   node server.js
 //
 // This server accepts WebSocket connections and expects the client to send a
-// handshake like: "MWOSP-v1 <session> <width> <height>".
+// handshake like: "MWOSP-v1 <session> <width> <height> [v2] [z]".
+// Clients that append "v2" get the reply "MWOSP-v2" and binary frames built with
+// MwospEncoder (layout in src/sys-apps/mwosp.hpp); everyone else gets v1 text.
+// With "z" as well ("MWOSP-v2 z"), every message goes through one raw deflate stream per
+// session (see src/sys-apps/browser-zstream.hpp).
 // After handshake, server will send a few demo Draw*/Fill* commands periodically.
 // It also responds to GetStorage/SetStorage messages in-memory.
+// SVGs are sent as content-hashed assets: "DrawAsset <hash> ..." first, and the
+// source ("DefineAsset <hash> <svg>") only when the client answers "MissingAsset <hash>".
+// MWOSP_RECORD=<dir> writes every session as it went on the wire to <dir>/session-<time>.mwr,
+// ready for tools/browser-replay (per message: u8 'T' | 'B', u32 LE length, payload).
+// MWOSP_DEMO=list plays a scrolling list instead of the single demo frame (v2 clients): one frame
+// per step, ScrollViewport plus the exposed row, icons reused across rows, one icon that only
+// shows up mid-scroll and one that is defined again. record.js records it without a device.
 
-const WebSocket = require('ws');
+const crypto = require('crypto');
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
 
-const wss = new WebSocket.Server({ port: 8080 });
-console.log('MWOSP test server listening on ws://0.0.0.0:8080');
+const OPEN = 1; // WebSocket.OPEN
 
 const storage = new Map();
 
-wss.on('connection', (ws, req) => {
-    console.log('client connected:', req.socket.remoteAddress);
+// hash -> asset source, shared by all sessions
+const assets = new Map();
+
+// first 16 hex digits of the SHA-256 of the asset, checked by the client
+function assetHash(source) {
+    const hash = crypto.createHash('sha256').update(source, 'utf8').digest('hex').substring(0, 16);
+    assets.set(hash, source);
+    return hash;
+}
+
+// MWOSP-v2 opcodes, keep in sync with src/sys-apps/mwosp.hpp
+const OP = {
+    FILL_RECT: 0x01,
+    DRAW_CIRCLE: 0x02,
+    DRAW_TEXT: 0x03,
+    DRAW_SVG: 0x04,
+    THEME_COLOR: 0x05,
+    TITLE: 0x06,
+    NAVIGATE: 0x07,
+    EXIT: 0x08,
+    TEXT: 0x09,
+    BEGIN_FRAME: 0x0a,
+    END_FRAME: 0x0b,
+    DEFINE_ASSET: 0x0c,
+    DRAW_ASSET: 0x0d,
+    SCROLL: 0x0e,
+    COMPRESSED: 0x0f,
+};
+
+const Z_WINDOW_BITS = 12; // client ring is 1 << 12 bytes
+const Z_MAX_MESSAGE = 16 * 1024; // client limit for one inflated message
+
+// All messages to one client, in order. With compression on they share one deflate stream,
+// flushed (Z_SYNC_FLUSH) per message so the client can decode each one as it arrives.
+class Outbox {
+    constructor(ws, recordFile = null) {
+        this.ws = ws;
+        this.queue = Promise.resolve();
+        this.deflate = null;
+        this.epoch = 0;
+        this.stats = { messages: 0, raw: 0, wire: 0 };
+        this.record = null;
+        if (recordFile) {
+            this.record = fs.openSync(recordFile, 'w');
+            console.log('recording to', recordFile);
+        }
+    }
+
+    // what the client receives, in order
+    _wire(data, binary) {
+        const payload = Buffer.isBuffer(data) ? data : Buffer.from(data, 'utf8');
+        if (this.record !== null) {
+            const head = Buffer.alloc(5);
+            head.write(binary ? 'B' : 'T', 0, 'ascii');
+            head.writeUInt32LE(payload.length, 1);
+            fs.writeSync(this.record, head);
+            fs.writeSync(this.record, payload);
+        }
+        this.ws.send(data, { binary });
+    }
+
+    // queued like a message, so it applies exactly between the messages before and after it
+    enableCompression(epoch = 0) {
+        this.queue = this.queue.then(() => {
+            if (this.deflate) this.deflate.close();
+            this.epoch = epoch & 0xff;
+            this.chunks = [];
+            this.deflate = zlib.createDeflateRaw({ windowBits: Z_WINDOW_BITS, memLevel: 8 });
+            this.deflate.on('data', (c) => this.chunks.push(c));
+        });
+    }
+
+    text(str) { this._send('T', Buffer.from(String(str), 'utf8'), String(str)); }
+    binary(buf) { this._send('B', buf, buf); }
+
+    _send(kind, raw, plain) {
+        this.queue = this.queue.then(() => new Promise((resolve) => {
+            if (this.ws.readyState !== OPEN) return resolve();
+            this.stats.messages++;
+            this.stats.raw += raw.length;
+            if (!this.deflate || raw.length > Z_MAX_MESSAGE) {
+                this.stats.wire += raw.length;
+                this._wire(plain, kind === 'B');
+                return resolve();
+            }
+            const deflate = this.deflate;
+            deflate.write(raw);
+            deflate.flush(zlib.constants.Z_SYNC_FLUSH, () => {
+                const body = Buffer.concat(this.chunks);
+                this.chunks = [];
+                const head = Buffer.alloc(5);
+                head.writeUInt8(OP.COMPRESSED, 0);
+                head.writeUInt16LE(body.length + 2, 1);
+                head.writeUInt8(this.epoch, 3);
+                head.write(kind, 4, 'ascii');
+                this.stats.wire += head.length + body.length;
+                if (this.ws.readyState === OPEN) this._wire(Buffer.concat([head, body]), true);
+                resolve();
+            });
+        }));
+    }
+
+    close() {
+        this.queue = this.queue.then(() => {
+            if (this.deflate) this.deflate.close();
+            this.deflate = null;
+            if (this.record !== null) fs.closeSync(this.record);
+            this.record = null;
+        });
+    }
+}
+
+// theme slot indices for themeColor()
+const THEME_SLOTS = ['bg', 'text', 'primary', 'accent', 'accent2', 'accentText', 'pressed', 'danger', 'placeholder'];
+
+// Batches commands into binary frames: u8 opcode | u16 LE length | payload.
+// Frames are sent when flush() is called or when the batch reaches maxFrame bytes.
+class MwospEncoder {
+    constructor(out, maxFrame = 4096) {
+        this.out = out;
+        this.maxFrame = maxFrame;
+        this.parts = [];
+        this.size = 0;
+    }
+
+    _cmd(op, ints, text, encoding = 'utf8') {
+        const str = text === undefined ? null : Buffer.from(String(text), encoding);
+        let len = str ? str.length : 0;
+        for (const [type] of ints) len += type === 'u8' ? 1 : 2;
+        if (len > 0xffff) throw new Error('MWOSP-v2 payload too large');
+        if (this.size + 3 + len > this.maxFrame) this.flush();
+
+        const buf = Buffer.alloc(3 + len);
+        buf.writeUInt8(op, 0);
+        buf.writeUInt16LE(len, 1);
+        let o = 3;
+        for (const [type, v] of ints) {
+            if (type === 'u8') buf.writeUInt8(v & 0xff, o++);
+            else if (type === 'i16') { buf.writeInt16LE(Math.max(-32768, Math.min(32767, v | 0)), o); o += 2; }
+            else { buf.writeUInt16LE(v & 0xffff, o); o += 2; }
+        }
+        if (str) str.copy(buf, o);
+        this.parts.push(buf);
+        this.size += buf.length;
+        return this;
+    }
+
+    fillRect(x, y, w, h, color) { return this._cmd(OP.FILL_RECT, [['i16', x], ['i16', y], ['i16', w], ['i16', h], ['u16', color]]); }
+    drawCircle(x, y, r, color) { return this._cmd(OP.DRAW_CIRCLE, [['i16', x], ['i16', y], ['i16', r], ['u16', color]]); }
+    drawText(x, y, size, color, text) { return this._cmd(OP.DRAW_TEXT, [['i16', x], ['i16', y], ['u8', size], ['u16', color]], text); }
+    drawSVG(x, y, w, h, color, svg) { return this._cmd(OP.DRAW_SVG, [['i16', x], ['i16', y], ['i16', w], ['i16', h], ['u16', color]], svg); }
+    themeColor(name, color) {
+        const slot = THEME_SLOTS.indexOf(name);
+        if (slot < 0) throw new Error('unknown theme slot ' + name);
+        return this._cmd(OP.THEME_COLOR, [['u8', slot], ['u16', color]]);
+    }
+    title(text) { return this._cmd(OP.TITLE, [], text); }
+    navigate(target) { return this._cmd(OP.NAVIGATE, [], target); }
+    exit() { return this._cmd(OP.EXIT, []); }
+    text(command) { return this._cmd(OP.TEXT, [], command); } // any v1 text command
+    defineAsset(hash, source) {
+        const h = Buffer.from(hash, 'ascii');
+        return this._cmd(OP.DEFINE_ASSET, [['u8', h.length]], Buffer.concat([h, Buffer.from(source, 'utf8')]).toString('latin1'), 'latin1');
+    }
+    drawAsset(x, y, w, h, color, hash) { return this._cmd(OP.DRAW_ASSET, [['i16', x], ['i16', y], ['i16', w], ['i16', h], ['u16', color]], hash); }
+    // move the client's page pixels; positive dy moves content down, only the exposed strip needs redrawing
+    scroll(dx, dy) { return this._cmd(OP.SCROLL, [['i16', dx], ['i16', dy]]); }
+    beginFrame() { return this._cmd(OP.BEGIN_FRAME, []); } // client composes offscreen until endFrame
+    endFrame() { return this._cmd(OP.END_FRAME, []); }
+
+    flush() {
+        if (this.size === 0) return null;
+        const frame = Buffer.concat(this.parts, this.size);
+        this.parts = [];
+        this.size = 0;
+        this.out.binary(frame);
+        return frame;
+    }
+}
+
+const LIST_ICONS = [
+    '<svg xmlns="http://www.w3.org/2000/svg" width="24" height="24"><rect x="2" y="2" width="20" height="20" fill="#0000ff"/></svg>',
+    '<svg xmlns="http://www.w3.org/2000/svg" width="24" height="24"><circle cx="12" cy="12" r="10" fill="#00ff00"/></svg>',
+    '<svg xmlns="http://www.w3.org/2000/svg" width="24" height="24"><path d="M12 2 L22 22 L2 22 Z" fill="#ff0000"/></svg>',
+];
+// first used by row LIST_LATE_ROW, so it is requested while the list scrolls
+const LIST_LATE_ICON = '<svg xmlns="http://www.w3.org/2000/svg" width="24" height="24"><rect x="4" y="4" width="16" height="16" rx="4" fill="#ffff00"/></svg>';
+const LIST_LATE_ROW = 9;
+const LIST_ROW_H = 40;
+const LIST_STEPS = [1, 1, 1, 1, 1, -1, 1, 1]; // rows per step; negative scrolls back up
+
+function listRow(enc, i, y, width) {
+    const icon = i === LIST_LATE_ROW ? LIST_LATE_ICON : LIST_ICONS[i % LIST_ICONS.length];
+    enc.fillRect(0, y, width, LIST_ROW_H, i % 2 ? 0x2104 : 0)
+        .drawAsset(8, y + 8, 24, 24, 0xffff, assetHash(icon))
+        .drawText(44, y + 14, 2, 0xffff, `Item ${i}`);
+}
+
+// MWOSP_DEMO=list: first frame, then one frame per step that scrolls by a row and draws the
+// row that came into view. `done` runs after the last step.
+function playList(enc, width, height, done) {
+    const visible = Math.ceil(height / LIST_ROW_H);
+    let top = 0;
+    enc.beginFrame().fillRect(0, 0, width, height, 0);
+    for (let i = 0; i < visible; i++) listRow(enc, i, i * LIST_ROW_H, width);
+    enc.endFrame().flush();
+
+    let step = 0;
+    const next = () => {
+        if (step === LIST_STEPS.length) return done && done();
+        const dir = LIST_STEPS[step++];
+        top += dir;
+        enc.beginFrame().scroll(0, -dir * LIST_ROW_H);
+        if (dir > 0) listRow(enc, top + visible - 1, (visible - 1) * LIST_ROW_H, width);
+        else listRow(enc, top, 0, width);
+        enc.endFrame().flush();
+        // a server that does not track what the client holds sends a source again
+        if (step === 3) enc.defineAsset(assetHash(LIST_ICONS[0]), LIST_ICONS[0]).flush();
+        setTimeout(next, 250);
+    };
+    setTimeout(next, 250);
+}
+
+// One client connection. `ws` needs send(data, { binary }), readyState and on('message' | 'close').
+// opts: record (file for the session), demo ('list'), heartbeat (default true), onDone (list demo finished)
+function serve(ws, opts = {}) {
+    const out = new Outbox(ws, opts.record);
+    let enc = null; // MwospEncoder once the client negotiated v2
 
     ws.on('message', (msg) => {
         msg = msg.toString();
@@ -27,19 +266,62 @@ wss.on('connection', (ws, req) => {
         // but log and send back a theme and some demo commands.
         if (msg.startsWith('MWOSP-v1')) {
             console.log('Handshake:', msg);
+            const caps = msg.split(' ').slice(4);
+            if (caps.includes('v2')) {
+                enc = new MwospEncoder(out);
+                const z = caps.includes('z');
+                out.text(z ? 'MWOSP-v2 z' : 'MWOSP-v2');
+                // compressed from the next message on
+                if (z) out.enableCompression();
+            }
+            if (enc && opts.demo === 'list') {
+                const [width, height] = msg.split(' ').slice(2, 4).map((v) => parseInt(v, 10));
+                setTimeout(() => playList(enc, width || 320, height || 240, opts.onDone), 200);
+                return;
+            }
             // Send a few commands to draw a demo screen
+            const svg = '<svg xmlns="http://www.w3.org/2000/svg" width="24" height="24"><rect width="24" height="24" fill="#0000ff"/></svg>';
             setTimeout(() => {
-                ws.send('FillRect 0 0 320 240 0'); // black background (color=0)
-                ws.send('FillRect 6 26 308 48 63488'); // red card (example 16-bit color)
-                ws.send('DrawText 12 36 2 65535 Hello from MWOSP demo'); // white text
-                ws.send('DrawCircle 160 140 30 2016'); // green-ish circle
+                if (enc) {
+                    // whole screen in a single frame
+                    enc.beginFrame()
+                        .fillRect(0, 0, 320, 240, 0)
+                        .fillRect(6, 26, 308, 48, 63488)
+                        .drawText(12, 36, 2, 65535, 'Hello from MWOSP demo')
+                        .drawCircle(160, 140, 30, 2016)
+                        .drawAsset(200, 100, 24, 24, 31, assetHash(svg))
+                        .endFrame()
+                        .flush();
+                    return;
+                }
+                out.text('BeginFrame'); // nothing shows up until EndFrame
+                out.text('FillRect 0 0 320 240 0'); // black background (color=0)
+                out.text('FillRect 6 26 308 48 63488'); // red card (example 16-bit color)
+                out.text('DrawText 12 36 2 65535 Hello from MWOSP demo'); // white text
+                out.text('DrawCircle 160 140 30 2016'); // green-ish circle
                 // Demonstrate an SVG (very small example - client may ignore if unsupported)
-                const svg = '<svg xmlns="http://www.w3.org/2000/svg" width="24" height="24"><rect width="24" height="24" fill="#0000ff"/></svg>';
-                ws.send('DrawSVG 200 100 24 24 31 ' + svg);
+                out.text(`DrawAsset ${assetHash(svg)} 200 100 24 24 31`);
+                out.text('EndFrame');
             }, 200);
             return;
         }
 
+        if (msg.startsWith('ZReset ')) {
+            // client lost the stream: fresh deflate context under the epoch it asked for
+            out.enableCompression(parseInt(msg.substring('ZReset '.length), 10) || 0);
+            return;
+        }
+
+        if (msg.startsWith('MissingAsset ')) {
+            const hash = msg.substring('MissingAsset '.length).trim();
+            const source = assets.get(hash);
+            if (!source) return;
+            // the client draws everything that waited for it as soon as it arrives
+            if (enc) enc.defineAsset(hash, source).flush();
+            else out.text(`DefineAsset ${hash} ${source}`);
+            return;
+        }
+
         // Storage commands
         if (msg.startsWith('SetStorage ')) {
             // Format: SetStorage <key> <value>
@@ -57,27 +339,44 @@ wss.on('connection', (ws, req) => {
         if (msg.startsWith('GetStorage ')) {
             const key = msg.substring('GetStorage '.length);
             const val = storage.get(key) || '';
-            ws.send(`GetBackStorage ${key} ${val}`);
+            out.text(`GetBackStorage ${key} ${val}`);
             console.log(`Returned storage for ${key}`);
             return;
         }
 
         // Echo other messages for debugging
-        ws.send('Echo: ' + msg);
+        out.text('Echo: ' + msg);
     });
 
     ws.on('close', () => {
-        console.log('client disconnected');
+        const { messages, raw, wire } = out.stats;
+        console.log(`client disconnected, ${messages} messages, ${raw} bytes raw, ${wire} bytes on air`);
+        out.close();
     });
 
     // Periodically send a heartbeat or random draw commands
+    if (opts.heartbeat === false) return;
     const interval = setInterval(() => {
-        if (ws.readyState !== WebSocket.OPEN) {
+        if (ws.readyState !== OPEN) {
             clearInterval(interval);
             return;
         }
         // send a small status text at top-left
         const now = new Date().toISOString();
-        ws.send(`DrawText 6 3 1 65535 ServerTime: ${now}`);
+        if (enc) enc.drawText(6, 3, 1, 65535, `ServerTime: ${now}`).flush();
+        else out.text(`DrawText 6 3 1 65535 ServerTime: ${now}`);
     }, 5000);
-});
+}
+
+module.exports = { serve, assetHash };
+
+if (require.main === module) {
+    const WebSocket = require('ws');
+    const wss = new WebSocket.Server({ port: 8080 });
+    console.log('MWOSP test server listening on ws://0.0.0.0:8080');
+    wss.on('connection', (ws, req) => {
+        console.log('client connected:', req.socket.remoteAddress);
+        const record = process.env.MWOSP_RECORD ? path.join(process.env.MWOSP_RECORD, `session-${Date.now()}.mwr`) : null;
+        serve(ws, { record, demo: process.env.MWOSP_DEMO });
+    });
+}
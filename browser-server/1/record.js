@@ -0,0 +1,64 @@
+// Records a session of this server for tools/browser-replay without a device or the ws package.
+// Usage:
+//   node record.js <out.mwr> [v1|v2] [list]
+//
+// A scripted client stands in for the browser: it sends the handshake and, like the device,
+// answers the first DrawAsset of every asset it has not been sent with "MissingAsset <hash>".
+// Compressed sessions ("z") need a real client, see MWOSP_RECORD in index.js.
+
+const EventEmitter = require('events');
+const { serve } = require('./index.js');
+
+const [file, proto = 'v2', demo] = process.argv.slice(2);
+if (!file || !['v1', 'v2'].includes(proto)) {
+    console.error('usage: node record.js <out.mwr> [v1|v2] [list]');
+    process.exit(2);
+}
+
+const OP_DEFINE_ASSET = 0x0c;
+const OP_DRAW_ASSET = 0x0d;
+
+const ws = new EventEmitter();
+ws.readyState = 1;
+const known = new Set();
+const requested = new Set();
+
+function reply(text) {
+    setImmediate(() => ws.emit('message', Buffer.from(text, 'utf8')));
+}
+
+function drawn(hash) {
+    if (known.has(hash) || requested.has(hash)) return;
+    requested.add(hash);
+    reply('MissingAsset ' + hash);
+}
+
+ws.send = (data, { binary }) => {
+    if (!binary) {
+        const msg = String(data);
+        if (msg.startsWith('DefineAsset ')) known.add(msg.split(' ')[1]);
+        else if (msg.startsWith('DrawAsset ')) drawn(msg.split(' ')[1]);
+        return;
+    }
+    // u8 opcode | u16 LE length | payload
+    for (let o = 0; o + 3 <= data.length;) {
+        const op = data[o];
+        const len = data.readUInt16LE(o + 1);
+        const p = data.subarray(o + 3, o + 3 + len);
+        if (op === OP_DEFINE_ASSET) known.add(p.subarray(1, 1 + p[0]).toString('ascii'));
+        else if (op === OP_DRAW_ASSET) drawn(p.subarray(10).toString('ascii'));
+        o += 3 + len;
+    }
+};
+
+function finish() {
+    // let answers to the last frame arrive before the socket closes
+    setTimeout(() => {
+        ws.readyState = 3;
+        ws.emit('close');
+    }, 500);
+}
+
+serve(ws, { record: file, demo, heartbeat: false, onDone: finish });
+reply(`MWOSP-v1 record 320 240${proto === 'v2' ? ' v2' : ''}`);
+if (demo !== 'list') setTimeout(finish, 1000);
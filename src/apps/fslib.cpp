@@ -54,12 +54,72 @@ namespace LuaApps
             return 1;
         }
 
+        // ---------------- FS_setMany ----------------
+        // Lua: FS_setMany({ key = data, ... }) -> bool
+        int lua_FS_setMany(lua_State *L)
+        {
+            luaL_checktype(L, 1, LUA_TTABLE);
+
+            std::vector<std::pair<String, ENC_FS::Buffer>> items;
+            lua_pushnil(L);
+            while (lua_next(L, 1))
+            {
+                size_t len = 0;
+                const char *dataPtr = luaL_checklstring(L, -1, &len);
+                // convert a copy of the key: converting a numeric key in place breaks lua_next
+                lua_pushvalue(L, -2);
+                const char *key = lua_tostring(L, -1);
+                if (!key)
+                    return luaL_error(L, "FS_setMany: keys must be strings or numbers");
+                items.push_back({String(key), ENC_FS::Buffer(dataPtr, dataPtr + len)});
+                lua_pop(L, 2);
+            }
+
+            String appId = getApp(L)->path;
+            bool ok = ENC_FS::Storage::setMany(appId, items);
+
+            lua_pushboolean(L, ok);
+            return 1;
+        }
+
+        // ---------------- FS_getMany ----------------
+        // Lua: FS_getMany({ key1, key2, ... }) -> { key1 = data, ... } (missing keys are nil, empty values "")
+        int lua_FS_getMany(lua_State *L)
+        {
+            luaL_checktype(L, 1, LUA_TTABLE);
+
+            std::vector<String> keys;
+            size_t n = lua_rawlen(L, 1);
+            for (size_t i = 1; i <= n; ++i)
+            {
+                lua_rawgeti(L, 1, i);
+                keys.push_back(String(luaL_checkstring(L, -1)));
+                lua_pop(L, 1);
+            }
+
+            String appId = getApp(L)->path;
+            std::vector<bool> found;
+            std::vector<ENC_FS::Buffer> values = ENC_FS::Storage::getMany(appId, keys, &found);
+
+            lua_newtable(L);
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                if (!found[i])
+                    continue;
+                lua_pushlstring(L, reinterpret_cast<const char *>(values[i].data()), values[i].size());
+                lua_setfield(L, -2, keys[i].c_str());
+            }
+            return 1;
+        }
+
         // ---------------- Register Functions ----------------
         void register_fs_functions(lua_State *L)
         {
             lua_register(L, "FS_get", lua_FS_get);
             lua_register(L, "FS_set", lua_FS_set);
             lua_register(L, "FS_del", lua_FS_del);
+            lua_register(L, "FS_setMany", lua_FS_setMany);
+            lua_register(L, "FS_getMany", lua_FS_getMany);
         }
 
     } // namespace FsLib
@@ -11,6 +11,8 @@ namespace LuaApps {
         int lua_FS_get(lua_State* L);
         int lua_FS_set(lua_State* L);
         int lua_FS_del(lua_State* L);
+        int lua_FS_setMany(lua_State* L);
+        int lua_FS_getMany(lua_State* L);
         
         void register_fs_functions(lua_State* L);
     }
@@ -94,24 +94,13 @@ namespace LuaApps::LuaFunctions
                 url.replace("\n", ""); // sicherstellen kein whitespace
                 url.replace("\r", ""); // sicherstellen kein whitespace
                 url.replace("\t", ""); // sicherstellen kein whitespace
-                HTTPClient http;
-                if (http.begin(url))
-                {
-                    int httpCode = http.GET();
-                    if (httpCode == HTTP_CODE_OK)
-                    {
-                        code = http.getString();
-                    }
-                    else
-                    {
-                        err = "http error: " + String(httpCode);
-                    }
-                    http.end();
-                }
-                else
-                {
-                    err = "http begin failed";
-                }
+                HttpPool::Request req;
+                req.url = url;
+                HttpPool::Response res;
+                if (!HttpPool::fetch(req, res, code))
+                    err = "http error: " + res.error;
+                else if (res.status != 200)
+                    err = "http error: " + String(res.status);
             }
             else
             {
@@ -222,7 +211,9 @@ namespace LuaApps::LuaFunctions
         return 1;
     }
 
-    int luaHttpRequest(lua_State *L)
+    // httpReq/httpsReq: {method, url, body, headers, saveTo, onChunk} -> {status, body[, bytes]}. Both share the pooled
+    // keep-alive connections; the URL scheme decides about TLS, `tls` only fills in a missing one.
+    static int luaHttpCommon(lua_State *L, bool tls)
     {
         if (WiFi.status() != WL_CONNECTED)
         {
@@ -231,29 +222,29 @@ namespace LuaApps::LuaFunctions
         }
 
         luaL_checktype(L, 1, LUA_TTABLE);
-        const char *method = "GET";
-        const char *url = nullptr;
-        String body = "";
-        std::map<String, String> headers;
+        HttpPool::Request req;
+        req.maxRedirects = 0; // same as HTTPClient's default
 
         lua_getfield(L, 1, "method");
         if (!lua_isnil(L, -1))
-            method = luaL_checkstring(L, -1);
+            req.method = luaL_checkstring(L, -1);
         lua_pop(L, 1);
 
         lua_getfield(L, 1, "url");
         if (!lua_isnil(L, -1))
-            url = luaL_checkstring(L, -1);
+            req.url = luaL_checkstring(L, -1);
         else
         {
             lua_pushstring(L, "Missing 'url' field");
             return lua_error(L);
         }
         lua_pop(L, 1);
+        if (!req.url.startsWith("http://") && !req.url.startsWith("https://"))
+            req.url = String(tls ? "https://" : "http://") + req.url;
 
         lua_getfield(L, 1, "body");
         if (!lua_isnil(L, -1))
-            body = luaL_checkstring(L, -1);
+            req.body = luaL_checkstring(L, -1);
         lua_pop(L, 1);
 
         lua_getfield(L, 1, "headers");
@@ -262,133 +253,135 @@ namespace LuaApps::LuaFunctions
             lua_pushnil(L);
             while (lua_next(L, -2))
             {
-                headers[luaL_checkstring(L, -2)] = luaL_checkstring(L, -1);
+                req.headers[luaL_checkstring(L, -2)] = luaL_checkstring(L, -1);
                 lua_pop(L, 1);
             }
         }
         lua_pop(L, 1);
 
-        WiFiClient client;
-        HTTPClient http;
-        if (!http.begin(client, url))
-        {
-            lua_pushstring(L, "Failed to begin HTTP connection");
-            return lua_error(L);
-        }
-
-        for (auto &pair : headers)
-            http.addHeader(pair.first, pair.second);
-
-        int code = -1;
-        String response;
-
-        if (strcmp(method, "GET") == 0)
-            code = http.GET();
-        else if (strcmp(method, "POST") == 0)
-            code = http.POST(body);
-        else if (strcmp(method, "PUT") == 0)
-            code = http.PUT(body);
-        else if (strcmp(method, "DELETE") == 0)
-            code = http.sendRequest("DELETE", body);
-        else
+        if (req.method != "GET" && req.method != "POST" && req.method != "PUT" && req.method != "DELETE")
         {
-            http.end();
             lua_pushstring(L, "Unsupported HTTP method");
             return lua_error(L);
         }
 
-        response = (code > 0) ? http.getString() : String("Request failed: ") + http.errorToString(code);
-        lua_newtable(L);
-        lua_pushinteger(L, code);
-        lua_setfield(L, -2, "status");
-        lua_pushstring(L, response.c_str());
-        lua_setfield(L, -2, "body");
-
-        http.end();
-        return 1;
-    }
-
-    int luaHttpsRequest(lua_State *L)
-    {
-        if (WiFi.status() != WL_CONNECTED)
-        {
-            lua_pushstring(L, "Not connected to WiFi");
-            return lua_error(L);
-        }
-
-        luaL_checktype(L, 1, LUA_TTABLE);
-        const char *method = "GET";
-        const char *url = nullptr;
-        String body = "";
-        std::map<String, String> headers;
-
-        lua_getfield(L, 1, "method");
+        // saveTo = "file" / onChunk = function(chunk): stream the body instead of returning it
+        Network::BodyTarget target;
+        lua_getfield(L, 1, "saveTo");
         if (!lua_isnil(L, -1))
-            method = luaL_checkstring(L, -1);
-        lua_pop(L, 1);
-
-        lua_getfield(L, 1, "url");
+            target.saveTo = luaL_checkstring(L, -1);
+        lua_getfield(L, 1, "onChunk");
         if (!lua_isnil(L, -1))
-            url = luaL_checkstring(L, -1);
-        else
         {
-            lua_pushstring(L, "Missing 'url' field");
-            return lua_error(L);
+            luaL_checktype(L, -1, LUA_TFUNCTION);
+            target.onChunk = lua_absindex(L, -1);
         }
-        lua_pop(L, 1);
 
-        lua_getfield(L, 1, "body");
-        if (!lua_isnil(L, -1))
-            body = luaL_checkstring(L, -1);
-        lua_pop(L, 1);
+        bool streamed = target.saveTo.length() > 0 || target.onChunk != 0;
 
-        lua_getfield(L, 1, "headers");
-        if (lua_istable(L, -1))
+        HttpPool::Response res;
+        String response;
+        int code = -1;
+        size_t bytes = 0;
+        if (!streamed)
         {
-            lua_pushnil(L);
-            while (lua_next(L, -2))
-            {
-                headers[luaL_checkstring(L, -2)] = luaL_checkstring(L, -1);
-                lua_pop(L, 1);
-            }
+            if (HttpPool::fetch(req, res, response))
+                code = res.status;
+            else
+                response = "Request failed: " + res.error;
         }
-        lua_pop(L, 1);
-
-        WiFiClientSecure client;
-        client.setInsecure();
-
-        HTTPClient http;
-        http.begin(client, url);
-
-        for (auto &pair : headers)
-            http.addHeader(pair.first, pair.second);
-
-        int code = -1;
-        String response;
-
-        if (strcmp(method, "GET") == 0)
-            code = http.GET();
-        else if (strcmp(method, "POST") == 0)
-            code = http.POST(body);
-        else if (strcmp(method, "PUT") == 0)
-            code = http.PUT(body);
-        else if (strcmp(method, "DELETE") == 0)
-            code = http.sendRequest("DELETE", body);
         else
         {
-            http.end();
-            lua_pushstring(L, "Unsupported HTTP method");
-            return lua_error(L);
+            HttpPool::Lease lease;
+            String err;
+            if (HttpPool::open(req, res, lease))
+            {
+                HttpPool::BodyReader body(*lease, res, req.timeoutMs);
+                bool ok = Network::streamResponseBody(L, body, target, bytes, err);
+                lease.release(ok && !res.close);
+                if (ok)
+                    code = res.status;
+            }
+            else
+                err = res.error;
+            if (code < 0)
+                response = "Request failed: " + err;
         }
 
-        response = (code > 0) ? http.getString() : String("Request failed: ") + http.errorToString(code);
         lua_newtable(L);
         lua_pushinteger(L, code);
         lua_setfield(L, -2, "status");
-        lua_pushstring(L, response.c_str());
+        lua_pushlstring(L, response.c_str(), response.length());
         lua_setfield(L, -2, "body");
+        if (streamed && code >= 0)
+        {
+            lua_pushinteger(L, (lua_Integer)bytes);
+            lua_setfield(L, -2, "bytes");
+        }
+        return 1;
+    }
 
-        http.end();
+    int luaHttpRequest(lua_State *L)
+    {
+        return luaHttpCommon(L, false);
+    }
+
+    int luaHttpsRequest(lua_State *L)
+    {
+        return luaHttpCommon(L, true);
+    }
+
+    // httpPoolStats() -> {requests, hits, connects, handshakes, failures, evictions, tlsWaits, idle, inUse, tlsLive}
+    int luaHttpPoolStats(lua_State *L)
+    {
+        HttpPool::Stats st = HttpPool::stats();
+        lua_newtable(L);
+        lua_pushinteger(L, st.requests);
+        lua_setfield(L, -2, "requests");
+        lua_pushinteger(L, st.hits);
+        lua_setfield(L, -2, "hits");
+        lua_pushinteger(L, st.connects);
+        lua_setfield(L, -2, "connects");
+        lua_pushinteger(L, st.handshakes);
+        lua_setfield(L, -2, "handshakes");
+        lua_pushinteger(L, st.failures);
+        lua_setfield(L, -2, "failures");
+        lua_pushinteger(L, st.evictions);
+        lua_setfield(L, -2, "evictions");
+        lua_pushinteger(L, st.tlsWaits);
+        lua_setfield(L, -2, "tlsWaits");
+        lua_pushinteger(L, st.idle);
+        lua_setfield(L, -2, "idle");
+        lua_pushinteger(L, st.inUse);
+        lua_setfield(L, -2, "inUse");
+        lua_pushinteger(L, st.tlsLive);
+        lua_setfield(L, -2, "tlsLive");
+        return 1;
+    }
+
+    // svgCacheStats() -> {hits, misses, parseFailures, collisions, evictions, parseMs, maxParseUs, bytes, entries}
+    int luaSvgCacheStats(lua_State *L)
+    {
+        SVGStats st = svgStats();
+        lua_newtable(L);
+        lua_pushinteger(L, st.hits);
+        lua_setfield(L, -2, "hits");
+        lua_pushinteger(L, st.misses);
+        lua_setfield(L, -2, "misses");
+        lua_pushinteger(L, st.parseFailures);
+        lua_setfield(L, -2, "parseFailures");
+        lua_pushinteger(L, st.collisions);
+        lua_setfield(L, -2, "collisions");
+        lua_pushinteger(L, st.evictions);
+        lua_setfield(L, -2, "evictions");
+        lua_pushinteger(L, (lua_Integer)(st.parseUs / 1000));
+        lua_setfield(L, -2, "parseMs");
+        lua_pushinteger(L, st.maxParseUs);
+        lua_setfield(L, -2, "maxParseUs");
+        lua_pushinteger(L, (lua_Integer)st.bytes);
+        lua_setfield(L, -2, "bytes");
+        lua_pushinteger(L, (lua_Integer)st.entries);
+        lua_setfield(L, -2, "entries");
         return 1;
     }
 
@@ -401,6 +394,8 @@ namespace LuaApps::LuaFunctions
         lua_register(L, "millis", luaMillis);
         lua_register(L, "httpReq", luaHttpRequest);
         lua_register(L, "httpsReq", luaHttpsRequest);
+        lua_register(L, "httpPoolStats", luaHttpPoolStats);
+        lua_register(L, "svgCacheStats", luaSvgCacheStats);
         lua_register(L, "RGB", lua_RGB);
         lua_register(L, "getTheme", lua_getTheme);
 
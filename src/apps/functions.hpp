@@ -18,6 +18,8 @@ extern "C"
 #include "fslib.hpp"
 #include "../auth/auth.hpp"
 #include "../wifi/index.hpp"
+#include "../wifi/http-pool.hpp"
+#include "../screen/svg.hpp"
 #include "../fs/enc-fs.hpp"
 #include "index.hpp"
 #include "../styles/global.hpp"
@@ -33,5 +35,7 @@ namespace LuaApps::LuaFunctions
     int luaMillis(lua_State *L);
     int luaHttpRequest(lua_State *L);
     int luaHttpsRequest(lua_State *L);
+    int luaHttpPoolStats(lua_State *L);
+    int luaSvgCacheStats(lua_State *L);
     void register_default_functions(lua_State *L);
 }
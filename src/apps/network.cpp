@@ -2,9 +2,11 @@
 // Implementation for LuaApps::Network
 //
 // Note: This implementation targets typical ESP32 Arduino environment.
-// It uses WiFiClient, WiFiServer, WiFiUDP and WiFiClientSecure.
-// Async HTTP uses std::thread when available (ESP32). If threads are not available,
-// httpRequestAsync returns NetError::NOT_IMPLEMENTED.
+// It uses WiFiClient and WiFiClientSecure for TCP/TLS, plain lwIP sockets for servers and UDP,
+// and the NetReactor (wifi/net-reactor.hpp) for every blocking wait, so nothing busy-polls.
+// HTTP requests go through the shared keep-alive pool in wifi/http-pool.hpp.
+// Async HTTP runs on the NetWorkers task pool (wifi/net-workers.hpp); Lua gets its results on
+// the app's own task through net.await / net.poll.
 //
 // This file provides a practical, self-contained implementation of the header API
 // provided earlier. It's written to be robust and straightforward; further
@@ -13,19 +15,27 @@
 #include "network.hpp"
 
 #include <WiFiClient.h>
-#include <WiFiServer.h>
-#include <WiFiUdp.h>
 #include <WiFiClientSecure.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "lwip/sockets.h"
+
+#include "../wifi/http-pool.hpp"
+#include "../wifi/net-reactor.hpp"
+#include "../wifi/net-workers.hpp"
 
 #include <sstream>
 #include <algorithm>
 #include <cstring>
+#include <cerrno>
 #include <chrono>
-#include <thread>
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
 #include <queue>
+#include <deque>
+#include <memory>
+#include <new>
 
     namespace LuaApps::Network
 {
@@ -40,12 +50,27 @@
     static std::atomic<int32_t> g_nextUdpHandle{1};
     static std::atomic<int32_t> g_nextTlsHandle{1};
 
+    // WiFiClientSecure keeps its socket in the protected ssl context; the reactor needs the fd.
+    class TlsClient : public WiFiClientSecure
+    {
+    public:
+        int sockFd() const { return sslclient ? sslclient->socket : -1; }
+    };
+
+    struct TcpServer
+    {
+        int fd = -1;      // listening lwIP socket
+        int watchId = -1; // NetReactor watch accepting connections
+        std::deque<SocketHandle> pending; // accepted, waiting for tcpServerAccept()
+        std::function<void(SocketHandle)> onClient;
+    };
+
     // Maps for resources
     static std::map<SocketHandle, WiFiClient *> g_tcpClients;
-    static std::map<ServerHandle, WiFiServer *> g_tcpServers;
-    static std::map<ServerHandle, std::function<void(SocketHandle)>> g_serverCallbacks;
-    static std::map<UdpHandle, WiFiUDP *> g_udpHandles;
-    static std::map<TlsHandle, WiFiClientSecure *> g_tlsClients;
+    static std::map<ServerHandle, TcpServer *> g_tcpServers;
+    static std::queue<std::pair<ServerHandle, SocketHandle>> g_acceptedQueue; // for onClient, see poll_network_events
+    static std::map<UdpHandle, int> g_udpHandles;                             // lwIP socket
+    static std::map<TlsHandle, TlsClient *> g_tlsClients;
 
     // Queue for async HTTP callbacks/results
     struct AsyncHttpTask
@@ -215,31 +240,43 @@
         return (ssize_t)written;
     }
 
+    // Block until `c` has buffered data or was closed; false on timeout. Called without g_lock:
+    // a handle belongs to the app task using it, so `c` stays valid while that task waits.
+    static bool waitReadable(WiFiClient *c, int fd, uint32_t timeoutMs)
+    {
+        uint32_t start = millis();
+        while (c->available() == 0 && c->connected())
+        {
+            uint32_t spent = millis() - start;
+            if (spent >= timeoutMs)
+                return false;
+            std::vector<NetReactor::WaitFd> w = {{fd, NetReactor::EV_READ, 0}};
+            if (NetReactor::wait(w, timeoutMs - spent) == 0)
+                return false;
+        }
+        return true;
+    }
+
     ssize_t tcpRecv(SocketHandle sock, uint8_t *buffer, size_t bufferLen, uint32_t timeoutMs)
     {
         if (!buffer || bufferLen == 0)
             return -1;
-        std::lock_guard<std::mutex> guard(g_lock);
-        auto it = g_tcpClients.find(sock);
-        if (it == g_tcpClients.end())
-            return -1;
-        WiFiClient *client = it->second;
-        if (!client->connected() && client->available() == 0)
-            return 0; // EOF
-
-        // Wait up to timeoutMs for data
-        uint32_t waited = 0;
-        const uint32_t step = 5;
-        while (client->available() == 0 && waited < timeoutMs)
+        WiFiClient *client;
         {
-            delay(step);
-            waited += step;
+            std::lock_guard<std::mutex> guard(g_lock);
+            auto it = g_tcpClients.find(sock);
+            if (it == g_tcpClients.end())
+                return -1;
+            client = it->second;
         }
-        if (client->available() == 0)
+
+        if (!waitReadable(client, client->fd(), timeoutMs))
             return -1; // timeout/no data
+        int avail = client->available();
+        if (avail == 0)
+            return 0; // EOF
 
-        size_t toRead = std::min(bufferLen, (size_t)client->available());
-        int r = client->read(buffer, toRead);
+        int r = client->read(buffer, std::min(bufferLen, (size_t)avail));
         if (r < 0)
             return -1;
         return (ssize_t)r;
@@ -263,65 +300,175 @@
 
     /* --- TCP server API --- */
 
+    // Runs on the reactor task while the listening socket has connections queued.
+    static void acceptPending(ServerHandle sh, int lfd)
+    {
+        while (true)
+        {
+            int cfd = accept(lfd, nullptr, nullptr);
+            if (cfd < 0)
+                return;
+            int one = 1;
+            setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            WiFiClient *c = new WiFiClient(cfd);
+
+            std::lock_guard<std::mutex> guard(g_lock);
+            auto it = g_tcpServers.find(sh);
+            TcpServer *sv = it == g_tcpServers.end() ? nullptr : it->second;
+            size_t queued = !sv ? 0 : sv->onClient ? g_acceptedQueue.size() : sv->pending.size();
+            if (!sv || queued >= NETWORK_MAX_SOCKETS)
+            {
+                // server gone or nobody picks the connections up
+                c->stop();
+                delete c;
+                continue;
+            }
+            SocketHandle h = g_nextSocketHandle.fetch_add(1);
+            g_tcpClients[h] = c;
+            if (sv->onClient)
+                g_acceptedQueue.push({sh, h});
+            else
+                sv->pending.push_back(h);
+        }
+    }
+
     std::pair<ServerHandle, NetResult> tcpServerListen(uint16_t port, std::function<void(SocketHandle client)> onClient, uint16_t backlog)
     {
         if (port == 0)
             return {-1, NetResult(NetError::BAD_ARG, "port 0 invalid")};
-        WiFiServer *server = new WiFiServer(port);
-        if (!server)
-            return {-1, NetResult(NetError::NO_RESOURCES, "alloc failed")};
-        server->setNoDelay(true);
-        server->begin(backlog);
-
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            return {-1, NetResult(NetError::NO_RESOURCES, "socket failed")};
+
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, backlog) < 0)
+        {
+            close(fd);
+            return {-1, NetResult(NetError::IO, "bind/listen failed")};
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+        TcpServer *sv = new TcpServer();
+        sv->fd = fd;
+        sv->onClient = onClient;
         ServerHandle h = g_nextServerHandle.fetch_add(1);
         {
             std::lock_guard<std::mutex> guard(g_lock);
-            g_tcpServers[h] = server;
-            g_serverCallbacks[h] = onClient;
+            g_tcpServers[h] = sv;
+        }
+
+        int id = NetReactor::watch(fd, NetReactor::EV_READ, [h](int lfd, uint8_t ev)
+                                   {
+                                       if (!(ev & NetReactor::EV_ERROR))
+                                           acceptPending(h, lfd);
+                                   });
+        if (id < 0)
+        {
+            tcpServerStop(h);
+            return {-1, NetResult(NetError::NO_RESOURCES, "reactor unavailable")};
         }
+        std::lock_guard<std::mutex> guard(g_lock);
+        sv->watchId = id;
         return {h, NetResult(NetError::OK)};
     }
 
+    SocketHandle tcpServerAccept(ServerHandle server, uint32_t timeoutMs)
+    {
+        uint32_t start = millis();
+        while (true)
+        {
+            int lfd;
+            {
+                std::lock_guard<std::mutex> guard(g_lock);
+                auto it = g_tcpServers.find(server);
+                if (it == g_tcpServers.end())
+                    return -1;
+                TcpServer *sv = it->second;
+                if (!sv->pending.empty())
+                {
+                    SocketHandle h = sv->pending.front();
+                    sv->pending.pop_front();
+                    return h;
+                }
+                lfd = sv->fd;
+            }
+
+            uint32_t spent = millis() - start;
+            if (spent >= timeoutMs)
+                return -1;
+            // wakes once the reactor has accepted (its callback runs before waiters are released)
+            std::vector<NetReactor::WaitFd> w = {{lfd, NetReactor::EV_READ, 0}};
+            if (NetReactor::wait(w, timeoutMs - spent) > 0)
+                delay(1); // queued in the backlog but not yet accepted by the reactor
+        }
+    }
+
     NetResult tcpServerStop(ServerHandle server)
     {
-        std::lock_guard<std::mutex> guard(g_lock);
-        auto it = g_tcpServers.find(server);
-        if (it == g_tcpServers.end())
-            return NetResult(NetError::BAD_ARG, "invalid server");
-        WiFiServer *sv = it->second;
-        if (sv)
+        TcpServer *sv;
         {
-            sv->close();
-            delete sv;
+            std::lock_guard<std::mutex> guard(g_lock);
+            auto it = g_tcpServers.find(server);
+            if (it == g_tcpServers.end())
+                return NetResult(NetError::BAD_ARG, "invalid server");
+            sv = it->second;
+            g_tcpServers.erase(it);
+
+            // connections nobody accepted yet
+            for (SocketHandle h : sv->pending)
+            {
+                auto c = g_tcpClients.find(h);
+                if (c == g_tcpClients.end())
+                    continue;
+                c->second->stop();
+                delete c->second;
+                g_tcpClients.erase(c);
+            }
         }
-        g_tcpServers.erase(it);
-        g_serverCallbacks.erase(server);
+        // outside g_lock, the accept callback takes it
+        NetReactor::unwatch(sv->watchId);
+        close(sv->fd);
+        delete sv;
         return NetResult(NetError::OK);
     }
 
     /* --- UDP API --- */
 
+    static int findUdp(UdpHandle h)
+    {
+        std::lock_guard<std::mutex> guard(g_lock);
+        auto it = g_udpHandles.find(h);
+        return it == g_udpHandles.end() ? -1 : it->second;
+    }
+
     std::pair<UdpHandle, NetResult> udpOpen(uint16_t localPort)
     {
-        WiFiUDP *u = new WiFiUDP();
-        if (!u)
-            return {-1, NetResult(NetError::NO_RESOURCES, "alloc failed")};
-        if (localPort != 0)
-        {
-            if (!u->begin(localPort))
-            {
-                delete u;
-                return {-1, NetResult(NetError::IO, "bind failed")};
-            }
-        }
-        else
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0)
+            return {-1, NetResult(NetError::NO_RESOURCES, "socket failed")};
+
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        // port 0 binds an ephemeral port
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(localPort);
+        if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
         {
-            // begin without port allocates when sending
-            u->begin(0);
+            close(fd);
+            return {-1, NetResult(NetError::IO, "bind failed")};
         }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
         UdpHandle h = g_nextUdpHandle.fetch_add(1);
         std::lock_guard<std::mutex> guard(g_lock);
-        g_udpHandles[h] = u;
+        g_udpHandles[h] = fd;
         return {h, NetResult(NetError::OK)};
     }
 
@@ -329,76 +476,63 @@
     {
         if (!data || len == 0)
             return -1;
-        std::lock_guard<std::mutex> guard(g_lock);
-        auto it = g_udpHandles.find(h);
-        if (it == g_udpHandles.end())
+        int fd = findUdp(h);
+        if (fd < 0)
             return -1;
-        WiFiUDP *u = it->second;
-        if (!u)
+
+        IPAddress ip;
+        if (!ip.fromString(hostOrIp) && !dnsResolve(hostOrIp, ip).ok())
             return -1;
-        // beginPacket + write + endPacket
-        if (!u->beginPacket(hostOrIp.c_str(), port))
-        {
+        sockaddr_in to = {};
+        to.sin_family = AF_INET;
+        to.sin_port = htons(port);
+        to.sin_addr.s_addr = (uint32_t)ip;
+        int r = sendto(fd, data, len, 0, (sockaddr *)&to, sizeof(to));
+        if (r < 0)
             return -1;
-        }
-        size_t written = u->write(data, len);
-        if (written != len)
-        {
-            // still call endPacket
-            u->endPacket();
-            return (ssize_t)written;
-        }
-        int res = u->endPacket();
-        if (res == 1)
-            return (ssize_t)written;
-        return -1;
+        return (ssize_t)r;
     }
 
     ssize_t udpReceiveFrom(UdpHandle h, uint8_t *buffer, size_t bufferLen, String &outFrom, uint16_t &outPort, uint32_t timeoutMs)
     {
         if (!buffer || bufferLen == 0)
             return -1;
-        std::lock_guard<std::mutex> guard(g_lock);
-        auto it = g_udpHandles.find(h);
-        if (it == g_udpHandles.end())
-            return -1;
-        WiFiUDP *u = it->second;
-        if (!u)
+        int fd = findUdp(h);
+        if (fd < 0)
             return -1;
 
-        uint32_t waited = 0;
-        const uint32_t step = 5;
-        while (u->parsePacket() == 0 && waited < timeoutMs)
+        // datagrams larger than bufferLen are truncated
+        sockaddr_in from = {};
+        socklen_t fromLen = sizeof(from);
+        int r = recvfrom(fd, buffer, bufferLen, MSG_DONTWAIT, (sockaddr *)&from, &fromLen);
+        if (r < 0 && (errno == EWOULDBLOCK || errno == EAGAIN))
         {
-            delay(step);
-            waited += step;
+            // nothing queued yet, only then park on the reactor
+            std::vector<NetReactor::WaitFd> w = {{fd, NetReactor::EV_READ, 0}};
+            if (NetReactor::wait(w, timeoutMs) == 0)
+                return -1;
+            fromLen = sizeof(from);
+            r = recvfrom(fd, buffer, bufferLen, MSG_DONTWAIT, (sockaddr *)&from, &fromLen);
         }
-        int pktSize = u->parsePacket();
-        if (pktSize <= 0)
-            return -1;
-        int toRead = std::min((int)bufferLen, pktSize);
-        int r = u->read(buffer, toRead);
-        IPAddress remoteIp = u->remoteIP();
-        outFrom = remoteIp.toString();
-        outPort = u->remotePort();
         if (r < 0)
             return -1;
+        outFrom = IPAddress(from.sin_addr.s_addr).toString();
+        outPort = ntohs(from.sin_port);
         return (ssize_t)r;
     }
 
     NetResult udpClose(UdpHandle h)
     {
-        std::lock_guard<std::mutex> guard(g_lock);
-        auto it = g_udpHandles.find(h);
-        if (it == g_udpHandles.end())
-            return NetResult(NetError::BAD_ARG, "invalid udp handle");
-        WiFiUDP *u = it->second;
-        if (u)
+        int fd;
         {
-            u->stop();
-            delete u;
+            std::lock_guard<std::mutex> guard(g_lock);
+            auto it = g_udpHandles.find(h);
+            if (it == g_udpHandles.end())
+                return NetResult(NetError::BAD_ARG, "invalid udp handle");
+            fd = it->second;
+            g_udpHandles.erase(it);
         }
-        g_udpHandles.erase(it);
+        close(fd);
         return NetResult(NetError::OK);
     }
 
@@ -408,7 +542,7 @@
     {
         if (host.length() == 0)
             return {-1, NetResult(NetError::BAD_ARG, "host empty")};
-        WiFiClientSecure *c = new WiFiClientSecure();
+        TlsClient *c = new TlsClient();
         if (!c)
             return {-1, NetResult(NetError::NO_RESOURCES, "alloc failed")};
         // On many ESP32 builds, setInsecure or setCACert can be used. We'll default to insecure to avoid certificate complexity.
@@ -450,7 +584,7 @@
         auto it = g_tlsClients.find(t);
         if (it == g_tlsClients.end())
             return -1;
-        WiFiClientSecure *c = it->second;
+        TlsClient *c = it->second;
         if (!c->connected())
             return -1;
         size_t written = 0;
@@ -479,25 +613,22 @@
     {
         if (!buffer || bufferLen == 0)
             return -1;
-        std::lock_guard<std::mutex> guard(g_lock);
-        auto it = g_tlsClients.find(t);
-        if (it == g_tlsClients.end())
-            return -1;
-        WiFiClientSecure *c = it->second;
-        if (!c->connected() && c->available() == 0)
-            return 0;
-
-        uint32_t waited = 0;
-        const uint32_t step = 5;
-        while (c->available() == 0 && waited < timeoutMs)
+        TlsClient *c;
         {
-            delay(step);
-            waited += step;
+            std::lock_guard<std::mutex> guard(g_lock);
+            auto it = g_tlsClients.find(t);
+            if (it == g_tlsClients.end())
+                return -1;
+            c = it->second;
         }
-        if (c->available() == 0)
+
+        // the socket may turn readable with only part of a TLS record, waitReadable() keeps waiting then
+        if (!waitReadable(c, c->sockFd(), timeoutMs))
             return -1;
-        size_t toRead = std::min(bufferLen, (size_t)c->available());
-        int r = c->read(buffer, toRead);
+        int avail = c->available();
+        if (avail == 0)
+            return 0;
+        int r = c->read(buffer, std::min(bufferLen, (size_t)avail));
         if (r < 0)
             return -1;
         return (ssize_t)r;
@@ -509,7 +640,7 @@
         auto it = g_tlsClients.find(t);
         if (it == g_tlsClients.end())
             return NetResult(NetError::BAD_ARG, "invalid tls handle");
-        WiFiClientSecure *c = it->second;
+        TlsClient *c = it->second;
         if (c)
         {
             c->stop();
@@ -521,7 +652,46 @@
 
     /* --- HTTP synchronous request --- */
 
-    // Very small HTTP request builder + response parser
+    // Translate the Network request arguments into a pool request; callers see 3xx responses as before.
+    static NetResult buildPoolRequest(const String &method,
+                                      const String &host,
+                                      const String &path,
+                                      const std::map<String, String> &headers,
+                                      const String &body,
+                                      uint16_t port,
+                                      bool useTls,
+                                      uint32_t timeoutMs,
+                                      HttpPool::Request &req)
+    {
+        if (method.length() == 0 || host.length() == 0)
+            return NetResult(NetError::BAD_ARG, "method/host empty");
+        String requestPath = path.length() ? path : "/";
+        if (!requestPath.startsWith("/"))
+            requestPath = "/" + requestPath;
+
+        uint16_t actualPort = port;
+        if (actualPort == 0)
+            actualPort = useTls ? 443 : 80;
+
+        req.method = method;
+        req.url = String(useTls ? "https://" : "http://") + host + ":" + String(actualPort) + requestPath;
+        req.headers = headers;
+        req.body = body;
+        req.timeoutMs = timeoutMs;
+        req.maxRedirects = 0;
+        return NetResult(NetError::OK);
+    }
+
+    static NetResult poolError(const HttpPool::Response &pr)
+    {
+        if (pr.status == 0 && pr.error == "connect failed")
+            return NetResult(NetError::NOT_CONNECTED, pr.error);
+        if (pr.status == 0)
+            return NetResult(NetError::TIMEOUT, pr.error);
+        return NetResult(NetError::IO, pr.error);
+    }
+
+    // Thin wrapper over HttpPool: keep-alive connections are shared with the rest of the system.
     static HttpResponse performHttpRequestInternal(const String &method,
                                                    const String &host,
                                                    const String &path,
@@ -532,268 +702,24 @@
                                                    uint32_t timeoutMs)
     {
         HttpResponse res;
-        res.result = NetResult(NetError::UNKNOWN, "not executed");
-
-        if (method.length() == 0 || host.length() == 0)
-        {
-            res.result = NetResult(NetError::BAD_ARG, "method/host empty");
-            return res;
-        }
-        String requestPath = path.length() ? path : "/";
-
-        uint16_t actualPort = port;
-        if (actualPort == 0)
-            actualPort = useTls ? 443 : 80;
-
-        // connect
-        bool connected = false;
-        WiFiClient *rawClient = nullptr;
-        WiFiClientSecure *secureClient = nullptr;
-        if (useTls)
-        {
-            secureClient = new WiFiClientSecure();
-            if (!secureClient)
-            {
-                res.result = NetResult(NetError::NO_RESOURCES, "alloc tls client failed");
-                return res;
-            }
-            secureClient->setInsecure();
-#if defined(ARDUINO_ARCH_ESP32)
-            connected = secureClient->connect(host.c_str(), actualPort, timeoutMs);
-#else
-            secureClient->connect(host.c_str(), actualPort);
-            auto start = std::chrono::steady_clock::now();
-            while (!secureClient->connected())
-            {
-                auto now = std::chrono::steady_clock::now();
-                if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() >= timeoutMs)
-                    break;
-                delay(5);
-            }
-            connected = secureClient->connected();
-#endif
-        }
-        else
-        {
-            rawClient = new WiFiClient();
-            if (!rawClient)
-            {
-                res.result = NetResult(NetError::NO_RESOURCES, "alloc client failed");
-                return res;
-            }
-#if defined(ARDUINO_ARCH_ESP32)
-            connected = rawClient->connect(host.c_str(), actualPort, timeoutMs);
-#else
-            rawClient->connect(host.c_str(), actualPort);
-            auto start = std::chrono::steady_clock::now();
-            while (!rawClient->connected())
-            {
-                auto now = std::chrono::steady_clock::now();
-                if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() >= timeoutMs)
-                    break;
-                delay(5);
-            }
-            connected = rawClient->connected();
-#endif
-        }
-
-        if (!connected)
-        {
-            if (secureClient)
-            {
-                delete secureClient;
-            }
-            if (rawClient)
-            {
-                delete rawClient;
-            }
-            res.result = NetResult(NetError::NOT_CONNECTED, "connect failed");
+        HttpPool::Request req;
+        res.result = buildPoolRequest(method, host, path, headers, body, port, useTls, timeoutMs, req);
+        if (!res.result.ok())
             return res;
-        }
-
-        // build request lines
-        std::ostringstream ss;
-        ss << (const char *)method.c_str() << " " << (const char *)requestPath.c_str() << " HTTP/1.1\r\n";
-        ss << "Host: " << (const char *)host.c_str() << "\r\n";
-        ss << "User-Agent: LuaApps/1.0\r\n";
-        if (body.length() > 0)
-        {
-            ss << "Content-Length: " << body.length() << "\r\n";
-        }
-        // add headers
-        for (const auto &h : headers)
-        {
-            ss << (const char *)h.first.c_str() << ": " << (const char *)h.second.c_str() << "\r\n";
-        }
-        ss << "Connection: close\r\n";
-        ss << "\r\n";
-        if (body.length() > 0)
-            ss << (const char *)body.c_str();
 
-        String reqStr = ss.str().c_str();
-
-        WiFiClient *rw = nullptr;
-        if (useTls)
-        {
-            rw = secureClient;
-        }
-        else
-        {
-            rw = rawClient;
-        }
-
-        // write request
-        size_t total = reqStr.length();
-        size_t written = 0;
-        uint32_t startMs = millis();
-        while (written < total)
-        {
-            int w = rw->write((const uint8_t *)reqStr.c_str() + written, total - written);
-            if (w > 0)
-                written += w;
-            else
-            {
-                if (millis() - startMs > timeoutMs)
-                {
-                    // timeout
-                    rw->stop();
-                    if (secureClient)
-                        delete secureClient;
-                    if (rawClient)
-                        delete rawClient;
-                    res.result = NetResult(NetError::TIMEOUT, "write timeout");
-                    return res;
-                }
-                delay(1);
-            }
-        }
-
-        // read status line
-        // wait for data up to timeout
-        uint32_t waited = 0;
-        const uint32_t step = 5;
-        while (!rw->available() && waited < timeoutMs)
-        {
-            delay(step);
-            waited += step;
-        }
-        if (!rw->available())
+        HttpPool::Response pr;
+        String bodyStr;
+        if (!HttpPool::fetch(req, pr, bodyStr))
         {
-            rw->stop();
-            if (secureClient)
-                delete secureClient;
-            if (rawClient)
-                delete rawClient;
-            res.result = NetResult(NetError::TIMEOUT, "no response");
+            res.result = poolError(pr);
+            res.status_code = pr.status;
             return res;
         }
 
-        // read header lines
-        String statusLine = rw->readStringUntil('\n'); // includes \r often
-        statusLine.trim();
-        // parse status code
-        int status = 0;
-        {
-            // Example: HTTP/1.1 200 OK
-            int pos1 = statusLine.indexOf(' ');
-            if (pos1 > 0)
-            {
-                int pos2 = statusLine.indexOf(' ', pos1 + 1);
-                String codeStr;
-                if (pos2 > pos1)
-                    codeStr = statusLine.substring(pos1 + 1, pos2);
-                else
-                    codeStr = statusLine.substring(pos1 + 1);
-                status = codeStr.toInt();
-            }
-        }
-        res.status_code = status;
-
-        // Headers
-        std::map<String, String> respHeaders;
-        while (true)
-        {
-            String line = rw->readStringUntil('\n');
-            line.trim();
-            if (line.length() == 0)
-                break;
-            int colon = line.indexOf(':');
-            if (colon > 0)
-            {
-                String k = line.substring(0, colon);
-                String v = line.substring(colon + 1);
-                v.trim();
-                respHeaders[k] = v;
-            }
-        }
-        res.headers = respHeaders;
-
-        // Body: if Content-Length present, read exact amount; otherwise read until connection closed.
-        size_t contentLength = 0;
-        bool hasContentLength = false;
-        auto it = respHeaders.find("Content-Length");
-        if (it != respHeaders.end())
-        {
-            contentLength = (size_t)it->second.toInt();
-            hasContentLength = true;
-        }
-
-        String bodyStr;
-        if (hasContentLength)
-        {
-            size_t remaining = contentLength;
-            while (remaining > 0)
-            {
-                if (rw->available())
-                {
-                    int toread = std::min((size_t)rw->available(), remaining);
-                    char chunk[256];
-                    int r = rw->read((uint8_t *)chunk, toread);
-                    if (r > 0)
-                    {
-                        bodyStr += String(chunk, r);
-                        remaining -= r;
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
-                else
-                {
-                    // wait a bit
-                    delay(5);
-                }
-            }
-        }
-        else
-        {
-            // read until EOF/connection close or small timeout
-            uint32_t idle = 0;
-            while (true)
-            {
-                while (rw->available())
-                {
-                    char chunk[256];
-                    int r = rw->read((uint8_t *)chunk, sizeof(chunk));
-                    if (r > 0)
-                        bodyStr += String(chunk, r);
-                }
-                if (!rw->connected())
-                    break;
-                delay(5);
-                idle += 5;
-                if (idle > timeoutMs)
-                    break;
-            }
-        }
+        res.status_code = pr.status;
+        res.headers = pr.headers;
         res.body = bodyStr;
         res.result = NetResult(NetError::OK);
-        rw->stop();
-        if (secureClient)
-            delete secureClient;
-        if (rawClient)
-            delete rawClient;
         return res;
     }
 
@@ -819,37 +745,15 @@
                                bool useTls,
                                uint32_t timeoutMs)
     {
-#if defined(ARDUINO_ARCH_ESP32) || defined(__cpp_lib_thread)
-        // Launch worker thread to perform blocking request, then push result to queue for main-loop callback.
-        try
-        {
-            std::thread worker([method, host, path, headers, body, port, useTls, timeoutMs, callback]()
-                               {
+        // runs on a NetWorkers task, the callback is dispatched from poll_network_events()
+        bool queued = NetWorkers::post([method, host, path, headers, body, port, useTls, timeoutMs, callback]()
+                                       {
             HttpResponse r = performHttpRequestInternal(method, host, path, headers, body, port, useTls, timeoutMs);
-            // push to queue
-            {
-                std::lock_guard<std::mutex> qguard(g_asyncQueueLock);
-                g_asyncHttpQueue.push(AsyncHttpTask{callback, r});
-            } });
-            worker.detach();
-            return NetResult(NetError::OK);
-        }
-        catch (...)
-        {
-            return NetResult(NetError::NO_RESOURCES, "thread creation failed");
-        }
-#else
-        (void)method;
-        (void)host;
-        (void)path;
-        (void)callback;
-        (void)headers;
-        (void)body;
-        (void)port;
-        (void)useTls;
-        (void)timeoutMs;
-        return NetResult(NetError::NOT_IMPLEMENTED, "threads not available");
-#endif
+            std::lock_guard<std::mutex> qguard(g_asyncQueueLock);
+            g_asyncHttpQueue.push(AsyncHttpTask{callback, r}); });
+        if (!queued)
+            return NetResult(NetError::NO_RESOURCES, "async queue full");
+        return NetResult(NetError::OK);
     }
 
     /* --- Lua binding helpers --- */
@@ -958,93 +862,123 @@
         return NetResult(NetError::OK);
     }
 
-    /* --- Polling / event pumping --- */
+    /* --- Streaming response bodies --- */
 
-    void poll_network_events()
+    // App-relative ENC_FS path, resolved like exec(3, ...); ".." is rejected
+    static bool appFilePath(lua_State * L, const String &rel, ENC_FS::Path &out)
+    {
+        App *app = getApp(L);
+        if (!app || rel.length() == 0 || rel.indexOf("..") >= 0)
+            return false;
+        out = ENC_FS::str2Path(app->path + "/" + rel);
+        return true;
+    }
+
+    bool streamResponseBody(lua_State * L, HttpPool::BodyReader & body, const BodyTarget &target, size_t &outBytes, String &err)
     {
-        // 1) Check servers for new clients and accept them
-        std::vector<std::pair<ServerHandle, WiFiClient *>> accepted;
+        outBytes = 0;
+        ENC_FS::Path path;
+        ENC_FS::FileWriter file;
+        bool toFile = target.saveTo.length() > 0;
+        if (toFile && !appFilePath(L, target.saveTo, path))
         {
-            std::lock_guard<std::mutex> guard(g_lock);
-            for (auto &p : g_tcpServers)
-            {
-                ServerHandle sh = p.first;
-                WiFiServer *sv = p.second;
-                if (!sv)
-                    continue;
-                WiFiClient client = sv->available();
-                if (client)
-                {
-                    // Allocate new WiFiClient pointer and transfer
-                    WiFiClient *cptr = new WiFiClient(client);
-                    SocketHandle newSock = g_nextSocketHandle.fetch_add(1);
-                    g_tcpClients[newSock] = cptr;
-                    // get callback
-                    auto itcb = g_serverCallbacks.find(sh);
-                    if (itcb != g_serverCallbacks.end())
-                    {
-                        // Call callback outside lock to avoid deadlocks
-                        std::function<void(SocketHandle)> cb = itcb->second;
-                        // unlock before calling
-                        // we'll call it after collecting accepted sockets
-                        accepted.emplace_back(sh, cptr);
-                        // We also want to call cb with newSock; store mapping in a temp vector
-                        // We'll call below
-                        (void)cb;
-                    }
-                    else
-                    {
-                        // no callback; leave client available in map
-                    }
-                }
-            }
+            err = "invalid save path";
+            return false;
         }
-        // Now call callbacks for accepted connections, mapping cptr -> socket handle
-        // To map pointer to handle:
+        if (toFile && !file.open(path))
         {
-            std::lock_guard<std::mutex> guard(g_lock);
-            for (auto &entry : accepted)
+            err = "cannot open " + target.saveTo;
+            return false;
+        }
+
+        // one bounded buffer per request, whatever the body size
+        std::unique_ptr<uint8_t[]> buf(new uint8_t[HttpPool::HTTP_CHUNK]);
+        bool ok = true;
+        while (size_t n = body.read(buf.get(), HttpPool::HTTP_CHUNK))
+        {
+            outBytes += n;
+            if (toFile && !file.write(buf.get(), n))
             {
-                WiFiClient *cptr = entry.second;
-                // find handle
-                SocketHandle found = -1;
-                for (auto &kp : g_tcpClients)
+                err = "write failed";
+                ok = false;
+                break;
+            }
+            if (target.onChunk)
+            {
+                lua_pushvalue(L, target.onChunk);
+                lua_pushlstring(L, (const char *)buf.get(), n);
+                if (lua_pcall(L, 1, 1, 0) != LUA_OK)
                 {
-                    if (kp.second == cptr)
-                    {
-                        found = kp.first;
-                        break;
-                    }
+                    err = lua_tostring(L, -1);
+                    lua_pop(L, 1);
+                    ok = false;
+                    break;
                 }
-                if (found == -1)
-                    continue;
-                // find server callback
-                ServerHandle sh = entry.first;
-                auto itcb = g_serverCallbacks.find(sh);
-                if (itcb != g_serverCallbacks.end())
+                bool stop = lua_isboolean(L, -1) && !lua_toboolean(L, -1);
+                lua_pop(L, 1);
+                if (stop)
                 {
-                    // call callback (careful: user callback may assume main thread)
-                    try
-                    {
-                        itcb->second(found);
-                    }
-                    catch (...)
-                    {
-                        // swallow exceptions to avoid crashing
-                    }
+                    err = "aborted";
+                    ok = false;
+                    break;
                 }
             }
         }
+        if (ok && !body.done())
+        {
+            err = "body read failed";
+            ok = false;
+        }
 
-        // 2) Process async HTTP queue: invoke callbacks on main thread
-        std::vector<AsyncHttpTask> tasks;
+        if (toFile && !file.close() && ok)
         {
-            std::lock_guard<std::mutex> qguard(g_asyncQueueLock);
-            while (!g_asyncHttpQueue.empty())
-            {
-                tasks.push_back(g_asyncHttpQueue.front());
-                g_asyncHttpQueue.pop();
-            }
+            err = "write failed";
+            ok = false;
+        }
+        if (toFile && !ok)
+            ENC_FS::deleteFile(path); // no half downloads
+        return ok;
+    }
+
+    /* --- Polling / event pumping --- */
+
+    void poll_network_events()
+    {
+        // 1) onClient callbacks for connections the reactor accepted
+        std::vector<std::pair<std::function<void(SocketHandle)>, SocketHandle>> accepted;
+        {
+            std::lock_guard<std::mutex> guard(g_lock);
+            while (!g_acceptedQueue.empty())
+            {
+                auto entry = g_acceptedQueue.front();
+                g_acceptedQueue.pop();
+                auto it = g_tcpServers.find(entry.first);
+                if (it != g_tcpServers.end() && it->second->onClient)
+                    accepted.emplace_back(it->second->onClient, entry.second);
+            }
+        }
+        for (auto &entry : accepted)
+        {
+            // called without g_lock, the callback usually talks to the socket
+            try
+            {
+                entry.first(entry.second);
+            }
+            catch (...)
+            {
+                // swallow exceptions to avoid crashing
+            }
+        }
+
+        // 2) Native httpRequestAsync() callbacks (Lua requests are delivered by net.poll)
+        std::vector<AsyncHttpTask> tasks;
+        {
+            std::lock_guard<std::mutex> qguard(g_asyncQueueLock);
+            while (!g_asyncHttpQueue.empty())
+            {
+                tasks.push_back(g_asyncHttpQueue.front());
+                g_asyncHttpQueue.pop();
+            }
         }
         for (auto &t : tasks)
         {
@@ -1064,6 +998,15 @@
 
     static void cleanup_all_resources()
     {
+        std::vector<ServerHandle> servers;
+        {
+            std::lock_guard<std::mutex> guard(g_lock);
+            for (auto &p : g_tcpServers)
+                servers.push_back(p.first);
+        }
+        for (ServerHandle h : servers)
+            tcpServerStop(h);
+
         std::lock_guard<std::mutex> guard(g_lock);
         for (auto &p : g_tcpClients)
         {
@@ -1075,25 +1018,8 @@
         }
         g_tcpClients.clear();
 
-        for (auto &p : g_tcpServers)
-        {
-            if (p.second)
-            {
-                p.second->close();
-                delete p.second;
-            }
-        }
-        g_tcpServers.clear();
-        g_serverCallbacks.clear();
-
         for (auto &p : g_udpHandles)
-        {
-            if (p.second)
-            {
-                p.second->stop();
-                delete p.second;
-            }
-        }
+            close(p.second);
         g_udpHandles.clear();
 
         for (auto &p : g_tlsClients)
@@ -1122,28 +1048,229 @@
     {
         LH_TCP = 1,
         LH_UDP = 2,
-        LH_TLS = 3
+        LH_TLS = 3,
+        LH_SERVER = 4
     };
 
+    static const char *const HANDLE_METATABLES[] = {nullptr, "net.tcp", "net.udp", "net.tls", "net.server"};
+
     struct LuaHandle
     {
         int32_t handle;
         int32_t type;
     };
 
-    // Helper to check and fetch LuaHandle pointer
+    // Helper to check and fetch LuaHandle pointer; expectedType 0 accepts any net handle
     static LuaHandle *check_luahandle(lua_State * L, int idx, int expectedType)
     {
-        void *ud = luaL_checkudata(L, idx, "net.handle");
-        if (!ud)
-            return nullptr;
-        LuaHandle *lh = (LuaHandle *)ud;
-        if (expectedType != 0 && lh->type != expectedType)
+        if (expectedType != 0)
+            return (LuaHandle *)luaL_checkudata(L, idx, HANDLE_METATABLES[expectedType]);
+        for (int t = LH_TCP; t <= LH_SERVER; ++t)
+        {
+            void *ud = luaL_testudata(L, idx, HANDLE_METATABLES[t]);
+            if (ud)
+                return (LuaHandle *)ud;
+        }
+        luaL_argerror(L, idx, "net handle expected");
+        return nullptr;
+    }
+
+    static void push_luahandle(lua_State * L, int32_t handle, int type)
+    {
+        LuaHandle *lh = (LuaHandle *)lua_newuserdata(L, sizeof(LuaHandle));
+        lh->handle = handle;
+        lh->type = type;
+        luaL_getmetatable(L, HANDLE_METATABLES[type]);
+        lua_setmetatable(L, -2);
+    }
+
+    /* --- Receive buffers ---
+       net.buffer(capacity) is one userdata with the bytes inline; recv_into() reads from the socket
+       straight into it, so a receive loop allocates nothing. Unread data is [rd, wr). Space freed by
+       read()/skip() is reclaimed by moving the unread rest to the front when a socket read needs it,
+       so every read (and every UDP datagram) lands in one contiguous span. */
+
+    constexpr uint32_t NET_BUFFER_MAX = 64 * 1024;
+
+    struct NetBuffer
+    {
+        uint32_t cap;
+        uint32_t rd;
+        uint32_t wr;
+        uint8_t data[1];
+    };
+
+    static NetBuffer *check_buffer(lua_State * L, int idx)
+    {
+        return (NetBuffer *)luaL_checkudata(L, idx, "net.buffer");
+    }
+
+    // Contiguous free space at the end of `b`, compacting when that gains at least half the buffer
+    static uint32_t buffer_reserve(NetBuffer * b)
+    {
+        if (b->rd == b->wr)
+            b->rd = b->wr = 0;
+        else if (b->rd > 0 && b->cap - b->wr < b->cap / 2)
+        {
+            memmove(b->data, b->data + b->rd, b->wr - b->rd);
+            b->wr -= b->rd;
+            b->rd = 0;
+        }
+        return b->cap - b->wr;
+    }
+
+    // recv(max_bytes [, timeout_ms]) for TCP and TLS: reads straight into the Lua string buffer
+    static int stream_recv(lua_State * L, int type, ssize_t (*recvFn)(int32_t, uint8_t *, size_t, uint32_t), const char *errMsg)
+    {
+        LuaHandle *lh = check_luahandle(L, 1, type);
+        lua_Integer maxBytes = luaL_checkinteger(L, 2);
+        uint32_t timeout = (uint32_t)luaL_optinteger(L, 3, NETWORK_DEFAULT_TIMEOUT_MS);
+        if (maxBytes <= 0)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, "invalid max_bytes");
+            return 2;
+        }
+        // up to LUAL_BUFFERSIZE this is stack memory, the result string is the only allocation
+        luaL_Buffer b;
+        char *p = luaL_buffinitsize(L, &b, (size_t)maxBytes);
+        ssize_t r = recvFn(lh->handle, (uint8_t *)p, (size_t)maxBytes, timeout);
+        if (r < 0)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, errMsg);
+            return 2;
+        }
+        luaL_pushresultsize(&b, (size_t)r);
+        return 1;
+    }
+
+    // recv_into(buffer [, timeout_ms]) -> bytes_read (0 on EOF) | nil, err
+    static int stream_recv_into(lua_State * L, int type, ssize_t (*recvFn)(int32_t, uint8_t *, size_t, uint32_t), const char *errMsg)
+    {
+        LuaHandle *lh = check_luahandle(L, 1, type);
+        NetBuffer *b = check_buffer(L, 2);
+        uint32_t timeout = (uint32_t)luaL_optinteger(L, 3, NETWORK_DEFAULT_TIMEOUT_MS);
+        uint32_t room = buffer_reserve(b);
+        if (room == 0)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, "buffer full");
+            return 2;
+        }
+        ssize_t r = recvFn(lh->handle, b->data + b->wr, room, timeout);
+        if (r < 0)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, errMsg);
+            return 2;
+        }
+        b->wr += (uint32_t)r;
+        lua_pushinteger(L, r);
+        return 1;
+    }
+
+    // buffer(capacity) -> buffer
+    static int l_buffer_new(lua_State * L)
+    {
+        lua_Integer cap = luaL_checkinteger(L, 1);
+        luaL_argcheck(L, cap > 0 && cap <= NET_BUFFER_MAX, 1, "capacity out of range");
+        NetBuffer *b = (NetBuffer *)lua_newuserdata(L, sizeof(NetBuffer) + (size_t)cap - 1);
+        b->cap = (uint32_t)cap;
+        b->rd = b->wr = 0;
+        luaL_getmetatable(L, "net.buffer");
+        lua_setmetatable(L, -2);
+        return 1;
+    }
+
+    static int l_buffer_len(lua_State * L)
+    {
+        NetBuffer *b = check_buffer(L, 1);
+        lua_pushinteger(L, b->wr - b->rd);
+        return 1;
+    }
+
+    static int l_buffer_capacity(lua_State * L)
+    {
+        lua_pushinteger(L, check_buffer(L, 1)->cap);
+        return 1;
+    }
+
+    // n defaults to everything unread, larger n is clamped
+    static uint32_t buffer_count_arg(lua_State * L, NetBuffer * b, int idx)
+    {
+        uint32_t avail = b->wr - b->rd;
+        lua_Integer n = luaL_optinteger(L, idx, avail);
+        if (n < 0)
+            n = 0;
+        return (uint32_t)std::min<lua_Integer>(n, avail);
+    }
+
+    // buf:peek([n]) -> string (does not consume)
+    static int l_buffer_peek(lua_State * L)
+    {
+        NetBuffer *b = check_buffer(L, 1);
+        uint32_t n = buffer_count_arg(L, b, 2);
+        lua_pushlstring(L, (const char *)b->data + b->rd, n);
+        return 1;
+    }
+
+    // buf:read([n]) -> string (consumes)
+    static int l_buffer_read(lua_State * L)
+    {
+        NetBuffer *b = check_buffer(L, 1);
+        uint32_t n = buffer_count_arg(L, b, 2);
+        lua_pushlstring(L, (const char *)b->data + b->rd, n);
+        b->rd += n;
+        return 1;
+    }
+
+    // buf:skip(n) -> bytes skipped
+    static int l_buffer_skip(lua_State * L)
+    {
+        NetBuffer *b = check_buffer(L, 1);
+        uint32_t n = buffer_count_arg(L, b, 2);
+        b->rd += n;
+        lua_pushinteger(L, n);
+        return 1;
+    }
+
+    static int l_buffer_clear(lua_State * L)
+    {
+        NetBuffer *b = check_buffer(L, 1);
+        b->rd = b->wr = 0;
+        return 0;
+    }
+
+    // buf:byte(i) -> value of the i-th unread byte (1-based) | nil
+    static int l_buffer_byte(lua_State * L)
+    {
+        NetBuffer *b = check_buffer(L, 1);
+        lua_Integer i = luaL_checkinteger(L, 2);
+        if (i < 1 || i > (lua_Integer)(b->wr - b->rd))
+        {
+            lua_pushnil(L);
+            return 1;
+        }
+        lua_pushinteger(L, b->data[b->rd + i - 1]);
+        return 1;
+    }
+
+    // buf:find(needle) -> 1-based position in the unread data | nil; for line/frame protocols
+    static int l_buffer_find(lua_State * L)
+    {
+        NetBuffer *b = check_buffer(L, 1);
+        size_t len;
+        const char *needle = luaL_checklstring(L, 2, &len);
+        const uint8_t *begin = b->data + b->rd, *end = b->data + b->wr;
+        const uint8_t *hit = std::search(begin, end, (const uint8_t *)needle, (const uint8_t *)needle + len);
+        if (len == 0 || hit == end)
         {
-            luaL_error(L, "invalid handle type");
-            return nullptr;
+            lua_pushnil(L);
+            return 1;
         }
-        return lh;
+        lua_pushinteger(L, hit - begin + 1);
+        return 1;
     }
 
     // tcp_connect(host, port, timeout_ms)
@@ -1205,27 +1332,12 @@
     // tcp_recv(sock, max_bytes, timeout_ms)
     static int l_tcp_recv(lua_State * L)
     {
-        LuaHandle *lh = check_luahandle(L, 1, LH_TCP);
-        int maxBytes = (int)luaL_checkinteger(L, 2);
-        uint32_t timeout = NETWORK_DEFAULT_TIMEOUT_MS;
-        if (lua_gettop(L) >= 3 && lua_isnumber(L, 3))
-            timeout = (uint32_t)lua_tointeger(L, 3);
-        if (maxBytes <= 0)
-        {
-            lua_pushnil(L);
-            lua_pushstring(L, "invalid max_bytes");
-            return 2;
-        }
-        std::vector<char> buf(maxBytes);
-        ssize_t r = tcpRecv(lh->handle, (uint8_t *)buf.data(), buf.size(), timeout);
-        if (r < 0)
-        {
-            lua_pushnil(L);
-            lua_pushstring(L, "recv failed");
-            return 2;
-        }
-        lua_pushlstring(L, buf.data(), (size_t)r);
-        return 1;
+        return stream_recv(L, LH_TCP, tcpRecv, "recv failed");
+    }
+
+    static int l_tcp_recv_into(lua_State * L)
+    {
+        return stream_recv_into(L, LH_TCP, tcpRecv, "recv failed");
     }
 
     // tcp_close(sock)
@@ -1290,27 +1402,56 @@
     static int l_udp_recv(lua_State * L)
     {
         LuaHandle *lh = check_luahandle(L, 1, LH_UDP);
-        int maxBytes = (int)luaL_checkinteger(L, 2);
-        uint32_t timeout = NETWORK_DEFAULT_TIMEOUT_MS;
-        if (lua_gettop(L) >= 3 && lua_isnumber(L, 3))
-            timeout = (uint32_t)lua_tointeger(L, 3);
+        lua_Integer maxBytes = luaL_checkinteger(L, 2);
+        uint32_t timeout = (uint32_t)luaL_optinteger(L, 3, NETWORK_DEFAULT_TIMEOUT_MS);
         if (maxBytes <= 0)
         {
             lua_pushnil(L);
             lua_pushstring(L, "invalid max_bytes");
             return 2;
         }
-        std::vector<char> buf(maxBytes);
+        luaL_Buffer b;
+        char *p = luaL_buffinitsize(L, &b, (size_t)maxBytes);
         String from;
         uint16_t fromport = 0;
-        ssize_t r = udpReceiveFrom(lh->handle, (uint8_t *)buf.data(), buf.size(), from, fromport, timeout);
+        ssize_t r = udpReceiveFrom(lh->handle, (uint8_t *)p, (size_t)maxBytes, from, fromport, timeout);
         if (r < 0)
         {
             lua_pushnil(L);
             lua_pushstring(L, "udp recv failed");
             return 2;
         }
-        lua_pushlstring(L, buf.data(), (size_t)r);
+        luaL_pushresultsize(&b, (size_t)r);
+        lua_pushstring(L, from.c_str());
+        lua_pushinteger(L, fromport);
+        return 3;
+    }
+
+    // u:recv_into(buffer [, timeout_ms]) -> bytes, from, fromport | nil, err
+    // One datagram per call; it is truncated to the free space of the buffer.
+    static int l_udp_recv_into(lua_State * L)
+    {
+        LuaHandle *lh = check_luahandle(L, 1, LH_UDP);
+        NetBuffer *b = check_buffer(L, 2);
+        uint32_t timeout = (uint32_t)luaL_optinteger(L, 3, NETWORK_DEFAULT_TIMEOUT_MS);
+        uint32_t room = buffer_reserve(b);
+        if (room == 0)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, "buffer full");
+            return 2;
+        }
+        String from;
+        uint16_t fromport = 0;
+        ssize_t r = udpReceiveFrom(lh->handle, b->data + b->wr, room, from, fromport, timeout);
+        if (r < 0)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, "udp recv failed");
+            return 2;
+        }
+        b->wr += (uint32_t)r;
+        lua_pushinteger(L, r);
         lua_pushstring(L, from.c_str());
         lua_pushinteger(L, fromport);
         return 3;
@@ -1373,34 +1514,67 @@
 
     // tls_recv(tls_handle, max_bytes, timeout_ms)
     static int l_tls_recv(lua_State * L)
+    {
+        return stream_recv(L, LH_TLS, tlsRecv, "tls recv failed");
+    }
+
+    static int l_tls_recv_into(lua_State * L)
+    {
+        return stream_recv_into(L, LH_TLS, tlsRecv, "tls recv failed");
+    }
+
+    static int l_tls_close(lua_State * L)
     {
         LuaHandle *lh = check_luahandle(L, 1, LH_TLS);
-        int maxBytes = (int)luaL_checkinteger(L, 2);
-        uint32_t timeout = NETWORK_DEFAULT_TIMEOUT_MS;
-        if (lua_gettop(L) >= 3 && lua_isnumber(L, 3))
-            timeout = (uint32_t)lua_tointeger(L, 3);
-        if (maxBytes <= 0)
+        NetResult nr = tlsClose(lh->handle);
+        if (!nr.ok())
         {
             lua_pushnil(L);
-            lua_pushstring(L, "invalid max_bytes");
+            lua_pushstring(L, nr.message.c_str());
             return 2;
         }
-        std::vector<char> buf(maxBytes);
-        ssize_t r = tlsRecv(lh->handle, (uint8_t *)buf.data(), buf.size(), timeout);
-        if (r < 0)
+        lh->handle = -1;
+        lua_pushboolean(L, 1);
+        return 1;
+    }
+
+    // tcp_listen(port [, backlog]) -> server | nil, err
+    static int l_tcp_listen(lua_State * L)
+    {
+        int port = (int)luaL_checkinteger(L, 1);
+        int backlog = (int)luaL_optinteger(L, 2, 4);
+        // no onClient callback: Lua code picks connections up with server:accept() on its own task
+        auto pr = tcpServerListen((uint16_t)port, nullptr, (uint16_t)backlog);
+        if (!pr.second.ok())
         {
             lua_pushnil(L);
-            lua_pushstring(L, "tls recv failed");
+            lua_pushstring(L, pr.second.message.c_str());
             return 2;
         }
-        lua_pushlstring(L, buf.data(), (size_t)r);
+        push_luahandle(L, pr.first, LH_SERVER);
         return 1;
     }
 
-    static int l_tls_close(lua_State * L)
+    // server:accept([timeout_ms]) -> tcp handle | nil, "timeout"
+    static int l_server_accept(lua_State * L)
     {
-        LuaHandle *lh = check_luahandle(L, 1, LH_TLS);
-        NetResult nr = tlsClose(lh->handle);
+        LuaHandle *lh = check_luahandle(L, 1, LH_SERVER);
+        uint32_t timeout = (uint32_t)luaL_optinteger(L, 2, NETWORK_DEFAULT_TIMEOUT_MS);
+        SocketHandle h = tcpServerAccept(lh->handle, timeout);
+        if (h < 0)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, "timeout");
+            return 2;
+        }
+        push_luahandle(L, h, LH_TCP);
+        return 1;
+    }
+
+    static int l_server_close(lua_State * L)
+    {
+        LuaHandle *lh = check_luahandle(L, 1, LH_SERVER);
+        NetResult nr = tcpServerStop(lh->handle);
         if (!nr.ok())
         {
             lua_pushnil(L);
@@ -1412,9 +1586,371 @@
         return 1;
     }
 
+    // Readiness of a handle that is known without touching the socket (buffered data, EOF,
+    // accepted connections). `fd` is the socket to block on otherwise.
+    static uint8_t handle_ready(const LuaHandle &lh, uint8_t events, int &fd)
+    {
+        fd = -1;
+        std::lock_guard<std::mutex> guard(g_lock);
+        switch (lh.type)
+        {
+        case LH_TCP:
+        {
+            auto it = g_tcpClients.find(lh.handle);
+            if (it == g_tcpClients.end())
+                return NetReactor::EV_ERROR;
+            fd = it->second->fd();
+            // EOF counts as readable, recv() returns "" then
+            bool readable = it->second->available() > 0 || !it->second->connected();
+            return (events & NetReactor::EV_READ) && readable ? NetReactor::EV_READ : 0;
+        }
+        case LH_TLS:
+        {
+            auto it = g_tlsClients.find(lh.handle);
+            if (it == g_tlsClients.end())
+                return NetReactor::EV_ERROR;
+            fd = it->second->sockFd();
+            bool readable = it->second->available() > 0 || !it->second->connected();
+            return (events & NetReactor::EV_READ) && readable ? NetReactor::EV_READ : 0;
+        }
+        case LH_UDP:
+        {
+            auto it = g_udpHandles.find(lh.handle);
+            if (it == g_udpHandles.end())
+                return NetReactor::EV_ERROR;
+            fd = it->second;
+            return 0;
+        }
+        case LH_SERVER:
+        {
+            auto it = g_tcpServers.find(lh.handle);
+            if (it == g_tcpServers.end())
+                return NetReactor::EV_ERROR;
+            fd = it->second->fd;
+            return (events & NetReactor::EV_READ) && !it->second->pending.empty() ? NetReactor::EV_READ : 0;
+        }
+        }
+        return NetReactor::EV_ERROR;
+    }
+
+    // wait({handles...} [, timeout_ms [, "r" | "w" | "rw"]]) -> {ready handles...}
+    // Blocks the app task until one handle is readable (data, EOF, pending connection) or
+    // writable; the table is empty on timeout.
+    static int l_net_wait(lua_State * L)
+    {
+        luaL_checktype(L, 1, LUA_TTABLE);
+        uint32_t timeout = (uint32_t)luaL_optinteger(L, 2, NETWORK_DEFAULT_TIMEOUT_MS);
+        const char *mode = luaL_optstring(L, 3, "r");
+        uint8_t events = (strchr(mode, 'r') ? NetReactor::EV_READ : 0) | (strchr(mode, 'w') ? NetReactor::EV_WRITE : 0);
+        if (!events)
+            return luaL_argerror(L, 3, "mode must be \"r\", \"w\" or \"rw\"");
+
+        // the userdata stay alive while table 1 references them
+        int n = (int)lua_rawlen(L, 1);
+        std::vector<LuaHandle *> handles(n);
+        for (int i = 0; i < n; ++i)
+        {
+            lua_rawgeti(L, 1, i + 1);
+            handles[i] = check_luahandle(L, -1, 0);
+            lua_pop(L, 1);
+        }
+
+        std::vector<uint8_t> ready(n, 0);
+        std::vector<NetReactor::WaitFd> fds(n);
+        uint32_t start = millis();
+        while (n > 0)
+        {
+            int count = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                int fd;
+                ready[i] = handle_ready(*handles[i], events, fd);
+                fds[i] = {fd, events, 0};
+                count += ready[i] != 0;
+            }
+            if (count)
+                break;
+
+            uint32_t spent = millis() - start;
+            if (spent >= timeout || NetReactor::wait(fds, timeout - spent) == 0)
+                break;
+
+            // socket-level readiness is final for UDP, writes and errors; for TCP/TLS reads the
+            // loop re-checks, a readable socket may hold only part of a TLS record
+            for (int i = 0; i < n; ++i)
+            {
+                uint8_t r = fds[i].ready & (NetReactor::EV_WRITE | NetReactor::EV_ERROR);
+                if (handles[i]->type == LH_UDP)
+                    r |= fds[i].ready & NetReactor::EV_READ;
+                ready[i] = r;
+                count += r != 0;
+            }
+            if (count)
+                break;
+            delay(1); // readable socket not consumed yet (e.g. a connection the reactor is still accepting)
+        }
+
+        lua_newtable(L);
+        int out = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            if (!ready[i])
+                continue;
+            lua_rawgeti(L, 1, i + 1);
+            lua_rawseti(L, -2, ++out);
+        }
+        return 1;
+    }
+
+    /* --- Streaming HTTP for Lua ---
+       net.http_stream(options) returns after the response head; the body is then pulled in bounded
+       pieces (read / read_into / chunks) or pumped to a file (save), so its size does not matter. */
+
+    struct HttpStream
+    {
+        HttpPool::Lease lease;
+        HttpPool::Response res;
+        std::unique_ptr<HttpPool::BodyReader> body;
+    };
+
+    static HttpStream *check_stream(lua_State * L, int idx)
+    {
+        HttpStream **ud = (HttpStream **)luaL_checkudata(L, idx, "net.stream");
+        if (!*ud)
+            luaL_error(L, "stream closed");
+        return *ud;
+    }
+
+    // Body complete or broken: hand the socket back, keep-alive only after a complete body
+    static void stream_finish(HttpStream * s)
+    {
+        if (s->lease && (s->body->done() || s->body->failed()))
+            s->lease.release(s->body->done() && !s->res.close);
+    }
+
+    // Open options as a pool request and read the response head; nil, err pushed on failure.
+    static bool open_lua_request(lua_State * L, int optionsIdx, HttpPool::Lease & lease, HttpPool::Response & pr, uint32_t &timeout)
+    {
+        String method, host, path, body;
+        std::map<String, String> headers;
+        uint16_t port = 0;
+        bool useTls = false;
+        timeout = NETWORK_DEFAULT_TIMEOUT_MS;
+        HttpPool::Request req;
+        NetResult nr = lua_check_http_options(L, optionsIdx, method, host, path, headers, body, port, useTls, timeout);
+        if (nr.ok())
+            nr = buildPoolRequest(method, host, path, headers, body, port, useTls, timeout, req);
+        if (nr.ok() && !HttpPool::open(req, pr, lease))
+            nr = poolError(pr);
+        if (!nr.ok())
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, nr.message.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // http_stream(options) -> stream | nil, err
+    static int l_http_stream(lua_State * L)
+    {
+        luaL_checktype(L, 1, LUA_TTABLE);
+        std::unique_ptr<HttpStream> s(new HttpStream());
+        uint32_t timeout;
+        if (!open_lua_request(L, 1, s->lease, s->res, timeout))
+            return 2;
+        s->body.reset(new HttpPool::BodyReader(*s->lease, s->res, timeout));
+        stream_finish(s.get()); // e.g. 204: nothing to read
+
+        HttpStream **ud = (HttpStream **)lua_newuserdata(L, sizeof(HttpStream *));
+        *ud = s.release();
+        luaL_getmetatable(L, "net.stream");
+        lua_setmetatable(L, -2);
+        return 1;
+    }
+
+    static int l_stream_status(lua_State * L)
+    {
+        lua_pushinteger(L, check_stream(L, 1)->res.status);
+        return 1;
+    }
+
+    static int l_stream_headers(lua_State * L)
+    {
+        push_headers_table(L, check_stream(L, 1)->res.headers);
+        return 1;
+    }
+
+    // stream:length() -> Content-Length | nil (chunked / until close)
+    static int l_stream_length(lua_State * L)
+    {
+        HttpStream *s = check_stream(L, 1);
+        if (s->res.chunked || s->res.contentLength < 0)
+            lua_pushnil(L);
+        else
+            lua_pushinteger(L, s->res.contentLength);
+        return 1;
+    }
+
+    // Result of a read that returned nothing: nil at the end, nil, err on a broken body
+    static int stream_end(lua_State * L, HttpStream * s)
+    {
+        stream_finish(s);
+        lua_pushnil(L);
+        if (!s->body->failed())
+            return 1;
+        lua_pushstring(L, "body read failed");
+        return 2;
+    }
+
+    // stream:read([max_bytes]) -> string | nil (end) | nil, err
+    static int l_stream_read(lua_State * L)
+    {
+        HttpStream *s = check_stream(L, 1);
+        lua_Integer maxBytes = luaL_optinteger(L, 2, HttpPool::HTTP_CHUNK);
+        luaL_argcheck(L, maxBytes > 0, 2, "invalid max_bytes");
+        luaL_Buffer b;
+        char *p = luaL_buffinitsize(L, &b, (size_t)maxBytes);
+        size_t n = s->body->read((uint8_t *)p, (size_t)maxBytes);
+        if (n == 0)
+            return stream_end(L, s);
+        luaL_pushresultsize(&b, n);
+        stream_finish(s);
+        return 1;
+    }
+
+    // stream:read_into(buffer) -> bytes | nil (end) | nil, err
+    static int l_stream_read_into(lua_State * L)
+    {
+        HttpStream *s = check_stream(L, 1);
+        NetBuffer *b = check_buffer(L, 2);
+        uint32_t room = buffer_reserve(b);
+        if (room == 0)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, "buffer full");
+            return 2;
+        }
+        size_t n = s->body->read(b->data + b->wr, room);
+        if (n == 0)
+            return stream_end(L, s);
+        b->wr += (uint32_t)n;
+        stream_finish(s);
+        lua_pushinteger(L, (lua_Integer)n);
+        return 1;
+    }
+
+    static int stream_chunks_iter(lua_State * L)
+    {
+        lua_settop(L, 0);
+        lua_pushvalue(L, lua_upvalueindex(1)); // stream
+        lua_pushvalue(L, lua_upvalueindex(2)); // size
+        int r = l_stream_read(L);
+        if (r == 2)
+            return luaL_error(L, "%s", lua_tostring(L, -1));
+        return 1;
+    }
+
+    // stream:chunks([size]) -> iterator for `for chunk in stream:chunks() do ... end`
+    static int l_stream_chunks(lua_State * L)
+    {
+        check_stream(L, 1);
+        lua_Integer size = luaL_optinteger(L, 2, HttpPool::HTTP_CHUNK);
+        luaL_argcheck(L, size > 0, 2, "invalid size");
+        lua_pushvalue(L, 1);
+        lua_pushinteger(L, size);
+        lua_pushcclosure(L, stream_chunks_iter, 2);
+        return 1;
+    }
+
+    // stream:save(path) -> bytes | nil, err; writes the rest of the body to an app file
+    static int l_stream_save(lua_State * L)
+    {
+        HttpStream *s = check_stream(L, 1);
+        BodyTarget target;
+        target.saveTo = luaL_checkstring(L, 2);
+        size_t bytes = 0;
+        String err;
+        bool ok = streamResponseBody(L, *s->body, target, bytes, err);
+        stream_finish(s);
+        if (!ok)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, err.c_str());
+            return 2;
+        }
+        lua_pushinteger(L, (lua_Integer)bytes);
+        return 1;
+    }
+
+    // stream:close(); an unfinished body closes the socket
+    static int l_stream_close(lua_State * L)
+    {
+        HttpStream **ud = (HttpStream **)luaL_checkudata(L, 1, "net.stream");
+        if (*ud)
+        {
+            stream_finish(*ud);
+            delete *ud; // a lease still held here is dropped, i.e. the socket closed
+            *ud = nullptr;
+        }
+        return 0;
+    }
+
     // http_request(options) -> response_table or nil, err
+    // options.save_to = "path" (app-relative file) and/or options.on_chunk = function(chunk) stream the
+    // body instead of returning it; the response then has body = "" and bytes = <body size>.
+    static int l_http_request_streamed(lua_State * L)
+    {
+        BodyTarget target;
+        lua_getfield(L, 1, "save_to");
+        if (!lua_isnil(L, -1))
+            target.saveTo = luaL_checkstring(L, -1);
+        lua_getfield(L, 1, "on_chunk");
+        if (!lua_isnil(L, -1))
+        {
+            luaL_checktype(L, -1, LUA_TFUNCTION);
+            target.onChunk = lua_absindex(L, -1);
+        }
+
+        HttpPool::Lease lease;
+        HttpPool::Response pr;
+        uint32_t timeout;
+        if (!open_lua_request(L, 1, lease, pr, timeout))
+            return 2;
+        HttpPool::BodyReader body(*lease, pr, timeout);
+        size_t bytes = 0;
+        String err;
+        bool ok = streamResponseBody(L, body, target, bytes, err);
+        lease.release(ok && !pr.close);
+        if (!ok)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, err.c_str());
+            return 2;
+        }
+
+        HttpResponse res;
+        res.status_code = pr.status;
+        res.headers = pr.headers;
+        res.result = NetResult(NetError::OK);
+        push_http_response(L, res);
+        lua_pushinteger(L, (lua_Integer)bytes);
+        lua_setfield(L, -2, "bytes");
+        return 1;
+    }
+
     static int l_http_request(lua_State * L)
     {
+        if (lua_istable(L, 1))
+        {
+            lua_getfield(L, 1, "save_to");
+            lua_getfield(L, 1, "on_chunk");
+            bool streamed = !lua_isnil(L, -1) || !lua_isnil(L, -2);
+            lua_pop(L, 2);
+            if (streamed)
+                return l_http_request_streamed(L);
+        }
+
         String method, host, path, body;
         std::map<String, String> headers;
         uint16_t port = 0;
@@ -1438,7 +1974,216 @@
         return 1;
     }
 
-    // http_request_async(options, callback)
+    /* --- Async HTTP for Lua ---
+       Requests run on the NetWorkers pool. Results are posted to the inbox of the lua_State that
+       started them and only turned into Lua values on that app's task (net.await / net.poll), so
+       no other task ever touches the state.
+
+       Registry: "net.inbox"   userdata holding the shared inbox
+                 "net.async"   id -> true (pending) | function (callback) | thread (awaiting coroutine)
+                 "net.results" id -> response table not picked up yet
+    */
+
+    struct AsyncCompletion
+    {
+        int32_t id;
+        HttpResponse response;
+    };
+
+    struct AsyncInbox
+    {
+        std::mutex lock;
+        std::condition_variable cv;
+        std::deque<AsyncCompletion> done;
+    };
+
+    // Lua owns one reference; in-flight jobs keep the inbox alive after the app closed its state.
+    using InboxRef = std::shared_ptr<AsyncInbox>;
+
+    static std::atomic<int32_t> g_nextAsyncId{1};
+
+    static InboxRef get_inbox(lua_State * L)
+    {
+        lua_getfield(L, LUA_REGISTRYINDEX, "net.inbox");
+        InboxRef *ref = (InboxRef *)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+        return ref ? *ref : InboxRef();
+    }
+
+    static int async_table(lua_State * L, const char *name)
+    {
+        lua_getfield(L, LUA_REGISTRYINDEX, name);
+        return lua_absindex(L, -1);
+    }
+
+    // Start a request on the worker pool; the id is registered in "net.async" with `marker`
+    // (the value at index `marker`, or true when 0).
+    static int32_t start_async_request(lua_State * L, int optionsIdx, int marker, String &err)
+    {
+        String method, host, path, body;
+        std::map<String, String> headers;
+        uint16_t port = 0;
+        bool useTls = false;
+        uint32_t timeout = NETWORK_DEFAULT_TIMEOUT_MS;
+        NetResult ok = lua_check_http_options(L, optionsIdx, method, host, path, headers, body, port, useTls, timeout);
+        if (!ok.ok())
+        {
+            err = ok.message;
+            return -1;
+        }
+
+        InboxRef inbox = get_inbox(L);
+        int32_t id = g_nextAsyncId.fetch_add(1);
+        bool queued = NetWorkers::post([inbox, id, method, host, path, headers, body, port, useTls, timeout]()
+                                       {
+            HttpResponse r = performHttpRequestInternal(method, host, path, headers, body, port, useTls, timeout);
+            std::lock_guard<std::mutex> g(inbox->lock);
+            inbox->done.push_back(AsyncCompletion{id, r});
+            inbox->cv.notify_all(); });
+        if (!queued)
+        {
+            err = "async queue full";
+            return -1;
+        }
+
+        int t = async_table(L, "net.async");
+        if (marker)
+            lua_pushvalue(L, marker);
+        else
+            lua_pushboolean(L, 1);
+        lua_rawseti(L, t, id);
+        lua_pop(L, 1);
+        return id;
+    }
+
+    // Move finished requests from the inbox into "net.results". Returns how many arrived.
+    // Results of requests nobody waits for any more (net.await timed out) are dropped.
+    static int drain_inbox(lua_State * L)
+    {
+        InboxRef inbox = get_inbox(L);
+        std::deque<AsyncCompletion> done;
+        {
+            std::lock_guard<std::mutex> g(inbox->lock);
+            done.swap(inbox->done);
+        }
+        if (done.empty())
+            return 0;
+        int t = async_table(L, "net.async");
+        int results = async_table(L, "net.results");
+        int arrived = 0;
+        for (auto &c : done)
+        {
+            bool known = lua_rawgeti(L, t, c.id) != LUA_TNIL;
+            lua_pop(L, 1);
+            if (!known)
+                continue;
+            push_http_response(L, c.response);
+            lua_rawseti(L, results, c.id);
+            ++arrived;
+        }
+        lua_pop(L, 2);
+        return arrived;
+    }
+
+    // Abandon `id`: clear it from "net.async" and "net.results"; a late result is dropped by drain_inbox().
+    static void forget_request(lua_State * L, int32_t id)
+    {
+        const char *tables[] = {"net.async", "net.results"};
+        for (const char *name : tables)
+        {
+            int t = async_table(L, name);
+            lua_pushnil(L);
+            lua_rawseti(L, t, id);
+            lua_pop(L, 1);
+        }
+    }
+
+    static bool wait_inbox(lua_State * L, uint32_t timeoutMs)
+    {
+        InboxRef inbox = get_inbox(L);
+        std::unique_lock<std::mutex> g(inbox->lock);
+        return inbox->cv.wait_for(g, std::chrono::milliseconds(timeoutMs), [&]
+                                  { return !inbox->done.empty(); });
+    }
+
+    // Take the result of `id` if it is there: pushes the response table and clears the id.
+    static bool take_result(lua_State * L, int32_t id)
+    {
+        int results = async_table(L, "net.results");
+        lua_rawgeti(L, results, id);
+        if (lua_isnil(L, -1))
+        {
+            lua_pop(L, 2);
+            return false;
+        }
+        lua_pushnil(L);
+        lua_rawseti(L, results, id);
+        lua_remove(L, results);
+
+        int t = async_table(L, "net.async");
+        lua_pushnil(L);
+        lua_rawseti(L, t, id);
+        lua_pop(L, 1);
+        return true;
+    }
+
+    // Hand finished results to their callbacks / awaiting coroutines. Returns how many ran.
+    static int dispatch_results(lua_State * L)
+    {
+        std::vector<int32_t> ready;
+        int t = async_table(L, "net.async");
+        int results = async_table(L, "net.results");
+        lua_pushnil(L);
+        while (lua_next(L, t) != 0)
+        {
+            int32_t id = (int32_t)lua_tointeger(L, -2);
+            bool waiting = lua_isfunction(L, -1) || lua_isthread(L, -1);
+            lua_pop(L, 1);
+            if (!waiting)
+                continue;
+            if (lua_rawgeti(L, results, id) != LUA_TNIL)
+                ready.push_back(id);
+            lua_pop(L, 1);
+        }
+
+        for (int32_t id : ready)
+        {
+            lua_rawgeti(L, t, id); // callback or coroutine
+            if (!take_result(L, id))
+            {
+                lua_pop(L, 1);
+                continue;
+            }
+
+            if (lua_isfunction(L, -2))
+            {
+                if (lua_pcall(L, 1, 0, 0) != LUA_OK)
+                {
+                    Serial.printf("http async callback error: %s\n", lua_tostring(L, -1));
+                    lua_pop(L, 1);
+                }
+                continue;
+            }
+
+            lua_State *co = lua_tothread(L, -2);
+            if (lua_status(co) != LUA_YIELD)
+            {
+                lua_pop(L, 2); // finished or resumed by someone else meanwhile
+                continue;
+            }
+            lua_xmove(L, co, 1); // the response becomes the result of net.await()
+            int st = lua_resume(co, L, 1);
+            if (st != LUA_OK && st != LUA_YIELD)
+                Serial.printf("net.await coroutine error: %s\n", lua_tostring(co, -1));
+            lua_settop(co, 0);
+            lua_pop(L, 1); // thread
+        }
+        lua_pop(L, 2);
+        return (int)ready.size();
+    }
+
+    // http_request_async(options, callback) -> id | nil, err
+    // The callback runs on the app's task from net.poll().
     static int l_http_request_async(lua_State * L)
     {
         if (!lua_istable(L, 1))
@@ -1453,60 +2198,124 @@
             lua_pushstring(L, "callback expected");
             return 2;
         }
+        String err;
+        int32_t id = start_async_request(L, 1, 2, err);
+        if (id < 0)
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, err.c_str());
+            return 2;
+        }
+        lua_pushinteger(L, id);
+        return 1;
+    }
 
-        // Convert options
-        String method, host, path, body;
-        std::map<String, String> headers;
-        uint16_t port = 0;
-        bool useTls = false;
-        uint32_t timeout = NETWORK_DEFAULT_TIMEOUT_MS;
-        NetResult ok = lua_check_http_options(L, 1, method, host, path, headers, body, port, useTls, timeout);
-        if (!ok.ok())
+    // http_async(options) -> id | nil, err
+    static int l_http_async(lua_State * L)
+    {
+        luaL_checktype(L, 1, LUA_TTABLE);
+        String err;
+        int32_t id = start_async_request(L, 1, 0, err);
+        if (id < 0)
         {
             lua_pushnil(L);
-            lua_pushstring(L, ok.message.c_str());
+            lua_pushstring(L, err.c_str());
             return 2;
         }
+        lua_pushinteger(L, id);
+        return 1;
+    }
 
-        // Reference the Lua callback (create a reference)
-        lua_pushvalue(L, 2);
-        int cbRef = luaL_ref(L, LUA_REGISTRYINDEX);
+    // await(id [, timeout_ms]) -> response_table | nil, err
+    // Inside a coroutine it yields until net.poll() resumes it with the response; on the main
+    // thread it blocks the app task (at most timeout_ms). After a timeout the request is abandoned.
+    static int l_await(lua_State * L)
+    {
+        int32_t id = (int32_t)luaL_checkinteger(L, 1);
+        drain_inbox(L);
+        if (take_result(L, id))
+            return 1;
 
-        // Create C++ callback that pushes result into queue and when executed will call Lua callback.
-        std::function<void(const HttpResponse &)> cb = [L, cbRef](const HttpResponse &r)
+        int t = async_table(L, "net.async");
+        int pending = lua_rawgeti(L, t, id);
+        lua_pop(L, 1);
+        if (pending == LUA_TNIL)
         {
-            // When called from poll_network_events (main thread), this lambda is executed in main thread.
-            // Acquire stack and call the Lua function ref.
-            lua_rawgeti(L, LUA_REGISTRYINDEX, cbRef); // push function
-            push_http_response(L, r);                 // push response table
-            if (lua_pcall(L, 1, 0, 0) != LUA_OK)
-            {
-                // Error calling Lua callback; print message to Serial (best effort)
-                const char *err = lua_tostring(L, -1);
-                Serial.print("http async callback error: ");
-                if (err)
-                    Serial.println(err);
-                else
-                    Serial.println("unknown");
-                lua_pop(L, 1);
-            }
-            // release reference
-            luaL_unref(L, LUA_REGISTRYINDEX, cbRef);
-        };
+            lua_pop(L, 1);
+            lua_pushnil(L);
+            lua_pushstring(L, "unknown request");
+            return 2;
+        }
+        if (pending != LUA_TBOOLEAN)
+        {
+            lua_pop(L, 1);
+            return luaL_error(L, "request %d is already awaited", (int)id);
+        }
 
-        NetResult nr = httpRequestAsync(method, host, path, cb, headers, body, port, useTls, timeout);
-        if (!nr.ok())
+        bool isMain = lua_pushthread(L) == 1;
+        if (!isMain && lua_isyieldable(L))
+        {
+            lua_rawseti(L, t, id); // t[id] = this coroutine
+            lua_pop(L, 1);
+            return lua_yield(L, 0);
+        }
+        lua_pop(L, 2);
+
+        uint32_t timeout = (uint32_t)luaL_optinteger(L, 2, UINT32_MAX);
+        uint32_t start = millis();
+        while (true)
+        {
+            uint32_t spent = millis() - start;
+            if (spent >= timeout)
+                break;
+            wait_inbox(L, timeout - spent);
+            drain_inbox(L);
+            if (take_result(L, id))
+                return 1;
+        }
+        forget_request(L, id);
+        lua_pushnil(L);
+        lua_pushstring(L, "timeout");
+        return 2;
+    }
+
+    // spawn(fn, ...) -> true | nil, err
+    // Runs fn as a coroutine right away; it may net.await() without blocking the caller.
+    static int l_spawn(lua_State * L)
+    {
+        luaL_checktype(L, 1, LUA_TFUNCTION);
+        int nargs = lua_gettop(L) - 1;
+        lua_State *co = lua_newthread(L);
+        lua_insert(L, 1);
+        lua_xmove(L, co, nargs + 1);
+        int st = lua_resume(co, L, nargs);
+        if (st != LUA_OK && st != LUA_YIELD)
         {
-            // release ref
-            luaL_unref(L, LUA_REGISTRYINDEX, cbRef);
             lua_pushnil(L);
-            lua_pushstring(L, nr.message.c_str());
+            lua_pushstring(L, lua_tostring(co, -1));
             return 2;
         }
+        lua_settop(co, 0);
         lua_pushboolean(L, 1);
         return 1;
     }
 
+    // poll([timeout_ms]) -> number of callbacks / coroutines run
+    // Waits up to timeout_ms (default 0) for the first result.
+    static int l_poll(lua_State * L)
+    {
+        uint32_t timeout = (uint32_t)luaL_optinteger(L, 1, 0);
+        drain_inbox(L);
+        int n = dispatch_results(L);
+        if (n == 0 && timeout > 0 && wait_inbox(L, timeout))
+        {
+            drain_inbox(L);
+            n = dispatch_results(L);
+        }
+        lua_pushinteger(L, n);
+        return 1;
+    }
+
     // dns_lookup(hostname) -> ip_string | nil, err
     static int l_dns_lookup(lua_State * L)
     {
@@ -1545,9 +2354,17 @@
         {"has_internet", l_has_internet},
         {"dns_lookup", l_dns_lookup},
         {"tcp_connect", l_tcp_connect},
+        {"tcp_listen", l_tcp_listen},
+        {"wait", l_net_wait},
         {"udp_open", l_udp_open},
+        {"buffer", l_buffer_new},
         {"http_request", l_http_request},
+        {"http_stream", l_http_stream},
         {"http_request_async", l_http_request_async},
+        {"http_async", l_http_async},
+        {"await", l_await},
+        {"spawn", l_spawn},
+        {"poll", l_poll},
         {"tls_connect", l_tls_connect},
         {"udp_send_to", l_udp_send_to}, // convenience: allow module-level call
         {"udp_recv", l_udp_recv},
@@ -1557,18 +2374,48 @@
     static const luaL_Reg tcp_methods[] = {
         {"send", l_tcp_send},
         {"recv", l_tcp_recv},
+        {"recv_into", l_tcp_recv_into},
         {"close", l_tcp_close},
         {NULL, NULL}};
 
     static const luaL_Reg udp_methods[] = {
         {"send_to", l_udp_send_to},
         {"recv", l_udp_recv},
+        {"recv_into", l_udp_recv_into},
         {"close", l_udp_close},
         {NULL, NULL}};
 
+    static const luaL_Reg buffer_methods[] = {
+        {"len", l_buffer_len},
+        {"capacity", l_buffer_capacity},
+        {"peek", l_buffer_peek},
+        {"read", l_buffer_read},
+        {"skip", l_buffer_skip},
+        {"clear", l_buffer_clear},
+        {"byte", l_buffer_byte},
+        {"find", l_buffer_find},
+        {NULL, NULL}};
+
+    static const luaL_Reg stream_methods[] = {
+        {"status", l_stream_status},
+        {"headers", l_stream_headers},
+        {"length", l_stream_length},
+        {"read", l_stream_read},
+        {"read_into", l_stream_read_into},
+        {"chunks", l_stream_chunks},
+        {"save", l_stream_save},
+        {"close", l_stream_close},
+        {NULL, NULL}};
+
+    static const luaL_Reg server_methods[] = {
+        {"accept", l_server_accept},
+        {"close", l_server_close},
+        {NULL, NULL}};
+
     static const luaL_Reg tls_methods[] = {
         {"send", l_tls_send},
         {"recv", l_tls_recv},
+        {"recv_into", l_tls_recv_into},
         {"close", l_tls_close},
         {NULL, NULL}};
 
@@ -1630,8 +2477,58 @@
         lua_setfield(L, -2, "__gc");
         lua_pop(L, 1);
 
+        // server metatable
+        luaL_newmetatable(L, "net.server");
+        lua_newtable(L);
+        luaL_setfuncs(L, server_methods, 0);
+        lua_setfield(L, -2, "__index");
+        lua_pushcfunction(L, [](lua_State *L) -> int
+                          {
+        LuaHandle *lh = (LuaHandle*)lua_touserdata(L, 1);
+        if (lh && lh->type == LH_SERVER && lh->handle > 0) {
+            tcpServerStop(lh->handle);
+            lh->handle = -1;
+        }
+        return 0; });
+        lua_setfield(L, -2, "__gc");
+        lua_pop(L, 1);
+
+        // buffer metatable (plain memory, no __gc needed)
+        luaL_newmetatable(L, "net.buffer");
+        lua_newtable(L);
+        luaL_setfuncs(L, buffer_methods, 0);
+        lua_setfield(L, -2, "__index");
+        lua_pushcfunction(L, l_buffer_len);
+        lua_setfield(L, -2, "__len");
+        lua_pop(L, 1);
+
+        // stream metatable
+        luaL_newmetatable(L, "net.stream");
+        lua_newtable(L);
+        luaL_setfuncs(L, stream_methods, 0);
+        lua_setfield(L, -2, "__index");
+        lua_pushcfunction(L, l_stream_close);
+        lua_setfield(L, -2, "__gc");
+        lua_pop(L, 1);
+
         // set table at global 'net'
         lua_setglobal(L, "net");
+
+        // async HTTP state of this lua_State
+        InboxRef *inbox = (InboxRef *)lua_newuserdata(L, sizeof(InboxRef));
+        new (inbox) InboxRef(std::make_shared<AsyncInbox>());
+        luaL_newmetatable(L, "net.inbox");
+        lua_pushcfunction(L, [](lua_State *L) -> int
+                          {
+        ((InboxRef *)lua_touserdata(L, 1))->~InboxRef();
+        return 0; });
+        lua_setfield(L, -2, "__gc");
+        lua_setmetatable(L, -2);
+        lua_setfield(L, LUA_REGISTRYINDEX, "net.inbox");
+        lua_newtable(L);
+        lua_setfield(L, LUA_REGISTRYINDEX, "net.async");
+        lua_newtable(L);
+        lua_setfield(L, LUA_REGISTRYINDEX, "net.results");
     }
 
 } // namespace LuaApps::Network
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "../wifi/index.hpp"
 #include "app.hpp"
+#include "../wifi/http-pool.hpp"
 
 #include <WiFi.h>
 #include <vector>
@@ -113,10 +114,13 @@ namespace LuaApps::Network
     /* --- TCP server API (C++ side) --- */
 
     // Start listening on port. Returns server handle or negative on error.
-    // onClient is a callback invoked when a new client is accepted; it receives the client SocketHandle.
-    // Implementations may call the callback on the networking task or schedule it for the main loop — see implementation.
+    // The NetReactor task accepts connections as they arrive. With an onClient callback they are handed
+    // to it from poll_network_events(); without one they queue (up to NETWORK_MAX_SOCKETS) for tcpServerAccept().
     std::pair<ServerHandle, NetResult> tcpServerListen(uint16_t port, std::function<void(SocketHandle client)> onClient, uint16_t backlog = 4);
 
+    // Take the next accepted connection, waiting up to timeoutMs. Returns -1 on timeout.
+    SocketHandle tcpServerAccept(ServerHandle server, uint32_t timeoutMs = NETWORK_DEFAULT_TIMEOUT_MS);
+
     // Stop and free server.
     NetResult tcpServerStop(ServerHandle server);
 
@@ -156,9 +160,10 @@ namespace LuaApps::Network
                              bool useTls = false,
                              uint32_t timeoutMs = NETWORK_DEFAULT_TIMEOUT_MS);
 
-    // Perform an asynchronous HTTP(S) request — the callback will be invoked when finished.
-    // Callback signature: void(HttpResponse response).
-    // Implementations should ensure callback runs in a safe context to call into Lua (or schedule for main loop).
+    // Perform an asynchronous HTTP(S) request on the NetWorkers pool.
+    // Callback signature: void(HttpResponse response); it is invoked from poll_network_events(),
+    // which Windows::loop() runs every frame on the render task.
+    // Lua code uses net.http_async / net.await instead, see below.
     NetResult httpRequestAsync(const String &method,
                                const String &host,
                                const String &path,
@@ -188,9 +193,20 @@ namespace LuaApps::Network
         local data = sock:recv(max_bytes [, timeout_ms]) -> string|nil, err
         sock:close()
 
+        -- Receive buffers (recv_into reads without creating Lua strings; also on tls and udp handles)
+        local buf = net.buffer(4096)
+        local n = sock:recv_into(buf [, timeout_ms])  -- bytes appended, 0 on EOF | nil, err
+        buf:len(), buf:capacity(), buf:byte(i), buf:find("\r\n")
+        buf:peek([n]), buf:read([n]), buf:skip(n), buf:clear()
+
         -- TCP server
-        local server = net.tcp_listen(port, function(client_sock) ... end)
-        server:stop()
+        local server = net.tcp_listen(port [, backlog])
+        local client = server:accept([timeout_ms])  -- tcp handle or nil, "timeout"
+        server:close()
+
+        -- Readiness (blocks the app task, no polling)
+        local ready = net.wait({sock, server, udp, ...} [, timeout_ms [, "r" | "w" | "rw"]])
+        for _, h in ipairs(ready) do ... end        -- empty table on timeout
 
         -- UDP
         local u = net.udp_open([local_port])
@@ -207,8 +223,20 @@ namespace LuaApps::Network
         -- HTTP(S)
         -- sync
         local res = net.http_request({ method = "GET", host = "example.com", path = "/", headers = {...}, body = "" , tls=true })
-        -- async (callback receives a response table)
-        net.http_request_async({ ... }, function(response_table) end)
+        -- streaming: status and headers first, then the body in bounded pieces
+        local st = net.http_stream({ host = "example.com", path = "/big.json", tls = true })  -- or nil, err
+        st:status(), st:headers(), st:length()        -- length is nil for chunked bodies
+        for chunk in st:chunks([size]) do ... end     -- or st:read([max]) / st:read_into(buf) until nil
+        st:save("downloads/big.json")                 -- rest of the body to an app file -> bytes
+        st:close()
+        net.http_request({ ..., save_to = "file", on_chunk = function(chunk) end })  -- body = "", bytes = n
+        -- async: requests run on worker tasks, results are delivered on the app's own task
+        local id = net.http_async({ ... })           -- id or nil, err
+        local res = net.await(id [, timeout_ms])      -- in a coroutine: yields until net.poll() resumes it
+                                                      -- on the main thread: blocks the app task
+        net.spawn(function() local r = net.await(net.http_async{...}) ... end)
+        net.poll([timeout_ms])                        -- resumes coroutines / runs callbacks whose response arrived
+        net.http_request_async({ ... }, function(response_table) end)  -- callback runs from net.poll()
 
       The exact Lua table shapes and userdata metatables are defined in the implementation.
     */
@@ -225,11 +253,21 @@ namespace LuaApps::Network
                                      std::map<String, String> &outHeaders, String &outBody,
                                      uint16_t &outPort, bool &outUseTls, uint32_t &outTimeoutMs);
 
+    // Where a streamed response body goes (see net.http_stream, http_request{save_to, on_chunk}).
+    struct BodyTarget
+    {
+        int onChunk = 0; // absolute stack index of a Lua function(chunk); returning false aborts
+        String saveTo;   // ENC_FS path relative to the app folder; the file is removed on failure
+    };
+
+    // Pump the rest of a response body into `target` on the calling app task, HTTP_CHUNK bytes at
+    // a time. The caller hands the socket back to the pool afterwards.
+    bool streamResponseBody(lua_State *L, HttpPool::BodyReader &body, const BodyTarget &target, size_t &outBytes, String &err);
+
     /* --- Lifecycle / poll --- */
 
-    // If the implementation has background work or async callbacks that need to be pumped from the main loop,
-    // call this periodically from the main loop (non-blocking). Implementations that schedule callbacks to run
-    // on the main thread should implement them here.
+    // Runs queued onClient and native httpRequestAsync() callbacks (non-blocking). Called every frame from
+    // Windows::loop(), so callbacks run on the render task and should return quickly.
     void poll_network_events();
 
     /* --- Utility --- */
@@ -10,6 +10,7 @@
 #include "../sys-apps/browser.hpp"
 
 #include "../icons/index.hpp"
+#include "../screen/icon-cache.hpp"
 
 extern bool executeApplication(const std::vector<String> &args);
 
@@ -509,7 +510,7 @@ void Windows::drawMenu(Vec pos, Vec move, MouseState state)
                 int iconX = scPos.pos.x + ((w / 2) - (d / 2));
                 int iconY = scPos.pos.y + 15;
 
-                drawSVGString(shortCut.svg, iconX, iconY, d, d, TEXT);
+                IconCache::draw(shortCut.svg, iconX, iconY, d, d, TEXT, BG);
             }
 
             scXPos += w + 5;
@@ -1,4 +1,5 @@
 #include "windows.hpp"
+#include "network.hpp"
 
 namespace Windows
 {
@@ -249,6 +250,8 @@ namespace Windows
     void loop()
     {
         updateSVGList();
+        // native async HTTP callbacks and TCP onClient handlers
+        LuaApps::Network::poll_network_events();
         while (!canAccess)
         {
             delay(5);
@@ -1,10 +1,10 @@
 // Unified AVF/WAV/RGB565 player as Lua API (no setup/loop)
-// Drop into your codebase; requires WiFiClientSecure, HTTPClient, Screen::tft, ENC_FS or SD replacement as needed.
+// Drop into your codebase; requires HttpPool, Screen::tft, ENC_FS or SD replacement as needed.
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
 #include <vector>
+#include "../wifi/http-pool.hpp"
 #include "driver/dac.h"
 
 // ---------- Tunables (tune to fit memory / performance) ----------
@@ -155,7 +155,7 @@ static bool readFull(WiFiClient *s, uint8_t *buf, size_t len, unsigned long time
 }
 
 // ---------- WAV streaming parser + feed function (reads from WiFiClient sequentially and feeds circ buffer) ----------
-static bool streamWavToDAC(WiFiClient *stream, HTTPClient &https, uint32_t maxPreviewBytes = 0xFFFFFFFF)
+static bool streamWavToDAC(WiFiClient *stream, HttpPool::Lease &media, uint32_t maxPreviewBytes = 0xFFFFFFFF)
 {
     // read RIFF header (already partially read upstream sometimes; caller should ensure stream is at file start)
     uint8_t hdr[12];
@@ -379,39 +379,28 @@ int lua_WIN_drawVideo(lua_State *L)
         url.replace("/raw/refs/heads/", "/");
     }
 
-    WiFiClientSecure client;
-    client.setInsecure();
-    HTTPClient https;
+    // pooled connection; the body is only ever partly read, so every release closes it
+    HttpPool::Lease media;
 
     auto openStream = [&](uint32_t byteOffset) -> WiFiClient *
     {
-        if (!https.begin(client, url))
-        {
-            Serial.println("[lua_WIN_drawVideo] https.begin() failed");
-            return nullptr;
-        }
+        HttpPool::Request req;
+        req.url = url;
         if (byteOffset)
-            https.addHeader("Range", "bytes=" + String(byteOffset) + "-");
-        int httpCode = https.GET();
-        // follow redirects
-        while (httpCode == 302 || httpCode == 301)
+            req.headers["Range"] = "bytes=" + String(byteOffset) + "-";
+        HttpPool::Response res;
+        if (!HttpPool::open(req, res, media))
         {
-            String redirect = https.getLocation();
-            https.end();
-            if (!https.begin(client, redirect))
-            {
-                Serial.println("[lua_WIN_drawVideo] redirect begin failed");
-                return nullptr;
-            }
-            httpCode = https.GET();
+            Serial.println("[lua_WIN_drawVideo] request failed: " + res.error);
+            return nullptr;
         }
-        if (httpCode != HTTP_CODE_OK && httpCode != HTTP_CODE_PARTIAL_CONTENT)
+        if (res.status != 200 && res.status != 206)
         {
-            Serial.printf("[lua_WIN_drawVideo] HTTP GET failed: %d\n", httpCode);
-            https.end();
+            Serial.printf("[lua_WIN_drawVideo] HTTP GET failed: %d\n", res.status);
+            media.release(false);
             return nullptr;
         }
-        return https.getStreamPtr();
+        return &*media;
     };
 
     // open initial stream to read first few bytes to detect format
@@ -429,14 +418,14 @@ int lua_WIN_drawVideo(lua_State *L)
         if (!stream->connected() && stream->available() == 0)
         {
             Serial.println("[lua_WIN_drawVideo] disconnected early");
-            https.end();
+            media.release(false);
             Windows::canAccess = true;
             return 0;
         }
         if (millis() - waitStart > 3000)
         {
             Serial.println("[lua_WIN_drawVideo] header timeout");
-            https.end();
+            media.release(false);
             Windows::canAccess = true;
             return 0;
         }
@@ -449,7 +438,7 @@ int lua_WIN_drawVideo(lua_State *L)
     if (got < 8)
     {
         Serial.println("[lua_WIN_drawVideo] header read fail");
-        https.end();
+        media.release(false);
         Windows::canAccess = true;
         return 0;
     }
@@ -471,7 +460,7 @@ int lua_WIN_drawVideo(lua_State *L)
     }
 
     // rewind stream by closing and reopening at 0 (to ensure consistent parsing)
-    https.end();
+    media.release(false);
 
     if (isWav)
     {
@@ -483,8 +472,8 @@ int lua_WIN_drawVideo(lua_State *L)
             return 0;
         }
         // stream WAV to DAC (this function will close when complete)
-        bool ok = streamWavToDAC(stream, https);
-        https.end();
+        bool ok = streamWavToDAC(stream, media);
+        media.release(false);
         Windows::canAccess = true;
         Serial.printf("[lua_WIN_drawVideo] WAV playback done ok=%d\n", ok ? 1 : 0);
         return 0;
@@ -502,7 +491,7 @@ int lua_WIN_drawVideo(lua_State *L)
         uint8_t header8[8];
         if (!readFull(stream, header8, 8))
         {
-            https.end();
+            media.release(false);
             Windows::canAccess = true;
             return 0;
         }
@@ -521,7 +510,7 @@ int lua_WIN_drawVideo(lua_State *L)
         if (!lineBuf)
         {
             Serial.println("[lua_WIN_drawVideo] lineBuf alloc failed");
-            https.end();
+            media.release(false);
             Windows::canAccess = true;
             return 0;
         }
@@ -534,7 +523,7 @@ int lua_WIN_drawVideo(lua_State *L)
             {
                 heap_caps_free(lineBuf);
                 Serial.println("[lua_WIN_drawVideo] scaledLineBuf fail");
-                https.end();
+                media.release(false);
                 Windows::canAccess = true;
                 return 0;
             }
@@ -613,7 +602,7 @@ int lua_WIN_drawVideo(lua_State *L)
             heap_caps_free(scaledLineBuf);
         if (lineBuf)
             heap_caps_free(lineBuf);
-        https.end();
+        media.release(false);
         Screen::tft.fillScreen(BG);
         Windows::canAccess = true;
         Serial.printf("[lua_WIN_drawVideo] finished oldRaw; freeHeap=%u\n", (unsigned)ESP.getFreeHeap());
@@ -632,7 +621,7 @@ int lua_WIN_drawVideo(lua_State *L)
     uint8_t avfBase[12];
     if (!readFull(stream, avfBase, 12))
     {
-        https.end();
+        media.release(false);
         Windows::canAccess = true;
         return 0;
     }
@@ -654,7 +643,7 @@ int lua_WIN_drawVideo(lua_State *L)
         uint8_t aHdr[10];
         if (!readFull(stream, aHdr, 10))
         {
-            https.end();
+            media.release(false);
             Windows::canAccess = true;
             return 0;
         }
@@ -673,7 +662,7 @@ int lua_WIN_drawVideo(lua_State *L)
     uint8_t fcountBuf[4];
     if (!readFull(stream, fcountBuf, 4))
     {
-        https.end();
+        media.release(false);
         Windows::canAccess = true;
         return 0;
     }
@@ -692,7 +681,7 @@ int lua_WIN_drawVideo(lua_State *L)
     if (!lineBuf)
     {
         Serial.println("[lua_WIN_drawVideo] lineBuf alloc fail");
-        https.end();
+        media.release(false);
         Windows::canAccess = true;
         return 0;
     }
@@ -704,7 +693,7 @@ int lua_WIN_drawVideo(lua_State *L)
         {
             heap_caps_free(lineBuf);
             Serial.println("[lua_WIN_drawVideo] scaledLineBuf fail");
-            https.end();
+            media.release(false);
             Windows::canAccess = true;
             return 0;
         }
@@ -816,7 +805,7 @@ int lua_WIN_drawVideo(lua_State *L)
                     uint32_t targetFrame = (uint32_t)(pos * (float)framesCount);
                     currentFrame = targetFrame;
                     Serial.printf("[lua_WIN_drawVideo] seek -> frame %u\n", currentFrame);
-                    https.end();
+                    media.release(false);
                     // compute byte offset: we need to recompute header size: base12 + (if audio present) audioHdr10 + audioBytes + 4(frameCount) = offsetToFrames
                     uint32_t offset = 12;
                     if (hasAudio)
@@ -853,7 +842,7 @@ int lua_WIN_drawVideo(lua_State *L)
                         }
                     }
                     // Now s2 is positioned at the compSize of desired frame; swap https/stream to s2
-                    https.end();
+                    media.release(false);
                     // To simplify we'll close and assign "stream" to a new stream opened with Range at the computed byte position:
                     // compute newBytePos by asking s2->available? Not trivial; easier: reopen original with Range offset and let the loop read frame by frame from there.
                     // For simplicity (robust) we'll just reopen entire resource and skip frames like above into "stream" to position.
@@ -909,7 +898,7 @@ int lua_WIN_drawVideo(lua_State *L)
                     uint32_t targetFrame = (uint32_t)(pos * (float)framesCount);
                     currentFrame = targetFrame;
                     Serial.printf("[lua_WIN_drawVideo] seek -> frame %u\n", currentFrame);
-                    https.end();
+                    media.release(false);
                     // reposition stream as above (reopen and skip)
                     uint32_t offset = 12;
                     if (hasAudio)
@@ -1085,7 +1074,7 @@ int lua_WIN_drawVideo(lua_State *L)
         timerAlarmDisable(audioTimer);
     dac_output_disable(DAC_CHANNEL_PLAY);
 
-    https.end();
+    media.release(false);
     Screen::tft.fillScreen(BG);
     Windows::canAccess = true;
     Serial.printf("[lua_WIN_drawVideo] finished; freeHeap=%u\n", (unsigned)ESP.getFreeHeap());
@@ -911,10 +911,11 @@ namespace LuaApps::WinLib
 
             Screen::tft.setViewport(rect.pos.x, rect.pos.y, rect.dimensions.x, rect.dimensions.y, true);
 
+            // steps keeps its old meaning of "smoother when higher": 4 is the default tolerance
             ok = drawSVGString(svgStr,
                                x, y,
                                w, h,
-                               color, steps > 10 ? 10 : (steps < 1 ? 1 : steps));
+                               color, 1.0f / (steps > 10 ? 10 : (steps < 1 ? 1 : steps)));
 
             Screen::tft.resetViewport();
 
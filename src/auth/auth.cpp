@@ -44,45 +44,25 @@ namespace Auth
     void copyPublicDir(const String &path)
     {
         esp_log_level_set("*", ESP_LOG_NONE);
-        auto files = SD_FS::readDirStr(path);
 
-        for (const auto &full : files)
-        {
-            String fp = full.startsWith("/public/") ? full.substring(7) : full;
+        String rel = path.startsWith("/public") ? path.substring(7) : path;
 
-            if (SD_FS::isDirectory(full))
-            {
-                ENC_FS::mkDir(ENC_FS::str2Path(fp));
-                copyPublicDir(full); // recurse
-            }
-            else
-            {
-                const size_t CHUNK_SIZE = 4096;
-                long fileSize = SD_FS::getFileSize(full);
-                if (fileSize <= 0)
-                    continue;
+        // progress bar below the "Copying Data..." text
+        const int barX = 20, barY = 140, barW = 280, barH = 12;
+        int lastFill = -1;
+        Screen::tft.drawRect(barX - 1, barY - 1, barW + 2, barH + 2, TEXT);
 
-                ENC_FS::Buffer chunk(CHUNK_SIZE);
-                long offset = 0;
+        ENC_FS::Import::importTree(path, ENC_FS::str2Path(rel), [&](const ENC_FS::Import::Progress &p)
+                                   {
+                                       if (p.bytesTotal == 0)
+                                           return;
+                                       int fill = (int)((p.bytesDone * barW) / p.bytesTotal);
+                                       if (fill == lastFill)
+                                           return;
+                                       lastFill = fill;
+                                       Screen::tft.fillRect(barX, barY, fill, barH, PRIMARY);
+                                   });
 
-                int lastSlash = fp.lastIndexOf('/');
-                if (lastSlash >= 0)
-                {
-                    String parentDir = fp.substring(0, lastSlash);
-                    ENC_FS::mkDir(ENC_FS::str2Path(parentDir));
-                }
-
-                while (offset < fileSize)
-                {
-                    size_t bytesToRead = min((long)CHUNK_SIZE, fileSize - offset);
-                    if (!SD_FS::readFileBuff(full, offset, bytesToRead, chunk))
-                        break;
-                    if (!ENC_FS::writeFile(ENC_FS::str2Path(fp), offset, offset + bytesToRead, chunk))
-                        break;
-                    offset += bytesToRead;
-                }
-            }
-        }
         esp_log_level_set("*", ESP_LOG_INFO); // or ESP_LOG_WARN / ESP_LOG_ERROR
     }
 
@@ -4,6 +4,7 @@
 #include "utils/crypto.hpp"
 #include "fs/index.hpp"
 #include "fs/enc-fs.hpp"
+#include "fs/import.hpp"
 #include "io/read-string.hpp"
 #include "screen/index.hpp"
 #include "utils/rect.hpp"
@@ -0,0 +1,114 @@
+#if defined(ARDUINO)
+
+#include "backend.hpp"
+
+#include <SD.h>
+#include <SPIFFS.h>
+
+namespace FsBackend
+{
+    class ArduinoFileHandle : public FileHandle
+    {
+    public:
+        explicit ArduinoFileHandle(File f) : f(f) {}
+        ~ArduinoFileHandle() override { close(); }
+
+        size_t read(uint8_t *buf, size_t len) override
+        {
+            int n = f.read(buf, len);
+            return n > 0 ? (size_t)n : 0;
+        }
+
+        size_t write(const uint8_t *buf, size_t len) override { return f.write(buf, len); }
+        bool seek(size_t pos) override { return f.seek(pos); }
+        size_t size() override { return f.size(); }
+
+        void close() override
+        {
+            if (f)
+                f.close();
+        }
+
+    private:
+        File f;
+    };
+
+    Handle ArduinoFs::open(const char *path, OpenMode mode)
+    {
+        const char *m = FILE_READ;
+        if (mode == OpenMode::Write)
+            m = FILE_WRITE;
+        else if (mode == OpenMode::Append)
+            m = FILE_APPEND;
+
+        File f = fs.open(path, m);
+        if (!f)
+            return nullptr;
+        return Handle(new ArduinoFileHandle(f));
+    }
+
+    bool ArduinoFs::exists(const char *path) { return fs.exists(path); }
+
+    bool ArduinoFs::isDirectory(const char *path)
+    {
+        File f = fs.open(path);
+        bool r = f && f.isDirectory();
+        if (f)
+            f.close();
+        return r;
+    }
+
+    bool ArduinoFs::mkdir(const char *path) { return fs.mkdir(path); }
+    bool ArduinoFs::remove(const char *path) { return fs.remove(path); }
+    bool ArduinoFs::rmdir(const char *path) { return fs.rmdir(path); }
+    bool ArduinoFs::rename(const char *from, const char *to) { return fs.rename(from, to); }
+
+    long ArduinoFs::fileSize(const char *path)
+    {
+        File f = fs.open(path, FILE_READ);
+        if (!f)
+            return -1;
+        long s = f.size();
+        f.close();
+        return s;
+    }
+
+    bool ArduinoFs::list(const char *path, const ListFn &cb)
+    {
+        File dir = fs.open(path);
+        if (!dir || !dir.isDirectory())
+        {
+            if (dir)
+                dir.close();
+            return false;
+        }
+
+        File e = dir.openNextFile();
+        while (e)
+        {
+            // older cores return the full path from name()
+            const char *name = e.name();
+            const char *slash = strrchr(name, '/');
+            DirEntry entry{slash ? slash + 1 : name, e.isDirectory(), (size_t)e.size()};
+            cb(entry);
+            e.close();
+            e = dir.openNextFile();
+        }
+        dir.close();
+        return true;
+    }
+
+    ArduinoFs &sd()
+    {
+        static ArduinoFs backend(SD);
+        return backend;
+    }
+
+    ArduinoFs &spiffs()
+    {
+        static ArduinoFs backend(SPIFFS);
+        return backend;
+    }
+} // namespace FsBackend
+
+#endif
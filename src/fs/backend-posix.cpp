@@ -0,0 +1,127 @@
+#if !defined(ARDUINO)
+
+#include "backend.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FsBackend
+{
+    class PosixFileHandle : public FileHandle
+    {
+    public:
+        explicit PosixFileHandle(FILE *f) : f(f) {}
+        ~PosixFileHandle() override { close(); }
+
+        size_t read(uint8_t *buf, size_t len) override { return f ? fread(buf, 1, len, f) : 0; }
+        size_t write(const uint8_t *buf, size_t len) override { return f ? fwrite(buf, 1, len, f) : 0; }
+        bool seek(size_t pos) override { return f && fseek(f, (long)pos, SEEK_SET) == 0; }
+
+        size_t size() override
+        {
+            if (!f)
+                return 0;
+            struct stat st;
+            fflush(f);
+            if (fstat(fileno(f), &st) != 0)
+                return 0;
+            return (size_t)st.st_size;
+        }
+
+        void close() override
+        {
+            if (f)
+                fclose(f);
+            f = nullptr;
+        }
+
+    private:
+        FILE *f;
+    };
+
+    PosixDir::PosixDir(const char *rootDir)
+    {
+        if (!rootDir)
+            rootDir = getenv("MWOS_SD_ROOT");
+        root = rootDir ? rootDir : "./sd-root";
+        while (root.size() > 1 && root.back() == '/')
+            root.pop_back();
+        ::mkdir(root.c_str(), 0755);
+    }
+
+    std::string PosixDir::resolve(const char *path) const
+    {
+        std::string p = path ? path : "/";
+        if (p.empty() || p[0] != '/')
+            p = "/" + p;
+        return root + p;
+    }
+
+    Handle PosixDir::open(const char *path, OpenMode mode)
+    {
+        const char *m = mode == OpenMode::Read ? "rb" : mode == OpenMode::Write ? "wb"
+                                                                                 : "ab";
+        std::string full = resolve(path);
+        struct stat st;
+        if (mode == OpenMode::Read && (stat(full.c_str(), &st) != 0 || S_ISDIR(st.st_mode)))
+            return nullptr;
+        FILE *f = fopen(full.c_str(), m);
+        if (!f)
+            return nullptr;
+        return Handle(new PosixFileHandle(f));
+    }
+
+    bool PosixDir::exists(const char *path)
+    {
+        struct stat st;
+        return stat(resolve(path).c_str(), &st) == 0;
+    }
+
+    bool PosixDir::isDirectory(const char *path)
+    {
+        struct stat st;
+        return stat(resolve(path).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    }
+
+    bool PosixDir::mkdir(const char *path) { return ::mkdir(resolve(path).c_str(), 0755) == 0; }
+    bool PosixDir::remove(const char *path) { return ::unlink(resolve(path).c_str()) == 0; }
+    bool PosixDir::rmdir(const char *path) { return ::rmdir(resolve(path).c_str()) == 0; }
+    bool PosixDir::rename(const char *from, const char *to) { return ::rename(resolve(from).c_str(), resolve(to).c_str()) == 0; }
+
+    long PosixDir::fileSize(const char *path)
+    {
+        struct stat st;
+        if (stat(resolve(path).c_str(), &st) != 0 || S_ISDIR(st.st_mode))
+            return -1;
+        return (long)st.st_size;
+    }
+
+    bool PosixDir::list(const char *path, const ListFn &cb)
+    {
+        std::string full = resolve(path);
+        DIR *d = opendir(full.c_str());
+        if (!d)
+            return false;
+
+        struct dirent *de;
+        while ((de = readdir(d)) != nullptr)
+        {
+            if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+                continue;
+            std::string child = full + "/" + de->d_name;
+            struct stat st;
+            if (stat(child.c_str(), &st) != 0)
+                continue;
+            DirEntry entry{de->d_name, S_ISDIR(st.st_mode), S_ISDIR(st.st_mode) ? 0 : (size_t)st.st_size};
+            cb(entry);
+        }
+        closedir(d);
+        return true;
+    }
+} // namespace FsBackend
+
+#endif
@@ -0,0 +1,139 @@
+#include "backend.hpp"
+
+#if defined(ESP_PLATFORM)
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+namespace FsBackend
+{
+    static Backend *g_active = nullptr;
+
+    static Backend &defaultBackend()
+    {
+#if defined(ARDUINO)
+        return sd();
+#else
+        static PosixDir host(nullptr);
+        return host;
+#endif
+    }
+
+    Backend &active()
+    {
+        return g_active ? *g_active : defaultBackend();
+    }
+
+    void setActive(Backend *b)
+    {
+        g_active = b;
+    }
+
+    uint32_t nowMicros()
+    {
+#if defined(ESP_PLATFORM)
+        return (uint32_t)esp_timer_get_time();
+#else
+        using namespace std::chrono;
+        return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static void sleepMicros(uint32_t us)
+    {
+        if (us == 0)
+            return;
+#if defined(ESP_PLATFORM)
+        if (us >= 1000)
+            vTaskDelay(pdMS_TO_TICKS(us / 1000));
+        else
+        {
+            uint32_t start = nowMicros();
+            while (nowMicros() - start < us)
+                ;
+        }
+#else
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+#endif
+    }
+
+    // ---------- Faulty ----------
+
+    bool Faulty::op()
+    {
+        sleepMicros(cfg.opLatencyUs);
+        if (cfg.failOneIn == 0)
+            return true;
+
+        // xorshift32: cheap and reproducible for a given seed
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        if (rng % cfg.failOneIn == 0)
+        {
+            ++injectedFailures;
+            return false;
+        }
+        return true;
+    }
+
+    void Faulty::waitBytes(size_t bytes, uint32_t usPerKB)
+    {
+        sleepMicros((uint32_t)(((uint64_t)bytes * usPerKB) / 1024));
+    }
+
+    class FaultyHandle : public FileHandle
+    {
+    public:
+        FaultyHandle(Faulty &owner, Handle inner) : owner(owner), inner(std::move(inner)) {}
+
+        size_t read(uint8_t *buf, size_t len) override
+        {
+            if (!owner.op())
+                return 0;
+            size_t n = inner->read(buf, len);
+            owner.waitBytes(n, owner.cfg.readUsPerKB);
+            return n;
+        }
+
+        size_t write(const uint8_t *buf, size_t len) override
+        {
+            if (!owner.op())
+                return 0;
+            size_t n = inner->write(buf, len);
+            owner.waitBytes(n, owner.cfg.writeUsPerKB);
+            return n;
+        }
+
+        bool seek(size_t pos) override { return inner->seek(pos); }
+        size_t size() override { return inner->size(); }
+        void close() override { inner->close(); }
+
+    private:
+        Faulty &owner;
+        Handle inner;
+    };
+
+    Handle Faulty::open(const char *path, OpenMode mode)
+    {
+        if (!op())
+            return nullptr;
+        Handle h = inner.open(path, mode);
+        if (!h)
+            return nullptr;
+        return Handle(new FaultyHandle(*this, std::move(h)));
+    }
+
+    bool Faulty::exists(const char *path) { return op() && inner.exists(path); }
+    bool Faulty::isDirectory(const char *path) { return op() && inner.isDirectory(path); }
+    bool Faulty::mkdir(const char *path) { return op() && inner.mkdir(path); }
+    bool Faulty::remove(const char *path) { return op() && inner.remove(path); }
+    bool Faulty::rmdir(const char *path) { return op() && inner.rmdir(path); }
+    bool Faulty::rename(const char *from, const char *to) { return op() && inner.rename(from, to); }
+    long Faulty::fileSize(const char *path) { return op() ? inner.fileSize(path) : -1; }
+    bool Faulty::list(const char *path, const ListFn &cb) { return op() && inner.list(path, cb); }
+} // namespace FsBackend
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <memory>
+
+#if !defined(ARDUINO)
+#include <string>
+#endif
+
+// Storage backend used by SD_FS and ENC_FS for all file I/O.
+//
+// On the device the active backend wraps the Arduino SD card (ArduinoFs over fs::FS); host builds
+// use PosixDir, which maps "/a/b" onto a local directory, so the filesystem logic can be run,
+// fuzzed and benchmarked on Linux. Faulty wraps any backend and injects latency and failures
+// to model slow or flaky SD cards. Paths are absolute, '/'-separated, without trailing slash.
+namespace FsBackend
+{
+    enum class OpenMode
+    {
+        Read,
+        Write, // create or truncate
+        Append
+    };
+
+    class FileHandle
+    {
+    public:
+        virtual ~FileHandle() {}
+        virtual size_t read(uint8_t *buf, size_t len) = 0;
+        virtual size_t write(const uint8_t *buf, size_t len) = 0;
+        virtual bool seek(size_t pos) = 0;
+        virtual size_t size() = 0;
+        virtual void close() = 0;
+    };
+
+    using Handle = std::unique_ptr<FileHandle>;
+
+    struct DirEntry
+    {
+        const char *name; // last path segment only
+        bool isDir;
+        size_t size;
+    };
+
+    using ListFn = std::function<void(const DirEntry &)>;
+
+    class Backend
+    {
+    public:
+        virtual ~Backend() {}
+
+        // nullptr on failure
+        virtual Handle open(const char *path, OpenMode mode) = 0;
+
+        virtual bool exists(const char *path) = 0;
+        virtual bool isDirectory(const char *path) = 0;
+        virtual bool mkdir(const char *path) = 0;
+        virtual bool remove(const char *path) = 0;
+        virtual bool rmdir(const char *path) = 0;
+        virtual bool rename(const char *from, const char *to) = 0;
+        virtual long fileSize(const char *path) = 0; // -1 if missing
+
+        // Calls cb for every entry of a directory; false if path is not a directory.
+        virtual bool list(const char *path, const ListFn &cb) = 0;
+    };
+
+    // Backend used by SD_FS / ENC_FS. Defaults to the SD card (device) or PosixDir (host).
+    Backend &active();
+    void setActive(Backend *b); // nullptr restores the default
+
+    uint32_t nowMicros();
+
+#if !defined(ARDUINO)
+    // Host backend: every path is resolved below `root` (default: $MWOS_SD_ROOT or ./sd-root).
+    class PosixDir : public Backend
+    {
+    public:
+        explicit PosixDir(const char *root);
+
+        Handle open(const char *path, OpenMode mode) override;
+        bool exists(const char *path) override;
+        bool isDirectory(const char *path) override;
+        bool mkdir(const char *path) override;
+        bool remove(const char *path) override;
+        bool rmdir(const char *path) override;
+        bool rename(const char *from, const char *to) override;
+        long fileSize(const char *path) override;
+        bool list(const char *path, const ListFn &cb) override;
+
+    private:
+        std::string resolve(const char *path) const;
+        std::string root;
+    };
+#endif
+
+    struct FaultConfig
+    {
+        uint32_t opLatencyUs = 0;    // per metadata op (open, exists, mkdir, list, ...)
+        uint32_t readUsPerKB = 0;    // added per KB read
+        uint32_t writeUsPerKB = 0;   // added per KB written
+        uint32_t failOneIn = 0;      // 0 = never, otherwise each op fails with probability 1/N
+        uint32_t seed = 0x12345678u; // deterministic failure pattern
+    };
+
+    // Decorator modelling an SD card: adds latency and random failures around another backend.
+    class Faulty : public Backend
+    {
+    public:
+        Faulty(Backend &inner, const FaultConfig &cfg) : inner(inner), cfg(cfg), rng(cfg.seed ? cfg.seed : 1) {}
+
+        Handle open(const char *path, OpenMode mode) override;
+        bool exists(const char *path) override;
+        bool isDirectory(const char *path) override;
+        bool mkdir(const char *path) override;
+        bool remove(const char *path) override;
+        bool rmdir(const char *path) override;
+        bool rename(const char *from, const char *to) override;
+        long fileSize(const char *path) override;
+        bool list(const char *path, const ListFn &cb) override;
+
+        uint32_t injectedFailures = 0;
+
+    private:
+        friend class FaultyHandle;
+        bool op(); // applies op latency, returns false if this op should fail
+        void waitBytes(size_t bytes, uint32_t usPerKB);
+
+        Backend &inner;
+        FaultConfig cfg;
+        uint32_t rng;
+    };
+} // namespace FsBackend
+
+#if defined(ARDUINO)
+#include <FS.h>
+
+namespace FsBackend
+{
+    // Device backend over any Arduino fs::FS (SD, SPIFFS).
+    class ArduinoFs : public Backend
+    {
+    public:
+        explicit ArduinoFs(fs::FS &fs) : fs(fs) {}
+
+        Handle open(const char *path, OpenMode mode) override;
+        bool exists(const char *path) override;
+        bool isDirectory(const char *path) override;
+        bool mkdir(const char *path) override;
+        bool remove(const char *path) override;
+        bool rmdir(const char *path) override;
+        bool rename(const char *from, const char *to) override;
+        long fileSize(const char *path) override;
+        bool list(const char *path, const ListFn &cb) override;
+
+    private:
+        fs::FS &fs;
+    };
+
+    ArduinoFs &sd();
+    ArduinoFs &spiffs();
+} // namespace FsBackend
+#endif
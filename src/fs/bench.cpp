@@ -0,0 +1,173 @@
+#include "bench.hpp"
+
+#include <stdio.h>
+#include <string>
+
+namespace FsBench
+{
+    const char *opName(Op op)
+    {
+        switch (op)
+        {
+        case Op::Read:
+            return "read";
+        case Op::Write:
+            return "write";
+        case Op::Append:
+            return "append";
+        case Op::ReadDir:
+            return "readDir";
+        case Op::Exists:
+            return "exists";
+        }
+        return "?";
+    }
+
+    static Result finish(Op op, size_t param, uint32_t ops, uint32_t start)
+    {
+        Result r;
+        r.op = op;
+        r.param = param;
+        r.ops = ops;
+        r.micros = FsBackend::nowMicros() - start;
+        if (!r.micros)
+            r.micros = 1;
+        r.opsPerSec = (float)ops * 1000000.0f / (float)r.micros;
+        return r;
+    }
+
+    static bool writeWhole(FsBackend::Backend &b, const std::string &path, const std::vector<uint8_t> &data, FsBackend::OpenMode mode)
+    {
+        FsBackend::Handle f = b.open(path.c_str(), mode);
+        if (!f)
+            return false;
+        size_t n = data.empty() ? 0 : f->write(data.data(), data.size());
+        f->close();
+        return n == data.size();
+    }
+
+    static void removeTree(FsBackend::Backend &b, const std::string &path)
+    {
+        std::vector<std::pair<std::string, bool>> entries;
+        if (!b.list(path.c_str(), [&](const FsBackend::DirEntry &e)
+                    { entries.push_back({path + "/" + e.name, e.isDir}); }))
+        {
+            b.remove(path.c_str());
+            return;
+        }
+        for (const auto &e : entries)
+        {
+            if (e.second)
+                removeTree(b, e.first);
+            else
+                b.remove(e.first.c_str());
+        }
+        b.rmdir(path.c_str());
+    }
+
+    static void benchFiles(FsBackend::Backend &b, const std::string &dir, uint32_t iterations, std::vector<Result> &out)
+    {
+        const size_t sizes[] = {64, 1024, 16 * 1024, 128 * 1024};
+        for (size_t size : sizes)
+        {
+            std::vector<uint8_t> data(size, 0x5A);
+            std::vector<uint8_t> readBuf(size);
+            std::string path = dir + "/f" + std::to_string(size);
+            // large files: fewer ops so one case stays in the seconds range on an SD card
+            uint32_t n = size >= 16 * 1024 ? (iterations / 4 ? iterations / 4 : 1) : iterations;
+
+            uint32_t start = FsBackend::nowMicros();
+            for (uint32_t i = 0; i < n; ++i)
+                writeWhole(b, path, data, FsBackend::OpenMode::Write);
+            out.push_back(finish(Op::Write, size, n, start));
+
+            start = FsBackend::nowMicros();
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                FsBackend::Handle f = b.open(path.c_str(), FsBackend::OpenMode::Read);
+                if (!f)
+                    continue;
+                f->read(readBuf.data(), readBuf.size());
+                f->close();
+            }
+            out.push_back(finish(Op::Read, size, n, start));
+
+            std::string apath = path + ".app";
+            start = FsBackend::nowMicros();
+            for (uint32_t i = 0; i < n; ++i)
+                writeWhole(b, apath, data, FsBackend::OpenMode::Append);
+            out.push_back(finish(Op::Append, size, n, start));
+
+            b.remove(path.c_str());
+            b.remove(apath.c_str());
+        }
+    }
+
+    static void benchReadDir(FsBackend::Backend &b, const std::string &dir, uint32_t iterations, std::vector<Result> &out)
+    {
+        const size_t fanouts[] = {8, 64, 256};
+        std::vector<uint8_t> one(1, 0);
+        for (size_t fanout : fanouts)
+        {
+            std::string d = dir + "/d" + std::to_string(fanout);
+            b.mkdir(d.c_str());
+            for (size_t i = 0; i < fanout; ++i)
+                writeWhole(b, d + "/e" + std::to_string(i), one, FsBackend::OpenMode::Write);
+
+            size_t seen = 0;
+            uint32_t start = FsBackend::nowMicros();
+            for (uint32_t i = 0; i < iterations; ++i)
+                b.list(d.c_str(), [&](const FsBackend::DirEntry &)
+                       { ++seen; });
+            out.push_back(finish(Op::ReadDir, fanout, iterations, start));
+
+            removeTree(b, d);
+        }
+    }
+
+    static void benchExists(FsBackend::Backend &b, const std::string &dir, uint32_t iterations, std::vector<Result> &out)
+    {
+        const size_t depths[] = {1, 4, 8};
+        std::vector<uint8_t> one(1, 0);
+        for (size_t depth : depths)
+        {
+            std::string p = dir + "/x" + std::to_string(depth);
+            b.mkdir(p.c_str());
+            for (size_t i = 1; i < depth; ++i)
+            {
+                p += "/s" + std::to_string(i);
+                b.mkdir(p.c_str());
+            }
+            std::string leaf = p + "/leaf";
+            writeWhole(b, leaf, one, FsBackend::OpenMode::Write);
+
+            uint32_t ops = iterations * 8;
+            uint32_t start = FsBackend::nowMicros();
+            for (uint32_t i = 0; i < ops; ++i)
+                b.exists(leaf.c_str());
+            out.push_back(finish(Op::Exists, depth, ops, start));
+
+            removeTree(b, dir + "/x" + std::to_string(depth));
+        }
+    }
+
+    std::vector<Result> run(FsBackend::Backend &b, const char *scratchDir, uint32_t iterations)
+    {
+        std::vector<Result> out;
+        std::string dir = scratchDir;
+        if (iterations == 0)
+            iterations = 1;
+
+        if (b.exists(dir.c_str()))
+            removeTree(b, dir);
+        if (!b.mkdir(dir.c_str()))
+            return out;
+
+        benchFiles(b, dir, iterations, out);
+        benchReadDir(b, dir, iterations, out);
+        benchExists(b, dir, iterations, out);
+
+        removeTree(b, dir);
+        return out;
+    }
+} // namespace FsBench
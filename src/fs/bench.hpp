@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "backend.hpp"
+
+// Micro benchmarks for a storage backend (no Arduino dependency, runs on the device and on the host).
+//
+// Every case works below `scratchDir`, which is created and removed again. Results are ops/sec,
+// so a PosixDir run can be compared with a Faulty(PosixDir) run that models a given SD card.
+namespace FsBench
+{
+    enum class Op
+    {
+        Read,
+        Write,
+        Append,
+        ReadDir, // param = entries in the directory
+        Exists   // param = path depth
+    };
+
+    struct Result
+    {
+        Op op;
+        size_t param; // file size in bytes, directory fan-out or path depth
+        uint32_t ops;
+        uint32_t micros;
+        float opsPerSec;
+    };
+
+    const char *opName(Op op);
+
+    // Runs read/write/append for sizes {64, 1K, 16K, 128K}, readDir for fan-outs {8, 64, 256}
+    // and exists() for depths {1, 4, 8}. `iterations` scales the number of ops per case.
+    std::vector<Result> run(FsBackend::Backend &b, const char *scratchDir = "/.fsbench", uint32_t iterations = 16);
+} // namespace FsBench
@@ -0,0 +1,563 @@
+#include "blob-store.hpp"
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <algorithm>
+
+#include <mbedtls/sha256.h>
+
+namespace ENC_FS
+{
+    namespace BlobStore
+    {
+        struct Manifest
+        {
+            std::map<String, Entry> byPath;
+        };
+
+        static std::mutex g_lock; // protects g_manifests
+        static std::map<String, Manifest> g_manifests;
+
+        static Path manifestPath(const String &app)
+        {
+            return {String("programs"), app, String(MANIFEST_NAME)};
+        }
+
+        // journal copy written before the manifest is replaced
+        static Path journalPath(const String &app)
+        {
+            return {String("programs"), app, String(MANIFEST_NAME) + ".new"};
+        }
+
+        bool isReserved(const String &relPath)
+        {
+            return relPath.startsWith(MANIFEST_NAME);
+        }
+
+        // programs/<app>/<rel...> -> app, "rel/..."
+        static bool splitAppPath(const Path &p, String &app, String &rel)
+        {
+            if (p.size() < 2 || p[0] != "programs")
+                return false;
+            app = p[1];
+            rel = "";
+            for (size_t i = 2; i < p.size(); ++i)
+            {
+                if (rel.length())
+                    rel += "/";
+                rel += p[i];
+            }
+            return true;
+        }
+
+        // ---------- manifest (de)serialisation ----------
+
+        // Returns false if a line is malformed or the "# <count>" trailer (if any) does not match.
+        bool parse(const String &s, std::vector<Entry> &out)
+        {
+            out.clear();
+            bool ok = true;
+            long trailer = -1;
+            int idx = 0;
+            while (idx < (int)s.length())
+            {
+                int nl = s.indexOf('\n', idx);
+                String line = nl < 0 ? s.substring(idx) : s.substring(idx, nl);
+                idx = nl < 0 ? s.length() : nl + 1;
+                line.trim();
+                if (line.length() == 0)
+                    continue;
+                if (line.startsWith("#"))
+                {
+                    trailer = line.substring(1).toInt();
+                    continue;
+                }
+
+                int a = line.indexOf(' ');
+                int b = a < 0 ? -1 : line.indexOf(' ', a + 1);
+                if (a != 64 || b < 0)
+                {
+                    ok = false; // malformed line
+                    continue;
+                }
+                Entry e;
+                e.hash = line.substring(0, a);
+                e.hash.toLowerCase();
+                e.size = (size_t)line.substring(a + 1, b).toInt();
+                e.path = line.substring(b + 1);
+                e.path.trim();
+                if (e.path.length() == 0 || e.path.indexOf("..") >= 0 || isReserved(e.path))
+                {
+                    ok = false;
+                    continue;
+                }
+                out.push_back(e);
+            }
+            return ok && (trailer < 0 || trailer == (long)out.size());
+        }
+
+        static bool parseComplete(const String &s, Manifest &m)
+        {
+            std::vector<Entry> v;
+            bool ok = parse(s, v) && s.indexOf('#') >= 0;
+            for (const Entry &e : v)
+                m.byPath[e.path] = e;
+            return ok;
+        }
+
+        static Buffer serialiseManifest(const Manifest &m)
+        {
+            String s;
+            s.reserve(m.byPath.size() * 96);
+            for (const auto &kv : m.byPath)
+            {
+                const Entry &e = kv.second;
+                s += e.hash + " " + String((unsigned)e.size) + " " + e.path + "\n";
+            }
+            s += "# " + String((unsigned)m.byPath.size()) + "\n"; // trailer marks a complete write
+            return Buffer(s.begin(), s.end());
+        }
+
+        // Caller holds g_lock.
+        static Manifest &loadLocked(const String &app)
+        {
+            auto it = g_manifests.find(app);
+            if (it != g_manifests.end())
+                return it->second;
+
+            Manifest &m = g_manifests[app];
+            Path mp = manifestPath(app);
+            Path jp = journalPath(app);
+            if (exists(jp))
+            {
+                // a replace() was interrupted: a complete journal is the new manifest
+                Manifest next;
+                if (parseComplete(readFileString(jp), next))
+                {
+                    m = next;
+                    writeFile(mp, 0, 0, serialiseManifest(m));
+                    fsync(mp);
+                    deleteFile(jp);
+                    return m;
+                }
+                deleteFile(jp);
+            }
+            if (exists(mp))
+                parseComplete(readFileString(mp), m);
+            return m;
+        }
+
+        static bool storeLocked(const String &app, const Manifest &m)
+        {
+            return writeFile(manifestPath(app), 0, 0, serialiseManifest(m));
+        }
+
+        // ---------- blobs ----------
+
+        static String toHex(const uint8_t h[32])
+        {
+            static const char *hex = "0123456789abcdef";
+            String out;
+            out.reserve(64);
+            for (int i = 0; i < 32; ++i)
+            {
+                out += hex[h[i] >> 4];
+                out += hex[h[i] & 0x0F];
+            }
+            return out;
+        }
+
+        String hashHex(const Buffer &data)
+        {
+            uint8_t h[32];
+            mbedtls_sha256_context ctx;
+            mbedtls_sha256_init(&ctx);
+            mbedtls_sha256_starts_ret(&ctx, 0);
+            mbedtls_sha256_update_ret(&ctx, data.data(), data.size());
+            mbedtls_sha256_finish_ret(&ctx, h);
+            mbedtls_sha256_free(&ctx);
+            return toHex(h);
+        }
+
+        Path blobPath(const String &hash)
+        {
+            return {String("blobs"), hash.substring(0, 2), hash};
+        }
+
+        bool hasBlob(const String &hash, size_t size)
+        {
+            return getFileSize(blobPath(hash)) == (long)size;
+        }
+
+        bool put(const Buffer &data, String &hashOut, bool *written)
+        {
+            hashOut = hashHex(data);
+            if (written)
+                *written = false;
+            if (hasBlob(hashOut, data.size()))
+                return true;
+
+            if (written)
+                *written = true;
+            return writeFile(blobPath(hashOut), 0, 0, data);
+        }
+
+        bool link(const String &app, const String &relPath, const String &hash, size_t size)
+        {
+            if (isReserved(relPath))
+                return false;
+            bool known;
+            {
+                std::lock_guard<std::mutex> g(g_lock);
+                known = loadLocked(app).byPath.count(relPath) > 0;
+            }
+            // first time this path goes through the store: drop the plain copy of an older install
+            if (!known)
+            {
+                Path plain = {String("programs"), app};
+                plain.push_back(relPath);
+                deleteFile(plain);
+            }
+
+            std::lock_guard<std::mutex> g(g_lock);
+            Manifest &m = loadLocked(app);
+            auto it = m.byPath.find(relPath);
+            if (it != m.byPath.end() && it->second.hash == hash && it->second.size == size)
+                return true; // unchanged, manifest stays as is
+
+            Entry e;
+            e.path = relPath;
+            e.hash = hash;
+            e.size = size;
+            m.byPath[relPath] = e;
+            return storeLocked(app, m);
+        }
+
+        bool addFile(const String &app, const String &relPath, const Buffer &data, bool *written)
+        {
+            String hash;
+            if (!put(data, hash, written))
+                return false;
+            return link(app, relPath, hash, data.size());
+        }
+
+        // ---------- streaming writer ----------
+
+        static uint32_t g_stagingSeq = 0;
+
+        Writer::Writer()
+        {
+            mbedtls_sha256_context *ctx = new mbedtls_sha256_context;
+            mbedtls_sha256_init(ctx);
+            mbedtls_sha256_starts_ret(ctx, 0);
+            sha = ctx;
+        }
+
+        Writer::~Writer()
+        {
+            abort();
+            mbedtls_sha256_free((mbedtls_sha256_context *)sha);
+            delete (mbedtls_sha256_context *)sha;
+        }
+
+        bool Writer::write(const uint8_t *data, size_t len)
+        {
+            if (failed)
+                return false;
+            mbedtls_sha256_update_ret((mbedtls_sha256_context *)sha, data, len);
+            total += len;
+
+            if (!spilled && ram.size() + len <= RAM_LIMIT)
+            {
+                ram.insert(ram.end(), data, data + len);
+                return true;
+            }
+
+            if (!spilled)
+            {
+                staging = {String("blobs"), String("tmp"), String(millis()) + "-" + String(g_stagingSeq++)};
+                if (!spill.open(staging) || !spill.write(ram.data(), ram.size()))
+                {
+                    failed = true;
+                    return false;
+                }
+                Buffer().swap(ram);
+                spilled = true;
+            }
+            failed = !spill.write(data, len);
+            return !failed;
+        }
+
+        void Writer::abort()
+        {
+            if (spilled)
+            {
+                spill.close();
+                deleteFile(staging);
+                spilled = false;
+            }
+            Buffer().swap(ram);
+        }
+
+        bool Writer::commitBlob(String &hashOut, bool *written, const String &expectHash)
+        {
+            if (written)
+                *written = false;
+            if (failed)
+            {
+                abort();
+                return false;
+            }
+
+            uint8_t h[32];
+            mbedtls_sha256_finish_ret((mbedtls_sha256_context *)sha, h);
+            hashOut = toHex(h);
+            if (expectHash.length() && !expectHash.equalsIgnoreCase(hashOut))
+            {
+                Serial.println("[BlobStore] hash mismatch, expected " + expectHash + " got " + hashOut);
+                failed = true;
+                abort();
+                return false;
+            }
+
+            if (!spilled)
+            {
+                bool ok = true;
+                if (!hasBlob(hashOut, ram.size()))
+                {
+                    ok = writeFile(blobPath(hashOut), 0, 0, ram);
+                    if (written)
+                        *written = ok;
+                }
+                Buffer().swap(ram);
+                return ok;
+            }
+
+            bool ok = spill.close();
+            if (ok && !hasBlob(hashOut, total))
+            {
+                // the nonce is bound to the path, so the staged file is re-encrypted under the blob name
+                Path dst = blobPath(hashOut);
+                FileWriter out;
+                ok = out.open(dst);
+                for (size_t off = 0; ok && off < total; off += RAM_LIMIT)
+                {
+                    size_t end = std::min(total, off + RAM_LIMIT);
+                    Buffer chunk = readFilePart(staging, (long)off, (long)end);
+                    ok = chunk.size() == end - off && out.write(chunk.data(), chunk.size());
+                }
+                ok = out.close() && ok;
+                if (written)
+                    *written = ok;
+            }
+            deleteFile(staging);
+            spilled = false;
+            return ok;
+        }
+
+        bool Writer::commit(const String &app, const String &relPath, bool *written)
+        {
+            String hash;
+            return commitBlob(hash, written) && link(app, relPath, hash, total);
+        }
+
+        bool replace(const String &app, const std::vector<Entry> &next)
+        {
+            Manifest m;
+            for (const Entry &e : next)
+            {
+                if (isReserved(e.path))
+                {
+                    Serial.println("[BlobStore] replace: reserved path " + e.path);
+                    return false;
+                }
+                if (!hasBlob(e.hash, e.size))
+                {
+                    Serial.println("[BlobStore] replace: missing blob for " + e.path);
+                    return false;
+                }
+                m.byPath[e.path] = e;
+            }
+
+            std::set<String> known;
+            for (const Entry &e : entries(app))
+                known.insert(e.path);
+            // drop plain copies of an older install that would shadow the new entries
+            for (const Entry &e : next)
+            {
+                if (known.count(e.path))
+                    continue;
+                Path plain = {String("programs"), app};
+                plain.push_back(e.path);
+                deleteFile(plain);
+            }
+
+            std::lock_guard<std::mutex> g(g_lock);
+            // journal first: until the real manifest is complete, a crash recovers from the journal
+            Path jp = journalPath(app);
+            Path mp = manifestPath(app);
+            Buffer data = serialiseManifest(m);
+            if (!writeFile(jp, 0, 0, data) || !fsync(jp))
+                return false;
+            bool ok = writeFile(mp, 0, 0, data) && fsync(mp);
+            if (ok)
+                deleteFile(jp);
+            g_manifests[app] = m;
+            return ok;
+        }
+
+        std::vector<Entry> entries(const String &app)
+        {
+            std::vector<Entry> out;
+            std::lock_guard<std::mutex> g(g_lock);
+            for (const auto &kv : loadLocked(app).byPath)
+                out.push_back(kv.second);
+            return out;
+        }
+
+        bool prune(const String &app, const std::vector<String> &keep)
+        {
+            std::set<String> k(keep.begin(), keep.end());
+            std::lock_guard<std::mutex> g(g_lock);
+            Manifest &m = loadLocked(app);
+            bool changed = false;
+            for (auto it = m.byPath.begin(); it != m.byPath.end();)
+            {
+                if (!k.count(it->first))
+                {
+                    it = m.byPath.erase(it);
+                    changed = true;
+                }
+                else
+                    ++it;
+            }
+            return changed ? storeLocked(app, m) : true;
+        }
+
+        // ---------- ENC_FS hooks ----------
+
+        bool resolve(const Path &p, Path &blob, long *size)
+        {
+            String app, rel;
+            if (!splitAppPath(p, app, rel) || rel.length() == 0 || isReserved(rel))
+                return false;
+
+            std::lock_guard<std::mutex> g(g_lock);
+            Manifest &m = loadLocked(app);
+            auto it = m.byPath.find(rel);
+            if (it == m.byPath.end())
+                return false;
+            blob = blobPath(it->second.hash);
+            if (size)
+                *size = (long)it->second.size;
+            return true;
+        }
+
+        bool forget(const Path &p)
+        {
+            String app, rel;
+            if (!splitAppPath(p, app, rel) || rel.length() == 0 || isReserved(rel))
+                return false;
+
+            std::lock_guard<std::mutex> g(g_lock);
+            Manifest &m = loadLocked(app);
+            if (!m.byPath.erase(rel))
+                return false;
+            return storeLocked(app, m);
+        }
+
+        void listNames(const Path &dir, std::vector<String> &out)
+        {
+            String app, rel;
+            if (!splitAppPath(dir, app, rel))
+                return;
+            String prefix = rel.length() ? rel + "/" : String("");
+
+            std::lock_guard<std::mutex> g(g_lock);
+            Manifest &m = loadLocked(app);
+            for (const auto &kv : m.byPath)
+            {
+                if (!kv.first.startsWith(prefix))
+                    continue;
+                String rest = kv.first.substring(prefix.length());
+                int slash = rest.indexOf('/');
+                String name = slash < 0 ? rest : rest.substring(0, slash);
+                if (std::find(out.begin(), out.end(), name) == out.end())
+                    out.push_back(name);
+            }
+        }
+
+        void invalidate(const Path &dir)
+        {
+            std::lock_guard<std::mutex> g(g_lock);
+            if (dir.empty() || (dir.size() == 1 && dir[0] == "programs"))
+            {
+                g_manifests.clear();
+                return;
+            }
+            String app, rel;
+            if (splitAppPath(dir, app, rel))
+                g_manifests.erase(app);
+        }
+
+        // hashes referenced by the manifest of any installed app
+        static std::set<String> liveHashes()
+        {
+            std::set<String> live;
+            for (const String &app : readDir({"programs"}))
+                for (const Entry &e : entries(app))
+                    live.insert(e.hash);
+            return live;
+        }
+
+        std::vector<String> hashesBelow(const Path &dir)
+        {
+            std::vector<String> apps;
+            if (dir.size() == 1 && dir[0] == "programs")
+                apps = readDir({"programs"});
+            else if (dir.size() == 2 && dir[0] == "programs")
+                apps.push_back(dir[1]);
+
+            std::set<String> hashes;
+            for (const String &app : apps)
+                for (const Entry &e : entries(app))
+                    hashes.insert(e.hash);
+            return std::vector<String>(hashes.begin(), hashes.end());
+        }
+
+        size_t release(const std::vector<String> &hashes)
+        {
+            if (hashes.empty())
+                return 0;
+            std::set<String> live = liveHashes();
+            size_t removed = 0;
+            for (const String &hash : hashes)
+                if (!live.count(hash) && deleteFile(blobPath(hash)))
+                    removed++;
+            if (removed)
+                Serial.printf("[BlobStore] released %u blobs\n", (unsigned)removed);
+            return removed;
+        }
+
+        size_t gc()
+        {
+            std::set<String> live = liveHashes();
+
+            size_t removed = 0;
+            for (const String &shard : readDir({"blobs"}))
+            {
+                for (const String &hash : readDir({String("blobs"), shard}))
+                {
+                    if (live.count(hash))
+                        continue;
+                    if (deleteFile({String("blobs"), shard, hash}))
+                        removed++;
+                }
+            }
+            if (removed)
+                Serial.printf("[BlobStore] gc removed %u blobs\n", (unsigned)removed);
+            return removed;
+        }
+    }
+} // namespace ENC_FS
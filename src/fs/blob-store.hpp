@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+#include "enc-fs.hpp"
+
+namespace ENC_FS
+{
+    // Content-addressed, deduplicated store for installed app files.
+    //
+    // File contents live once in blobs/<h[0..2]>/<sha256 hex>. An app folder programs/<app>/ only keeps
+    // a manifest (pkg.manifest, one "<sha256 hex> <size> <relative path>" line per file and a
+    // "# <count>" trailer, the same format as a package's manifest.txt); ENC_FS
+    // resolves reads of programs/<app>/<path> that have no plain file through it. Identical files
+    // across apps and versions are stored once and reinstalling unchanged files writes no file data.
+    // A plain file in the app folder (e.g. id.txt, files written by the app itself) takes precedence.
+    namespace BlobStore
+    {
+        constexpr const char *MANIFEST_NAME = "pkg.manifest";
+
+        struct Entry
+        {
+            String path; // relative to programs/<app>/, '/'-separated
+            String hash; // lowercase sha256 hex
+            size_t size;
+        };
+
+        // pkg.manifest and its journal: never a package file, link() and replace() refuse them
+        bool isReserved(const String &relPath);
+
+        // Parse manifest text into entries (false on malformed lines or a trailer mismatch).
+        bool parse(const String &text, std::vector<Entry> &out);
+
+        String hashHex(const Buffer &data);
+        Path blobPath(const String &hash);
+        bool hasBlob(const String &hash, size_t size);
+
+        // Store `data` unless a blob with the same hash already exists. `written` tells whether SD was touched.
+        bool put(const Buffer &data, String &hashOut, bool *written = nullptr);
+
+        // Store `data` as programs/<app>/<relPath>: put the blob, record it in the manifest and
+        // remove a plain copy left by an older install.
+        bool addFile(const String &app, const String &relPath, const Buffer &data, bool *written = nullptr);
+
+        // Streams a file of unknown size into the store: hashes while writing, keeps small files
+        // in RAM and spills larger ones to a staging file that becomes the blob on commit().
+        class Writer
+        {
+        public:
+            static constexpr size_t RAM_LIMIT = 16 * 1024;
+
+            Writer();
+            ~Writer();
+
+            bool write(const uint8_t *data, size_t len);
+            // Finish the hash, place the blob (skipped if already present) and record programs/<app>/<relPath>.
+            bool commit(const String &app, const String &relPath, bool *written = nullptr);
+            // Only place the blob. With `expectHash` set, a mismatching download is discarded.
+            bool commitBlob(String &hashOut, bool *written = nullptr, const String &expectHash = "");
+            void abort();
+            size_t size() const { return total; }
+
+        private:
+            void *sha; // mbedtls_sha256_context
+            Buffer ram;
+            FileWriter spill;
+            Path staging;
+            size_t total = 0;
+            bool spilled = false;
+            bool failed = false;
+        };
+
+        // Point programs/<app>/<relPath> at the stored blob `hash`.
+        bool link(const String &app, const String &relPath, const String &hash, size_t size);
+
+        std::vector<Entry> entries(const String &app);
+
+        // Switch programs/<app>/ to exactly `next` in one step. All blobs must already be stored.
+        // The manifest is journaled (pkg.manifest.new) so a crash leaves either the old or the new version.
+        bool replace(const String &app, const std::vector<Entry> &next);
+
+        // Drop manifest entries whose path is not in `keep` (files removed by an update).
+        bool prune(const String &app, const std::vector<String> &keep);
+
+        // ---------- hooks used by the ENC_FS file API ----------
+
+        // If `p` is a manifest-backed app file, set `blob` (and `size`) to its blob.
+        bool resolve(const Path &p, Path &blob, long *size = nullptr);
+        // Remove the manifest entry for `p`; false if there is none.
+        bool forget(const Path &p);
+        // Names below `dir` that only exist in a manifest (first path segment after `dir`).
+        void listNames(const Path &dir, std::vector<String> &out);
+        // Drop cached manifests of apps at or below `dir` (after rmDir).
+        void invalidate(const Path &dir);
+
+        // Blobs referenced by the apps a rmDir(dir) removes (programs/<app> or programs).
+        std::vector<String> hashesBelow(const Path &dir);
+        // After those apps are gone: delete the blobs of `hashes` no remaining manifest references.
+        size_t release(const std::vector<String> &hashes);
+
+        // Delete blobs no manifest references anymore. Returns the number of blobs removed.
+        size_t gc();
+    }
+} // namespace ENC_FS
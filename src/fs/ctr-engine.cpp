@@ -0,0 +1,165 @@
+#include "ctr-engine.hpp"
+
+#include <cstring>
+#include <vector>
+
+#if defined(ESP_PLATFORM)
+#include "esp_timer.h"
+#else
+#include <chrono>
+#endif
+
+namespace ENC_FS
+{
+    // CTR over an all-zero input yields the raw keystream; the backend does the
+    // counter increments itself and keeps the AES unit locked for the whole batch.
+    static const uint8_t kZeroBlocks[CtrEngine::BATCH_BLOCKS * CtrEngine::BLOCK] = {0};
+
+    static inline void counterAdd(uint8_t counter[16], uint64_t v)
+    {
+        // 128-bit big-endian add (mbedtls_aes_crypt_ctr increments from byte 15 upwards)
+        for (int i = 15; i >= 0 && v; --i)
+        {
+            v += counter[i];
+            counter[i] = (uint8_t)(v & 0xFF);
+            v >>= 8;
+        }
+    }
+
+    static inline void xorBytes(const uint8_t *in, const uint8_t *ks, uint8_t *out, size_t n)
+    {
+        if ((((uintptr_t)in | (uintptr_t)ks | (uintptr_t)out) & 3) == 0)
+        {
+            const uint32_t *in32 = (const uint32_t *)in;
+            const uint32_t *ks32 = (const uint32_t *)ks;
+            uint32_t *out32 = (uint32_t *)out;
+            size_t words = n >> 2;
+            for (size_t i = 0; i < words; ++i)
+                out32[i] = in32[i] ^ ks32[i];
+            size_t done = words << 2;
+            in += done;
+            ks += done;
+            out += done;
+            n -= done;
+        }
+        for (size_t i = 0; i < n; ++i)
+            out[i] = in[i] ^ ks[i];
+    }
+
+    CtrEngine::CtrEngine()
+    {
+#if defined(ESP_PLATFORM)
+        esp_aes_init(&ctx);
+#else
+        mbedtls_aes_init(&ctx);
+#endif
+    }
+
+    CtrEngine::~CtrEngine()
+    {
+#if defined(ESP_PLATFORM)
+        esp_aes_free(&ctx);
+#else
+        mbedtls_aes_free(&ctx);
+#endif
+    }
+
+    bool CtrEngine::setKey(const uint8_t *key, unsigned keyBits)
+    {
+#if defined(ESP_PLATFORM)
+        keyed = esp_aes_setkey(&ctx, key, keyBits) == 0;
+#else
+        keyed = mbedtls_aes_setkey_enc(&ctx, key, keyBits) == 0;
+#endif
+        return keyed;
+    }
+
+    void CtrEngine::encryptBlocks(const uint8_t *counter, uint8_t *keystream, size_t blocks)
+    {
+        uint8_t nonceCounter[16];
+        uint8_t streamBlock[16];
+        size_t ncOff = 0;
+        memcpy(nonceCounter, counter, 16);
+#if defined(ESP_PLATFORM)
+        esp_aes_crypt_ctr(&ctx, blocks * BLOCK, &ncOff, nonceCounter, streamBlock, kZeroBlocks, keystream);
+#else
+        mbedtls_aes_crypt_ctr(&ctx, blocks * BLOCK, &ncOff, nonceCounter, streamBlock, kZeroBlocks, keystream);
+#endif
+    }
+
+    void CtrEngine::crypt(const uint8_t *in, uint8_t *out, size_t len, size_t offset, const uint8_t nonce[16])
+    {
+        if (!len)
+            return;
+
+        alignas(4) uint8_t keystream[BATCH_BLOCKS * BLOCK];
+        uint8_t counter[16];
+        memcpy(counter, nonce, 16);
+        counterAdd(counter, (uint64_t)(offset / BLOCK));
+
+        size_t skip = offset % BLOCK;
+        while (len)
+        {
+            size_t blocks = (skip + len + BLOCK - 1) / BLOCK;
+            if (blocks > BATCH_BLOCKS)
+                blocks = BATCH_BLOCKS;
+
+            encryptBlocks(counter, keystream, blocks);
+            counterAdd(counter, blocks);
+
+            size_t take = blocks * BLOCK - skip;
+            if (take > len)
+                take = len;
+            xorBytes(in, keystream + skip, out, take);
+
+            in += take;
+            out += take;
+            len -= take;
+            skip = 0;
+        }
+    }
+
+    static uint32_t benchNowMicros()
+    {
+#if defined(ESP_PLATFORM)
+        return (uint32_t)esp_timer_get_time();
+#else
+        using namespace std::chrono;
+        return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    CtrBenchResult benchmarkCtr(size_t bytes, size_t chunk)
+    {
+        static const uint8_t testKey[32] = {
+            0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+            0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4};
+        uint8_t nonce[16];
+        for (int i = 0; i < 16; ++i)
+            nonce[i] = (uint8_t)(0xF0 + i);
+
+        if (chunk == 0)
+            chunk = bytes;
+
+        CtrEngine engine;
+        engine.setKey(testKey, 256);
+
+        std::vector<uint8_t> buf(chunk, 0xA5);
+
+        uint32_t start = benchNowMicros();
+        size_t done = 0;
+        while (done < bytes)
+        {
+            size_t n = (bytes - done < chunk) ? (bytes - done) : chunk;
+            engine.crypt(buf.data(), buf.data(), n, done, nonce);
+            done += n;
+        }
+        uint32_t elapsed = benchNowMicros() - start;
+
+        CtrBenchResult r;
+        r.bytes = done;
+        r.micros = elapsed ? elapsed : 1;
+        r.mbPerSec = (float)done / (float)r.micros; // bytes/us == MB/s
+        return r;
+    }
+} // namespace ENC_FS
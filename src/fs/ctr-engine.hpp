@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(ESP_PLATFORM)
+#include "aes/esp_aes.h"
+#else
+#include <mbedtls/aes.h>
+#endif
+
+namespace ENC_FS
+{
+    // AES-256-CTR engine with a cached expanded key.
+    // On the ESP32 the block cipher runs on the hardware AES unit (esp_aes),
+    // on other targets (host builds) it falls back to software mbedtls.
+    // Keystream is produced for BATCH_BLOCKS counter blocks at a time and XORed in 32-bit words.
+    class CtrEngine
+    {
+    public:
+        static constexpr size_t BLOCK = 16;
+        static constexpr size_t BATCH_BLOCKS = 32; // 512 bytes keystream per batch
+
+        CtrEngine();
+        ~CtrEngine();
+
+        CtrEngine(const CtrEngine &) = delete;
+        CtrEngine &operator=(const CtrEngine &) = delete;
+
+        bool setKey(const uint8_t *key, unsigned keyBits = 256);
+        bool hasKey() const { return keyed; }
+
+        // out = in ^ keystream, where the keystream starts at byte `offset` of the
+        // stream defined by the initial 16-byte counter `nonce` (big-endian 128-bit counter,
+        // same layout as mbedtls_aes_crypt_ctr). in and out may alias.
+        void crypt(const uint8_t *in, uint8_t *out, size_t len, size_t offset, const uint8_t nonce[16]);
+
+    private:
+        void encryptBlocks(const uint8_t *counters, uint8_t *keystream, size_t blocks);
+
+#if defined(ESP_PLATFORM)
+        esp_aes_context ctx;
+#else
+        mbedtls_aes_context ctx;
+#endif
+        bool keyed = false;
+    };
+
+    // Process-wide engine keyed with deriveKey() on first use.
+    CtrEngine &ctrEngine();
+
+    struct CtrBenchResult
+    {
+        size_t bytes;
+        uint32_t micros;
+        float mbPerSec;
+    };
+
+    // Encrypt `bytes` of scratch data in chunks of `chunk` bytes (offset variant, like readFilePart)
+    // and report throughput. Uses a fixed test key so it does not depend on a logged-in user.
+    CtrBenchResult benchmarkCtr(size_t bytes = 256 * 1024, size_t chunk = 4096);
+} // namespace ENC_FS
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../ctr-engine.hpp"
+
+// Prints AES-CTR throughput of the ENC_FS crypto engine for a few chunk sizes.
+void cryptoBench(size_t bytes = 256 * 1024)
+{
+    Serial.println("---- ENC_FS AES-CTR bench ----");
+    const size_t chunks[] = {64, 512, 4096, 32768};
+    for (size_t chunk : chunks)
+    {
+        ENC_FS::CtrBenchResult r = ENC_FS::benchmarkCtr(bytes, chunk);
+        Serial.printf("chunk %6u: %u bytes in %u us -> %.2f MB/s\n",
+                      (unsigned)chunk, (unsigned)r.bytes, (unsigned)r.micros, r.mbPerSec);
+    }
+    Serial.println("---- ENC_FS AES-CTR bench end ----");
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../bench.hpp"
+#include "../enc-fs.hpp"
+
+// Prints backend ops/sec (read/write/append, readDir fan-out, exists depth) and, optionally,
+// the same for ENC_FS on top of it. failOneIn > 0 runs against Faulty to check error paths.
+void fsBench(uint32_t iterations = 16, bool withEncFs = true, uint32_t failOneIn = 0)
+{
+    Serial.println("---- FS backend bench ----");
+
+    FsBackend::Backend &base = FsBackend::active();
+    FsBackend::FaultConfig cfg;
+    cfg.failOneIn = failOneIn;
+    FsBackend::Faulty faulty(base, cfg);
+    FsBackend::Backend &b = failOneIn ? (FsBackend::Backend &)faulty : base;
+
+    for (const FsBench::Result &r : FsBench::run(b, "/.fsbench", iterations))
+        Serial.printf("%-8s %7u: %5u ops in %8u us -> %9.1f ops/s\n",
+                      FsBench::opName(r.op), (unsigned)r.param, (unsigned)r.ops, (unsigned)r.micros, r.opsPerSec);
+    if (failOneIn)
+        Serial.printf("injected failures: %u\n", (unsigned)faulty.injectedFailures);
+
+    if (withEncFs)
+    {
+        if (failOneIn)
+            FsBackend::setActive(&faulty);
+
+        const size_t sizes[] = {64, 1024, 16 * 1024};
+        for (size_t size : sizes)
+        {
+            ENC_FS::Path p = {"fsbench", "depth1", "depth2", "f" + String((unsigned)size)};
+            ENC_FS::Buffer data(size, 0x5A);
+
+            uint32_t start = micros();
+            for (uint32_t i = 0; i < iterations; ++i)
+                ENC_FS::joinEncPath(p);
+            uint32_t tJoin = micros() - start;
+
+            start = micros();
+            for (uint32_t i = 0; i < iterations; ++i)
+                ENC_FS::writeFile(p, 0, 0, data);
+            ENC_FS::sync();
+            uint32_t tWrite = micros() - start;
+
+            start = micros();
+            for (uint32_t i = 0; i < iterations; ++i)
+                ENC_FS::readFileFull(p);
+            uint32_t tRead = micros() - start;
+
+            Serial.printf("ENC_FS %6u B: joinEncPath %u us, write %u us, read %u us (x%u)\n",
+                          (unsigned)size, (unsigned)tJoin, (unsigned)tWrite, (unsigned)tRead, (unsigned)iterations);
+        }
+        ENC_FS::rmDir({"fsbench"});
+
+        FsBackend::setActive(nullptr);
+    }
+
+    Serial.println("---- FS backend bench end ----");
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../import.hpp"
+
+// Imports srcDir into a scratch ENC_FS directory and prints the pipeline throughput.
+void importBench(const String &srcDir = "/public")
+{
+    Serial.println("---- ENC_FS import bench ----");
+    ENC_FS::Import::BenchResult r = ENC_FS::Import::benchmark(srcDir);
+    Serial.printf("%u files, %llu bytes in %u ms -> %.3f MB/s\n",
+                  (unsigned)r.files, (unsigned long long)r.bytes, (unsigned)r.millis, r.mbPerSec);
+    Serial.println("---- ENC_FS import bench end ----");
+}
@@ -1,18 +1,30 @@
 #include "enc-fs.hpp"
+#include "ctr-engine.hpp"
+#include "write-cache.hpp"
+#include "kv-store.hpp"
+#include "import.hpp"
+#include "blob-store.hpp"
+#include "backend.hpp"
 
 #include <mbedtls/sha256.h>
-#include <mbedtls/aes.h>
 #include <mbedtls/md.h>
 #include <esp_system.h>
 #include "../auth/auth.hpp"
 #include <cstring>
 #include <cctype>
 #include <algorithm>
+#include <mutex>
 
 #define DERIVE_ITERATIONS 1
 
 namespace ENC_FS
 {
+    // all file I/O goes through the storage backend (SD card on the device)
+    static inline FsBackend::Backend &disk()
+    {
+        return FsBackend::active();
+    }
+
     // ---------- Helpers ----------
 
     Buffer sha256(const String &s)
@@ -106,16 +118,14 @@ namespace ENC_FS
 
     Buffer deriveKey()
     {
+        // import workers, the write-back flush task and the UI may ask for the key at the same time
         static Buffer key(32);
-        static bool created = false;
-        if (created)
-            return key;
-
-        String in = Crypto::HASH::sha256StringMul(Auth::username + String(":") + Auth::password, DERIVE_ITERATIONS);
-        Buffer h = sha256(in); // 32 bytes
-        memcpy(key.data(), h.data(), 32);
-
-        created = true;
+        static std::once_flag created;
+        std::call_once(created, []
+                       {
+            String in = Crypto::HASH::sha256StringMul(Auth::username + String(":") + Auth::password, DERIVE_ITERATIONS);
+            Buffer h = sha256(in); // 32 bytes
+            memcpy(key.data(), h.data(), 32); });
         return key;
     }
 
@@ -211,14 +221,14 @@ namespace ENC_FS
         Buffer cipher = aes_ctr_crypt_full_with_nonce(ptxt, nonce);
 
         // write raw ciphertext to SD and persist version metadata
-        if (SD.exists(metaFull.c_str()))
-            SD.remove(metaFull.c_str());
-        File f = SD.open(metaFull.c_str(), "w+");
+        if (disk().exists(metaFull.c_str()))
+            disk().remove(metaFull.c_str());
+        FsBackend::Handle f = disk().open(metaFull.c_str(), FsBackend::OpenMode::Write);
         if (!f)
             return false;
         if (!cipher.empty())
-            f.write(cipher.data(), cipher.size());
-        f.close();
+            f->write(cipher.data(), cipher.size());
+        f->close();
 
         // persist the version file for this meta
         writeVersionForFullPath(metaFull, version);
@@ -229,19 +239,19 @@ namespace ENC_FS
     static bool readNameMetaRaw(const String &parentEncPath, const String &encName, String &outName)
     {
         String metaFull = parentEncPath + String("/") + encName + String(".namemeta");
-        File f = SD.open(metaFull.c_str(), FILE_READ);
+        FsBackend::Handle f = disk().open(metaFull.c_str(), FsBackend::OpenMode::Read);
         if (!f)
             return false;
-        long fsize = f.size();
+        long fsize = f->size();
         if (fsize <= 0)
         {
-            f.close();
+            f->close();
             return false;
         }
         Buffer cbuf;
         cbuf.resize(fsize);
-        int got = f.read(cbuf.data(), fsize);
-        f.close();
+        int got = f->read(cbuf.data(), fsize);
+        f->close();
         if (got <= 0)
             return false;
         cbuf.resize(got);
@@ -280,7 +290,7 @@ namespace ENC_FS
 
         // ensure metadata exists (if absent, create it)
         String metaFull = parentEnc + String("/") + token + String(".namemeta");
-        if (!SD.exists(metaFull.c_str()))
+        if (!disk().exists(metaFull.c_str()))
         {
             // attempt to write metadata; ignore failure (best-effort)
             writeNameMetaRaw(parentEnc, token, seg);
@@ -335,12 +345,12 @@ namespace ENC_FS
     static uint64_t readVersionForFullPath(const String &full)
     {
         String metaPath = full + ivMetaSuffix;
-        File f = SD.open(metaPath.c_str(), FILE_READ);
+        FsBackend::Handle f = disk().open(metaPath.c_str(), FsBackend::OpenMode::Read);
         if (!f)
             return 0; // 0 indicates missing -> treat as version 0 (will be incremented to 1 on write)
         uint8_t buf[8];
-        int got = f.read(buf, 8);
-        f.close();
+        int got = f->read(buf, 8);
+        f->close();
         if (got != 8)
             return 0;
         uint64_t v = 0;
@@ -353,9 +363,9 @@ namespace ENC_FS
     {
         String metaPath = full + ivMetaSuffix;
         // overwrite or create
-        if (SD.exists(metaPath.c_str()))
-            SD.remove(metaPath.c_str());
-        File f = SD.open(metaPath.c_str(), "w+");
+        if (disk().exists(metaPath.c_str()))
+            disk().remove(metaPath.c_str());
+        FsBackend::Handle f = disk().open(metaPath.c_str(), FsBackend::OpenMode::Write);
         if (!f)
             return false;
         uint8_t buf[8];
@@ -364,8 +374,8 @@ namespace ENC_FS
             buf[i] = (uint8_t)(v & 0xFF);
             v >>= 8;
         }
-        size_t wrote = f.write(buf, 8);
-        f.close();
+        size_t wrote = f->write(buf, 8);
+        f->close();
         return wrote == 8;
     }
 
@@ -380,93 +390,29 @@ namespace ENC_FS
 
     // ---------- AES-CTR for file contents (updated to use per-file deterministic nonces) ----------
 
-    Buffer aes_ctr_crypt_full_with_nonce(const Buffer &in, const uint8_t nonce[16])
+    CtrEngine &ctrEngine()
     {
-        Buffer key = deriveKey();
-        Buffer out;
-        out.resize(in.size());
-
-        mbedtls_aes_context aes;
-        mbedtls_aes_init(&aes);
-        mbedtls_aes_setkey_enc(&aes, key.data(), 256);
-
-        size_t nc_off = 0;
-        uint8_t nonce_counter[16];
-        memcpy(nonce_counter, nonce, 16);
-        uint8_t stream_block[16];
-        memset(stream_block, 0, sizeof(stream_block));
+        static CtrEngine engine;
+        static std::once_flag keyed;
+        std::call_once(keyed, []
+                       {
+            Buffer key = deriveKey();
+            engine.setKey(key.data(), 256); });
+        return engine;
+    }
 
-        mbedtls_aes_crypt_ctr(&aes, in.size(), &nc_off, nonce_counter, stream_block, in.data(), out.data());
-        mbedtls_aes_free(&aes);
-        return out;
+    Buffer aes_ctr_crypt_full_with_nonce(const Buffer &in, const uint8_t nonce[16])
+    {
+        return aes_ctr_crypt_offset_with_nonce(in, 0, nonce);
     }
 
     Buffer aes_ctr_crypt_offset_with_nonce(const Buffer &in, size_t offset, const uint8_t nonce[16])
     {
-        Buffer key = deriveKey();
+        // CTR counter is the 16-byte nonce treated as a big-endian 128-bit integer, advanced by
+        // offset / 16 blocks. The engine keeps the expanded key and produces keystream in batches.
         Buffer out;
         out.resize(in.size());
-        mbedtls_aes_context aes;
-        mbedtls_aes_init(&aes);
-        mbedtls_aes_setkey_enc(&aes, key.data(), 256);
-
-        // CTR counter is nonce || counter. We emulate mbedtls_crypt_ctr behavior by constructing
-        // a counter block where the last 8 bytes are the block counter. We'll copy nonce into
-        // the first 16 bytes (treating it as the initial counter) and then increment the 128-bit
-        // counter as blocks advance. For compatibility with deriveNonceForFullPathVersion
-        // we treat the provided nonce as the initial 16-byte counter value.
-        size_t block_pos = offset / 16;
-        size_t block_off = offset % 16;
-        size_t remaining = in.size();
-        size_t written = 0;
-
-        // working counter (16 bytes)
-        uint8_t counter[16];
-        uint8_t keystream[16];
-
-        while (remaining)
-        {
-            // set counter = nonce + block_pos (add as little-endian to the last 8 bytes)
-            memcpy(counter, nonce, 16);
-            uint64_t bp = (uint64_t)block_pos;
-            // add bp into last 8 bytes little-endian style as CTR often uses LSB side
-            // We'll XOR/ADD in little-endian manner into last 8 bytes.
-            for (int i = 0; i < 8; ++i)
-            {
-                uint16_t sum = (uint16_t)counter[15 - i] + (uint16_t)(bp & 0xFF);
-                counter[15 - i] = (uint8_t)(sum & 0xFF);
-                bp >>= 8;
-                if (sum >> 8)
-                {
-                    // carry propagation
-                    uint64_t carry_pos = 1;
-                    while (carry_pos < 16)
-                    {
-                        int idx = 15 - i - carry_pos;
-                        if (idx < 0)
-                            break;
-                        uint16_t s2 = (uint16_t)counter[idx] + 1;
-                        counter[idx] = (uint8_t)(s2 & 0xFF);
-                        if ((s2 >> 8) == 0)
-                            break;
-                        ++carry_pos;
-                    }
-                }
-            }
-
-            mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, counter, keystream);
-
-            for (size_t i = block_off; i < 16 && remaining; ++i)
-            {
-                out[written] = in[written] ^ keystream[i];
-                ++written;
-                --remaining;
-            }
-            block_off = 0;
-            ++block_pos;
-        }
-
-        mbedtls_aes_free(&aes);
+        ctrEngine().crypt(in.data(), out.data(), in.size(), offset, nonce);
         return out;
     }
 
@@ -474,8 +420,13 @@ namespace ENC_FS
 
     bool exists(const Path &p)
     {
+        if (WriteCache::contains(p))
+            return true;
         String full = joinEncPath(p);
-        return SD.exists(full.c_str());
+        if (disk().exists(full.c_str()))
+            return true;
+        Path blob;
+        return BlobStore::resolve(p, blob);
     }
 
     bool mkDir(const Path &p)
@@ -487,8 +438,8 @@ namespace ENC_FS
             String seg = p[i];
             String enc = encryptSegment(seg, accumPlain, accumEnc);
             accumEnc += String("/") + enc;
-            if (!SD.exists(accumEnc.c_str()))
-                SD.mkdir(accumEnc.c_str());
+            if (!disk().exists(accumEnc.c_str()))
+                disk().mkdir(accumEnc.c_str());
 
             // update plain accum
             if (accumPlain.length() == 0)
@@ -501,93 +452,85 @@ namespace ENC_FS
 
     bool rmDir(const Path &p)
     {
+        // uninstalling an app: its files live in the blob store, not below p
+        std::vector<String> blobs = BlobStore::hashesBelow(p);
+        WriteCache::discardPrefix(p);
+        BlobStore::invalidate(p);
         String full = joinEncPath(p);
         // Serial.printf("[rmDir] Called for path: %s\n", full.c_str());
 
-        if (!SD.exists(full.c_str()))
+        if (!disk().exists(full.c_str()))
         {
             // Serial.printf("[rmDir] Path does not exist: %s\n", full.c_str());
+            BlobStore::release(blobs); // an app whose manifest never left the write cache
             return false;
         }
 
-        File f = SD.open(full.c_str());
-        if (!f)
-        {
-            // Serial.printf("[rmDir] Failed to open, attempting remove(): %s\n", full.c_str());
-            bool res = SD.remove(full.c_str());
-            // Serial.printf("[rmDir] Remove result: %d\n", res);
-            return res;
-        }
-
-        if (!f.isDirectory())
+        if (!disk().isDirectory(full.c_str()))
         {
             // Serial.printf("[rmDir] Not a directory, removing file: %s\n", full.c_str());
-            f.close();
             // remove associated iv meta as well
             String metaPath = String(full) + ivMetaSuffix;
-            if (SD.exists(metaPath.c_str()))
-                SD.remove(metaPath.c_str());
+            if (disk().exists(metaPath.c_str()))
+                disk().remove(metaPath.c_str());
             // remove namemeta sibling
             String nameMeta = String(full) + String(".namemeta");
-            if (SD.exists(nameMeta.c_str()))
-                SD.remove(nameMeta.c_str());
-            bool res = SD.remove(full.c_str());
+            if (disk().exists(nameMeta.c_str()))
+                disk().remove(nameMeta.c_str());
+            bool res = disk().remove(full.c_str());
             // Serial.printf("[rmDir] File remove result: %d\n", res);
             return res;
         }
 
-        // Serial.printf("[rmDir] Directory found, cleaning contents...\n");
-        File entry = f.openNextFile();
-        while (entry)
-        {
-            String en = String(entry.name());
-            // Serial.printf("[rmDir] Found entry: %s\n", en.c_str());
-
-            if (entry.isDirectory())
-            {
-                // Serial.printf("[rmDir] Entry is directory, recursing via SD_FS::deleteDir()\n");
-                bool res = SD_FS::deleteDir(en);
-                // Serial.printf("[rmDir] SD_FS::deleteDir('%s') => %d\n", en.c_str(), res);
-            }
-            else
-            {
-                // remove associated iv meta if present
-                String metaPath = en + ivMetaSuffix;
-                if (SD.exists(metaPath.c_str()))
-                    SD.remove(metaPath.c_str());
-                // remove namemeta
-                String nameMeta = en + String(".namemeta");
-                if (SD.exists(nameMeta.c_str()))
-                    SD.remove(nameMeta.c_str());
-                bool res = SD.remove(en.c_str());
-                // Serial.printf("[rmDir] Removed file %s => %d\n", en.c_str(), res);
-            }
-
-            entry.close();
-            entry = f.openNextFile();
-        }
-
-        f.close();
-        // Serial.printf("[rmDir] Directory empty, attempting to remove folder itself: %s\n", full.c_str());
-
+        // Serial.printf("[rmDir] Directory found, removing recursively: %s\n", full.c_str());
+        // SD_FS::deleteDir removes every entry including .ivmeta/.namemeta siblings
         bool res = SD_FS::deleteDir(full);
         // Serial.printf("[rmDir] Final SD_FS::deleteDir('%s') => %d\n", full.c_str(), res);
+        if (res)
+            BlobStore::release(blobs);
 
         return res;
     }
 
+    static Buffer sliceCached(const Buffer &data, long start, long end)
+    {
+        long fsize = (long)data.size();
+        if (start == end && end <= 0)
+        {
+            start = 0;
+            end = fsize;
+        }
+        if (end <= 0 || end > fsize)
+            end = fsize;
+        if (start < 0)
+            start = 0;
+        if (start > end)
+            start = end;
+        return Buffer(data.begin() + start, data.begin() + end);
+    }
+
     Buffer readFilePart(const Path &p, long start, long end)
     {
         Buffer empty;
+        Buffer cached;
+        if (WriteCache::get(p, cached))
+            return sliceCached(cached, start, end);
+
         String full = joinEncPath(p);
-        File f = SD.open(full.c_str(), FILE_READ);
+        FsBackend::Handle f = disk().open(full.c_str(), FsBackend::OpenMode::Read);
         if (!f)
+        {
+            // installed app files are stored once in the blob store
+            Path blob;
+            if (BlobStore::resolve(p, blob))
+                return readFilePart(blob, start, end);
             return empty;
-        long fsize = f.size();
+        }
+        long fsize = f->size();
         if (start == end && end <= 0)
         {
             start = 0;
-            end = f.size();
+            end = f->size();
         }
         if (end <= 0 || end > fsize)
             end = fsize;
@@ -598,9 +541,9 @@ namespace ENC_FS
         long len = end - start;
         Buffer cbuf;
         cbuf.resize(len);
-        f.seek(start);
-        int got = f.read(cbuf.data(), len);
-        f.close();
+        f->seek(start);
+        int got = f->read(cbuf.data(), len);
+        f->close();
         if (got <= 0)
             return Buffer();
         cbuf.resize(got);
@@ -638,21 +581,96 @@ namespace ENC_FS
         return String((const char *)b.data(), b.size());
     }
 
-    bool writeFile(const Path &p, long start, long end, const Buffer &data)
+    bool FileWriter::open(const Path &p)
     {
-        String full = joinEncPath(p);
+        WriteCache::discard(p);
+        return openVersion(p);
+    }
+
+    bool FileWriter::openVersion(const Path &p)
+    {
+        close();
+        path = p;
+        offset = 0;
+        failed = false;
+        full = joinEncPath(p);
 
         String accumPlain = String("");
         String accumEnc = String("/") + Auth::username;
         for (size_t i = 0; i + 1 < p.size(); ++i)
         {
-            accumPlain = (accumPlain.length() == 0) ? String("/") + p[i] : accumPlain + String("/") + p[i];
+            // tokens are keyed by the parent's plain path, as in joinEncPath()
             String enc = encryptSegment(p[i], accumPlain, accumEnc);
+            accumPlain = (accumPlain.length() == 0) ? String("/") + p[i] : accumPlain + String("/") + p[i];
             accumEnc += String("/") + enc;
-            if (!SD.exists(accumEnc.c_str()))
-                SD.mkdir(accumEnc.c_str());
+            if (!disk().exists(accumEnc.c_str()))
+                disk().mkdir(accumEnc.c_str());
         }
 
+        // increment version for this file to avoid keystream reuse
+        uint64_t curVersion = readVersionForFullPath(full);
+        uint64_t newVersion = (curVersion == 0) ? 1 : (curVersion + 1);
+        // derive nonce from newVersion (deterministic)
+        deriveNonceForFullPathVersion(full, newVersion, nonce);
+
+        if (disk().exists(full.c_str()))
+            disk().remove(full.c_str());
+        file = disk().open(full.c_str(), FsBackend::OpenMode::Write);
+        if (!file)
+            return false;
+
+        // persist new version up front so a partially written file still decrypts
+        writeVersionForFullPath(full, newVersion);
+        return true;
+    }
+
+    bool FileWriter::write(const uint8_t *data, size_t len)
+    {
+        if (!file || failed)
+            return false;
+        if (len == 0)
+            return true;
+
+        scratch.resize(len);
+        ctrEngine().crypt(data, scratch.data(), len, offset, nonce);
+        size_t wrote = file->write(scratch.data(), len);
+        offset += wrote;
+        if (wrote != len)
+            failed = true;
+        return !failed;
+    }
+
+    bool FileWriter::close()
+    {
+        if (!file)
+            return false;
+        file->close();
+        file.reset();
+
+        // ensure name meta exists for the file (create sibling .namemeta if missing)
+        int lastSlash = full.lastIndexOf('/');
+        String parentEnc = (lastSlash >= 0) ? full.substring(0, lastSlash) : String("");
+        String encName = (lastSlash >= 0) ? full.substring(lastSlash + 1) : full;
+        String metaFull = parentEnc + String("/") + encName + String(".namemeta");
+        if (!disk().exists(metaFull.c_str()) && !path.empty())
+            writeNameMetaRaw(parentEnc, encName, path.back());
+
+        Buffer().swap(scratch);
+        return !failed;
+    }
+
+    bool writeFileThrough(const Path &p, const Buffer &plaintext)
+    {
+        // called by the write-back flush, which holds the cache's flush lock
+        FileWriter w;
+        if (!w.openVersion(p))
+            return false;
+        bool ok = w.write(plaintext.data(), plaintext.size());
+        return w.close() && ok;
+    }
+
+    bool writeFile(const Path &p, long start, long end, const Buffer &data)
+    {
         Buffer plaintext;
         if (start == 0 && end == 0)
         {
@@ -674,60 +692,48 @@ namespace ENC_FS
                 plaintext[start + i] = data[i];
         }
 
-        // increment version for this file to avoid keystream reuse
-        uint64_t curVersion = readVersionForFullPath(full);
-        uint64_t newVersion = (curVersion == 0) ? 1 : (curVersion + 1);
-        // derive nonce from newVersion (deterministic)
-        uint8_t nonce[16];
-        deriveNonceForFullPathVersion(full, newVersion, nonce);
-
-        Buffer cipher = aes_ctr_crypt_full_with_nonce(plaintext, nonce);
+        // hand the merged content to the write-back cache; large files are written through
+        if (WriteCache::put(p, plaintext))
+            return true;
+        // an older cached version must neither be read back nor flushed over the new file
+        WriteCache::discard(p);
+        return writeFileThrough(p, plaintext);
+    }
 
-        if (SD.exists(full.c_str()))
-            SD.remove(full.c_str());
-        File fw = SD.open(full.c_str(), "w+");
-        if (!fw)
-            return false;
-        if (!cipher.empty())
-            fw.write(cipher.data(), cipher.size());
-        fw.close();
+    bool appendFile(const Path &p, const Buffer &data)
+    {
+        long pos = getFileSize(p);
+        if (pos < 0)
+            pos = 0;
+        return writeFile(p, pos, pos + (long)data.size(), data);
+    }
 
-        // persist new version
-        writeVersionForFullPath(full, newVersion);
+    bool appendInPlace(const Path &p, const Buffer &data)
+    {
+        WriteCache::flush(p);
+        String full = joinEncPath(p);
+        if (!disk().exists(full.c_str()))
+            return writeFileThrough(p, data);
 
-        // ensure name meta exists for the file (create sibling .namemeta if missing)
-        // determine parentEnc path
-        int lastSlash = full.lastIndexOf('/');
-        String parentEnc = (lastSlash >= 0) ? full.substring(0, lastSlash) : String("");
-        String encName = (lastSlash >= 0) ? full.substring(lastSlash + 1) : full;
-        // try to write name meta if missing
-        String metaFull = parentEnc + String("/") + encName + String(".namemeta");
-        if (!SD.exists(metaFull.c_str()))
+        // bytes past the current end have never been encrypted under this version,
+        // so extending the CTR stream does not reuse keystream
+        uint64_t version = readVersionForFullPath(full);
+        if (version == 0)
         {
-            // derive plain parent path from p (reconstruct)
-            String parentPlain = String("");
-            for (size_t i = 0; i + 1 < p.size(); ++i)
-            {
-                if (parentPlain.length() == 0)
-                    parentPlain = String("/") + p[i];
-                else
-                    parentPlain += String("/") + p[i];
-            }
-            writeNameMetaRaw(parentEnc, encName, p.back());
+            version = 1;
+            writeVersionForFullPath(full, version);
         }
+        uint8_t nonce[16];
+        deriveNonceForFullPathVersion(full, version, nonce);
 
-        return true;
-    }
-
-    bool appendFile(const Path &p, const Buffer &data)
-    {
-        String full = joinEncPath(p);
-        File f = SD.open(full.c_str(), FILE_WRITE);
+        FsBackend::Handle f = disk().open(full.c_str(), FsBackend::OpenMode::Append);
         if (!f)
             return false;
-        long pos = f.size();
-        f.close();
-        return writeFile(p, pos, pos + (long)data.size(), data);
+        size_t pos = f->size();
+        Buffer cipher = aes_ctr_crypt_offset_with_nonce(data, pos, nonce);
+        size_t wrote = cipher.empty() ? 0 : f->write(cipher.data(), cipher.size());
+        f->close();
+        return wrote == cipher.size();
     }
 
     bool writeFileString(const Path &p, const String &s)
@@ -741,37 +747,42 @@ namespace ENC_FS
 
     bool deleteFile(const Path &p)
     {
+        bool dropped = WriteCache::discard(p);
         String full = joinEncPath(p);
-        if (!SD.exists(full.c_str()))
-            return false;
+        if (!disk().exists(full.c_str()))
+            return BlobStore::forget(p) || dropped;
         // remove associated iv meta too
         String metaPath = full + ivMetaSuffix;
-        if (SD.exists(metaPath.c_str()))
-            SD.remove(metaPath.c_str());
+        if (disk().exists(metaPath.c_str()))
+            disk().remove(metaPath.c_str());
         // remove name meta sibling
         String nameMeta = full + String(".namemeta");
-        if (SD.exists(nameMeta.c_str()))
-            SD.remove(nameMeta.c_str());
-        return SD.remove(full.c_str());
+        if (disk().exists(nameMeta.c_str()))
+            disk().remove(nameMeta.c_str());
+        return disk().remove(full.c_str());
     }
 
     long getFileSize(const Path &p)
     {
+        long cached = WriteCache::size(p);
+        if (cached >= 0)
+            return cached;
         String full = joinEncPath(p);
-        File f = SD.open(full.c_str(), FILE_READ);
-        if (!f)
-            return -1;
-        long s = f.size();
-        f.close();
-        return s;
+        long size = disk().fileSize(full.c_str());
+        if (size < 0)
+        {
+            Path blob;
+            BlobStore::resolve(p, blob, &size);
+        }
+        return size;
     }
 
     Metadata getMetadata(const Path &p)
     {
         Metadata m;
+        WriteCache::flush(p);
         String full = joinEncPath(p);
-        File f = SD.open(full.c_str());
-        if (!f)
+        if (!disk().exists(full.c_str()))
         {
             m.size = -1;
             m.encryptedName = "";
@@ -779,9 +790,9 @@ namespace ENC_FS
             m.isDirectory = false;
             return m;
         }
-        m.size = f.size();
-        m.encryptedName = String(f.name());
-        m.isDirectory = f.isDirectory();
+        m.isDirectory = disk().isDirectory(full.c_str());
+        m.size = m.isDirectory ? 0 : disk().fileSize(full.c_str());
+        m.encryptedName = full;
         int lastSlash = m.encryptedName.lastIndexOf('/');
         String last = (lastSlash >= 0) ? m.encryptedName.substring(lastSlash + 1) : m.encryptedName;
 
@@ -792,7 +803,6 @@ namespace ENC_FS
             m.decryptedName = dec;
         else
             m.decryptedName = String("<enc>");
-        f.close();
 
         return m;
     }
@@ -800,23 +810,15 @@ namespace ENC_FS
     std::vector<String> readDir(const Path &plainDir)
     {
         std::vector<String> out;
+        WriteCache::flushPrefix(plainDir);
         String encPath = joinEncPath(plainDir);
-        File dir = SD.open(encPath.c_str());
-        if (!dir || !dir.isDirectory())
-            return out;
-        File e = dir.openNextFile();
-        while (e)
-        {
-            String en = String(e.name());
-            int lastSlash = en.lastIndexOf('/');
-            String nameOnly = (lastSlash >= 0) ? en.substring(lastSlash + 1) : en;
-            String dec;
-            if (decryptSegment(nameOnly, encPath, dec))
-                out.push_back(dec);
-            e.close();
-            e = dir.openNextFile();
-        }
-        dir.close();
+        disk().list(encPath.c_str(), [&](const FsBackend::DirEntry &e)
+                    {
+                        String dec;
+                        if (decryptSegment(String(e.name), encPath, dec))
+                            out.push_back(dec);
+                    });
+        BlobStore::listNames(plainDir, out);
         return out;
     }
 
@@ -827,6 +829,16 @@ namespace ENC_FS
             Serial.println(s);
     }
 
+    bool sync()
+    {
+        return WriteCache::flushAll();
+    }
+
+    bool fsync(const Path &p)
+    {
+        return WriteCache::flush(p);
+    }
+
     Path storagePath(const String &appId, const String &key)
     {
         Path p;
@@ -839,22 +851,33 @@ namespace ENC_FS
 
     namespace Storage
     {
+        // backed by the per-app log-structured store (kv-store.cpp); storagePath() remains
+        // the location of the legacy per-key files that KvStore migrates on first use
         Buffer get(const String &appId, const String &key, long start, long end)
         {
-            Path p = storagePath(appId, key);
-            return ENC_FS::readFile(p, (start < 0 ? 0 : start), end);
+            Buffer out;
+            KvStore::get(appId, key, out, start, end);
+            return out;
         }
 
         bool del(const String &appId, const String &key)
         {
-            Path p = storagePath(appId, key);
-            return ENC_FS::deleteFile(p);
+            return KvStore::del(appId, key);
         }
 
         bool set(const String &appId, const String &key, const Buffer &data)
         {
-            Path p = storagePath(appId, key);
-            return ENC_FS::writeFile(p, 0, 0, data);
+            return KvStore::set(appId, key, data);
+        }
+
+        bool setMany(const String &appId, const std::vector<std::pair<String, Buffer>> &items)
+        {
+            return KvStore::setMany(appId, items);
+        }
+
+        std::vector<Buffer> getMany(const String &appId, const std::vector<String> &keys, std::vector<bool> *found)
+        {
+            return KvStore::getMany(appId, keys, found);
         }
     }
 
@@ -879,9 +902,26 @@ namespace ENC_FS
         {
             makeSureBrowserStorageExist();
             // Deletes the specific domain data file and its associated metadata
+            if (exists({"browser", "assets", domain}))
+                rmDir({"browser", "assets", domain});
             return deleteFile({"browser", domain + ".data"});
         }
 
+        Buffer getAsset(const String &domain, const String &hash)
+        {
+            Path p = {"browser", "assets", domain, hash};
+            if (!exists(p))
+                return Buffer();
+            return readFileFull(p);
+        }
+
+        bool setAsset(const String &domain, const String &hash, const Buffer &data)
+        {
+            makeSureBrowserStorageExist();
+            mkDir({"browser", "assets", domain});
+            return writeFile({"browser", "assets", domain, hash}, 0, 0, data);
+        }
+
         std::vector<String> listSites()
         {
             makeSureBrowserStorageExist();
@@ -916,35 +956,15 @@ namespace ENC_FS
 
     void copyFileFromSPIFFS(const char *spiffsPath, const Path &sdPath)
     {
-        File src = SPIFFS.open(spiffsPath, FILE_READ);
-        if (!src || src.isDirectory())
+#if defined(ARDUINO)
+        FsBackend::Backend &spiffs = FsBackend::spiffs();
+#else
+        FsBackend::Backend &spiffs = FsBackend::active(); // host builds have no flash partition
+#endif
+        long size = spiffs.fileSize(spiffsPath);
+        if (size < 0)
             return;
 
-        File dest = SD.open(path2Str(sdPath), FILE_WRITE);
-        if (!dest)
-        {
-            src.close();
-            return;
-        }
-
-        constexpr size_t bufSize = 1024;
-        uint8_t buffer[bufSize];
-
-        while (true)
-        {
-            size_t bytesRead = src.read(buffer, bufSize);
-            if (bytesRead == 0)
-                break;
-            if (dest.write(buffer, bytesRead) != bytesRead)
-            {
-                dest.close();
-                src.close();
-                SD.remove(path2Str(sdPath));
-                return;
-            }
-        }
-
-        dest.close();
-        src.close();
+        Import::importFiles({{&spiffs, String(spiffsPath), sdPath, (size_t)size}});
     }
 } // namespace ENC_FS
@@ -6,6 +6,8 @@
 #include <SPIFFS.h>
 #include <SD.h>
 
+#include "backend.hpp"
+
 namespace ENC_FS
 {
     using Buffer = std::vector<uint8_t>;
@@ -55,13 +57,47 @@ namespace ENC_FS
     String readFileString(const Path &p);
     bool writeFile(const Path &p, long start, long end, const Buffer &data);
     bool appendFile(const Path &p, const Buffer &data);
+    // Appends by encrypting only the new bytes under the file's current version (no rewrite).
+    // Only for files that are never rewritten in place, e.g. append-only logs.
+    bool appendInPlace(const Path &p, const Buffer &data);
     bool writeFileString(const Path &p, const String &s);
+
+    // Streams a new version of an encrypted file to SD chunk by chunk, without reading or
+    // holding the whole file in RAM. Bypasses the write-back cache: open() drops content still
+    // pending there, so a later flush cannot overwrite the streamed file.
+    class FileWriter
+    {
+    public:
+        ~FileWriter() { close(); }
+
+        bool open(const Path &p);
+        bool write(const uint8_t *data, size_t len);
+        bool close();
+        size_t size() const { return offset; }
+
+    private:
+        // open() without the cache step, for the cache's own flush (defined in enc-fs.cpp)
+        friend bool writeFileThrough(const Path &p, const Buffer &plaintext);
+        bool openVersion(const Path &p);
+
+        FsBackend::Handle file;
+        String full;
+        Path path;
+        uint8_t nonce[16];
+        size_t offset = 0;
+        bool failed = false;
+        Buffer scratch;
+    };
     bool deleteFile(const Path &p);
     long getFileSize(const Path &p);
     Metadata getMetadata(const Path &p);
     std::vector<String> readDir(const Path &plainDir);
     void lsDirSerial(const Path &plainDir);
 
+    // Flush pending write-back data to SD (all files / one file).
+    bool sync();
+    bool fsync(const Path &p);
+
     Path storagePath(const String &appId, const String &key);
 
     namespace Storage
@@ -69,6 +105,9 @@ namespace ENC_FS
         Buffer get(const String &appId, const String &key, long start = -1, long end = -1);
         bool del(const String &appId, const String &key);
         bool set(const String &appId, const String &key, const Buffer &data);
+        bool setMany(const String &appId, const std::vector<std::pair<String, Buffer>> &items);
+        // found (optional) tells a missing key from an empty value
+        std::vector<Buffer> getMany(const String &appId, const std::vector<String> &keys, std::vector<bool> *found = nullptr);
     }
 
     namespace BrowserStorage
@@ -78,6 +117,9 @@ namespace ENC_FS
         bool set(const String &domain, const Buffer &data);
         bool clearAll();
         std::vector<String> listSites();
+        // content-addressed assets of a site (browser/assets/<domain>/<hash>)
+        Buffer getAsset(const String &domain, const String &hash);
+        bool setAsset(const String &domain, const String &hash, const Buffer &data);
     }
 
     void copyFileFromSPIFFS(const char *spiffsPath, const Path &sdPath);
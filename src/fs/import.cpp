@@ -0,0 +1,264 @@
+#include "import.hpp"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+namespace ENC_FS
+{
+    namespace Import
+    {
+        enum ChunkKind : uint8_t
+        {
+            CHUNK_DATA = 0,
+            CHUNK_END = 1,  // end of the current file
+            CHUNK_FAIL = 2, // source could not be opened / read
+            CHUNK_DONE = 3  // reader finished all items and no longer touches the job
+        };
+
+        struct Chunk
+        {
+            uint8_t idx;
+            uint8_t kind;
+            uint16_t len;
+        };
+
+        struct ReaderJob
+        {
+            const std::vector<Item> *items;
+            QueueHandle_t filled; // reader -> writer
+            QueueHandle_t free;   // writer -> reader (buffer indices)
+            uint8_t *buffers[2];
+        };
+
+        static void readerTask(void *pvParameters)
+        {
+            ReaderJob *job = static_cast<ReaderJob *>(pvParameters);
+            const std::vector<Item> &items = *job->items;
+            QueueHandle_t filled = job->filled;
+            QueueHandle_t freeQ = job->free;
+            size_t count = items.size();
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                FsBackend::Handle f = items[i].src->open(items[i].srcPath.c_str(), FsBackend::OpenMode::Read);
+                while (true)
+                {
+                    Chunk c;
+                    xQueueReceive(freeQ, &c.idx, portMAX_DELAY);
+                    if (!f)
+                    {
+                        c.kind = CHUNK_FAIL;
+                        c.len = 0;
+                    }
+                    else
+                    {
+                        size_t n = f->read(job->buffers[c.idx], IMPORT_CHUNK);
+                        c.kind = n > 0 ? CHUNK_DATA : CHUNK_END;
+                        c.len = n > 0 ? (uint16_t)n : 0;
+                    }
+                    xQueueSend(filled, &c, portMAX_DELAY);
+                    if (c.kind != CHUNK_DATA)
+                        break;
+                }
+                if (f)
+                    f->close();
+            }
+
+            // last message: after this the writer may free the job
+            Chunk done{0, CHUNK_DONE, 0};
+            xQueueSend(filled, &done, portMAX_DELAY);
+            vTaskDelete(NULL);
+        }
+
+        static void makeSkeleton(const std::vector<Path> &dirs, const std::vector<Item> &items)
+        {
+            std::vector<String> made;
+            auto ensure = [&](const Path &dir)
+            {
+                if (dir.empty())
+                    return;
+                String key = path2Str(dir);
+                for (const String &m : made)
+                    if (m == key)
+                        return;
+                mkDir(dir);
+                made.push_back(key);
+            };
+
+            for (const Path &d : dirs)
+                ensure(d);
+            for (const Item &it : items)
+                if (!it.dst.empty())
+                    ensure(Path(it.dst.begin(), it.dst.end() - 1));
+        }
+
+        static bool streamFiles(const std::vector<Item> &items, Progress &pr, ProgressFn &onProgress)
+        {
+            Buffer a(IMPORT_CHUNK), b(IMPORT_CHUNK);
+            ReaderJob job;
+            job.items = &items;
+            job.buffers[0] = a.data();
+            job.buffers[1] = b.data();
+            job.filled = xQueueCreate(2, sizeof(Chunk));
+            job.free = xQueueCreate(2, sizeof(uint8_t));
+            if (!job.filled || !job.free)
+            {
+                if (job.filled)
+                    vQueueDelete(job.filled);
+                if (job.free)
+                    vQueueDelete(job.free);
+                return false;
+            }
+            for (uint8_t i = 0; i < 2; ++i)
+                xQueueSend(job.free, &i, 0);
+
+            // SD reads on core 0, encryption + SD writes on the caller's core (app tasks run on core 1)
+            TaskHandle_t reader = NULL;
+            BaseType_t res = xTaskCreatePinnedToCore(
+                readerTask,
+                "EncFsImport",
+                4096,
+                &job,
+                uxTaskPriorityGet(NULL),
+                &reader,
+                0);
+            if (res != pdPASS)
+            {
+                Serial.println("ERROR: failed to create EncFsImport task");
+                vQueueDelete(job.filled);
+                vQueueDelete(job.free);
+                return false;
+            }
+
+            bool allOk = true;
+            for (const Item &item : items)
+            {
+                pr.current = item.srcPath;
+
+                FileWriter w;
+                bool ok = w.open(item.dst);
+                while (true)
+                {
+                    Chunk c;
+                    xQueueReceive(job.filled, &c, portMAX_DELAY);
+                    if (c.kind == CHUNK_DATA)
+                    {
+                        if (ok)
+                            ok = w.write(job.buffers[c.idx], c.len);
+                        xQueueSend(job.free, &c.idx, portMAX_DELAY);
+                        pr.bytesDone += c.len;
+                        if (onProgress)
+                            onProgress(pr);
+                        continue;
+                    }
+                    xQueueSend(job.free, &c.idx, portMAX_DELAY);
+                    if (c.kind == CHUNK_FAIL)
+                        ok = false;
+                    break;
+                }
+                ok = w.close() && ok;
+
+                if (!ok)
+                {
+                    Serial.printf("[Import] failed: %s\n", item.srcPath.c_str());
+                    allOk = false;
+                }
+                ++pr.filesDone;
+                if (onProgress)
+                    onProgress(pr);
+            }
+
+            Chunk c;
+            do
+            {
+                xQueueReceive(job.filled, &c, portMAX_DELAY);
+            } while (c.kind != CHUNK_DONE);
+
+            vQueueDelete(job.filled);
+            vQueueDelete(job.free);
+            return allOk;
+        }
+
+        static bool run(const std::vector<Path> &dirs, const std::vector<Item> &items, ProgressFn onProgress)
+        {
+            Progress pr;
+            pr.filesTotal = items.size();
+            for (const Item &it : items)
+                pr.bytesTotal += it.size;
+
+            makeSkeleton(dirs, items);
+            if (onProgress)
+                onProgress(pr);
+            if (items.empty())
+                return true;
+
+            return streamFiles(items, pr, onProgress);
+        }
+
+        static void collect(const String &dir, const Path &dst, std::vector<Path> &dirs, std::vector<Item> &items)
+        {
+            FsBackend::Backend &disk = FsBackend::active();
+            String base = dir.endsWith("/") ? dir : dir + "/";
+
+            std::vector<FsBackend::DirEntry> entries;
+            std::vector<String> names;
+            disk.list(dir.c_str(), [&](const FsBackend::DirEntry &e)
+                      {
+                          names.push_back(String(e.name));
+                          entries.push_back(e);
+                      });
+
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                Path child = dst;
+                child.push_back(names[i]);
+                if (entries[i].isDir)
+                {
+                    dirs.push_back(child);
+                    collect(base + names[i], child, dirs, items);
+                }
+                else
+                    items.push_back({&disk, base + names[i], child, entries[i].size});
+            }
+        }
+
+        bool importTree(const String &srcDir, const Path &dstDir, ProgressFn onProgress)
+        {
+            std::vector<Path> dirs;
+            std::vector<Item> items;
+            if (!dstDir.empty())
+                dirs.push_back(dstDir);
+            collect(srcDir, dstDir, dirs, items);
+            return run(dirs, items, onProgress);
+        }
+
+        bool importFiles(const std::vector<Item> &items, ProgressFn onProgress)
+        {
+            return run({}, items, onProgress);
+        }
+
+        BenchResult benchmark(const String &srcDir)
+        {
+            Path scratch = {String("import-bench")};
+
+            uint64_t bytes = 0;
+            size_t files = 0;
+            uint32_t start = millis();
+            importTree(srcDir, scratch, [&](const Progress &p)
+                       {
+                           bytes = p.bytesDone;
+                           files = p.filesDone;
+                       });
+            uint32_t elapsed = millis() - start;
+            rmDir(scratch);
+
+            BenchResult r;
+            r.files = files;
+            r.bytes = bytes;
+            r.millis = elapsed ? elapsed : 1;
+            r.mbPerSec = (float)bytes / 1000.0f / (float)r.millis; // bytes/ms / 1000 == MB/s
+            return r;
+        }
+    }
+} // namespace ENC_FS
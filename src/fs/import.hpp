@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+#include "enc-fs.hpp"
+
+namespace ENC_FS
+{
+    // Bulk import of plain files (SD /public, SPIFFS) into encrypted storage.
+    //
+    // Each source file is streamed exactly once: a reader task pinned to core 0 fills two
+    // IMPORT_CHUNK buffers from the source while the calling task encrypts and writes the
+    // other one through ENC_FS::FileWriter. The encrypted directory skeleton is created
+    // before any file data is copied.
+    namespace Import
+    {
+        constexpr size_t IMPORT_CHUNK = 4096;
+
+        struct Progress
+        {
+            size_t filesDone = 0;
+            size_t filesTotal = 0;
+            uint64_t bytesDone = 0;
+            uint64_t bytesTotal = 0;
+            String current; // source path of the file being copied
+        };
+
+        using ProgressFn = std::function<void(const Progress &)>;
+
+        struct Item
+        {
+            FsBackend::Backend *src; // e.g. FsBackend::sd(), FsBackend::spiffs()
+            String srcPath;
+            Path dst;
+            size_t size;
+        };
+
+        // Copy every file below srcDir of the active backend (SD card) into dstDir (relative layout kept).
+        bool importTree(const String &srcDir, const Path &dstDir, ProgressFn onProgress = nullptr);
+
+        // Stream a list of files; directories of all destinations are created first.
+        bool importFiles(const std::vector<Item> &items, ProgressFn onProgress = nullptr);
+
+        struct BenchResult
+        {
+            size_t files;
+            uint64_t bytes;
+            uint32_t millis;
+            float mbPerSec;
+        };
+
+        // Import srcDir into a scratch destination, report throughput, remove the scratch copy.
+        BenchResult benchmark(const String &srcDir = "/public");
+    }
+} // namespace ENC_FS
@@ -1,9 +1,15 @@
 #include "fs/index.hpp"
+#include "fs/backend.hpp"
 
 #include "../styles/global.hpp"
 
 namespace SD_FS
 {
+    // path-based operations go through the storage backend (SD card on the device)
+    static inline FsBackend::Backend &disk()
+    {
+        return FsBackend::active();
+    }
 
     bool init(uint8_t csPin)
     {
@@ -76,33 +82,33 @@ namespace SD_FS
 
     bool writeFile(const String &path, const String &content)
     {
-        File file = SD.open(path, FILE_WRITE);
+        FsBackend::Handle file = disk().open(path.c_str(), FsBackend::OpenMode::Write);
         if (!file)
         {
             Serial.printf("❌ writeFile: can't open %s\n", path.c_str());
             return false;
         }
-        file.print(content);
-        file.close();
+        file->write((const uint8_t *)content.c_str(), content.length());
+        file->close();
         return true;
     }
 
     bool appendFile(const String &path, const String &content)
     {
-        File file = SD.open(path, FILE_APPEND);
+        FsBackend::Handle file = disk().open(path.c_str(), FsBackend::OpenMode::Append);
         if (!file)
         {
             Serial.printf("❌ appendFile: can't open %s\n", path.c_str());
             return false;
         }
-        file.print(content);
-        file.close();
+        file->write((const uint8_t *)content.c_str(), content.length());
+        file->close();
         return true;
     }
 
     String readFile(const String &path)
     {
-        File file = SD.open(path);
+        FsBackend::Handle file = disk().open(path.c_str(), FsBackend::OpenMode::Read);
         String result = "";
 
         if (!file)
@@ -111,32 +117,36 @@ namespace SD_FS
             return result;
         }
 
-        while (file.available())
-            result += (char)file.read();
+        size_t size = file->size();
+        Buffer buf(size);
+        size_t got = size ? file->read(buf.data(), size) : 0;
+        file->close();
 
-        file.close();
+        result.reserve(got);
+        for (size_t i = 0; i < got; ++i)
+            result += (char)buf[i];
 
         return result;
     }
 
     bool readFileBuff(const String &path, long offset, size_t length, Buffer &buffer)
     {
-        File file = SD.open(path, FILE_READ);
+        FsBackend::Handle file = disk().open(path.c_str(), FsBackend::OpenMode::Read);
         if (!file)
         {
             Serial.printf("❌ Failed to open file for reading: %s\n", path.c_str());
             return false;
         }
 
-        if (!file.seek(offset))
+        if (!file->seek(offset))
         {
             Serial.printf("❌ Failed to seek to offset %ld in file: %s\n", offset, path.c_str());
-            file.close();
+            file->close();
             return false;
         }
 
-        size_t bytesRead = file.read(buffer.data(), length);
-        file.close();
+        size_t bytesRead = file->read(buffer.data(), length);
+        file->close();
 
         if (bytesRead != length)
         {
@@ -150,7 +160,7 @@ namespace SD_FS
 
     bool deleteFile(const String &path)
     {
-        if (!SD.remove(path))
+        if (!disk().remove(path.c_str()))
         {
             Serial.printf("❌ deleteFile failed: %s\n", path.c_str());
             return false;
@@ -160,7 +170,7 @@ namespace SD_FS
 
     bool renameFile(const String &from, const String &to)
     {
-        if (!SD.rename(from, to))
+        if (!disk().rename(from.c_str(), to.c_str()))
         {
             Serial.printf("❌ renameFile failed: %s → %s\n", from.c_str(), to.c_str());
             return false;
@@ -191,49 +201,34 @@ namespace SD_FS
     std::vector<String> readDirStr(const String &path)
     {
         std::vector<String> out;
-        File root = SD.open(path);
-        if (!root || !root.isDirectory())
-        {
-            Serial.printf("❌ Not a dir: %s\n", path.c_str());
-            return {};
-        }
 
         // Ensure path ends with single slash
         String base = path;
         if (base.length() > 0 && !base.endsWith("/"))
             base += "/";
 
-        File file = root.openNextFile();
-        while (file)
+        bool ok = disk().list(path.c_str(), [&](const FsBackend::DirEntry &e)
+                              {
+                                  out.push_back(base + String(e.name)); // <--- absolute path
+                              });
+        if (!ok)
         {
-            String fullname = base + String(file.name()); // <--- absolute path
-            out.push_back(fullname);
-            file.close();
-            file = root.openNextFile();
+            Serial.printf("❌ Not a dir: %s\n", path.c_str());
+            return {};
         }
 
-        root.close();
         return out;
     }
 
     void forEachFile(const String &path, std::function<void(const String &name, bool isDir)> cb)
     {
-        File root = SD.open(path);
-        if (!root || !root.isDirectory())
-            return;
-
-        File file = root.openNextFile();
-        while (file)
-        {
-            cb(file.name(), file.isDirectory());
-            file.close();
-            file = root.openNextFile();
-        }
+        disk().list(path.c_str(), [&](const FsBackend::DirEntry &e)
+                    { cb(String(e.name), e.isDir); });
     }
 
     bool createDir(const String &path)
     {
-        if (!SD.mkdir(path))
+        if (!disk().mkdir(path.c_str()))
         {
             Serial.printf("❌ mkdir failed: %s\n", path.c_str());
             return false;
@@ -243,49 +238,41 @@ namespace SD_FS
 
     bool deleteDir(const String &path)
     {
-        File dir = SD.open(path);
-        if (!dir || !dir.isDirectory())
+        // collect first, removing entries while a directory is being enumerated is not safe on FAT
+        std::vector<std::pair<String, bool>> entries;
+        bool ok = disk().list(path.c_str(), [&](const FsBackend::DirEntry &e)
+                              { entries.push_back({String(path) + "/" + e.name, e.isDir}); });
+        if (!ok)
         {
             Serial.printf("❌ Not a dir: %s\n", path.c_str());
             return false;
         }
 
-        File file = dir.openNextFile();
-        while (file)
+        for (const auto &e : entries)
         {
-            String filePath = String(path) + "/" + file.name();
-            if (file.isDirectory())
-                deleteDir(filePath);
+            if (e.second)
+                deleteDir(e.first);
             else
-                SD.remove(filePath);
-            file = dir.openNextFile();
+                disk().remove(e.first.c_str());
         }
 
-        if (!SD.rmdir(path))
+        if (!disk().rmdir(path.c_str()))
             Serial.printf("❌ deleteDir failed: %s\n", path.c_str());
 
         return true;
     }
 
-    bool exists(const String &path) { return SD.exists(path); }
+    bool exists(const String &path) { return disk().exists(path.c_str()); }
 
     bool isDirectory(const String &path)
     {
-        File f = SD.open(path);
-        bool r = f && f.isDirectory();
-        if (f)
-            f.close();
-        return r;
+        return disk().isDirectory(path.c_str());
     }
 
     size_t fileSize(const String &path)
     {
-        File f = SD.open(path);
-        if (!f)
-            return 0;
-        size_t s = f.size();
-        f.close();
-        return s;
+        long s = disk().fileSize(path.c_str());
+        return s < 0 ? 0 : (size_t)s;
     }
 
     time_t getModifiedTime(const String &path)
@@ -309,69 +296,72 @@ namespace SD_FS
 
     long getFileSize(const String &path)
     {
-        File file = SD.open(path, FILE_READ);
-        if (!file)
-        {
+        long size = disk().fileSize(path.c_str());
+        if (size < 0)
             Serial.printf("❌ Failed to open file for size: %s\n", path.c_str());
-            return -1;
-        }
-
-        long size = file.size();
-        file.close(); // always close immediately
         return size;
     }
 
     void copyFileFromSPIFFS(const char *spiffsPath, const char *sdPath)
     {
-        File f = SPIFFS.open(spiffsPath, "r");
+        FsBackend::Handle f = FsBackend::spiffs().open(spiffsPath, FsBackend::OpenMode::Read);
         if (!f)
         {
             Serial.printf("Fehler beim Öffnen von %s in SPIFFS\n", spiffsPath);
             return;
         }
 
-        String content = f.readString(); // ganzen Inhalt als String einlesen
-        f.close();
+        // ganzen Inhalt einlesen und 1:1 auf SD schreiben
+        Buffer content(f->size());
+        size_t got = content.empty() ? 0 : f->read(content.data(), content.size());
+        f->close();
 
-        writeFile(sdPath, content); // auf SD schreiben
+        FsBackend::Handle out = disk().open(sdPath, FsBackend::OpenMode::Write);
+        if (!out)
+        {
+            Serial.printf("❌ writeFile: can't open %s\n", sdPath);
+            return;
+        }
+        out->write(content.data(), got);
+        out->close();
     }
 
     void lsDirSerial(const String &path)
     {
         Serial.println("--- READ DIR ---");
-        auto files = readDir(path);
-        for (const auto &f : files)
+        for (const String &f : readDirStr(path))
         {
-            Serial.println(f.path());
+            Serial.println(f);
         }
         Serial.println("--- READ DIR END ---");
     }
 
     void deleteFoldersXV(const String &path, const std::vector<String> &except)
     {
-        auto files = readDir(path);
+        String base = path.endsWith("/") ? path : path + "/";
+        std::vector<String> dirs;
+        forEachFile(path, [&](const String &name, bool isDir)
+                    {
+                        if (isDir)
+                            dirs.push_back(name);
+                    });
 
-        for (auto f : files)
+        for (const String &dirName : dirs)
         {
-            if (f.isDirectory())
+            // check ob dieser Ordner in except ist
+            bool skip = false;
+            for (const auto &ex : except)
             {
-                String dirName = f.name();
-
-                // check ob dieser Ordner in except ist
-                bool skip = false;
-                for (const auto &ex : except)
+                if (dirName.equalsIgnoreCase(ex))
                 {
-                    if (dirName.equalsIgnoreCase(ex))
-                    {
-                        skip = true;
-                        break;
-                    }
+                    skip = true;
+                    break;
                 }
+            }
 
-                if (!skip)
-                {
-                    deleteDir(f.path());
-                }
+            if (!skip)
+            {
+                deleteDir(base + dirName);
             }
         }
     }
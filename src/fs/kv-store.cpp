@@ -0,0 +1,620 @@
+#include "kv-store.hpp"
+#include "write-cache.hpp"
+
+#include <map>
+#include <unordered_map>
+#include <array>
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace ENC_FS
+{
+    namespace KvStore
+    {
+        using KeyHash = std::array<uint8_t, 32>;
+
+        struct KeyHasher
+        {
+            size_t operator()(const KeyHash &k) const
+            {
+                uint32_t h;
+                memcpy(&h, k.data(), 4); // already a SHA-256, any 4 bytes are well mixed
+                return h;
+            }
+        };
+
+        // value location inside the segment
+        struct Loc
+        {
+            uint32_t offset;
+            uint32_t len;
+        };
+
+        static constexpr uint8_t REC_SET = 1;
+        static constexpr uint8_t REC_DEL = 2;
+        static constexpr uint8_t REC_HEAD = 3; // first record of a compacted segment
+        static constexpr size_t REC_HEADER = 1 + 4 + 4 + 32;
+        static constexpr size_t HEAD_VALUE = 4 + 4; // u32 generation, u32 length of the compacted records
+
+        struct Store
+        {
+            std::mutex lock;
+            Path dir;
+            Path slots[2];   // store.kv, store.kv.new; compaction writes the one not in use
+            int active = 0;
+            Path segment;    // == slots[active]
+            uint32_t generation = 0;
+            std::unordered_map<KeyHash, Loc, KeyHasher> index;
+            uint32_t end = 0;       // logical end of the segment (== file size)
+            uint32_t liveBytes = 0; // bytes of records still referenced by the index
+            bool compactQueued = false;
+        };
+
+        static std::mutex g_storesLock;
+        static std::map<String, Store *> g_stores;
+        static TaskHandle_t g_compactTask = NULL;
+
+        // ---------- record encoding ----------
+
+        static KeyHash keyHash(const String &key)
+        {
+            Buffer h = sha256(key);
+            KeyHash k;
+            memcpy(k.data(), h.data(), 32);
+            return k;
+        }
+
+        static inline uint32_t fnv1a(uint32_t h, const uint8_t *p, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                h ^= p[i];
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        static uint32_t recordChecksum(const uint8_t *rec, uint32_t valueLen)
+        {
+            uint32_t h = fnv1a(2166136261u, rec, 5);
+            return fnv1a(h, rec + 9, 32 + valueLen);
+        }
+
+        static inline void put32(uint8_t *p, uint32_t v)
+        {
+            p[0] = (uint8_t)v;
+            p[1] = (uint8_t)(v >> 8);
+            p[2] = (uint8_t)(v >> 16);
+            p[3] = (uint8_t)(v >> 24);
+        }
+
+        static inline uint32_t get32(const uint8_t *p)
+        {
+            return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+
+        // Appends one record to `out` and returns the offset of its value within `out`.
+        static uint32_t encodeRecord(Buffer &out, uint8_t type, const KeyHash &k, const uint8_t *value, uint32_t len)
+        {
+            size_t at = out.size();
+            out.resize(at + REC_HEADER + len);
+            uint8_t *rec = out.data() + at;
+            rec[0] = type;
+            put32(rec + 1, len);
+            memcpy(rec + 9, k.data(), 32);
+            if (len)
+                memcpy(rec + REC_HEADER, value, len);
+            put32(rec + 5, recordChecksum(rec, len));
+            return (uint32_t)(at + REC_HEADER);
+        }
+
+        // ---------- index maintenance ----------
+
+        static void applySet(Store &s, const KeyHash &k, uint32_t valueOffset, uint32_t len)
+        {
+            auto it = s.index.find(k);
+            if (it != s.index.end())
+                s.liveBytes -= REC_HEADER + it->second.len;
+            s.index[k] = {valueOffset, len};
+            s.liveBytes += REC_HEADER + len;
+        }
+
+        static void applyDel(Store &s, const KeyHash &k)
+        {
+            auto it = s.index.find(k);
+            if (it == s.index.end())
+                return;
+            s.liveBytes -= REC_HEADER + it->second.len;
+            s.index.erase(it);
+        }
+
+        static bool compactLocked(Store &s);
+
+        static long segmentSize(Store &s)
+        {
+            long size = getFileSize(s.segment);
+            return size < 0 ? 0 : size;
+        }
+
+        // Rebuild the index from the segment. A torn or corrupt tail (power loss during an append)
+        // ends the scan; returns false in that case, s.end is then the end of the last good record.
+        // `committed` is the length a compacted segment announces in its head record (0 without one).
+        static bool readIndexLocked(Store &s, uint32_t *committed = nullptr)
+        {
+            s.index.clear();
+            s.end = 0;
+            s.liveBytes = 0;
+            s.generation = 0;
+            if (committed)
+                *committed = 0;
+
+            long size = getFileSize(s.segment);
+            if (size <= 0)
+                return true;
+
+            Buffer win;
+            uint32_t winStart = 0;
+            auto ensure = [&](uint32_t off, uint32_t n) -> const uint8_t *
+            {
+                if (off >= winStart && off + n <= winStart + win.size())
+                    return win.data() + (off - winStart);
+                if ((long)off + (long)n > size)
+                    return nullptr;
+                win = readFilePart(s.segment, off, off + std::max<uint32_t>(n, KV_SCAN_CHUNK));
+                winStart = off;
+                if (win.size() < n)
+                    return nullptr;
+                return win.data();
+            };
+
+            uint32_t off = 0;
+            while ((long)off < size)
+            {
+                const uint8_t *h = ensure(off, REC_HEADER);
+                if (!h)
+                    break;
+                uint8_t type = h[0];
+                uint32_t len = get32(h + 1);
+                uint32_t sum = get32(h + 5);
+                if ((type != REC_SET && type != REC_DEL && type != REC_HEAD) || (type == REC_DEL && len != 0) ||
+                    (type == REC_HEAD && (off != 0 || len != HEAD_VALUE)))
+                    break;
+
+                const uint8_t *rec = ensure(off, REC_HEADER + len);
+                if (!rec || recordChecksum(rec, len) != sum)
+                    break;
+
+                KeyHash k;
+                memcpy(k.data(), rec + 9, 32);
+                if (type == REC_SET)
+                    applySet(s, k, off + REC_HEADER, len);
+                else if (type == REC_DEL)
+                    applyDel(s, k);
+                else
+                {
+                    s.generation = get32(rec + REC_HEADER);
+                    if (committed)
+                        *committed = get32(rec + REC_HEADER + 4);
+                }
+
+                off += REC_HEADER + len;
+            }
+
+            s.end = off;
+            if ((long)off < size)
+            {
+                Serial.printf("[KvStore] dropping %ld corrupt tail bytes\n", size - (long)off);
+                return false;
+            }
+            return true;
+        }
+
+        // A failed compaction leaves the active segment untouched; re-read it so the index
+        // matches the file whatever step failed.
+        static bool compactOrReloadLocked(Store &s)
+        {
+            if (compactLocked(s))
+                return true;
+            readIndexLocked(s);
+            return false;
+        }
+
+        // Generation of a compacted segment from its head record; false if `p` does not start with one.
+        static bool readGeneration(const Path &p, uint32_t &generation)
+        {
+            Buffer h = readFilePart(p, 0, REC_HEADER + HEAD_VALUE);
+            if (h.size() != REC_HEADER + HEAD_VALUE || h[0] != REC_HEAD || get32(h.data() + 1) != HEAD_VALUE ||
+                recordChecksum(h.data(), HEAD_VALUE) != get32(h.data() + 5))
+                return false;
+            generation = get32(h.data() + REC_HEADER);
+            return true;
+        }
+
+        // Emptied rather than deleted: the file keeps its version counter, so the next compaction
+        // into this slot encrypts under a fresh nonce.
+        static void retireSlotLocked(Store &s, int slot)
+        {
+            if (getFileSize(s.slots[slot]) > 0)
+                writeFileThrough(s.slots[slot], Buffer());
+        }
+
+        // Pick the segment: the newest slot whose compacted records are all on SD. A slot with a
+        // newer but incomplete segment (power cut during compaction) or an older one (cut before it
+        // was retired) is emptied. store.kv without a head record is a segment that was never
+        // compacted. A torn tail is cut off by compacting, so later appends don't land behind garbage.
+        static void loadLocked(Store &s)
+        {
+            std::vector<std::pair<uint32_t, int>> candidates; // generation, slot
+            for (int i = 0; i < 2; ++i)
+            {
+                if (getFileSize(s.slots[i]) <= 0)
+                    continue;
+                uint32_t generation = 0;
+                if (readGeneration(s.slots[i], generation) || i == 0)
+                    candidates.push_back({generation, i});
+            }
+            std::sort(candidates.begin(), candidates.end(), [](const std::pair<uint32_t, int> &a, const std::pair<uint32_t, int> &b)
+                      { return a.first > b.first; });
+
+            for (auto &c : candidates)
+            {
+                s.active = c.second;
+                s.segment = s.slots[c.second];
+                uint32_t committed = 0;
+                bool clean = readIndexLocked(s, &committed);
+                if (s.end < committed)
+                {
+                    Serial.printf("[KvStore] dropping an interrupted compaction (generation %u)\n", (unsigned)c.first);
+                    continue;
+                }
+                retireSlotLocked(s, 1 - s.active);
+                if (!clean)
+                    compactOrReloadLocked(s);
+                return;
+            }
+
+            // nothing usable (or nothing at all): start over in store.kv
+            s.active = 0;
+            s.segment = s.slots[0];
+            s.index.clear();
+            s.end = 0;
+            s.liveBytes = 0;
+            s.generation = 0;
+            retireSlotLocked(s, 0);
+            retireSlotLocked(s, 1);
+        }
+
+        // Move legacy per-key files (data/<sha256>.data) into the segment, one key at a time so
+        // only a single value is held in RAM. A legacy file is deleted once its record is on SD;
+        // files left by an interrupted migration are picked up on the next open.
+        static void migrateLegacyLocked(Store &s)
+        {
+            if ((uint32_t)segmentSize(s) != s.end)
+                return; // torn tail still in place, appends would land behind it
+
+            std::vector<String> names = readDir(s.dir);
+
+            size_t migrated = 0;
+            for (const String &name : names)
+            {
+                if (!name.endsWith(".data"))
+                    continue;
+                Buffer kb;
+                if (!base64url_decode(name.substring(0, name.length() - 5), kb) || kb.size() != 32)
+                    continue;
+
+                Path legacy = s.dir;
+                legacy.push_back(name);
+                KeyHash k;
+                memcpy(k.data(), kb.data(), 32);
+
+                // already in the segment: the previous migration stopped before deleting the file
+                if (s.index.find(k) == s.index.end())
+                {
+                    Buffer record;
+                    {
+                        Buffer value = readFileFull(legacy);
+                        encodeRecord(record, REC_SET, k, value.data(), value.size());
+                    }
+                    if (!appendInPlace(s.segment, record))
+                        return;
+                    applySet(s, k, s.end + REC_HEADER, record.size() - REC_HEADER);
+                    s.end += record.size();
+                }
+                deleteFile(legacy);
+                ++migrated;
+            }
+
+            if (migrated)
+                Serial.printf("[KvStore] migrated %u legacy keys\n", (unsigned)migrated);
+        }
+
+        static Store *open(const String &appId)
+        {
+            std::lock_guard<std::mutex> g(g_storesLock);
+            auto it = g_stores.find(appId);
+            if (it != g_stores.end())
+                return it->second;
+
+            Store *s = new Store();
+            s->dir = {String("programms"), appId, String("data")};
+            s->slots[0] = s->dir;
+            s->slots[0].push_back(String("store.kv"));
+            s->slots[1] = s->dir;
+            s->slots[1].push_back(String("store.kv.new"));
+            s->segment = s->slots[0];
+
+            std::lock_guard<std::mutex> sl(s->lock);
+            loadLocked(*s);
+            migrateLegacyLocked(*s);
+
+            g_stores[appId] = s;
+            return s;
+        }
+
+        // The segment may have been removed or replaced behind our back (app data wiped);
+        // re-read it before appending so offsets stay in sync with the file. False if it still
+        // ends in a torn record that could not be cut off (appends would land behind it).
+        static bool revalidateLocked(Store &s)
+        {
+            if ((uint32_t)segmentSize(s) != s.end)
+                loadLocked(s);
+            return (uint32_t)segmentSize(s) == s.end;
+        }
+
+        // ---------- compaction ----------
+
+        static bool compactLocked(Store &s)
+        {
+            std::vector<std::pair<KeyHash, Loc>> live(s.index.begin(), s.index.end());
+            std::sort(live.begin(), live.end(), [](const std::pair<KeyHash, Loc> &a, const std::pair<KeyHash, Loc> &b)
+                      { return a.second.offset < b.second.offset; });
+
+            // small segments: one read instead of one per value
+            Buffer whole;
+            bool haveWhole = s.end <= 8 * KV_SCAN_CHUNK;
+            if (haveWhole && s.end > 0)
+                whole = readFilePart(s.segment, 0, s.end);
+
+            // head record first: the segment only counts once all `length` bytes are on SD
+            uint32_t length = REC_HEADER + HEAD_VALUE;
+            for (auto &e : live)
+                length += REC_HEADER + e.second.len;
+            uint8_t head[HEAD_VALUE];
+            put32(head, s.generation + 1);
+            put32(head + 4, length);
+
+            Buffer out;
+            out.reserve(length);
+            encodeRecord(out, REC_HEAD, KeyHash{}, head, HEAD_VALUE);
+            std::vector<std::pair<KeyHash, Loc>> moved;
+            moved.reserve(live.size());
+            for (auto &e : live)
+            {
+                const Loc &loc = e.second;
+                uint32_t off;
+                if (haveWhole)
+                {
+                    if (loc.offset + loc.len > whole.size())
+                        return false;
+                    off = encodeRecord(out, REC_SET, e.first, whole.data() + loc.offset, loc.len);
+                }
+                else
+                {
+                    Buffer v = loc.len ? readFilePart(s.segment, loc.offset, loc.offset + loc.len) : Buffer();
+                    if (v.size() != loc.len)
+                        return false;
+                    off = encodeRecord(out, REC_SET, e.first, v.data(), loc.len);
+                }
+                moved.push_back({e.first, {off, loc.len}});
+            }
+
+            // into the other slot: until it is complete, the current segment stays the one that is read
+            const int target = 1 - s.active;
+            if (!writeFileThrough(s.slots[target], out))
+                return false;
+            const int old = s.active;
+            s.active = target;
+            s.segment = s.slots[target];
+            s.generation++;
+            retireSlotLocked(s, old);
+
+            s.index.clear();
+            for (auto &m : moved)
+                s.index[m.first] = m.second;
+            s.end = out.size();
+            s.liveBytes = out.size() - (REC_HEADER + HEAD_VALUE);
+            return true;
+        }
+
+        static void compactTask(void *pvParameters)
+        {
+            (void)pvParameters;
+
+            for (;;)
+            {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+                std::vector<Store *> queued;
+                {
+                    std::lock_guard<std::mutex> g(g_storesLock);
+                    for (auto &kv : g_stores)
+                        queued.push_back(kv.second);
+                }
+
+                for (Store *s : queued)
+                {
+                    std::lock_guard<std::mutex> sl(s->lock);
+                    if (!s->compactQueued)
+                        continue;
+                    s->compactQueued = false;
+                    if (revalidateLocked(*s))
+                        compactOrReloadLocked(*s);
+                }
+            }
+        }
+
+        static void maybeCompactLocked(Store &s)
+        {
+            uint32_t dead = s.end - s.liveBytes;
+            if (s.compactQueued || s.end < KV_COMPACT_MIN_BYTES || dead <= s.liveBytes)
+                return;
+
+            if (g_compactTask == NULL)
+            {
+                BaseType_t res = xTaskCreate(compactTask, "KvCompact", 8192, NULL, 1, &g_compactTask);
+                if (res != pdPASS)
+                {
+                    g_compactTask = NULL;
+                    return;
+                }
+            }
+
+            s.compactQueued = true;
+            xTaskNotifyGive(g_compactTask);
+        }
+
+        // ---------- API ----------
+
+        bool get(const String &appId, const String &key, Buffer &out, long start, long end)
+        {
+            Store *s = open(appId);
+            std::lock_guard<std::mutex> sl(s->lock);
+
+            auto it = s->index.find(keyHash(key));
+            if (it == s->index.end())
+                return false;
+
+            long len = it->second.len;
+            if (end <= 0 || end > len)
+                end = len;
+            if (start < 0)
+                start = 0;
+            if (start > end)
+                start = end;
+
+            out.clear();
+            if (start == end)
+                return true;
+            out = readFilePart(s->segment, it->second.offset + start, it->second.offset + end);
+            return out.size() == (size_t)(end - start);
+        }
+
+        bool set(const String &appId, const String &key, const Buffer &data)
+        {
+            return setMany(appId, {{key, data}});
+        }
+
+        bool setMany(const String &appId, const std::vector<std::pair<String, Buffer>> &items)
+        {
+            if (items.empty())
+                return true;
+
+            Store *s = open(appId);
+            std::lock_guard<std::mutex> sl(s->lock);
+            if (!revalidateLocked(*s))
+                return false;
+
+            Buffer records;
+            std::vector<std::pair<KeyHash, Loc>> added;
+            added.reserve(items.size());
+            for (auto &item : items)
+            {
+                KeyHash k = keyHash(item.first);
+                uint32_t off = encodeRecord(records, REC_SET, k, item.second.data(), item.second.size());
+                added.push_back({k, {s->end + off, (uint32_t)item.second.size()}});
+            }
+
+            if (!appendInPlace(s->segment, records))
+                return false;
+
+            for (auto &a : added)
+                applySet(*s, a.first, a.second.offset, a.second.len);
+            s->end += records.size();
+            maybeCompactLocked(*s);
+            return true;
+        }
+
+        std::vector<Buffer> getMany(const String &appId, const std::vector<String> &keys, std::vector<bool> *found)
+        {
+            std::vector<Buffer> out(keys.size());
+            if (found)
+                found->assign(keys.size(), false);
+            if (keys.empty())
+                return out;
+
+            Store *s = open(appId);
+            std::lock_guard<std::mutex> sl(s->lock);
+
+            std::vector<std::pair<size_t, Loc>> toRead;
+            uint32_t lo = UINT32_MAX, hi = 0;
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                auto it = s->index.find(keyHash(keys[i]));
+                if (it == s->index.end())
+                    continue;
+                if (found)
+                    (*found)[i] = true;
+                if (it->second.len == 0)
+                    continue;
+                toRead.push_back({i, it->second});
+                lo = std::min(lo, it->second.offset);
+                hi = std::max(hi, it->second.offset + it->second.len);
+            }
+            if (toRead.empty())
+                return out;
+
+            // values close together: one SD read for the whole span
+            if (hi - lo <= 4 * KV_SCAN_CHUNK)
+            {
+                Buffer span = readFilePart(s->segment, lo, hi);
+                if (span.size() == hi - lo)
+                {
+                    for (auto &f : toRead)
+                    {
+                        const uint8_t *p = span.data() + (f.second.offset - lo);
+                        out[f.first].assign(p, p + f.second.len);
+                    }
+                    return out;
+                }
+            }
+
+            for (auto &f : toRead)
+                out[f.first] = readFilePart(s->segment, f.second.offset, f.second.offset + f.second.len);
+            return out;
+        }
+
+        bool del(const String &appId, const String &key)
+        {
+            Store *s = open(appId);
+            std::lock_guard<std::mutex> sl(s->lock);
+            if (!revalidateLocked(*s))
+                return false;
+
+            KeyHash k = keyHash(key);
+            if (s->index.find(k) == s->index.end())
+                return false;
+
+            Buffer record;
+            encodeRecord(record, REC_DEL, k, nullptr, 0);
+            if (!appendInPlace(s->segment, record))
+                return false;
+
+            applyDel(*s, k);
+            s->end += record.size();
+            maybeCompactLocked(*s);
+            return true;
+        }
+
+        bool compact(const String &appId)
+        {
+            Store *s = open(appId);
+            std::lock_guard<std::mutex> sl(s->lock);
+            return revalidateLocked(*s) && compactOrReloadLocked(*s);
+        }
+    }
+} // namespace ENC_FS
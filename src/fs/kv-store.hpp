@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include <utility>
+
+#include "enc-fs.hpp"
+
+namespace ENC_FS
+{
+    // Log-structured key/value store, one per app, behind ENC_FS::Storage.
+    //
+    // All keys of an app live in a single encrypted segment file (programms/<appId>/data/store.kv).
+    // Updates and deletes are appended as records; an in-memory hash index (key hash -> value
+    // location) is rebuilt by scanning the segment the first time an app touches its storage.
+    // A background task rewrites the segment without dead records once they dominate it.
+    //
+    // Compaction never rewrites the segment in use: the live records go to the other of two slots
+    // (store.kv, store.kv.new) behind a head record with a generation and their total length, and
+    // the old slot is emptied afterwards. On open the newest slot holding that many bytes of
+    // valid records wins, so a power cut at any point leaves the old or the new segment.
+    //
+    // Record layout (plaintext, encrypted in place with AES-CTR at its file offset):
+    //   u8  type      1 = set, 2 = delete, 3 = head (first record of a compacted segment,
+    //                 value: u32 generation, u32 segment length at compaction; key hash zero)
+    //   u32 valueLen  little-endian
+    //   u32 checksum  FNV-1a over type, valueLen, key hash and value
+    //   u8  key[32]   SHA-256 of the key (same hash the legacy per-key file names use)
+    //   u8  value[valueLen]
+    namespace KvStore
+    {
+        constexpr size_t KV_COMPACT_MIN_BYTES = 4096; // don't bother compacting tiny segments
+        constexpr size_t KV_SCAN_CHUNK = 4096;
+
+        // Reads value bytes [start, end) of `key` (end <= 0 means up to the end of the value).
+        bool get(const String &appId, const String &key, Buffer &out, long start = -1, long end = -1);
+        bool set(const String &appId, const String &key, const Buffer &data);
+        bool del(const String &appId, const String &key);
+
+        bool setMany(const String &appId, const std::vector<std::pair<String, Buffer>> &items);
+        // found[i] (if given) is true for every key present, including keys with an empty value
+        std::vector<Buffer> getMany(const String &appId, const std::vector<String> &keys, std::vector<bool> *found = nullptr);
+
+        // Rewrite the segment with live records only (normally done by the background task).
+        bool compact(const String &appId);
+    }
+} // namespace ENC_FS
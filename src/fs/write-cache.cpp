@@ -0,0 +1,264 @@
+#include "write-cache.hpp"
+
+#include <map>
+#include <mutex>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace ENC_FS
+{
+    namespace WriteCache
+    {
+        struct Entry
+        {
+            Path path;
+            Buffer data;
+            uint32_t lastWrite = 0;
+            uint32_t gen = 0; // bumped on every put so a flush can tell if it wrote the latest data
+        };
+
+        static std::mutex g_lock;      // guards g_entries / g_bytes
+        static std::mutex g_flushLock; // serializes SD writes of cached files (lock order: g_flushLock -> g_lock)
+        static std::map<String, Entry> g_entries;
+        static size_t g_bytes = 0;
+        static TaskHandle_t g_flushTask = NULL;
+
+        static String keyOf(const Path &p)
+        {
+            return path2Str(p);
+        }
+
+        static bool underPrefix(const String &key, const String &prefix)
+        {
+            if (prefix == "/")
+                return true;
+            return key == prefix || key.startsWith(prefix + "/");
+        }
+
+        // Write one entry to SD. Caller holds g_flushLock.
+        // The entry is only dropped if nobody wrote to it while the SD write was running.
+        static bool flushKeyLocked(const String &key)
+        {
+            Path path;
+            Buffer snapshot;
+            uint32_t gen;
+            {
+                std::lock_guard<std::mutex> g(g_lock);
+                auto it = g_entries.find(key);
+                if (it == g_entries.end())
+                    return true;
+                path = it->second.path;
+                snapshot = it->second.data;
+                gen = it->second.gen;
+            }
+
+            bool ok = writeFileThrough(path, snapshot);
+
+            std::lock_guard<std::mutex> g(g_lock);
+            auto it = g_entries.find(key);
+            if (ok && it != g_entries.end() && it->second.gen == gen)
+            {
+                g_bytes -= it->second.data.size();
+                g_entries.erase(it);
+            }
+            return ok;
+        }
+
+        static void flushTask(void *pvParameters)
+        {
+            (void)pvParameters;
+
+            for (;;)
+            {
+                bool idle;
+                {
+                    std::lock_guard<std::mutex> g(g_lock);
+                    idle = g_entries.empty();
+                }
+                ulTaskNotifyTake(pdTRUE, idle ? portMAX_DELAY : pdMS_TO_TICKS(WB_FLUSH_DELAY_MS));
+
+                std::vector<String> due;
+                {
+                    std::lock_guard<std::mutex> g(g_lock);
+                    uint32_t now = millis();
+                    for (auto &kv : g_entries)
+                        if (now - kv.second.lastWrite >= WB_FLUSH_DELAY_MS)
+                            due.push_back(kv.first);
+                }
+
+                for (const String &key : due)
+                {
+                    std::lock_guard<std::mutex> f(g_flushLock);
+                    if (!flushKeyLocked(key))
+                        Serial.printf("[WriteCache] flush failed: %s\n", key.c_str());
+                }
+            }
+        }
+
+        static void ensureFlushTask()
+        {
+            if (g_flushTask != NULL)
+                return;
+
+            BaseType_t res = xTaskCreate(
+                flushTask,
+                "EncFsFlush",
+                8192,
+                NULL,
+                1, // lowest app priority, below the render task
+                &g_flushTask);
+
+            if (res != pdPASS)
+            {
+                Serial.println("ERROR: failed to create EncFsFlush task");
+                g_flushTask = NULL;
+            }
+        }
+
+        bool put(const Path &p, Buffer &plaintext)
+        {
+            // large files would evict everything else; write them through
+            if (plaintext.size() > WB_MAX_BYTES / 2)
+                return false;
+
+            ensureFlushTask();
+            if (g_flushTask == NULL)
+                return false;
+
+            String key = keyOf(p);
+            while (true)
+            {
+                String victim;
+                {
+                    std::lock_guard<std::mutex> g(g_lock);
+                    auto it = g_entries.find(key);
+                    size_t old = (it != g_entries.end()) ? it->second.data.size() : 0;
+                    bool fits = g_bytes - old + plaintext.size() <= WB_MAX_BYTES &&
+                                (it != g_entries.end() || g_entries.size() < WB_MAX_ENTRIES);
+
+                    if (!fits)
+                    {
+                        // oldest other entry goes to SD first
+                        uint32_t now = millis();
+                        uint32_t bestAge = 0;
+                        for (auto &kv : g_entries)
+                        {
+                            if (kv.first == key)
+                                continue;
+                            uint32_t age = now - kv.second.lastWrite;
+                            if (victim.isEmpty() || age >= bestAge)
+                            {
+                                victim = kv.first;
+                                bestAge = age;
+                            }
+                        }
+                    }
+
+                    if (fits || victim.isEmpty())
+                    {
+                        Entry &e = g_entries[key];
+                        g_bytes = g_bytes - e.data.size() + plaintext.size();
+                        e.path = p;
+                        e.data = std::move(plaintext);
+                        e.lastWrite = millis();
+                        ++e.gen;
+                        break;
+                    }
+                }
+
+                std::lock_guard<std::mutex> f(g_flushLock);
+                if (!flushKeyLocked(victim))
+                    return false;
+            }
+
+            xTaskNotifyGive(g_flushTask);
+            return true;
+        }
+
+        bool get(const Path &p, Buffer &out)
+        {
+            std::lock_guard<std::mutex> g(g_lock);
+            auto it = g_entries.find(keyOf(p));
+            if (it == g_entries.end())
+                return false;
+            out = it->second.data;
+            return true;
+        }
+
+        bool contains(const Path &p)
+        {
+            std::lock_guard<std::mutex> g(g_lock);
+            return g_entries.count(keyOf(p)) != 0;
+        }
+
+        long size(const Path &p)
+        {
+            std::lock_guard<std::mutex> g(g_lock);
+            auto it = g_entries.find(keyOf(p));
+            if (it == g_entries.end())
+                return -1;
+            return (long)it->second.data.size();
+        }
+
+        bool discard(const Path &p)
+        {
+            std::lock_guard<std::mutex> f(g_flushLock);
+            std::lock_guard<std::mutex> g(g_lock);
+            auto it = g_entries.find(keyOf(p));
+            if (it == g_entries.end())
+                return false;
+            g_bytes -= it->second.data.size();
+            g_entries.erase(it);
+            return true;
+        }
+
+        void discardPrefix(const Path &dir)
+        {
+            String prefix = keyOf(dir);
+            std::lock_guard<std::mutex> f(g_flushLock);
+            std::lock_guard<std::mutex> g(g_lock);
+            for (auto it = g_entries.begin(); it != g_entries.end();)
+            {
+                if (underPrefix(it->first, prefix))
+                {
+                    g_bytes -= it->second.data.size();
+                    it = g_entries.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+
+        bool flush(const Path &p)
+        {
+            std::lock_guard<std::mutex> f(g_flushLock);
+            return flushKeyLocked(keyOf(p));
+        }
+
+        bool flushPrefix(const Path &dir)
+        {
+            String prefix = keyOf(dir);
+            std::vector<String> keys;
+            {
+                std::lock_guard<std::mutex> g(g_lock);
+                for (auto &kv : g_entries)
+                    if (underPrefix(kv.first, prefix))
+                        keys.push_back(kv.first);
+            }
+
+            bool ok = true;
+            for (const String &key : keys)
+            {
+                std::lock_guard<std::mutex> f(g_flushLock);
+                ok = flushKeyLocked(key) && ok;
+            }
+            return ok;
+        }
+
+        bool flushAll()
+        {
+            return flushPrefix(Path());
+        }
+    }
+} // namespace ENC_FS
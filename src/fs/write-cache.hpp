@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+#include "enc-fs.hpp"
+
+namespace ENC_FS
+{
+    // Encrypts `plaintext` under a fresh file version and writes it to SD (defined in enc-fs.cpp).
+    bool writeFileThrough(const Path &p, const Buffer &plaintext);
+
+    // Write-back cache for ENC_FS file contents.
+    //
+    // writeFile() hands the merged plaintext to the cache and returns after a copy; a low-priority
+    // flush task encrypts and writes it to SD once the file has been quiet for WB_FLUSH_DELAY_MS.
+    // Repeated writes to the same file coalesce into one SD write. When the cache is over budget
+    // the writer flushes synchronously (backpressure), so memory stays bounded.
+    namespace WriteCache
+    {
+        constexpr size_t WB_MAX_BYTES = 32 * 1024; // total plaintext held in the cache
+        constexpr size_t WB_MAX_ENTRIES = 16;
+        constexpr uint32_t WB_FLUSH_DELAY_MS = 300; // coalescing window after the last write
+
+        // Take ownership of `plaintext` (moved out) as the new content of `p`.
+        // Returns false if the file is too large to cache; the caller must write through.
+        bool put(const Path &p, Buffer &plaintext);
+
+        // Copy the cached content of `p` into `out`. Returns false if `p` is not cached.
+        bool get(const Path &p, Buffer &out);
+        bool contains(const Path &p);
+        long size(const Path &p);
+
+        // Drop pending content for `p` (or everything below it) without writing it.
+        // Waits for an in-flight flush of the same file so the SD state is settled afterwards.
+        bool discard(const Path &p);
+        void discardPrefix(const Path &dir);
+
+        bool flush(const Path &p);
+        bool flushPrefix(const Path &dir);
+        bool flushAll();
+    }
+} // namespace ENC_FS
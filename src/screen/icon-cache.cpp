@@ -0,0 +1,137 @@
+#include "icon-cache.hpp"
+
+#include <list>
+#include <vector>
+
+#include "index.hpp"
+#ifdef ICON_CACHE_PERSIST
+#include "../fs/enc-fs.hpp"
+#endif
+
+namespace IconCache
+{
+    struct Key
+    {
+        uint32_t fp;     // svgFingerprint() of the source
+        uint32_t length; // source length, so a fingerprint collision also needs the same size
+        int16_t w, h;
+        uint16_t color, bg;
+
+        bool operator==(const Key &o) const
+        {
+            return fp == o.fp && length == o.length && w == o.w && h == o.h && color == o.color && bg == o.bg;
+        }
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::vector<uint16_t> pixels; // transfer byte order, ready for pushRect
+    };
+
+    // front = most recently used
+    static std::list<Entry> g_lru;
+    static size_t g_ramBytes = 0;
+    static Stats g_stats;
+
+    static size_t entryBytes(const Entry &e)
+    {
+        return e.pixels.size() * sizeof(uint16_t) + sizeof(Entry);
+    }
+
+#ifdef ICON_CACHE_PERSIST
+    static String storageKey(const Key &k)
+    {
+        return String(k.fp, HEX) + "-" + String(k.length) + "-" + String(k.w) + "x" + String(k.h) + "-" +
+               String(k.color, HEX) + "-" + String(k.bg, HEX);
+    }
+
+    static bool load(const Key &k, std::vector<uint16_t> &pixels)
+    {
+        ENC_FS::Buffer buf = ENC_FS::Storage::get("icon-cache", storageKey(k));
+        if (buf.size() != pixels.size() * sizeof(uint16_t))
+            return false;
+        memcpy(pixels.data(), buf.data(), buf.size());
+        return true;
+    }
+
+    static void store(const Key &k, const std::vector<uint16_t> &pixels)
+    {
+        const uint8_t *p = (const uint8_t *)pixels.data();
+        ENC_FS::Storage::set("icon-cache", storageKey(k), ENC_FS::Buffer(p, p + pixels.size() * sizeof(uint16_t)));
+    }
+#endif
+
+    static bool render(const String &svg, const Key &k, std::vector<uint16_t> &pixels)
+    {
+#ifdef ICON_CACHE_PERSIST
+        if (load(k, pixels))
+        {
+            g_stats.diskHits++;
+            return true;
+        }
+#endif
+        NSVGimage *image = createSVG(svg);
+        if (!image)
+            return false;
+        const uint16_t bg = (k.bg >> 8) | (k.bg << 8);
+        std::fill(pixels.begin(), pixels.end(), bg);
+        if (!rasterizeSVG(image, pixels.data(), k.w, k.h, k.color))
+            return false;
+        g_stats.misses++;
+#ifdef ICON_CACHE_PERSIST
+        store(k, pixels);
+#endif
+        return true;
+    }
+
+    bool draw(const String &svg, int x, int y, int w, int h, uint16_t color, uint16_t bg)
+    {
+        if (w < 1 || h < 1 || svg.length() == 0)
+            return false;
+        if (w > MAX_SIDE || h > MAX_SIDE)
+            return drawSVGString(svg, x, y, w, h, color);
+
+        const Key key{svgFingerprint(svg), (uint32_t)svg.length(), (int16_t)w, (int16_t)h, color, bg};
+        for (auto it = g_lru.begin(); it != g_lru.end(); ++it)
+        {
+            if (!(it->key == key))
+                continue;
+            g_stats.hits++;
+            if (it != g_lru.begin())
+                g_lru.splice(g_lru.begin(), g_lru, it);
+            Screen::tft.pushRect(x, y, w, h, it->pixels.data());
+            return true;
+        }
+
+        Entry entry{key, std::vector<uint16_t>((size_t)w * h)};
+        if (!render(svg, key, entry.pixels))
+            return false;
+        Screen::tft.pushRect(x, y, w, h, entry.pixels.data());
+
+        const size_t bytes = entryBytes(entry);
+        while (!g_lru.empty() && g_ramBytes + bytes > RAM_BUDGET)
+        {
+            g_ramBytes -= entryBytes(g_lru.back());
+            g_lru.pop_back();
+            g_stats.evictions++;
+        }
+        g_lru.push_front(std::move(entry));
+        g_ramBytes += bytes;
+        return true;
+    }
+
+    void clear()
+    {
+        g_lru.clear();
+        g_ramBytes = 0;
+    }
+
+    Stats stats()
+    {
+        Stats s = g_stats;
+        s.ramBytes = g_ramBytes;
+        s.entries = g_lru.size();
+        return s;
+    }
+}
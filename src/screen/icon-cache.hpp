@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Rasterized SVG icons for UI that draws the same icon on a plain background over and over
+// (launcher shortcuts, settings). An icon is rendered once per (source, size, colour, background)
+// into an RGB565 bitmap; every later draw is a single pushRect.
+//
+// Bitmaps live in a RAM LRU. Build with -DICON_CACHE_PERSIST to also keep them in ENC_FS::Storage
+// under "icon-cache", so they survive a reboot (an encrypted SD read usually costs more than
+// rasterizing a small icon, hence off by default).
+namespace IconCache
+{
+    constexpr size_t RAM_BUDGET = 24 * 1024; // bitmap bytes
+    constexpr int MAX_SIDE = 96;             // larger icons are drawn directly
+
+    // Draw svg fitted into (x, y, w, h) over bg, which must be what the area shows
+    bool draw(const String &svg, int x, int y, int w, int h, uint16_t color, uint16_t bg);
+
+    // Drop the RAM cache (e.g. after a theme change)
+    void clear();
+
+    struct Stats
+    {
+        uint32_t hits = 0;
+        uint32_t diskHits = 0;
+        uint32_t misses = 0;
+        uint32_t evictions = 0;
+        size_t ramBytes = 0;
+        size_t entries = 0;
+    };
+
+    Stats stats();
+}
@@ -9,22 +9,34 @@ extern "C"
 #include <cstdint>
 #include <algorithm>
 #include <cstring>
+#include <cmath>
+#include <vector>
 
-// Cache size
-static constexpr int SVG_CACHE_SIZE = 4;
+// ---------------------------
+// Parse cache
+// ---------------------------
+// Parsed images stay in RAM up to a byte budget measured with svgImageBytes(). When it is full
+// the entry that is cheapest to lose goes first: score = parse time / (bytes * idle time), so a
+// large image that parsed quickly and has not been drawn for a while is evicted before a small or
+// slow one that is drawn every few seconds.
+
+static constexpr size_t SVG_CACHE_BUDGET = 48 * 1024; // all built-in icons fit
+static constexpr int SVG_CACHE_SIZE = 16;
+static constexpr unsigned long SVG_CACHE_IDLE_MS = 60000; // updateSVGList() drops older entries
 
 struct SVGImageChacheItem
 {
     NSVGimage *image = nullptr;
-    unsigned long lastUsed = 0;   // millis() when last used
-    unsigned long complexity = 0; // ms it took to parse
-    uint16_t id = 0;              // small id derived from fingerprint
-    uint32_t fp = 0;              // 32-bit fingerprint (FNV-1a)
-    bool occupied = false;
+    String source;              // compared on a fingerprint match, so collisions cannot mix images
+    unsigned long lastUsed = 0; // millis() when last used
+    uint32_t parseUs = 0;       // what it costs to get it back
+    uint32_t fp = 0;            // 32-bit fingerprint (FNV-1a)
+    size_t bytes = 0;           // image + source
 };
 
-// single cache instance
 static SVGImageChacheItem svgChache[SVG_CACHE_SIZE] = {};
+static size_t svgChacheBytes = 0;
+static SVGStats stats;
 
 // FNV-1a 32-bit
 static uint32_t fnv1a32(const char *data, size_t len)
@@ -39,75 +51,59 @@ static uint32_t fnv1a32(const char *data, size_t len)
     return hash;
 }
 
-static uint16_t getSVGChacheID(const String &svgString)
-{
-    // 16-bit id as xor of fingerprint halves and length
-    const char *s = svgString.c_str();
-    size_t len = svgString.length();
-    uint32_t fp = fnv1a32(s, len);
-    return (uint16_t)((fp & 0xFFFFu) ^ ((fp >> 16) & 0xFFFFu) ^ (uint16_t)len);
-}
-
-static uint32_t getSVGFingerprint(const String &svgString)
+uint32_t svgFingerprint(const String &svgString)
 {
     return fnv1a32(svgString.c_str(), svgString.length());
 }
 
-static size_t cacheSize()
+static void dropEntry(SVGImageChacheItem &item)
 {
-    return SVG_CACHE_SIZE;
+    if (!item.image)
+        return;
+    deleteSVG(item.image);
+    svgChacheBytes -= item.bytes;
+    item = SVGImageChacheItem();
 }
 
-void updateSVGList()
+// Lowest value first: cheap to parse again, large and idle
+static int evictionCandidate(unsigned long now)
 {
-    unsigned long now = millis();
-    for (size_t i = 0; i < cacheSize(); ++i)
+    int best = -1;
+    float bestScore = 0;
+    for (int i = 0; i < SVG_CACHE_SIZE; ++i)
     {
-        if (svgChache[i].occupied && svgChache[i].image)
+        const SVGImageChacheItem &item = svgChache[i];
+        if (!item.image)
+            continue;
+        // subtract safely to handle millis overflow
+        const float idle = (float)(now - item.lastUsed) + 1.0f;
+        const float score = (item.parseUs + 1.0f) / ((float)item.bytes * idle);
+        if (best < 0 || score < bestScore)
         {
-            // subtract safely to handle millis overflow
-            unsigned long age = now - svgChache[i].lastUsed;
-            if (age > 1000UL) // older than 1 second
-            {
-                nsvgDelete(svgChache[i].image);
-                svgChache[i].image = nullptr;
-                svgChache[i].occupied = false;
-                svgChache[i].fp = 0;
-                svgChache[i].id = 0;
-                svgChache[i].complexity = 0;
-                svgChache[i].lastUsed = 0;
-            }
+            best = i;
+            bestScore = score;
         }
     }
+    return best;
 }
 
-void clearList()
+void updateSVGList()
 {
-    for (size_t i = 0; i < cacheSize(); ++i)
+    unsigned long now = millis();
+    for (int i = 0; i < SVG_CACHE_SIZE; ++i)
     {
-        if (svgChache[i].occupied)
+        if (svgChache[i].image && now - svgChache[i].lastUsed > SVG_CACHE_IDLE_MS)
         {
-            if (svgChache[i].image)
-            {
-                nsvgDelete(svgChache[i].image);
-            }
-            svgChache[i].image = nullptr;
-            svgChache[i].occupied = false;
-            svgChache[i].fp = 0;
-            svgChache[i].id = 0;
-            svgChache[i].complexity = 0;
-            svgChache[i].lastUsed = 0;
+            dropEntry(svgChache[i]);
+            stats.evictions++;
         }
     }
 }
 
-// Return true if cache is empty
-static bool cacheIsEmpty()
+void clearList()
 {
-    for (size_t i = 0; i < cacheSize(); ++i)
-        if (svgChache[i].occupied)
-            return false;
-    return true;
+    for (int i = 0; i < SVG_CACHE_SIZE; ++i)
+        dropEntry(svgChache[i]);
 }
 
 static NSVGimage *tryParseSVG(const String &svgString)
@@ -124,160 +120,855 @@ static NSVGimage *tryParseSVG(const String &svgString)
     return image;
 }
 
+NSVGimage *parseSVG(const String &svgString)
+{
+    return svgString.length() ? tryParseSVG(svgString) : nullptr;
+}
+
 NSVGimage *createSVG(const String &svgString)
 {
     if (svgString.length() == 0)
         return nullptr;
 
-    const uint32_t fp = getSVGFingerprint(svgString);
-    const uint16_t id = getSVGChacheID(svgString);
+    const uint32_t fp = svgFingerprint(svgString);
     unsigned long now = millis();
 
-    // 1) try to find in cache by fingerprint + id
-    for (size_t i = 0; i < cacheSize(); ++i)
+    // 1) try to find in cache by fingerprint, then the whole source
+    for (int i = 0; i < SVG_CACHE_SIZE; ++i)
     {
-        if (svgChache[i].occupied && svgChache[i].fp == fp && svgChache[i].id == id && svgChache[i].image)
+        SVGImageChacheItem &item = svgChache[i];
+        if (!item.image || item.fp != fp)
+            continue;
+        if (item.source != svgString)
         {
-            // cache hit
-            svgChache[i].lastUsed = now;
-            return svgChache[i].image;
+            stats.collisions++;
+            continue;
         }
+        // cache hit
+        stats.hits++;
+        item.lastUsed = now;
+        return item.image;
     }
 
     // Not found: attempt to parse
-    unsigned long t0 = millis();
+    stats.misses++;
+    uint32_t t0 = micros();
     NSVGimage *image = tryParseSVG(svgString);
-    unsigned long t1 = millis();
-    unsigned long complexity = (image) ? (t1 - t0) : 0;
 
     if (!image)
     {
-        // Parsing failed: free existing cache and attempt parse again (user requested)
+        // Parsing failed: free existing cache and attempt parse again (memory might now be available)
         clearList();
-
-        // Try parsing again after clearing cache (memory might now be available)
-        t0 = millis();
+        t0 = micros();
         image = tryParseSVG(svgString);
-        t1 = millis();
-        complexity = (image) ? (t1 - t0) : 0;
-
         if (!image)
         {
-            // Still failed: return nullptr
+            stats.parseFailures++;
             return nullptr;
         }
-        // else we have an image after clearing cache — continue to insert into cache
     }
 
-    // find a slot: first empty, else the one with largest age (not used longest)
+    const uint32_t parseUs = micros() - t0;
+    stats.parseUs += parseUs;
+    stats.maxParseUs = std::max(stats.maxParseUs, parseUs);
+
+    const size_t bytes = svgImageBytes(image) + svgString.length() + sizeof(SVGImageChacheItem);
+
+    // make room: a free slot and enough budget; an image larger than the whole budget still gets a
+    // slot of its own so the caller can draw it
     int chosen = -1;
-    for (size_t i = 0; i < cacheSize(); ++i)
+    for (;;)
     {
-        if (!svgChache[i].occupied)
-        {
-            chosen = (int)i;
+        chosen = -1;
+        for (int i = 0; i < SVG_CACHE_SIZE; ++i)
+            if (!svgChache[i].image)
+            {
+                chosen = i;
+                break;
+            }
+        if (chosen >= 0 && svgChacheBytes + bytes <= SVG_CACHE_BUDGET)
+            break;
+        int victim = evictionCandidate(now);
+        if (victim < 0)
             break;
+        dropEntry(svgChache[victim]);
+        stats.evictions++;
+    }
+
+    SVGImageChacheItem &item = svgChache[chosen];
+    item.image = image;
+    item.source = svgString;
+    item.lastUsed = now;
+    item.parseUs = parseUs;
+    item.fp = fp;
+    item.bytes = bytes;
+    svgChacheBytes += bytes;
+
+    return image;
+}
+
+SVGStats svgStats()
+{
+    SVGStats s = stats;
+    s.bytes = svgChacheBytes;
+    s.entries = 0;
+    for (int i = 0; i < SVG_CACHE_SIZE; ++i)
+        if (svgChache[i].image)
+            s.entries++;
+    return s;
+}
+
+void printSVGStats()
+{
+    SVGStats s = svgStats();
+    Serial.printf("[SVG] hit=%u miss=%u fail=%u collide=%u evict=%u parse=%lums max=%luus | %u images %u/%u bytes | outlines built=%u reused=%u\n",
+                  s.hits, s.misses, s.parseFailures, s.collisions, s.evictions,
+                  (unsigned long)(s.parseUs / 1000), (unsigned long)s.maxParseUs,
+                  (unsigned)s.entries, (unsigned)s.bytes, (unsigned)SVG_CACHE_BUDGET,
+                  s.outlineMisses, s.outlineHits);
+}
+
+bool drawSVGString(const String &imageStr,
+                   int xOff, int yOff,
+                   int targetW, int targetH,
+                   uint16_t color, float tolerance)
+{
+    return drawSVGString(Screen::tft, imageStr, xOff, yOff, targetW, targetH, color, tolerance);
+}
+
+bool drawSVGString(TFT_eSPI &gfx, const String &imageStr,
+                   int xOff, int yOff,
+                   int targetW, int targetH,
+                   uint16_t color, float tolerance)
+{
+    return drawSVGImage(gfx, createSVG(imageStr), xOff, yOff, targetW, targetH, color, tolerance);
+}
+
+bool drawSVGString(TFT_eSprite &sprite, const String &imageStr,
+                   int xOff, int yOff,
+                   int targetW, int targetH,
+                   uint16_t color, float tolerance)
+{
+    return drawSVGImage(sprite, createSVG(imageStr), xOff, yOff, targetW, targetH, color, tolerance);
+}
+
+size_t svgImageBytes(const NSVGimage *image)
+{
+    if (!image)
+        return 0;
+    size_t bytes = sizeof(NSVGimage);
+    for (NSVGshape *shape = image->shapes; shape; shape = shape->next)
+    {
+        bytes += sizeof(NSVGshape);
+        for (NSVGpath *path = shape->paths; path; path = path->next)
+            bytes += sizeof(NSVGpath) + path->npts * 2 * sizeof(float);
+    }
+    return bytes;
+}
+
+// ---------------------------
+// Scanline rasterizer
+// ---------------------------
+// Every shape is flattened into an edge list in device pixels: one layer for the fill (with the
+// shape's fill rule) and one for the stroke (expanded into polygons, nonzero). Each pixel row is
+// sampled on SVG_SUBSAMPLES scanlines with exact horizontal coverage, the layers are composited
+// into one alpha per pixel and blended over what is already on the target. The icon is processed
+// in bands of at most SVG_BAND_PIXELS: one read and one push per band instead of one bus
+// transaction per line segment.
+
+static constexpr int SVG_SUBSAMPLES = 4;
+static constexpr int SVG_BAND_PIXELS = 1024;
+
+struct SVGEdge
+{
+    float x0, y0, y1; // x at y0, y0 < y1
+    float dxdy;
+    int8_t dir; // +1 downwards, -1 upwards
+};
+
+struct SVGLayer
+{
+    uint32_t first = 0, count = 0; // range in svgEdges
+    bool evenOdd = false;
+    float alpha = 1.0f;
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+};
+
+// Reused between draws, they only grow
+static std::vector<SVGEdge> svgEdges;
+static std::vector<SVGLayer> svgLayers;
+static std::vector<float> svgLine; // flattened path, x/y pairs
+static std::vector<float> svgPoly; // one stroke piece, x/y pairs
+static std::vector<uint32_t> svgActive;
+static std::vector<std::pair<float, int8_t>> svgCross;
+static std::vector<float> svgCover, svgAlpha;
+static std::vector<uint16_t> svgPixels;
+
+// ---------------------------
+// Flattened outlines
+// ---------------------------
+// Curves are subdivided until the control points lie within the tolerance of the chord, so flat
+// stretches become one line and tight bends get as many as they need. The polyline of every path
+// is kept per (image, scale) so redrawing an icon at the same size does no curve math at all.
+
+static constexpr int SVG_OUTLINE_CACHE = 8;
+static constexpr int SVG_MAX_SUBDIVISION = 10;
+
+struct SVGOutline
+{
+    const NSVGimage *image = nullptr;
+    float scale = 0, tolerance = 0;
+    float *pts = nullptr;     // x/y pairs in scaled image units, no offset
+    uint32_t *ends = nullptr; // end of each path in pts (shape and path order)
+    uint32_t npts = 0, paths = 0;
+    unsigned long lastUsed = 0;
+};
+
+// Plain buffers like svgChache: nothing to tear down when images are freed from destructors
+static SVGOutline svgOutlines[SVG_OUTLINE_CACHE];
+static std::vector<float> svgOutlinePts;
+static std::vector<uint32_t> svgOutlineEnds;
+
+static void flattenCubic(std::vector<float> &out,
+                         float x1, float y1, float x2, float y2,
+                         float x3, float y3, float x4, float y4,
+                         float tolerance, int level)
+{
+    const float dx = x4 - x1, dy = y4 - y1;
+    const float chord2 = dx * dx + dy * dy;
+    bool flat;
+    if (chord2 > 1e-6f)
+    {
+        // distances of the control points from the chord, times the chord length
+        const float d2 = fabsf((x2 - x4) * dy - (y2 - y4) * dx);
+        const float d3 = fabsf((x3 - x4) * dy - (y3 - y4) * dx);
+        flat = (d2 + d3) * (d2 + d3) < tolerance * tolerance * chord2;
+    }
+    else
+    {
+        // closed loop: measure the control points from the end point instead
+        const float a = (x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1);
+        const float b = (x3 - x1) * (x3 - x1) + (y3 - y1) * (y3 - y1);
+        flat = std::max(a, b) < tolerance * tolerance;
+    }
+
+    if (flat || level >= SVG_MAX_SUBDIVISION)
+    {
+        out.push_back(x4);
+        out.push_back(y4);
+        return;
+    }
+
+    // de Casteljau split at t = 0.5
+    const float x12 = (x1 + x2) * 0.5f, y12 = (y1 + y2) * 0.5f;
+    const float x23 = (x2 + x3) * 0.5f, y23 = (y2 + y3) * 0.5f;
+    const float x34 = (x3 + x4) * 0.5f, y34 = (y3 + y4) * 0.5f;
+    const float x123 = (x12 + x23) * 0.5f, y123 = (y12 + y23) * 0.5f;
+    const float x234 = (x23 + x34) * 0.5f, y234 = (y23 + y34) * 0.5f;
+    const float xm = (x123 + x234) * 0.5f, ym = (y123 + y234) * 0.5f;
+
+    flattenCubic(out, x1, y1, x12, y12, x123, y123, xm, ym, tolerance, level + 1);
+    flattenCubic(out, xm, ym, x234, y234, x34, y34, x4, y4, tolerance, level + 1);
+}
+
+// Flatten every path of the image into svgOutlinePts / svgOutlineEnds
+static void flattenImage(const NSVGimage *image, float scale, float tolerance)
+{
+    std::vector<float> &out = svgOutlinePts;
+    out.clear();
+    svgOutlineEnds.clear();
+    for (NSVGshape *shape = image->shapes; shape; shape = shape->next)
+    {
+        for (NSVGpath *path = shape->paths; path; path = path->next)
+        {
+            const size_t start = out.size();
+            const float *p = path->pts;
+            if (path->npts > 0)
+            {
+                out.push_back(p[0] * scale);
+                out.push_back(p[1] * scale);
+            }
+            for (int i = 0; i + 3 < path->npts; i += 3)
+            {
+                const float *c = &p[i * 2];
+                flattenCubic(out,
+                             c[0] * scale, c[1] * scale, c[2] * scale, c[3] * scale,
+                             c[4] * scale, c[5] * scale, c[6] * scale, c[7] * scale,
+                             tolerance, 0);
+            }
+
+            // drop repeated points
+            size_t end = std::min(out.size(), start + 2);
+            for (size_t i = start + 2; i < out.size(); i += 2)
+            {
+                if (fabsf(out[i] - out[end - 2]) < 0.01f && fabsf(out[i + 1] - out[end - 1]) < 0.01f)
+                    continue;
+                out[end++] = out[i];
+                out[end++] = out[i + 1];
+            }
+            out.resize(end);
+            svgOutlineEnds.push_back(end);
         }
     }
+}
+
+static void releaseOutline(SVGOutline &o)
+{
+    free(o.pts);
+    free(o.ends);
+    o = SVGOutline();
+}
 
-    unsigned long now2 = millis();
-    if (chosen == -1)
+static const SVGOutline &getOutline(const NSVGimage *image, float scale, float tolerance)
+{
+    const unsigned long now = millis();
+    int chosen = 0;
+    for (int i = 0; i < SVG_OUTLINE_CACHE; i++)
     {
-        // all occupied: pick the one with oldest lastUsed (largest now - lastUsed)
-        unsigned long bestAge = 0;
-        int bestIndex = 0;
-        for (size_t i = 0; i < cacheSize(); ++i)
+        SVGOutline &o = svgOutlines[i];
+        if (o.image == image && o.scale == scale && o.tolerance == tolerance)
         {
-            unsigned long age = now2 - svgChache[i].lastUsed;
-            if (age >= bestAge)
+            stats.outlineHits++;
+            o.lastUsed = now;
+            return o;
+        }
+        if (!o.image || (svgOutlines[chosen].image && now - o.lastUsed > now - svgOutlines[chosen].lastUsed))
+            chosen = i;
+    }
+
+    stats.outlineMisses++;
+    flattenImage(image, scale, tolerance);
+
+    SVGOutline &o = svgOutlines[chosen];
+    releaseOutline(o);
+    o.pts = (float *)malloc(svgOutlinePts.size() * sizeof(float) + 1);
+    o.ends = (uint32_t *)malloc(svgOutlineEnds.size() * sizeof(uint32_t) + 1);
+    if (!o.pts || !o.ends)
+    {
+        // no room to keep it: draw from the scratch buffers this once
+        releaseOutline(o);
+        static SVGOutline scratch;
+        scratch.pts = svgOutlinePts.data();
+        scratch.ends = svgOutlineEnds.data();
+        scratch.npts = svgOutlinePts.size();
+        scratch.paths = svgOutlineEnds.size();
+        return scratch;
+    }
+    memcpy(o.pts, svgOutlinePts.data(), svgOutlinePts.size() * sizeof(float));
+    memcpy(o.ends, svgOutlineEnds.data(), svgOutlineEnds.size() * sizeof(uint32_t));
+    o.npts = svgOutlinePts.size();
+    o.paths = svgOutlineEnds.size();
+    o.image = image;
+    o.scale = scale;
+    o.tolerance = tolerance;
+    o.lastUsed = now;
+    return o;
+}
+
+static void forgetOutlines(const NSVGimage *image)
+{
+    for (SVGOutline &o : svgOutlines)
+        if (o.image == image)
+            releaseOutline(o);
+}
+
+void deleteSVG(NSVGimage *image)
+{
+    if (!image)
+        return;
+    forgetOutlines(image);
+    nsvgDelete(image);
+}
+
+// One cached path into svgLine, moved to the draw position
+static void placePath(const SVGOutline &outline, size_t index, float xOff, float yOff)
+{
+    const size_t start = index ? outline.ends[index - 1] : 0;
+    const size_t end = outline.ends[index];
+    svgLine.resize(end - start);
+    for (size_t i = start; i < end; i += 2)
+    {
+        svgLine[i - start] = outline.pts[i] + xOff;
+        svgLine[i - start + 1] = outline.pts[i + 1] + yOff;
+    }
+}
+
+// Closed polygon into the edge list of the last layer; oriented polygons all wind the same way
+// so overlapping stroke pieces add up under nonzero instead of cancelling
+static void addPolygon(const float *pts, size_t n, bool oriented)
+{
+    if (n < 3)
+        return;
+
+    int8_t flip = 1;
+    if (oriented)
+    {
+        float area = 0;
+        for (size_t i = 0, j = n - 1; i < n; j = i++)
+            area += pts[j * 2] * pts[i * 2 + 1] - pts[i * 2] * pts[j * 2 + 1];
+        flip = area < 0 ? -1 : 1;
+    }
+
+    SVGLayer &layer = svgLayers.back();
+    for (size_t i = 0, j = n - 1; i < n; j = i++)
+    {
+        float x0 = pts[j * 2], y0 = pts[j * 2 + 1];
+        float x1 = pts[i * 2], y1 = pts[i * 2 + 1];
+        if (layer.count == 0 && i == 0)
+        {
+            layer.minX = layer.maxX = x0;
+            layer.minY = layer.maxY = y0;
+        }
+        layer.minX = std::min(layer.minX, x1);
+        layer.maxX = std::max(layer.maxX, x1);
+        layer.minY = std::min(layer.minY, y1);
+        layer.maxY = std::max(layer.maxY, y1);
+
+        if (y0 == y1)
+            continue;
+        int8_t dir = flip;
+        if (y0 > y1)
+        {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+            dir = -dir;
+        }
+        svgEdges.push_back({x0, y0, y1, (x1 - x0) / (y1 - y0), dir});
+        layer.count++;
+    }
+}
+
+static void addDisc(float cx, float cy, float r)
+{
+    const int n = std::max(6, std::min(32, (int)(r * 4)));
+    svgPoly.clear();
+    for (int i = 0; i < n; i++)
+    {
+        const float a = i * 6.2831853f / n;
+        svgPoly.push_back(cx + cosf(a) * r);
+        svgPoly.push_back(cy + sinf(a) * r);
+    }
+    addPolygon(svgPoly.data(), n, true);
+}
+
+static void addQuad(float ax, float ay, float bx, float by, float cx, float cy, float dx, float dy)
+{
+    const float q[8] = {ax, ay, bx, by, cx, cy, dx, dy};
+    addPolygon(q, 4, true);
+}
+
+// Outer corner between two segments meeting at (x, y); the inner side is covered by the segments
+static void addJoin(const NSVGshape *shape, float x, float y,
+                    float px, float py, float nx, float ny, float hw)
+{
+    if (shape->strokeLineJoin == NSVG_JOIN_ROUND)
+    {
+        addDisc(x, y, hw);
+        return;
+    }
+
+    const float cross = px * ny - py * nx;
+    if (fabsf(cross) < 1e-4f && px * nx + py * ny > 0)
+        return; // straight on
+
+    // unit normals turned to the outer side
+    const float side = cross > 0 ? -1.0f : 1.0f;
+    const float ax = -py * side, ay = px * side;
+    const float bx = -ny * side, by = nx * side;
+
+    const float sx = ax + bx, sy = ay + by;
+    const float len2 = sx * sx + sy * sy;
+    if (shape->strokeLineJoin == NSVG_JOIN_MITER && len2 > 1e-6f && 2.0f / sqrtf(len2) <= shape->miterLimit)
+    {
+        const float k = 2.0f * hw / len2;
+        addQuad(x, y, x + ax * hw, y + ay * hw, x + sx * k, y + sy * k, x + bx * hw, y + by * hw);
+        return;
+    }
+    const float tri[6] = {x, y, x + ax * hw, y + ay * hw, x + bx * hw, y + by * hw};
+    addPolygon(tri, 3, true);
+}
+
+// svgLine as a stroke of half width hw: one quad per segment plus joins and caps
+static void addStroke(const NSVGshape *shape, bool closed, float hw)
+{
+    size_t n = svgLine.size() / 2;
+    const float *p = svgLine.data();
+    if (closed && n > 2 && fabsf(p[0] - p[n * 2 - 2]) < 0.01f && fabsf(p[1] - p[n * 2 - 1]) < 0.01f)
+        n--;
+    if (n < 2)
+        closed = false;
+
+    if (n == 1 || (n == 2 && !closed && p[0] == p[2] && p[1] == p[3]))
+    {
+        // a dot: only caps give it an area
+        if (shape->strokeLineCap == NSVG_CAP_ROUND)
+            addDisc(p[0], p[1], hw);
+        else if (shape->strokeLineCap == NSVG_CAP_SQUARE)
+            addQuad(p[0] - hw, p[1] - hw, p[0] + hw, p[1] - hw, p[0] + hw, p[1] + hw, p[0] - hw, p[1] + hw);
+        return;
+    }
+
+    const size_t segments = closed ? n : n - 1;
+    float firstDx = 0, firstDy = 0, lastDx = 0, lastDy = 0;
+    for (size_t s = 0; s < segments; s++)
+    {
+        float x0 = p[s * 2], y0 = p[s * 2 + 1];
+        float x1 = p[((s + 1) % n) * 2], y1 = p[((s + 1) % n) * 2 + 1];
+        float dx = x1 - x0, dy = y1 - y0;
+        const float len = sqrtf(dx * dx + dy * dy);
+        if (len <= 0)
+            continue;
+        dx /= len;
+        dy /= len;
+
+        if (s == 0)
+        {
+            firstDx = dx;
+            firstDy = dy;
+        }
+        else
+            addJoin(shape, x0, y0, lastDx, lastDy, dx, dy, hw);
+        lastDx = dx;
+        lastDy = dy;
+
+        if (!closed && shape->strokeLineCap == NSVG_CAP_SQUARE)
+        {
+            if (s == 0)
+            {
+                x0 -= dx * hw;
+                y0 -= dy * hw;
+            }
+            if (s == segments - 1)
             {
-                bestAge = age;
-                bestIndex = (int)i;
+                x1 += dx * hw;
+                y1 += dy * hw;
             }
         }
-        chosen = bestIndex;
+
+        const float ox = -dy * hw, oy = dx * hw;
+        addQuad(x0 + ox, y0 + oy, x1 + ox, y1 + oy, x1 - ox, y1 - oy, x0 - ox, y0 - oy);
     }
 
-    // Replace chosen slot (free previous image if any)
-    if (svgChache[chosen].occupied && svgChache[chosen].image)
+    if (closed)
+        addJoin(shape, p[0], p[1], lastDx, lastDy, firstDx, firstDy, hw);
+    else if (shape->strokeLineCap == NSVG_CAP_ROUND)
     {
-        nsvgDelete(svgChache[chosen].image);
+        addDisc(p[0], p[1], hw);
+        addDisc(p[n * 2 - 2], p[n * 2 - 1], hw);
     }
+}
+
+static float paintAlpha(const NSVGpaint &paint, float opacity)
+{
+    if (paint.type == NSVG_PAINT_NONE)
+        return 0;
+    // gradients are tinted like solid paint, only the alpha of a plain colour counts
+    const float a = paint.type == NSVG_PAINT_COLOR ? ((paint.color >> 24) & 0xFF) / 255.0f : 1.0f;
+    return a * opacity;
+}
+
+// Edge list for the whole image in device pixels
+static void buildLayers(NSVGimage *image, float scale, float xOff, float yOff, float tolerance)
+{
+    svgEdges.clear();
+    svgLayers.clear();
+    if (!(tolerance >= 0.01f))
+        tolerance = 0.01f;
+
+    const SVGOutline &outline = getOutline(image, scale, tolerance);
+    stats.segments = outline.npts / 2 - outline.paths;
+    size_t first = 0; // first path of the current shape in the outline
+    for (NSVGshape *shape = image->shapes; shape; shape = shape->next)
+    {
+        size_t paths = 0;
+        for (NSVGpath *path = shape->paths; path; path = path->next)
+            paths++;
+        const size_t base = first;
+        first += paths;
 
-    svgChache[chosen].image = image;
-    svgChache[chosen].lastUsed = now2;
-    svgChache[chosen].complexity = complexity;
-    svgChache[chosen].id = id;
-    svgChache[chosen].fp = fp;
-    svgChache[chosen].occupied = true;
+        if (!(shape->flags & NSVG_FLAGS_VISIBLE))
+            continue;
 
-    return image;
+        const float fillAlpha = paintAlpha(shape->fill, shape->opacity);
+        if (fillAlpha > 0)
+        {
+            svgLayers.emplace_back();
+            svgLayers.back().first = svgEdges.size();
+            svgLayers.back().evenOdd = shape->fillRule == NSVG_FILLRULE_EVENODD;
+            svgLayers.back().alpha = fillAlpha;
+            for (size_t i = 0; i < paths; i++)
+            {
+                placePath(outline, base + i, xOff, yOff);
+                addPolygon(svgLine.data(), svgLine.size() / 2, false);
+            }
+            if (svgLayers.back().count == 0)
+                svgLayers.pop_back();
+        }
+
+        const float strokeAlpha = paintAlpha(shape->stroke, shape->opacity);
+        if (strokeAlpha > 0 && shape->strokeWidth > 0)
+        {
+            // keep hairlines at least a pixel wide so small icons do not fade out
+            const float hw = std::max(0.5f, shape->strokeWidth * scale * 0.5f);
+            svgLayers.emplace_back();
+            svgLayers.back().first = svgEdges.size();
+            svgLayers.back().alpha = strokeAlpha;
+            size_t i = base;
+            for (NSVGpath *path = shape->paths; path; path = path->next, i++)
+            {
+                placePath(outline, i, xOff, yOff);
+                addStroke(shape, path->closed, hw);
+            }
+            if (svgLayers.back().count == 0)
+                svgLayers.pop_back();
+        }
+    }
 }
 
-bool drawSVGString(const String &imageStr,
-                   int xOff, int yOff,
-                   int targetW, int targetH,
-                   uint16_t color, int steps)
+// Add [xa, xb) of one sub-scanline to a coverage row of width w
+static inline void coverSpan(float *row, int w, float xa, float xb, float weight)
+{
+    xa = std::max(xa, 0.0f);
+    xb = std::min(xb, (float)w);
+    if (xb <= xa)
+        return;
+    const int ia = (int)xa, ib = (int)xb;
+    if (ia == ib)
+    {
+        row[ia] += (xb - xa) * weight;
+        return;
+    }
+    row[ia] += (ia + 1 - xa) * weight;
+    for (int i = ia + 1; i < ib; i++)
+        row[i] += weight;
+    if (ib < w)
+        row[ib] += (xb - ib) * weight;
+}
+
+// Coverage of one layer over the band (x0, y0, w, h) into svgCover
+static void coverLayer(const SVGLayer &layer, int x0, int y0, int w, int h)
+{
+    std::fill(svgCover.begin(), svgCover.begin() + w * h, 0.0f);
+
+    svgActive.clear();
+    for (uint32_t i = layer.first; i < layer.first + layer.count; i++)
+        if (svgEdges[i].y0 < y0 + h && svgEdges[i].y1 > y0)
+            svgActive.push_back(i);
+
+    const float weight = 1.0f / SVG_SUBSAMPLES;
+    for (int r = 0; r < h; r++)
+    {
+        float *row = &svgCover[r * w];
+        for (int s = 0; s < SVG_SUBSAMPLES; s++)
+        {
+            const float sy = y0 + r + (s + 0.5f) * weight;
+            svgCross.clear();
+            for (uint32_t i : svgActive)
+            {
+                const SVGEdge &e = svgEdges[i];
+                if (sy >= e.y0 && sy < e.y1)
+                    svgCross.push_back({e.x0 + (sy - e.y0) * e.dxdy - x0, e.dir});
+            }
+            if (svgCross.size() < 2)
+                continue;
+            std::sort(svgCross.begin(), svgCross.end(),
+                      [](const std::pair<float, int8_t> &a, const std::pair<float, int8_t> &b)
+                      { return a.first < b.first; });
+
+            int winding = 0;
+            for (size_t k = 0; k + 1 < svgCross.size(); k++)
+            {
+                winding += svgCross[k].second;
+                if (layer.evenOdd ? (winding & 1) : winding != 0)
+                    coverSpan(row, w, svgCross[k].first, svgCross[k + 1].first, weight);
+            }
+        }
+    }
+}
+
+// Where the blended pixels go: the panel via readRect/pushRect (transfer byte order), a 16-bit
+// sprite straight in its buffer (swapped as well), any other sprite pixel by pixel
+struct SVGPanelTarget
+{
+    TFT_eSPI &gfx;
+    void read(int x, int y, int w, int h, uint16_t *px)
+    {
+        gfx.readRect(x, y, w, h, px);
+        for (int i = 0; i < w * h; i++)
+            px[i] = (px[i] >> 8) | (px[i] << 8);
+    }
+    void write(int x, int y, int w, int h, uint16_t *px)
+    {
+        for (int i = 0; i < w * h; i++)
+            px[i] = (px[i] >> 8) | (px[i] << 8);
+        gfx.pushRect(x, y, w, h, px);
+    }
+};
+
+// 16-bit pixels in memory in transfer byte order, like a sprite buffer
+struct SVGMemoryTarget
+{
+    uint16_t *pixels;
+    int stride;
+    void read(int x, int y, int w, int h, uint16_t *px)
+    {
+        for (int r = 0; r < h; r++)
+            for (int c = 0; c < w; c++)
+            {
+                uint16_t v = pixels[(y + r) * stride + x + c];
+                px[r * w + c] = (v >> 8) | (v << 8);
+            }
+    }
+    void write(int x, int y, int w, int h, uint16_t *px)
+    {
+        for (int r = 0; r < h; r++)
+            for (int c = 0; c < w; c++)
+            {
+                uint16_t v = px[r * w + c];
+                pixels[(y + r) * stride + x + c] = (v >> 8) | (v << 8);
+            }
+    }
+};
+
+struct SVGSpriteTarget
+{
+    TFT_eSprite &sprite;
+    void read(int x, int y, int w, int h, uint16_t *px)
+    {
+        if (sprite.getColorDepth() == 16)
+            return SVGMemoryTarget{(uint16_t *)sprite.getPointer(), sprite.width()}.read(x, y, w, h, px);
+        for (int r = 0; r < h; r++)
+            for (int c = 0; c < w; c++)
+                px[r * w + c] = sprite.readPixel(x + c, y + r);
+    }
+    void write(int x, int y, int w, int h, uint16_t *px)
+    {
+        if (sprite.getColorDepth() == 16)
+            return SVGMemoryTarget{(uint16_t *)sprite.getPointer(), sprite.width()}.write(x, y, w, h, px);
+        for (int r = 0; r < h; r++)
+            for (int c = 0; c < w; c++)
+                sprite.drawPixel(x + c, y + r, px[r * w + c]);
+    }
+};
+
+// Draw into target, clipped to (0, 0, clipW, clipH)
+template <typename Target>
+static bool renderSVG(int clipW, int clipH, Target target, NSVGimage *image,
+                         int xOff, int yOff, int targetW, int targetH,
+                         uint16_t color, float tolerance)
 {
-    NSVGimage *image = createSVG(imageStr);
     if (!image || image->width <= 0 || image->height <= 0)
     {
         return false;
     }
 
-    // Compute scale once
     const float scale = std::min(
         (float)targetW / image->width,
         (float)targetH / image->height);
 
-    // Loop shapes
-    for (NSVGshape *shape = image->shapes; shape; shape = shape->next)
+    buildLayers(image, scale, xOff, yOff, tolerance);
+    if (svgLayers.empty())
+        return true;
+
+    float minX = svgLayers[0].minX, minY = svgLayers[0].minY;
+    float maxX = svgLayers[0].maxX, maxY = svgLayers[0].maxY;
+    for (const SVGLayer &layer : svgLayers)
     {
-        for (NSVGpath *path = shape->paths; path; path = path->next)
-        {
-            const float *pts = path->pts;
-            const int npts = path->npts;
+        minX = std::min(minX, layer.minX);
+        minY = std::min(minY, layer.minY);
+        maxX = std::max(maxX, layer.maxX);
+        maxY = std::max(maxY, layer.maxY);
+    }
+
+    // only what can reach the target
+    const int x0 = std::max(0, (int)floorf(minX));
+    const int y0 = std::max(0, (int)floorf(minY));
+    const int x1 = std::min(clipW, (int)ceilf(maxX));
+    const int y1 = std::min(clipH, (int)ceilf(maxY));
+    if (x1 <= x0 || y1 <= y0)
+        return true;
+
+    const int w = x1 - x0;
+    const int bandRows = std::max(1, std::min(y1 - y0, SVG_BAND_PIXELS / w));
+    if (svgCover.size() < (size_t)(w * bandRows))
+    {
+        svgCover.resize(w * bandRows);
+        svgAlpha.resize(w * bandRows);
+        svgPixels.resize(w * bandRows);
+    }
 
-            // Iterate through cubic bezier segments
-            for (int i = 0; i < npts - 1; i += 3)
+    for (int by = y0; by < y1; by += bandRows)
+    {
+        const int h = std::min(bandRows, y1 - by);
+        std::fill(svgAlpha.begin(), svgAlpha.begin() + w * h, 0.0f);
+
+        bool touched = false;
+        for (const SVGLayer &layer : svgLayers)
+        {
+            if (layer.maxY <= by || layer.minY >= by + h)
+                continue;
+            coverLayer(layer, x0, by, w, h);
+            // layers stack like paint: what is left uncovered shows through
+            for (int i = 0; i < w * h; i++)
             {
-                // Pre-scale + offset once per control point
-                const float x1 = pts[i * 2 + 0] * scale + xOff;
-                const float y1 = pts[i * 2 + 1] * scale + yOff;
-                const float x2 = pts[(i + 1) * 2 + 0] * scale + xOff;
-                const float y2 = pts[(i + 1) * 2 + 1] * scale + yOff;
-                const float x3 = pts[(i + 2) * 2 + 0] * scale + xOff;
-                const float y3 = pts[(i + 2) * 2 + 1] * scale + yOff;
-                const float x4 = pts[(i + 3) * 2 + 0] * scale + xOff;
-                const float y4 = pts[(i + 3) * 2 + 1] * scale + yOff;
-
-                float px = x1, py = y1;
-
-                // Use De Casteljau’s algorithm to avoid repeated powf/multiplications
-                for (int s = 1; s <= steps; s++)
+                const float c = std::min(svgCover[i], 1.0f) * layer.alpha;
+                svgAlpha[i] += (1.0f - svgAlpha[i]) * c;
+            }
+            touched = true;
+        }
+        if (!touched)
+            continue;
+
+        // only the rectangle that got any paint goes over the bus
+        int c0 = w, c1 = -1, r0 = h, r1 = -1;
+        for (int r = 0; r < h; r++)
+            for (int c = 0; c < w; c++)
+                if (svgAlpha[r * w + c] >= 0.5f / 255)
                 {
-                    const float t = (float)s / steps;
-                    const float it = 1.0f - t;
-
-                    const float bx =
-                        it * it * it * x1 +
-                        3 * it * it * t * x2 +
-                        3 * it * t * t * x3 +
-                        t * t * t * x4;
-
-                    const float by =
-                        it * it * it * y1 +
-                        3 * it * it * t * y2 +
-                        3 * it * t * t * y3 +
-                        t * t * t * y4;
-
-                    Screen::tft.drawLine((int)px, (int)py, (int)bx, (int)by, color);
-                    px = bx;
-                    py = by;
+                    c0 = std::min(c0, c);
+                    c1 = std::max(c1, c);
+                    r0 = std::min(r0, r);
+                    r1 = std::max(r1, r);
                 }
+        if (c1 < 0)
+            continue;
+
+        const int cw = c1 - c0 + 1, rh = r1 - r0 + 1;
+        uint16_t *px = svgPixels.data();
+        target.read(x0 + c0, by + r0, cw, rh, px);
+        for (int r = 0; r < rh; r++)
+            for (int c = 0; c < cw; c++)
+            {
+                const uint8_t a = (uint8_t)(svgAlpha[(r0 + r) * w + c0 + c] * 255 + 0.5f);
+                uint16_t &p = px[r * cw + c];
+                if (a == 255)
+                    p = color;
+                else if (a)
+                    p = TFT_eSPI::alphaBlend(a, color, p);
             }
-        }
+        target.write(x0 + c0, by + r0, cw, rh, px);
     }
 
     return true;
 }
+
+bool drawSVGImage(TFT_eSPI &gfx, NSVGimage *image,
+                  int xOff, int yOff,
+                  int targetW, int targetH,
+                  uint16_t color, float tolerance)
+{
+    return renderSVG(gfx.width(), gfx.height(), SVGPanelTarget{gfx}, image, xOff, yOff, targetW, targetH, color, tolerance);
+}
+
+bool drawSVGImage(TFT_eSprite &sprite, NSVGimage *image,
+                  int xOff, int yOff,
+                  int targetW, int targetH,
+                  uint16_t color, float tolerance)
+{
+    return renderSVG(sprite.width(), sprite.height(), SVGSpriteTarget{sprite}, image, xOff, yOff, targetW, targetH, color, tolerance);
+}
+
+bool rasterizeSVG(NSVGimage *image, uint16_t *pixels, int w, int h, uint16_t color, float tolerance)
+{
+    return renderSVG(w, h, SVGMemoryTarget{pixels, w}, image, 0, 0, w, h, color, tolerance);
+}
@@ -9,9 +9,69 @@ extern "C"
 
 NSVGimage *createSVG(const String &svgString);
 
+// Parse outside the shared cache, the caller frees it with deleteSVG()
+NSVGimage *parseSVG(const String &svgString);
+// nsvgDelete() plus the outlines cached for the image
+void deleteSVG(NSVGimage *image);
+
+// Curves are flattened until they are within this many pixels of the true shape
+#define SVG_TOLERANCE 0.25f
+
+struct SVGStats
+{
+    // parse cache (createSVG)
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t parseFailures = 0;
+    uint32_t collisions = 0; // same fingerprint, different source
+    uint32_t evictions = 0;
+    uint64_t parseUs = 0; // total time spent in nsvgParse on misses
+    uint32_t maxParseUs = 0;
+    size_t bytes = 0; // held by cached images and their sources
+    size_t entries = 0;
+
+    uint32_t outlineHits = 0, outlineMisses = 0; // flattened (image, scale) outlines reused / built
+    uint32_t segments = 0;                       // lines in the outline of the last draw
+};
+SVGStats svgStats();
+void printSVGStats();
+
 bool drawSVGString(const String &imageStr,
                    int xOff, int yOff,
                    int targetW, int targetH,
-                   uint16_t color, int steps = 4);
+                   uint16_t color, float tolerance = SVG_TOLERANCE);
+
+// Same, drawn into another target. Shapes are filled and stroked with anti-aliased edges blended
+// over what the target already shows: the panel is read back with readRect, a sprite in RAM.
+bool drawSVGString(TFT_eSPI &gfx, const String &imageStr,
+                   int xOff, int yOff,
+                   int targetW, int targetH,
+                   uint16_t color, float tolerance = SVG_TOLERANCE);
+bool drawSVGString(TFT_eSprite &sprite, const String &imageStr,
+                   int xOff, int yOff,
+                   int targetW, int targetH,
+                   uint16_t color, float tolerance = SVG_TOLERANCE);
+
+// Draw an already parsed image (the caller owns it)
+bool drawSVGImage(TFT_eSPI &gfx, NSVGimage *image,
+                  int xOff, int yOff,
+                  int targetW, int targetH,
+                  uint16_t color, float tolerance = SVG_TOLERANCE);
+bool drawSVGImage(TFT_eSprite &sprite, NSVGimage *image,
+                  int xOff, int yOff,
+                  int targetW, int targetH,
+                  uint16_t color, float tolerance = SVG_TOLERANCE);
+
+// Fit the image into a w x h buffer of RGB565 pixels in transfer byte order (as pushRect and
+// 16-bit sprites hold them) that already contains the background
+bool rasterizeSVG(NSVGimage *image, uint16_t *pixels, int w, int h,
+                  uint16_t color, float tolerance = SVG_TOLERANCE);
+
+// FNV-1a of the source, the key of the caches
+uint32_t svgFingerprint(const String &svgString);
+
+// Heap bytes held by a parsed image (shapes, paths, points)
+size_t svgImageBytes(const NSVGimage *image);
 
+// Drop cached images nobody drew for a minute (called from the window loop)
 void updateSVGList();
\ No newline at end of file
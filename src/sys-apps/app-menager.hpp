@@ -1,8 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
-#include <WiFiClientSecure.h>
-#include <HTTPClient.h>
+#include <WiFi.h>
 #include <FS.h>
 #include <vector>
 #include <algorithm>
@@ -10,6 +9,10 @@
 #include "../io/read-string.hpp"
 #include "../screen/index.hpp"
 #include "../fs/enc-fs.hpp"
+#include "../fs/blob-store.hpp"
+#include "../wifi/http-pool.hpp"
+#include "pkg-downloader.hpp"
+#include "pkg-archive.hpp"
 #include "../styles/global.hpp"
 
 namespace AppManager
@@ -222,7 +225,8 @@ namespace AppManager
 
     // ---------- networking ----------
 
-    static WiFiClientSecure secureClient; // global reusable
+    // All requests go through the shared HttpPool, so the many small GETs of an install (name,
+    // version, icon, manifest, ...) reuse one keep-alive TLS connection.
 
     // Core: download into Buffer with size limit and reserve to avoid fragmentation.
     static bool performGetBuffer(const String &url, Buffer &outBuf, size_t maxSize = 32 * 1024)
@@ -237,204 +241,76 @@ namespace AppManager
             return false;
         }
 
-        HTTPClient http;
-        // Reuse global secureClient to reduce heap churn
-        secureClient.setInsecure();
-
-        if (!http.begin(secureClient, url))
+        HttpPool::Request req;
+        req.url = url;
+        HttpPool::Response res;
+        HttpPool::Lease lease;
+        if (!HttpPool::open(req, res, lease))
         {
-            Serial.println("[ERROR] http.begin failed");
-            http.end(); // safe
+            Serial.println("[ERROR] HTTP GET failed: " + res.error);
             return false;
         }
-
-        http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-        http.setTimeout(15000);
-
-        int code = http.GET();
-        if (code != HTTP_CODE_OK)
+        if (res.status != 200)
         {
-            Serial.printf("[ERROR] HTTP GET failed: %d\n", code);
-            http.end();
+            Serial.printf("[ERROR] HTTP GET failed: %d\n", res.status);
+            HttpPool::readBody(lease, res, nullptr);
             return false;
         }
 
-        int contentLen = http.getSize();
-        if (contentLen > 0)
+        if (res.contentLength > 0)
         {
-            if ((size_t)contentLen > maxSize)
+            if ((size_t)res.contentLength > maxSize)
             {
                 Serial.println("[ERROR] Content-Length exceeds max allowed");
-                http.end();
-                return false;
+                return false; // dropping the lease closes the socket
             }
-            outBuf.data.reserve(contentLen);
+            outBuf.data.reserve(res.contentLength);
         }
         else
         {
             outBuf.data.reserve(std::min((size_t)1024, maxSize));
         }
 
-        WiFiClient &stream = http.getStream();
-        const size_t BUF_SZ = 256;
-        uint8_t tmp[BUF_SZ];
-        unsigned long lastData = millis();
-
-        while (http.connected())
-        {
-            int avail = stream.available();
-            if (avail > 0)
-            {
-                int toRead = std::min(avail, (int)BUF_SZ);
-                int r = stream.read(tmp, toRead);
-                if (r > 0)
-                {
-                    if (outBuf.data.size() + (size_t)r > maxSize)
-                    {
-                        Serial.println("[ERROR] Download exceeds maximum allowed size");
-                        http.end();
-                        return false;
-                    }
-                    outBuf.data.insert(outBuf.data.end(), tmp, tmp + r);
-                    lastData = millis();
-                }
-                else if (r < 0)
-                {
-                    Serial.println("[ERROR] Stream read error");
-                    http.end();
-                    return false;
-                }
-            }
-            else
-            {
-                if (millis() - lastData > 5000)
-                    break;
-                delay(1);
-            }
+        bool ok = HttpPool::readBody(lease, res, [&](const uint8_t *d, size_t n)
+                                     {
+                                         if (outBuf.data.size() + n > maxSize)
+                                         {
+                                             Serial.println("[ERROR] Download exceeds maximum allowed size");
+                                             return false;
+                                         }
+                                         outBuf.data.insert(outBuf.data.end(), d, d + n);
+                                         return true;
+                                     });
+        if (!ok)
+        {
+            Serial.println("[ERROR] Stream read error");
+            outBuf.data.clear();
+            return false;
         }
 
         outBuf.ok = true;
-        http.end();
         return true;
     }
 
-    // use secureClient for strings too, reduce memory churn
-    static String performGetString(const String &url, const String &fallback = "?")
+    // First non-empty line of a downloaded text file (name.txt, version.txt), or `fallback`.
+    static String firstLine(const Buffer &buf, const String &fallback = "?")
     {
-        if (WiFi.status() != WL_CONNECTED)
-            return fallback;
-
-        HTTPClient http;
-        secureClient.setInsecure();
-        if (!http.begin(secureClient, url))
-            return fallback;
-
-        http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-        int code = http.GET();
-        if (code != HTTP_CODE_OK)
-        {
-            http.end();
-            return fallback;
-        }
-
-        // read full stream (skip CR)
-        String raw;
-        WiFiClient &stream = http.getStream();
-        unsigned long lastData = millis();
-        const size_t BUF_SZ = 128;
-        uint8_t buf[BUF_SZ];
-        while (http.connected() || stream.available())
-        {
-            while (stream.available())
-            {
-                int r = stream.read(buf, BUF_SZ);
-                if (r > 0)
-                {
-                    for (int i = 0; i < r; ++i)
-                    {
-                        if (buf[i] != '\r')
-                            raw += (char)buf[i];
-                    }
-                    lastData = millis();
-                }
-            }
-            if (millis() - lastData > 5000)
-                break;
-            delay(1);
-        }
-        http.end();
-
-        raw.trim();
-        if (raw.length() == 0)
-            return fallback;
-
-        // try to decode chunked encoding if raw starts with a hex chunk-size line
-        String decoded;
-        int pos = 0;
-        bool chunkedDetected = false;
-        while (pos < raw.length())
-        {
-            int nl = raw.indexOf('\n', pos);
-            if (nl == -1)
-            { // no newline - can't be chunk header
-                break;
-            }
-            String line = raw.substring(pos, nl);
-            line.trim();
-            // check if line is only hex digits (chunk size)
-            bool isHex = line.length() > 0;
-            for (size_t i = 0; i < (size_t)line.length() && isHex; ++i)
-            {
-                char c = line[i];
-                if (!isxdigit((unsigned char)c))
-                    isHex = false;
-            }
-            if (!isHex)
-                break;
-
-            // parse chunk size
-            unsigned long chunkSize = strtoul(line.c_str(), NULL, 16);
-            chunkedDetected = true;
-            pos = nl + 1; // move after chunk-size line
-            if (chunkSize == 0)
-            {
-                // end of chunks
-                break;
-            }
-            // append available bytes up to chunkSize (clamp if stream truncated)
-            int available = raw.length() - pos;
-            int take = (int)std::min<unsigned long>(chunkSize, (unsigned long)std::max(0, available));
-            if (take > 0)
-            {
-                decoded += raw.substring(pos, pos + take);
-                pos += take;
-            }
-            // skip a single LF that follows chunk payload if present
-            if (pos < raw.length() && raw[pos] == '\n')
-                pos++;
-        }
-
-        String finalBody = chunkedDetected ? decoded : raw;
-        finalBody.trim();
-        if (finalBody.length() == 0)
+        if (!buf.ok)
             return fallback;
 
-        // return first non-empty line (most config files put name on first line)
-        int firstNL = finalBody.indexOf('\n');
-        if (firstNL == -1)
-            return finalBody;
-        // find first non-empty trimmed line
+        String raw((const char *)buf.data.data(), buf.data.size());
+        raw.replace("\r", "");
         int start = 0;
-        while (start <= finalBody.length())
+        while (start <= (int)raw.length())
         {
-            int nl2 = finalBody.indexOf('\n', start);
-            String line = (nl2 == -1) ? finalBody.substring(start) : finalBody.substring(start, nl2);
+            int nl = raw.indexOf('\n', start);
+            String line = (nl == -1) ? raw.substring(start) : raw.substring(start, nl);
             line.trim();
             if (line.length() > 0)
                 return line;
-            if (nl2 == -1)
+            if (nl == -1)
                 break;
-            start = nl2 + 1;
+            start = nl + 1;
         }
 
         return fallback;
@@ -460,22 +336,12 @@ namespace AppManager
         return true;
     }
 
-    static bool performGetWithFallback(const String &url, Buffer &buf)
-    {
-        return performGetBuffer(url, buf);
-    }
-
-    // fetchAndWrite: optionally use already-downloaded buffer (preBuf) to avoid duplicate GETs.
-    // createDirs controls whether to create programs/ folder and app folder.
-    static bool fetchAndWrite(const String &url, const String &path, const String &folderName, bool required, int &progress, int totalFiles, int currentFile, bool createDirs = true, const Buffer *preBuf = nullptr)
+    static void drawInstallProgress(const String &title, const String &msg, int progress, const String &detail)
     {
-        Serial.println("[Download] " + url + " -> " + path);
-
-        progress = (currentFile * 100) / totalFiles;
         clearScreen();
         Screen::tft.setTextColor(TEXT, BG);
         {
-            const String __t = String("Installing App");
+            const String __t = title;
             int __font = TITLE_FONT;
             int __w = Screen::tft.textWidth(__t.c_str(), __font);
             int __x = (screenW() - __w) / 2;
@@ -484,240 +350,14 @@ namespace AppManager
             int __y = TOP_MARGIN;
             Screen::tft.drawString(__t, __x, __y, __font);
         }
-        drawMessage("Downloading files...", TOP_MARGIN + Screen::tft.fontHeight(TITLE_FONT) + 8, TEXT, BG, HEADING_FONT);
+        drawMessage(msg, TOP_MARGIN + Screen::tft.fontHeight(TITLE_FONT) + 8, TEXT, BG, HEADING_FONT);
 
         int pbX = LEFT_MARGIN;
         int pbW = screenW() - LEFT_MARGIN - RIGHT_MARGIN;
         int pbY = screenH() / 2 - 14;
         drawProgressBar(pbX, pbY, pbW, 24, progress);
-        drawClippedString(pbX, pbY + 30, pbW, "Downloading: " + path, BODY_FONT);
-
-        Buffer dataBuf;
-        dataBuf.ok = false;
-
-        if (preBuf != nullptr && preBuf->ok)
-        {
-            // use provided pre-fetched buffer
-            dataBuf.data = preBuf->data;
-            dataBuf.ok = true;
-        }
-        else
-        {
-            // Perform HTTP GET and fill dataBuf.data (binary-safe), handling chunked transfer encoding
-            if (WiFi.status() != WL_CONNECTED)
-            {
-                if (required)
-                    drawError("No WiFi connection for " + path);
-                return !required;
-            }
-
-            HTTPClient http;
-            secureClient.setInsecure();
-            if (!http.begin(secureClient, url))
-            {
-                if (required)
-                    drawError("Failed to begin HTTP for " + path);
-                return !required;
-            }
-
-            http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-            int code = http.GET();
-            if (code != HTTP_CODE_OK)
-            {
-                http.end();
-                if (required)
-                    drawError("HTTP error " + String(code) + " for " + path);
-                return !required;
-            }
-
-            // Decide whether response is chunked
-            String transferEncoding = http.header("Transfer-Encoding");
-            long contentLength = http.getSize(); // -1 if unknown (often chunked)
-
-            WiFiClient &stream = http.getStream();
-            unsigned long lastData = millis();
-            const size_t BUF_SZ = 512;
-            uint8_t buf[BUF_SZ];
-            std::vector<uint8_t> out;
-            bool chunked = transferEncoding.length() && transferEncoding.indexOf("chunked") >= 0;
-            if (!chunked && contentLength == -1)
-            {
-                // Some servers do not set Transfer-Encoding but also don't provide size -> treat as chunked-style fallback
-                chunked = true;
-            }
-
-            if (!chunked)
-            {
-                // Read raw bytes until contentLength reached or stream closed
-                size_t readTotal = 0;
-                while ((http.connected() || stream.available()) && (contentLength == -1 || readTotal < (size_t)contentLength))
-                {
-                    while (stream.available())
-                    {
-                        int r = stream.read(buf, BUF_SZ);
-                        if (r > 0)
-                        {
-                            out.insert(out.end(), buf, buf + r);
-                            readTotal += r;
-                            lastData = millis();
-                        }
-                    }
-                    if (millis() - lastData > 5000)
-                        break;
-                    delay(1);
-                }
-            }
-            else
-            {
-                // Decode chunked transfer encoding
-                // State machine: read chunk-size line (ASCII hex + optional extensions), parse size, then read exactly size bytes, skip CRLF, repeat until size==0.
-                String lineBuf; // accumulate ASCII for chunk size lines
-                bool readingSizeLine = true;
-                unsigned long currentChunkSize = 0;
-                size_t remainingInChunk = 0;
-
-                // We'll read byte-by-byte from stream but in buffered blocks for efficiency.
-                while (http.connected() || stream.available())
-                {
-                    // read available into local buffer
-                    while (stream.available())
-                    {
-                        int r = stream.read(buf, BUF_SZ);
-                        if (r <= 0)
-                            break;
-
-                        for (int i = 0; i < r; ++i)
-                        {
-                            uint8_t b = buf[i];
-                            lastData = millis();
-
-                            if (readingSizeLine)
-                            {
-                                // accumulate until '\n'
-                                lineBuf += (char)b;
-                                if (b == '\n')
-                                {
-                                    // lineBuf may contain CRLF; trim whitespace
-                                    lineBuf.trim();
-                                    // extract only hex prefix (stop at first non-hex)
-                                    String hexPart;
-                                    for (size_t j = 0; j < lineBuf.length(); ++j)
-                                    {
-                                        char c = lineBuf[j];
-                                        if (isxdigit((unsigned char)c))
-                                            hexPart += c;
-                                        else
-                                            break;
-                                    }
-                                    if (hexPart.length() == 0)
-                                    {
-                                        // malformed chunk-size -> abort
-                                        lineBuf = "";
-                                        http.end();
-                                        if (required)
-                                            drawError("Malformed chunk size for " + path);
-                                        return !required;
-                                    }
-                                    currentChunkSize = strtoul(hexPart.c_str(), nullptr, 16);
-                                    if (currentChunkSize == 0)
-                                    {
-                                        // end of chunks -> stop reading further (there may be trailing headers which we can ignore)
-                                        readingSizeLine = false;
-                                        remainingInChunk = 0;
-                                        // consume rest of stream briefly then break outer loops
-                                        // break out by setting connected false after a short drain
-                                        // We won't try to read trailer headers; finish.
-                                        i = r; // move to outer
-                                        goto CHUNKED_DONE;
-                                    }
-                                    remainingInChunk = (size_t)currentChunkSize;
-                                    readingSizeLine = false;
-                                    lineBuf = "";
-                                }
-                            }
-                            else
-                            {
-                                // reading chunk payload
-                                if (remainingInChunk > 0)
-                                {
-                                    out.push_back(b);
-                                    remainingInChunk--;
-                                }
-                                else
-                                {
-                                    // We're at the CR/LF after chunk payload. Skip until we hit '\n' then switch to reading size line.
-                                    if (b == '\n')
-                                    {
-                                        readingSizeLine = true;
-                                        lineBuf = "";
-                                    }
-                                    // else keep skipping CR or any bytes until LF
-                                }
-                            }
-                        } // for r
-                    } // while stream.available()
-
-                    if (millis() - lastData > 5000)
-                        break;
-                    delay(1);
-                }
-            CHUNKED_DONE:;
-            }
-
-            http.end();
-
-            if (out.empty())
-            {
-                if (required)
-                    drawError("Empty download for " + path);
-                return !required;
-            }
-
-            dataBuf.data = std::move(out);
-            dataBuf.ok = true;
-        } // end download
-
-        // ensure program folders exist
-        if (createDirs)
-        {
-            if (!ENC_FS::exists({"programs"}))
-                ENC_FS::mkDir({"programs"});
-            if (!ENC_FS::exists({"programs", folderName}))
-                ENC_FS::mkDir({"programs", folderName});
-        }
-        else
-        {
-            if (!ENC_FS::exists({"programs", folderName}))
-            {
-                if (required)
-                    drawError("App folder missing: " + folderName);
-                // free buffer
-                std::vector<uint8_t>().swap(dataBuf.data);
-                return !required;
-            }
-        }
-
-        bool written = false;
-        if (dataBuf.ok)
-        {
-            written = ENC_FS::writeFile({"programs", folderName, path}, 0, 0, dataBuf.data);
-            Serial.println("[Write] File " + path + (written ? " OK" : " FAILED"));
-        }
-        else
-        {
-            if (required)
-                drawError("No data for " + path);
-            // free buffer (defensive)
-            std::vector<uint8_t>().swap(dataBuf.data);
-            return !required;
-        }
-
-        // free the buffer memory immediately to return heap
-        std::vector<uint8_t>().swap(dataBuf.data);
-
-        if (!written && required)
-            drawError("Failed to save " + path);
-        return written;
+        if (detail.length())
+            drawClippedString(pbX, pbY + 30, pbW, detail, BODY_FONT);
     }
 
     static std::vector<String> parsePkgTxt(const Buffer &buf)
@@ -899,6 +539,183 @@ namespace AppManager
 
     // installApp now takes the original inputId and the sanitized folderName derived from that input.
     // if isUpdate==true, existing folder will be used and no directories will be created.
+    // Streams `jobs` into programs/<folderName>/ while drawing progress; reports the first required failure.
+    static bool downloadJobs(const std::vector<PkgDownloader::Job> &jobs, const String &folderName, const String &title,
+                             std::vector<PkgDownloader::Result> &results)
+    {
+        bool downloaded = PkgDownloader::run(jobs, folderName, [&](const PkgDownloader::Progress &pr)
+                                             {
+                                                 int progress = pr.filesTotal ? (int)(pr.filesDone * 100 / pr.filesTotal) : 100;
+                                                 String detail = String(pr.filesDone) + "/" + String(pr.filesTotal) + " files, " +
+                                                                 String((unsigned long)(pr.bytesDone / 1024)) + " KB";
+                                                 if (pr.current.length())
+                                                     detail += " - " + pr.current;
+                                                 drawInstallProgress(title, "Downloading files...", progress, detail);
+                                             },
+                                             &results);
+        if (downloaded)
+            return true;
+
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            if (jobs[i].required && !results[i].ok)
+            {
+                drawError(results[i].status ? "HTTP error " + String(results[i].status) + " for " + jobs[i].relPath
+                                            : "Failed to download " + jobs[i].relPath);
+                break;
+            }
+        }
+        return false;
+    }
+
+    // Legacy packages: entry.lua, icon, name, version plus every file in pkg.txt.
+    static bool installFromPkgList(const String &base, const String &folderName, const String &title, bool isUpdate,
+                                   const std::vector<std::pair<String, const Buffer *>> &prefetched)
+    {
+        std::vector<String> core = {"entry.lua", "icon-20x20.raw", "name.txt", "version.txt"};
+
+        // get pkg list first (small, buffered)
+        Buffer pkgListBuf;
+        std::vector<String> extras;
+        if (performGetBuffer(base + "pkg.txt", pkgListBuf, 64 * 1024))
+        {
+            extras = parsePkgTxt(pkgListBuf);
+            std::vector<uint8_t>().swap(pkgListBuf.data);
+        }
+
+        std::vector<PkgDownloader::Job> jobs;
+        for (auto &path : core)
+        {
+            const Buffer *preBuf = nullptr;
+            for (auto &pf : prefetched)
+            {
+                if (pf.first == path && pf.second->ok && !pf.second->data.empty())
+                    preBuf = pf.second;
+            }
+
+            if (preBuf)
+            {
+                if (!ENC_FS::BlobStore::addFile(folderName, path, preBuf->data))
+                {
+                    drawError("Failed to save " + path);
+                    return false;
+                }
+                continue;
+            }
+            jobs.push_back({base + path, path, true});
+        }
+        // extras are optional: a failed extra is logged and skipped, as before
+        for (auto &f : extras)
+            jobs.push_back({base + f, f, false});
+
+        // stream everything over a few keep-alive connections straight into the blob store
+        std::vector<PkgDownloader::Result> results;
+        if (!downloadJobs(jobs, folderName, title, results))
+            return false;
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            if (!results[i].ok)
+                Serial.println("[WARN] failed to download extra: " + jobs[i].relPath);
+        }
+
+        // files dropped from the package since the last version no longer reference their blobs
+        if (isUpdate)
+        {
+            std::vector<String> keep = core;
+            keep.insert(keep.end(), extras.begin(), extras.end());
+            ENC_FS::BlobStore::prune(folderName, keep);
+        }
+        return true;
+    }
+
+    // Packages with manifest.txt: only files whose hash is not stored yet are downloaded (and verified
+    // against the manifest while streaming); the app switches to the new version in one manifest swap.
+    static bool installFromManifest(const String &base, const String &folderName, const String &title,
+                                    const std::vector<ENC_FS::BlobStore::Entry> &remote,
+                                    const std::vector<std::pair<String, const Buffer *>> &prefetched)
+    {
+        std::vector<PkgDownloader::Job> jobs;
+        uint64_t diffBytes = 0;
+        for (auto &e : remote)
+        {
+            if (ENC_FS::BlobStore::hasBlob(e.hash, e.size))
+                continue; // unchanged (or shared with another app)
+
+            bool stored = false;
+            for (auto &pf : prefetched)
+            {
+                if (pf.first == e.path && pf.second->ok && pf.second->data.size() == e.size &&
+                    ENC_FS::BlobStore::hashHex(pf.second->data) == e.hash)
+                {
+                    String hash;
+                    stored = ENC_FS::BlobStore::put(pf.second->data, hash);
+                }
+            }
+            if (stored)
+                continue;
+
+            jobs.push_back({base + e.path, e.path, true, e.hash});
+            diffBytes += e.size;
+        }
+        Serial.printf("[Install] manifest: %u files, %u to download (%llu bytes)\n",
+                      (unsigned)remote.size(), (unsigned)jobs.size(), (unsigned long long)diffBytes);
+
+        std::vector<PkgDownloader::Result> results;
+        if (!downloadJobs(jobs, folderName, title, results))
+            return false; // the installed version is untouched
+
+        if (!ENC_FS::BlobStore::replace(folderName, remote))
+        {
+            drawError("Failed to switch to new version");
+            return false;
+        }
+        return true;
+    }
+
+    // Packages with app.mwpk: one request, entries are inflated straight into the blob store and
+    // switched in together. Returns -1 if the package has no archive, 1 on success, 0 on failure.
+    static int installFromArchive(const String &base, const String &folderName, const String &title)
+    {
+        PkgArchive::Unpacker unpacker;
+        uint64_t got = 0;
+        long total = -1;
+        int status = 0;
+        unsigned long lastDraw = 0;
+
+        bool ok = PkgDownloader::stream(base + "app.mwpk", [&](const uint8_t *d, size_t n)
+                                        {
+                                            got += n;
+                                            if (millis() - lastDraw > 250)
+                                            {
+                                                lastDraw = millis();
+                                                int progress = total > 0 ? (int)(got * 100 / (uint64_t)total) : 0;
+                                                drawInstallProgress(title, "Unpacking package...", progress,
+                                                                    String((unsigned long)(got / 1024)) + " KB, " +
+                                                                        String((unsigned)unpacker.entries().size()) + " files");
+                                            }
+                                            return unpacker.feed(d, n);
+                                        },
+                                        &status, &total);
+        // no archive: not served, or something else served in its place (SPA fallback, custom 404 page)
+        if ((!ok && status != 200) || !unpacker.sawHeader())
+            return -1;
+
+        if (!ok || !unpacker.complete())
+        {
+            drawError("Broken package: " + (unpacker.error().length() ? unpacker.error() : String("truncated")));
+            return 0;
+        }
+        Serial.printf("[Install] app.mwpk: %u files, %llu bytes unpacked from %llu\n", (unsigned)unpacker.entries().size(),
+                      (unsigned long long)unpacker.rawBytes(), (unsigned long long)got);
+
+        if (!ENC_FS::BlobStore::replace(folderName, unpacker.entries()))
+        {
+            drawError("Failed to switch to new version");
+            return 0;
+        }
+        return 1;
+    }
+
     static bool installApp(const String &rawAppId, const String &inputFolderName, bool isUpdate)
     {
         if (!ensureWiFiConnected(10000))
@@ -928,8 +745,10 @@ namespace AppManager
 
         // Fetch icon, name.txt and version.txt once each and keep buffers to avoid re-downloads.
         performGetImageBuffer(base + "icon-20x20.raw", iconBuf, ICON_EXPECTED);
-        name = performGetString(base + "name.txt", "Unknown");
-        version = performGetString(base + "version.txt", "?");
+        performGetBuffer(base + "name.txt", nameBuf, 4 * 1024);
+        performGetBuffer(base + "version.txt", versionBuf, 4 * 1024);
+        name = firstLine(nameBuf, "Unknown");
+        version = firstLine(versionBuf, "?");
 
         if (name.length() == 0)
             name = "Unknown";
@@ -942,131 +761,61 @@ namespace AppManager
         if (!confirmInstallPrompt(name, iconBuf, version, folderName, isUpdate))
             return false;
 
-        // core files - we will use pre-fetched buffers where available to avoid re-downloading.
-        std::vector<std::pair<String, String>> core = {
-            {base + "entry.lua", "entry.lua"},
-            {base + "icon-20x20.raw", "icon-20x20.raw"},
-            {base + "name.txt", "name.txt"},
-            {base + "version.txt", "version.txt"},
-        };
-
-        int progress = 0;
-        int totalFiles = (int)core.size();
-        int currentFile = 0;
-
-        // get pkg list first to adjust totalFiles if present (but do not download extras yet)
-        Buffer pkgListBuf;
-        std::vector<String> extras;
-        if (performGetBuffer(base + "pkg.txt", pkgListBuf, 64 * 1024))
+        // ensure program folders exist (an update only overwrites files)
+        if (!isUpdate)
         {
-            extras = parsePkgTxt(pkgListBuf);
-            totalFiles += extras.size();
-            // free pkgListBuf now (we will download each extra individually later)
-            std::vector<uint8_t>().swap(pkgListBuf.data);
+            if (!ENC_FS::exists({"programs"}))
+                ENC_FS::mkDir({"programs"});
+            if (!ENC_FS::exists({"programs", folderName}))
+                ENC_FS::mkDir({"programs", folderName});
         }
-
-        // Download/write core files. Use pre-fetched buffers for icon/name/version.
-        for (auto &p : core)
+        else if (!ENC_FS::exists({"programs", folderName}))
         {
-            currentFile++;
-            const String &url = p.first;
-            const String &path = p.second;
-
-            const Buffer *preBuf = nullptr;
-            if (path == "icon-20x20.raw" && iconBuf.ok)
-                preBuf = &iconBuf;
-            else if (path == "name.txt" && nameBuf.ok)
-                preBuf = &nameBuf;
-            else if (path == "version.txt" && versionBuf.ok)
-                preBuf = &versionBuf;
-
-            if (!fetchAndWrite(url, path, folderName, true, progress, totalFiles, currentFile, !isUpdate, preBuf))
-                return false;
+            drawError("App folder missing: " + folderName);
+            return false;
         }
 
-        // download extras one by one; when updating, do not create folder - only overwrite files.
-        Buffer extraBuf;
-        for (size_t i = 0; i < extras.size(); ++i)
-        {
-            currentFile++;
-            const String &f = extras[i];
-            String url = base + f;
-            if (!performGetWithFallback(url, extraBuf))
-            {
-                // if an extra is optional, continue, otherwise consider required? Keep behavior conservative: if cannot download extras, warn but continue.
-                Serial.println("[WARN] failed to download extra: " + f);
-                std::vector<uint8_t>().swap(extraBuf.data);
-                progress = (currentFile * 100) / totalFiles;
-                // update screen
-                clearScreen();
-                Screen::tft.setTextColor(TEXT, BG);
-                {
-                    const String __t = String("Installing App");
-                    int __font = TITLE_FONT;
-                    int __w = Screen::tft.textWidth(__t.c_str(), __font);
-                    int __x = (screenW() - __w) / 2;
-                    __x = std::max(__x, LEFT_MARGIN);
-                    __x = std::min(__x, screenW() - __w - RIGHT_MARGIN);
-                    int __y = TOP_MARGIN;
-                    Screen::tft.drawString(__t, __x, __y, __font);
-                }
-                drawMessage("Downloading additional files...", TOP_MARGIN + Screen::tft.fontHeight(TITLE_FONT) + 8, TEXT, BG, HEADING_FONT);
-                int pbX = LEFT_MARGIN;
-                int pbW = screenW() - LEFT_MARGIN - RIGHT_MARGIN;
-                int pbY = screenH() / 2 - 14;
-                drawProgressBar(pbX, pbY, pbW, 24, progress);
-                drawClippedString(pbX, pbY + 30, pbW, "Downloading: " + f, BODY_FONT);
-                continue;
-            }
-            // write file (no dir creation if updating)
-            if (!ENC_FS::writeFile({"programs", folderName, f}, 0, 0, extraBuf.data))
-            {
-                Serial.println("[ERROR] failed to write extra: " + f);
-            }
-            std::vector<uint8_t>().swap(extraBuf.data);
+        const String title = isUpdate ? "Updating App" : "Installing App";
+        // icon/name/version were already fetched for the prompt and are stored from RAM
+        std::vector<std::pair<String, const Buffer *>> prefetched = {
+            {"icon-20x20.raw", &iconBuf},
+            {"name.txt", &nameBuf},
+            {"version.txt", &versionBuf},
+        };
 
-            progress = (currentFile * 100) / totalFiles;
-            clearScreen();
-            Screen::tft.setTextColor(TEXT, BG);
+        // package sources, best first: a fresh install takes the single archive, an update the
+        // manifest diff; pkg.txt (one request per file) is the fallback for older packages
+        int result = -1; // -1 = source not offered by this package
+        if (!isUpdate)
+            result = installFromArchive(base, folderName, title);
+        if (result < 0)
+        {
+            Buffer manifestBuf;
+            std::vector<ENC_FS::BlobStore::Entry> remote;
+            if (performGetBuffer(base + "manifest.txt", manifestBuf, 64 * 1024) &&
+                ENC_FS::BlobStore::parse(String((const char *)manifestBuf.data.data(), manifestBuf.data.size()), remote) &&
+                !remote.empty())
             {
-                const String __t = String("Installing App");
-                int __font = TITLE_FONT;
-                int __w = Screen::tft.textWidth(__t.c_str(), __font);
-                int __x = (screenW() - __w) / 2;
-                __x = std::max(__x, LEFT_MARGIN);
-                __x = std::min(__x, screenW() - __w - RIGHT_MARGIN);
-                int __y = TOP_MARGIN;
-                Screen::tft.drawString(__t, __x, __y, __font);
+                std::vector<uint8_t>().swap(manifestBuf.data);
+                result = installFromManifest(base, folderName, title, remote, prefetched) ? 1 : 0;
             }
-            drawMessage("Downloading additional files...", TOP_MARGIN + Screen::tft.fontHeight(TITLE_FONT) + 8, TEXT, BG, HEADING_FONT);
-            int pbX = LEFT_MARGIN;
-            int pbW = screenW() - LEFT_MARGIN - RIGHT_MARGIN;
-            int pbY = screenH() / 2 - 14;
-            drawProgressBar(pbX, pbY, pbW, 24, progress);
-            drawClippedString(pbX, pbY + 30, pbW, "Downloading: " + f, BODY_FONT);
         }
+        if (result < 0 && isUpdate)
+            result = installFromArchive(base, folderName, title);
+        if (result < 0)
+            result = installFromPkgList(base, folderName, title, isUpdate, prefetched) ? 1 : 0;
+        if (result == 0)
+            return false;
 
         // write the appId to id.txt in the app folder
         ENC_FS::writeFile({"programs", folderName, "id.txt"}, 0, 0, std::vector<uint8_t>(rawAppId.begin(), rawAppId.end()));
 
+        // blobs of the previous version that nothing references anymore
+        if (isUpdate)
+            ENC_FS::BlobStore::gc();
+
         // Finalize
-        clearScreen();
-        Screen::tft.setTextColor(TEXT, BG);
-        {
-            const String __t = String(isUpdate ? "Updating App" : "Installing App");
-            int __font = TITLE_FONT;
-            int __w = Screen::tft.textWidth(__t.c_str(), __font);
-            int __x = (screenW() - __w) / 2;
-            __x = std::max(__x, LEFT_MARGIN);
-            __x = std::min(__x, screenW() - __w - RIGHT_MARGIN);
-            int __y = TOP_MARGIN;
-            Screen::tft.drawString(__t, __x, __y, __font);
-        }
-        drawMessage("Finalizing...", TOP_MARGIN + Screen::tft.fontHeight(TITLE_FONT) + 8, TEXT, BG, HEADING_FONT);
-        int pbX = LEFT_MARGIN;
-        int pbW = screenW() - LEFT_MARGIN - RIGHT_MARGIN;
-        int pbY = screenH() / 2 - 14;
-        drawProgressBar(pbX, pbY, pbW, 24, 100);
+        drawInstallProgress(title, "Finalizing...", 100, "");
         delay(500);
 
         // free pre-fetched buffers
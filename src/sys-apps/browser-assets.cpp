@@ -0,0 +1,154 @@
+#include "browser-assets.hpp"
+
+#include <list>
+
+#include "../screen/svg.hpp"
+#include "../fs/enc-fs.hpp"
+
+namespace Browser
+{
+    namespace Assets
+    {
+        struct Entry
+        {
+            String domain;
+            String hash;
+            Image image;
+            size_t bytes;
+        };
+
+        // front = most recently used
+        static std::list<Entry> g_lru;
+        static size_t g_ramBytes = 0;
+        static Stats g_stats;
+
+        bool validHash(const String &hash)
+        {
+            if (hash.length() < MIN_HASH_LEN || hash.length() > MAX_HASH_LEN)
+                return false;
+            for (size_t i = 0; i < hash.length(); i++)
+            {
+                char c = hash[i];
+                if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+                    return false;
+            }
+            return true;
+        }
+
+        static bool hashMatches(const String &hash, const String &data)
+        {
+            static const char DIGITS[] = "0123456789abcdef";
+            ENC_FS::Buffer digest = ENC_FS::sha256(data);
+            for (size_t i = 0; i < hash.length(); i++)
+            {
+                uint8_t b = digest[i / 2];
+                char c = DIGITS[(i & 1) ? (b & 0x0F) : (b >> 4)];
+                if (hash[i] != c)
+                    return false;
+            }
+            return true;
+        }
+
+        static std::list<Entry>::iterator find(const String &domain, const String &hash)
+        {
+            for (auto it = g_lru.begin(); it != g_lru.end(); ++it)
+                if (it->hash == hash && it->domain == domain)
+                    return it;
+            return g_lru.end();
+        }
+
+        static Image insert(const String &domain, const String &hash, const String &src)
+        {
+            NSVGimage *raw = parseSVG(src);
+            if (!raw)
+                return nullptr;
+            Image image(raw, deleteSVG);
+
+            auto old = find(domain, hash);
+            if (old != g_lru.end())
+            {
+                g_ramBytes -= old->bytes;
+                g_lru.erase(old);
+            }
+
+            size_t bytes = svgImageBytes(raw) + hash.length() + domain.length() + sizeof(Entry);
+            while (!g_lru.empty() && g_ramBytes + bytes > RAM_BUDGET)
+            {
+                // frames that still draw an evicted image keep it alive through their shared_ptr
+                g_ramBytes -= g_lru.back().bytes;
+                g_lru.pop_back();
+                g_stats.evictions++;
+            }
+            g_lru.push_front({domain, hash, image, bytes});
+            g_ramBytes += bytes;
+            return image;
+        }
+
+        bool define(const String &domain, const String &hash, const char *data, size_t len)
+        {
+            String src;
+            if (!validHash(hash) || len == 0 || len > MAX_ASSET_BYTES || !src.concat(data, len) || !hashMatches(hash, src))
+            {
+                Serial.printf("[Browser] DefineAsset %s rejected\n", hash.c_str());
+                g_stats.rejected++;
+                return false;
+            }
+            g_stats.defines++;
+            g_stats.bytesDefined += len;
+
+            if (!insert(domain, hash, src))
+            {
+                g_stats.rejected++;
+                return false;
+            }
+
+            ENC_FS::BrowserStorage::setAsset(domain, hash, ENC_FS::Buffer((const uint8_t *)data, (const uint8_t *)data + len));
+            return true;
+        }
+
+        Image get(const String &domain, const String &hash)
+        {
+            auto it = find(domain, hash);
+            if (it != g_lru.end())
+            {
+                g_stats.ramHits++;
+                if (it != g_lru.begin())
+                    g_lru.splice(g_lru.begin(), g_lru, it);
+                return it->image;
+            }
+
+            if (validHash(hash))
+            {
+                ENC_FS::Buffer buf = ENC_FS::BrowserStorage::getAsset(domain, hash);
+                if (!buf.empty())
+                {
+                    String src;
+                    src.concat((const char *)buf.data(), buf.size());
+                    Image image = insert(domain, hash, src);
+                    if (image)
+                    {
+                        g_stats.diskHits++;
+                        return image;
+                    }
+                }
+            }
+
+            g_stats.misses++;
+            return nullptr;
+        }
+
+        void clear()
+        {
+            g_lru.clear();
+            g_ramBytes = 0;
+        }
+
+        Stats stats()
+        {
+            Stats s = g_stats;
+            s.ramBytes = g_ramBytes;
+            s.entries = g_lru.size();
+            return s;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+extern "C"
+{
+#include "nanosvg.h"
+}
+
+// Content-addressed SVG assets for the browser protocol.
+//
+//     DefineAsset <hash> <svg>            server -> client, once per asset
+//     DrawAsset <hash> x y w h color      server -> client, any number of times
+//     MissingAsset <hash>                 client -> server, DrawAsset for an unknown hash
+//
+// <hash> is the lowercase hex SHA-256 of the asset bytes, at least the first 16 digits. The client
+// checks it on DefineAsset, so a cached asset can never be confused with different content.
+// Parsed assets live in a RAM LRU; the sources are also kept per domain in
+// ENC_FS::BrowserStorage, so a revisit usually needs no DefineAsset at all.
+namespace Browser
+{
+    namespace Assets
+    {
+        constexpr size_t RAM_BUDGET = 48 * 1024;      // parsed images
+        constexpr size_t MAX_ASSET_BYTES = 16 * 1024; // larger assets are not accepted
+        constexpr size_t MIN_HASH_LEN = 16;
+        constexpr size_t MAX_HASH_LEN = 64;
+
+        using Image = std::shared_ptr<NSVGimage>;
+
+        bool validHash(const String &hash);
+
+        // Verify, parse and store an asset (RAM and flash). false on a bad hash or parse error.
+        bool define(const String &domain, const String &hash, const char *data, size_t len);
+
+        // Parsed asset from RAM or flash, nullptr if the server has to send it
+        Image get(const String &domain, const String &hash);
+
+        // Drop the RAM cache (the flash copies stay)
+        void clear();
+
+        struct Stats
+        {
+            uint32_t ramHits = 0;
+            uint32_t diskHits = 0;
+            uint32_t misses = 0;
+            uint32_t defines = 0;
+            uint32_t rejected = 0; // hash mismatch, too big or unparsable
+            uint32_t evictions = 0;
+            uint32_t bytesDefined = 0; // asset bytes received
+            size_t ramBytes = 0;
+            size_t entries = 0;
+        };
+
+        Stats stats();
+    }
+}
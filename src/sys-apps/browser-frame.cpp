@@ -0,0 +1,418 @@
+#include "browser-frame.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include "../screen/index.hpp"
+
+namespace Browser
+{
+    namespace Frame
+    {
+        enum Kind : uint8_t
+        {
+            K_RECT,
+            K_CIRCLE,
+            K_TEXT,
+            K_SVG,
+            K_IMAGE,
+        };
+
+        // one recorded command, geometry in screen coordinates
+        struct Cmd
+        {
+            Kind kind;
+            uint8_t size;
+            uint16_t color;
+            int16_t x, y, w, h;         // rect / svg box, circle: w = radius
+            int16_t bx0, by0, bx1, by1; // bounding box, clipped
+            String data;                // text or svg source
+            std::shared_ptr<NSVGimage> image;
+        };
+
+        static bool g_active = false;
+        static int g_cx = 0, g_cy = 0, g_cw = 0, g_ch = 0; // clip rect
+        static int g_ox = 0, g_oy = 0;                     // command datum
+        static std::vector<Cmd> g_cmds;
+        static std::vector<bool> g_dirty; // per band
+        static size_t g_textBytes = 0;
+
+        static TFT_eSprite *g_band = nullptr;
+        static int g_bandW = 0;
+
+        static Stats g_stats;
+
+        static int bandCount()
+        {
+            return (g_ch + BAND_H - 1) / BAND_H;
+        }
+
+        void begin(int clipX, int clipY, int clipW, int clipH, int originX, int originY)
+        {
+            if (g_active)
+                end(); // BeginFrame without EndFrame: show what we have
+
+            const int sw = Screen::tft.width(), sh = Screen::tft.height();
+            if (clipX < 0)
+            {
+                clipW += clipX;
+                clipX = 0;
+            }
+            if (clipY < 0)
+            {
+                clipH += clipY;
+                clipY = 0;
+            }
+            if (clipX + clipW > sw)
+                clipW = sw - clipX;
+            if (clipY + clipH > sh)
+                clipH = sh - clipY;
+            if (clipW <= 0 || clipH <= 0)
+                return;
+
+            g_cx = clipX;
+            g_cy = clipY;
+            g_cw = clipW;
+            g_ch = clipH;
+            g_ox = originX;
+            g_oy = originY;
+            g_cmds.clear();
+            g_dirty.assign(bandCount(), false);
+            g_textBytes = 0;
+            g_active = true;
+        }
+
+        bool active()
+        {
+            return g_active;
+        }
+
+        static void add(Cmd &&cmd)
+        {
+            if (cmd.bx0 < g_cx)
+                cmd.bx0 = g_cx;
+            if (cmd.by0 < g_cy)
+                cmd.by0 = g_cy;
+            if (cmd.bx1 > g_cx + g_cw)
+                cmd.bx1 = g_cx + g_cw;
+            if (cmd.by1 > g_cy + g_ch)
+                cmd.by1 = g_cy + g_ch;
+            if (cmd.bx0 >= cmd.bx1 || cmd.by0 >= cmd.by1)
+                return; // nothing visible
+
+            for (int b = (cmd.by0 - g_cy) / BAND_H; b <= (cmd.by1 - 1 - g_cy) / BAND_H; b++)
+                g_dirty[b] = true;
+
+            g_textBytes += cmd.data.length();
+            g_cmds.push_back(std::move(cmd));
+            g_stats.commands++;
+
+            // bound the RAM a runaway frame can take
+            if (g_cmds.size() >= MAX_COMMANDS || g_textBytes >= MAX_TEXT_BYTES)
+            {
+                int cx = g_cx, cy = g_cy, cw = g_cw, ch = g_ch, ox = g_ox, oy = g_oy;
+                end();
+                begin(cx, cy, cw, ch, ox, oy);
+            }
+        }
+
+        static Cmd makeCmd(Kind kind, int x, int y, int w, int h, uint16_t color)
+        {
+            Cmd c;
+            c.kind = kind;
+            c.size = 1;
+            c.color = color;
+            c.x = x + g_ox;
+            c.y = y + g_oy;
+            c.w = w;
+            c.h = h;
+            c.bx0 = c.x;
+            c.by0 = c.y;
+            c.bx1 = c.x + w;
+            c.by1 = c.y + h;
+            return c;
+        }
+
+        void fillRect(int x, int y, int w, int h, uint16_t color)
+        {
+            if (!g_active || w <= 0 || h <= 0)
+                return;
+            add(makeCmd(K_RECT, x, y, w, h, color));
+        }
+
+        void circle(int x, int y, int r, uint16_t color)
+        {
+            if (!g_active || r <= 0)
+                return;
+            Cmd c = makeCmd(K_CIRCLE, x, y, r, 0, color);
+            c.bx0 = c.x - r;
+            c.by0 = c.y - r;
+            c.bx1 = c.x + r + 1;
+            c.by1 = c.y + r + 1;
+            add(std::move(c));
+        }
+
+        void text(int x, int y, const String &text, uint16_t color, int size)
+        {
+            if (!g_active || text.length() == 0)
+                return;
+            if (size < 1)
+                size = 1;
+            // default GLCD font: 6 x 8 per char
+            Cmd c = makeCmd(K_TEXT, x, y, text.length() * 6 * size, 8 * size, color);
+            c.size = size;
+            c.data = text;
+            add(std::move(c));
+        }
+
+        void svg(const String &svg, int x, int y, int w, int h, uint16_t color)
+        {
+            if (!g_active || w <= 0 || h <= 0)
+                return;
+            Cmd c = makeCmd(K_SVG, x, y, w, h, color);
+            c.data = svg;
+            add(std::move(c));
+        }
+
+        void image(const std::shared_ptr<NSVGimage> &image, int x, int y, int w, int h, uint16_t color)
+        {
+            if (!g_active || !image || w <= 0 || h <= 0)
+                return;
+            Cmd c = makeCmd(K_IMAGE, x, y, w, h, color);
+            c.image = image;
+            add(std::move(c));
+        }
+
+        // draw one command into gfx whose (0, 0) is the screen point (dx, dy); a template so SVGs
+        // blend over the band sprite in RAM instead of reading the panel
+        template <typename Gfx>
+        static void draw(Gfx &gfx, const Cmd &c, int dx, int dy)
+        {
+            switch (c.kind)
+            {
+            case K_RECT:
+                gfx.fillRect(c.x - dx, c.y - dy, c.w, c.h, c.color);
+                break;
+            case K_CIRCLE:
+                gfx.drawCircle(c.x - dx, c.y - dy, c.w, c.color);
+                break;
+            case K_TEXT:
+                gfx.setTextSize(c.size);
+                gfx.setTextColor(c.color);
+                gfx.setCursor(c.x - dx, c.y - dy);
+                gfx.print(c.data);
+                break;
+            case K_SVG:
+                drawSVGString(gfx, c.data, c.x - dx, c.y - dy, c.w, c.h, c.color);
+                break;
+            case K_IMAGE:
+                drawSVGImage(gfx, c.image.get(), c.x - dx, c.y - dy, c.w, c.h, c.color);
+                break;
+            }
+        }
+
+        static bool ensureBand()
+        {
+            if (g_band && g_bandW == g_cw)
+                return true;
+            if (!g_band)
+                g_band = new TFT_eSprite(&Screen::tft);
+            else
+                g_band->deleteSprite();
+            g_band->setColorDepth(16);
+            g_bandW = g_band->createSprite(g_cw, BAND_H) ? g_cw : 0;
+            if (!g_bandW)
+                Serial.println("[Browser] Frame: no RAM for band sprite, drawing direct");
+            return g_bandW != 0;
+        }
+
+        static void composeBand(int band)
+        {
+            const int y0 = g_cy + band * BAND_H;
+            const int y1 = std::min(y0 + BAND_H, g_cy + g_ch);
+
+            // start from the last fill that covers the whole band, everything before it is hidden
+            size_t first = 0;
+            bool covered = false;
+            for (size_t i = g_cmds.size(); i-- > 0;)
+            {
+                const Cmd &c = g_cmds[i];
+                if (c.kind == K_RECT && c.bx0 <= g_cx && c.bx1 >= g_cx + g_cw && c.by0 <= y0 && c.by1 >= y1)
+                {
+                    first = i;
+                    covered = true;
+                    break;
+                }
+            }
+
+            if (!covered)
+            {
+                // partial update: keep what is on the panel around the new content
+                Screen::tft.readRect(g_cx, y0, g_cw, y1 - y0, (uint16_t *)g_band->getPointer());
+                g_stats.readbacks++;
+            }
+
+            for (size_t i = 0; i < g_cmds.size(); i++)
+            {
+                const Cmd &c = g_cmds[i];
+                if (c.by1 <= y0 || c.by0 >= y1)
+                    continue;
+                if (i < first)
+                {
+                    g_stats.culled++;
+                    continue;
+                }
+                draw(*g_band, c, g_cx, y0);
+            }
+
+            g_band->pushSprite(g_cx, y0);
+            g_stats.bands++;
+        }
+
+        bool end()
+        {
+            if (!g_active)
+                return false;
+            g_active = false;
+
+            uint32_t t0 = micros();
+
+            // compose in screen coordinates, the clip rect keeps the last band inside the frame
+            int32_t vx = Screen::tft.getViewportX(), vy = Screen::tft.getViewportY();
+            int32_t vw = Screen::tft.getViewportWidth(), vh = Screen::tft.getViewportHeight();
+            bool vDatum = Screen::tft.getViewportDatum();
+            Screen::tft.setViewport(g_cx, g_cy, g_cw, g_ch, false);
+
+            if (ensureBand())
+            {
+                for (int b = 0; b < (int)g_dirty.size(); b++)
+                    if (g_dirty[b])
+                        composeBand(b);
+            }
+            else
+            {
+                for (const Cmd &c : g_cmds)
+                    draw(Screen::tft, c, 0, 0);
+                g_stats.direct++;
+            }
+
+            Screen::tft.setViewport(vx, vy, vw, vh, vDatum);
+
+            uint32_t us = micros() - t0;
+            g_stats.frames++;
+            g_stats.lastUs = us;
+            g_stats.totalUs += us;
+            if (us > g_stats.maxUs)
+                g_stats.maxUs = us;
+
+            g_cmds.clear();
+            g_textBytes = 0;
+            return true;
+        }
+
+        void cancel()
+        {
+            g_active = false;
+            g_cmds.clear();
+            g_textBytes = 0;
+        }
+
+        void release()
+        {
+            cancel();
+            g_cmds.shrink_to_fit();
+            if (g_band)
+            {
+                g_band->deleteSprite();
+                delete g_band;
+                g_band = nullptr;
+            }
+            g_bandW = 0;
+        }
+
+        bool scroll(int x, int y, int w, int h, int dx, int dy, uint16_t fill)
+        {
+            if (dx == 0 && dy == 0)
+                return true;
+
+            // commands recorded so far belong before the move
+            bool reopen = g_active;
+            int cx = g_cx, cy = g_cy, cw = g_cw, ch = g_ch, ox = g_ox, oy = g_oy;
+            if (reopen)
+                end();
+
+            uint32_t t0 = micros();
+            int32_t vx = Screen::tft.getViewportX(), vy = Screen::tft.getViewportY();
+            int32_t vw = Screen::tft.getViewportWidth(), vh = Screen::tft.getViewportHeight();
+            bool vDatum = Screen::tft.getViewportDatum();
+            Screen::tft.setViewport(x, y, w, h, false);
+
+            bool moved = false;
+            const int copyW = w - abs(dx), copyH = h - abs(dy);
+            if (copyW <= 0 || copyH <= 0)
+            {
+                Screen::tft.fillRect(x, y, w, h, fill);
+            }
+            else
+            {
+                const int srcX = x + std::max(0, -dx), dstX = x + std::max(0, dx);
+                const int srcY = y + std::max(0, -dy), dstY = y + std::max(0, dy);
+
+                int rows = std::min(BAND_H, copyH);
+                uint16_t *buf = nullptr;
+                while (rows > 0 && !(buf = (uint16_t *)malloc((size_t)copyW * rows * sizeof(uint16_t))))
+                    rows /= 2;
+
+                if (buf)
+                {
+                    // moving down: copy bottom strip first, otherwise top first
+                    const int strips = (copyH + rows - 1) / rows;
+                    for (int i = 0; i < strips; i++)
+                    {
+                        int s = dy > 0 ? strips - 1 - i : i;
+                        int off = s * rows;
+                        int n = std::min(rows, copyH - off);
+                        Screen::tft.readRect(srcX, srcY + off, copyW, n, buf);
+                        Screen::tft.pushRect(dstX, dstY + off, copyW, n, buf);
+                    }
+                    free(buf);
+                    g_stats.scrollPixels += (uint32_t)copyW * copyH;
+                    moved = true;
+
+                    // exposed strips
+                    if (dy > 0)
+                        Screen::tft.fillRect(x, y, w, dy, fill);
+                    else if (dy < 0)
+                        Screen::tft.fillRect(x, y + h + dy, w, -dy, fill);
+                    if (dx > 0)
+                        Screen::tft.fillRect(x, y, dx, h, fill);
+                    else if (dx < 0)
+                        Screen::tft.fillRect(x + w + dx, y, -dx, h, fill);
+                }
+                else
+                {
+                    Serial.println("[Browser] scroll: no RAM for strip buffer");
+                    Screen::tft.fillRect(x, y, w, h, fill);
+                }
+            }
+
+            Screen::tft.setViewport(vx, vy, vw, vh, vDatum);
+            g_stats.scrolls++;
+            g_stats.scrollUs = micros() - t0;
+
+            if (reopen)
+                begin(cx, cy, cw, ch, ox, oy);
+            return moved;
+        }
+
+        Stats stats()
+        {
+            return g_stats;
+        }
+
+        void resetStats()
+        {
+            g_stats = Stats();
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+extern "C"
+{
+#include "nanosvg.h"
+}
+
+// Offscreen composition for server frames (BeginFrame ... EndFrame).
+//
+// Draw commands inside a frame are only recorded. end() replays them band by band into a
+// frame wide BAND_H sprite and pushes every damaged band with one transfer, so the user never sees
+// a half built page. Bands that are not fully covered by a FillRect start from the pixels read back
+// from the panel. If the sprite cannot be allocated the commands are replayed straight to the panel.
+namespace Browser
+{
+    namespace Frame
+    {
+        constexpr int BAND_H = 24;           // 320 x 24 x 2 = 15 KB sprite
+        constexpr size_t MAX_COMMANDS = 256; // bigger frames are flushed in parts
+        constexpr size_t MAX_TEXT_BYTES = 16 * 1024;
+
+        // Start a frame clipped to the screen rect (clipX, clipY, clipW, clipH). Command
+        // coordinates are relative to (originX, originY), the datum the panel uses right now.
+        void begin(int clipX, int clipY, int clipW, int clipH, int originX, int originY);
+        bool active();
+
+        void fillRect(int x, int y, int w, int h, uint16_t color);
+        void circle(int x, int y, int r, uint16_t color);
+        void text(int x, int y, const String &text, uint16_t color, int size);
+        void svg(const String &svg, int x, int y, int w, int h, uint16_t color);
+        void image(const std::shared_ptr<NSVGimage> &image, int x, int y, int w, int h, uint16_t color);
+
+        // Compose and push the damaged bands; false if no frame was open
+        bool end();
+        // Drop a frame without drawing (disconnect, navigation)
+        void cancel();
+        // Free the band sprite
+        void release();
+
+        // Move the pixels of the screen rect (x, y, w, h) by (dx, dy) and fill the exposed strips.
+        // Copies go through the panel (readRect/pushRect) in BAND_H row strips, in the order that
+        // never overwrites rows still to be read. An open frame is pushed first.
+        // false if nothing could be moved (whole rect filled): the caller has to redraw all of it.
+        bool scroll(int x, int y, int w, int h, int dx, int dy, uint16_t fill);
+
+        struct Stats
+        {
+            uint32_t frames = 0;
+            uint32_t commands = 0;
+            uint32_t culled = 0;    // commands hidden behind a later full band fill
+            uint32_t bands = 0;     // bands pushed
+            uint32_t readbacks = 0; // bands that needed the panel content
+            uint32_t direct = 0;    // frames drawn without sprite
+            uint32_t lastUs = 0;    // compose + push time of the last frame
+            uint32_t maxUs = 0;
+            uint64_t totalUs = 0;
+            uint32_t scrolls = 0;
+            uint32_t scrollPixels = 0; // pixels moved instead of redrawn
+            uint32_t scrollUs = 0;     // time of the last scroll
+        };
+
+        Stats stats();
+        void resetStats();
+    }
+}
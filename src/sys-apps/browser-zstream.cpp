@@ -0,0 +1,133 @@
+#include "browser-zstream.hpp"
+
+#include "rom/miniz.h"
+
+namespace Browser
+{
+    namespace ZStream
+    {
+        static tinfl_decompressor *g_inflater = nullptr;
+        static uint8_t *g_window = nullptr;
+        static size_t g_windowPos = 0;
+        static uint8_t g_epoch = 0;
+        static Stats g_stats;
+
+        bool start()
+        {
+            if (g_inflater)
+                return true;
+            g_inflater = (tinfl_decompressor *)malloc(sizeof(tinfl_decompressor));
+            g_window = (uint8_t *)malloc(WINDOW);
+            if (!g_inflater || !g_window)
+            {
+                Serial.println("[Browser] zstream: no RAM, staying uncompressed");
+                stop();
+                return false;
+            }
+            tinfl_init(g_inflater);
+            g_windowPos = 0;
+            g_epoch = 0; // new session, new stream
+            return true;
+        }
+
+        void stop()
+        {
+            free(g_inflater);
+            free(g_window);
+            g_inflater = nullptr;
+            g_window = nullptr;
+        }
+
+        bool active()
+        {
+            return g_inflater != nullptr;
+        }
+
+        uint8_t epoch()
+        {
+            return g_epoch;
+        }
+
+        void reset()
+        {
+            g_epoch++;
+            if (g_inflater)
+                tinfl_init(g_inflater);
+            g_windowPos = 0;
+        }
+
+        bool inflate(const uint8_t *in, size_t len, std::vector<uint8_t> &out)
+        {
+            out.clear();
+            if (!g_inflater)
+                return false;
+
+            uint32_t t0 = micros();
+            g_stats.wireBytes += len;
+            bool ok = true;
+            while (true)
+            {
+                size_t inSize = len;
+                size_t outSize = WINDOW - g_windowPos;
+                // the stream never ends, every message stops at a sync flush
+                tinfl_status st = tinfl_decompress(g_inflater, in, &inSize, g_window, g_window + g_windowPos, &outSize,
+                                                   TINFL_FLAG_HAS_MORE_INPUT);
+                in += inSize;
+                len -= inSize;
+
+                if (out.size() + outSize > MAX_MESSAGE)
+                {
+                    Serial.println("[Browser] zstream: message too large");
+                    ok = false;
+                    break;
+                }
+                out.insert(out.end(), g_window + g_windowPos, g_window + g_windowPos + outSize);
+                g_windowPos = (g_windowPos + outSize) & (WINDOW - 1);
+
+                if (st < TINFL_STATUS_DONE)
+                {
+                    Serial.printf("[Browser] zstream: inflate error %d\n", (int)st);
+                    ok = false;
+                    break;
+                }
+                if (st == TINFL_STATUS_DONE)
+                {
+                    // a final block is not part of the protocol
+                    ok = false;
+                    break;
+                }
+                if (st == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0)
+                    break;
+                // TINFL_STATUS_HAS_MORE_OUTPUT: ring wrapped, go on
+            }
+
+            uint32_t us = micros() - t0;
+            if (!ok)
+            {
+                g_stats.errors++;
+                return false;
+            }
+            g_stats.messages++;
+            g_stats.rawBytes += out.size();
+            g_stats.decodeUs += us;
+            if (us > g_stats.maxDecodeUs)
+                g_stats.maxDecodeUs = us;
+            return true;
+        }
+
+        Stats stats()
+        {
+            return g_stats;
+        }
+
+        void resetStats()
+        {
+            g_stats = Stats();
+        }
+
+        void countDropped()
+        {
+            g_stats.dropped++;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+// Compressed server messages (MWOSP capability "z", needs v2).
+//
+// The server keeps one raw deflate stream per session (window 2^WINDOW_BITS, Z_SYNC_FLUSH after
+// every message) and sends each message as MWOSP::OP_COMPRESSED:
+//     u8 epoch | u8 kind ('T' v1 text, 'B' v2 frame) | deflate bytes
+// The client inflates with the ROM tinfl into a WINDOW sized ring, so the dictionary carries over
+// from message to message. A broken stream is answered with "ZReset <epoch>"; the server then
+// starts a fresh stream with that epoch and everything still in flight from the old one is dropped.
+namespace Browser
+{
+    namespace ZStream
+    {
+        constexpr int WINDOW_BITS = 12;                // must match the server
+        constexpr size_t WINDOW = 1u << WINDOW_BITS;   // 4 KB ring
+        constexpr size_t MAX_MESSAGE = 16 * 1024;      // decoded size limit per message
+
+        // Allocate the decoder (~11 KB + WINDOW); false if there is no RAM
+        bool start();
+        void stop();
+        bool active();
+
+        uint8_t epoch();
+        // Fresh stream with the next epoch
+        void reset();
+
+        // Inflate one message into out (cleared first, at most MAX_MESSAGE bytes).
+        // false if the stream is broken, the caller must reset() and tell the server.
+        bool inflate(const uint8_t *in, size_t len, std::vector<uint8_t> &out);
+
+        struct Stats
+        {
+            uint32_t messages = 0;
+            uint32_t dropped = 0; // old epoch
+            uint32_t errors = 0;
+            uint64_t wireBytes = 0; // compressed
+            uint64_t rawBytes = 0;  // after inflate
+            uint32_t decodeUs = 0;  // all messages
+            uint32_t maxDecodeUs = 0;
+        };
+
+        // Counters are per connection, cleared on connect
+        Stats stats();
+        void resetStats();
+        void countDropped();
+    }
+}
@@ -13,6 +13,10 @@
 #include "../io/read-string.hpp"
 #include "../styles/global.hpp"
 #include "../fs/enc-fs.hpp"
+#include "mwosp.hpp"
+#include "browser-frame.hpp"
+#include "browser-assets.hpp"
+#include "browser-zstream.hpp"
 
 #include "nanosvg.h"
 
@@ -100,6 +104,42 @@ namespace Browser
         uint16_t placeholder = Style::Colors::placeholder;
     } theme;
 
+    // Theme colors by protocol name; the index is the slot of MWOSP::OP_THEME_COLOR
+    static const struct
+    {
+        const char *name;
+        uint16_t Theme::*color;
+    } THEME_SLOTS[] = {
+        {"bg", &Theme::bg},
+        {"text", &Theme::text},
+        {"primary", &Theme::primary},
+        {"accent", &Theme::accent},
+        {"accent2", &Theme::accent2},
+        {"accentText", &Theme::accentText},
+        {"pressed", &Theme::pressed},
+        {"danger", &Theme::danger},
+        {"placeholder", &Theme::placeholder},
+    };
+    static constexpr int THEME_SLOT_COUNT = sizeof(THEME_SLOTS) / sizeof(THEME_SLOTS[0]);
+
+    static uint16_t *themeColor(const String &name)
+    {
+        for (const auto &slot : THEME_SLOTS)
+            if (name == slot.name)
+                return &(theme.*slot.color);
+        return nullptr;
+    }
+
+    // server speaks MWOSP-v2 (binary frames), see mwosp.hpp
+    static bool protoV2 = false;
+
+    // inflated OP_COMPRESSED message, reused between messages
+    static std::vector<uint8_t> inflated;
+    static bool inflating = false;
+
+    // text commands and v2 ops handled, see commandCount()
+    static uint32_t handledCommands = 0;
+
     // touch/scroll state
     static int visitScrollOffset = 0;
     static bool touchActive = false;
@@ -116,6 +156,21 @@ namespace Browser
     // recent inputs cache
     static std::vector<String> recentInputs;
 
+    // DrawAsset calls that wait for the DefineAsset answering our MissingAsset. Coordinates
+    // follow the page through ScrollViewport, see scrollViewport().
+    struct PendingAsset
+    {
+        String hash;
+        int16_t x, y, w, h;
+        uint16_t color;
+    };
+    static std::vector<PendingAsset> pendingAssets;
+    static constexpr size_t MAX_PENDING_ASSETS = 16;
+
+    // session recording / replay, see startRecording()
+    static File recordFile;
+    static bool replaying = false;
+
     // ---------------------------
     // LocalStorage: LittleFS-backed, binary-friendly
     // ---------------------------
@@ -156,6 +211,45 @@ namespace Browser
             }
         }
 
+        // In-memory copy of what listSites() shows: one entry per storage file, the file content
+        // or, for an empty file, its name token. Loaded once, then kept current by set/del/clearAll
+        // so scrolling the home list never touches flash.
+        static std::vector<String> siteTokens;
+        static std::vector<String> siteNames;
+        static bool sitesLoaded = false;
+
+        static void indexPut(const String &key, const String &content)
+        {
+            if (!sitesLoaded)
+                return;
+            String token = base64EncodeSafe(key);
+            String shown = content.length() ? content : token;
+            for (size_t i = 0; i < siteTokens.size(); ++i)
+            {
+                if (siteTokens[i] == token)
+                {
+                    siteNames[i] = shown;
+                    return;
+                }
+            }
+            siteTokens.push_back(token);
+            siteNames.push_back(shown);
+        }
+
+        static void indexDel(const String &key)
+        {
+            String token = base64EncodeSafe(key);
+            for (size_t i = 0; i < siteTokens.size(); ++i)
+            {
+                if (siteTokens[i] == token)
+                {
+                    siteTokens.erase(siteTokens.begin() + i);
+                    siteNames.erase(siteNames.begin() + i);
+                    return;
+                }
+            }
+        }
+
         // write string
         void set(const String &key, const String &val)
         {
@@ -166,6 +260,7 @@ namespace Browser
                 return;
             f.print(val);
             f.close();
+            indexPut(key, val);
         }
 
         // write binary
@@ -179,6 +274,9 @@ namespace Browser
             if (!buf.empty())
                 f.write(buf.data(), buf.size());
             f.close();
+            String content;
+            content.concat((const char *)buf.data(), buf.size());
+            indexPut(key, content);
         }
 
         // read string (for older usage)
@@ -220,10 +318,13 @@ namespace Browser
             String p = toPath(key);
             if (LittleFS.exists(p))
                 LittleFS.remove(p);
+            indexDel(key);
         }
 
         void clearAll()
         {
+            siteTokens.clear();
+            siteNames.clear();
             if (!LittleFS.exists("/browser/storage"))
                 return;
             File root = LittleFS.open("/browser/storage", "r");
@@ -239,46 +340,40 @@ namespace Browser
             root.close();
         }
 
-        std::vector<String> listSites()
+        const std::vector<String> &listSites()
         {
-            std::vector<String> out;
+            if (sitesLoaded)
+                return siteNames;
+            sitesLoaded = true;
+            siteTokens.clear();
+            siteNames.clear();
             if (!LittleFS.exists("/browser/storage"))
-                return out;
+                return siteNames;
             File root = LittleFS.open("/browser/storage", "r");
             if (!root)
-                return out;
+                return siteNames;
             File file;
             while (file = root.openNextFile())
             {
                 String name = String(file.name()); // full path
-                // try to read human-readable content; if not present, fall back to base filename
+                file.close();
+                // filename portion (without path and extension)
+                int lastSlash = name.lastIndexOf('/');
+                int dot = name.lastIndexOf('.');
+                String token = name.substring(lastSlash + 1, dot > lastSlash ? dot : name.length());
+                // human-readable content if present, otherwise the token
                 String content;
                 File f = LittleFS.open(name, "r");
                 if (f)
                 {
                     content = f.readString();
                     f.close();
-                    if (content.length())
-                        out.push_back(content);
-                    else
-                    {
-                        // fallback: get filename portion (without path and extension)
-                        int lastSlash = name.lastIndexOf('/');
-                        int dot = name.lastIndexOf('.');
-                        String token = name.substring(lastSlash + 1, dot > lastSlash ? dot : name.length());
-                        out.push_back(token);
-                    }
-                }
-                else
-                {
-                    int lastSlash = name.lastIndexOf('/');
-                    int dot = name.lastIndexOf('.');
-                    String token = name.substring(lastSlash + 1, dot > lastSlash ? dot : name.length());
-                    out.push_back(token);
                 }
+                siteTokens.push_back(token);
+                siteNames.push_back(content.length() ? content : token);
             }
             root.close();
-            return out;
+            return siteNames;
         }
     } // namespace LocalStorage
 
@@ -322,25 +417,30 @@ namespace Browser
     // ---------------------------
     // Drawing helpers
     // ---------------------------
-    void drawText(int x, int y, const String &text, uint16_t color, int size)
+    // text as drawText shows it: cut with "..." at the right edge, empty if nothing fits
+    static String fitText(int x, int y, const String &text, int size)
     {
         int localW = viewportActive ? vpW : SCREEN_W;
         int localH = viewportActive ? vpH : SCREEN_H;
         if (y < 0 || y >= localH)
+            return String();
+        int textWidth = text.length() * 6 * size;
+        if (x + textWidth <= localW)
+            return text;
+        int maxChars = (localW - x) / (6 * size);
+        if (maxChars > 3)
+            return text.substring(0, maxChars - 3) + "...";
+        return String();
+    }
+
+    void drawText(int x, int y, const String &text, uint16_t color, int size)
+    {
+        String display = fitText(x, y, text, size);
+        if (!display.length())
             return;
         Screen::tft.setTextSize(size);
         Screen::tft.setTextColor(color);
         Screen::tft.setCursor(x, y);
-        int textWidth = text.length() * 6 * size;
-        String display = text;
-        if (x + textWidth > localW)
-        {
-            int maxChars = (localW - x) / (6 * size);
-            if (maxChars > 3)
-                display = text.substring(0, maxChars - 3) + "...";
-            else
-                return;
-        }
         Screen::tft.print(display);
     }
 
@@ -358,6 +458,225 @@ namespace Browser
             Serial.println("[Browser] drawSVG: parse failed");
     }
 
+    // Server draw commands, clipped to the screen (shared by the v1 text and v2 binary paths).
+    // Between BeginFrame and EndFrame they are only recorded, see browser-frame.hpp.
+    static void fillRectClipped(int x, int y, int w, int h, uint16_t c)
+    {
+        if (x < 0)
+        {
+            w += x;
+            x = 0;
+        }
+        if (y < 0)
+        {
+            h += y;
+            y = 0;
+        }
+        if (x + w > SCREEN_W)
+            w = SCREEN_W - x;
+        if (y + h > SCREEN_H)
+            h = SCREEN_H - y;
+        if (w <= 0 || h <= 0)
+            return;
+        if (Frame::active())
+            Frame::fillRect(x, y, w, h, c);
+        else
+            Screen::tft.fillRect(x, y, w, h, c);
+    }
+
+    static void drawCircleClipped(int x, int y, int r, uint16_t c)
+    {
+        if (r <= 0 || x < -r || x > SCREEN_W + r || y < -r || y > SCREEN_H + r)
+            return;
+        if (Frame::active())
+            Frame::circle(x, y, r, c);
+        else
+            drawCircle(x, y, r, c);
+    }
+
+    static void drawTextServer(int x, int y, const String &text, uint16_t c, int size)
+    {
+        if (Frame::active())
+            Frame::text(x, y, fitText(x, y, text, size), c, size);
+        else
+            drawText(x, y, text, c, size);
+    }
+
+    // SVG target box cut to the screen, false if nothing is left
+    static bool clipSVGBox(int &x, int &y, int &w, int &h)
+    {
+        if (x < 0)
+        {
+            w += x;
+            x = 0;
+        }
+        if (y < 0)
+        {
+            h += y;
+            y = 0;
+        }
+        if (x >= SCREEN_W || y >= SCREEN_H)
+            return false;
+        if (x + w > SCREEN_W)
+            w = SCREEN_W - x;
+        if (y + h > SCREEN_H)
+            h = SCREEN_H - y;
+        return w > 0 && h > 0;
+    }
+
+    static void drawSVGClipped(const String &svg, int x, int y, int w, int h, uint16_t c)
+    {
+        if (!clipSVGBox(x, y, w, h))
+            return;
+        if (Frame::active())
+            Frame::svg(svg, x, y, w, h, c);
+        else
+            drawSVG(svg, x, y, w, h, c);
+    }
+
+    // Screen area the server draws into: the current viewport, or the page below the top bar
+    // while a site is open. Used by frames and ScrollViewport.
+    static void serverRegion(int &x, int &y, int &w, int &h)
+    {
+        if (viewportActive)
+        {
+            x = vpX;
+            y = vpY;
+            w = vpW;
+            h = vpH;
+        }
+        else if (loc.state == "home" || loc.state == "")
+        {
+            x = 0;
+            y = 0;
+            w = SCREEN_W;
+            h = SCREEN_H;
+        }
+        else
+        {
+            x = 0;
+            y = VIEWPORT_Y;
+            w = SCREEN_W;
+            h = VIEWPORT_H;
+        }
+    }
+
+    static void beginFrame()
+    {
+        int x, y, w, h;
+        serverRegion(x, y, w, h);
+        if (viewportActive)
+            Frame::begin(x, y, w, h, vpX, vpY);
+        else
+            Frame::begin(x, y, w, h, 0, 0);
+    }
+
+    // DrawAsset: cached image, or ask the server for it and draw once it arrives
+    static void drawAsset(const String &hash, int x, int y, int w, int h, uint16_t c)
+    {
+        Assets::Image img = Assets::get(loc.domain, hash);
+        if (img)
+        {
+            if (!clipSVGBox(x, y, w, h))
+                return;
+            if (Frame::active())
+                Frame::image(img, x, y, w, h, c);
+            else
+                drawSVGImage(Screen::tft, img.get(), x, y, w, h, c);
+            return;
+        }
+        if (!Assets::validHash(hash))
+            return;
+
+        bool requested = false;
+        for (const PendingAsset &p : pendingAssets)
+            requested |= (p.hash == hash);
+        if (pendingAssets.size() < MAX_PENDING_ASSETS)
+            pendingAssets.push_back({hash, (int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h, c});
+        if (!requested)
+            webSocket.sendTXT("MissingAsset " + hash);
+    }
+
+    static void defineAsset(const String &hash, const char *data, size_t len)
+    {
+        if (!Assets::define(loc.domain, hash, data, len))
+            return;
+        std::vector<PendingAsset> waiting;
+        for (auto it = pendingAssets.begin(); it != pendingAssets.end();)
+        {
+            if (it->hash == hash)
+            {
+                waiting.push_back(*it);
+                it = pendingAssets.erase(it);
+            }
+            else
+                ++it;
+        }
+        if (waiting.empty())
+            return;
+
+        // the answer usually arrives after the frame that asked for it has ended: compose the
+        // late images as a frame of their own, clipped to the page like the server's frames
+        bool ownFrame = !Frame::active();
+        if (ownFrame)
+            beginFrame();
+        for (const PendingAsset &p : waiting)
+            drawAsset(p.hash, p.x, p.y, p.w, p.h, p.color);
+        if (ownFrame)
+            Frame::end();
+    }
+
+    static String assetStats()
+    {
+        Assets::Stats st = Assets::stats();
+        uint32_t lookups = st.ramHits + st.diskHits + st.misses;
+        char buf[200];
+        snprintf(buf, sizeof(buf), "ram=%u disk=%u miss=%u hitrate=%u%% defines=%u bytes=%u rejected=%u evictions=%u entries=%u ramBytes=%u",
+                 (unsigned)st.ramHits, (unsigned)st.diskHits, (unsigned)st.misses,
+                 (unsigned)(lookups ? (st.ramHits + st.diskHits) * 100 / lookups : 0),
+                 (unsigned)st.defines, (unsigned)st.bytesDefined, (unsigned)st.rejected,
+                 (unsigned)st.evictions, (unsigned)st.entries, (unsigned)st.ramBytes);
+        return String(buf);
+    }
+
+    // ScrollViewport dx dy: move the page pixels on the device, the server only redraws the
+    // exposed strip (filled with the theme background until then)
+    static void scrollViewport(int dx, int dy)
+    {
+        int x, y, w, h;
+        serverRegion(x, y, w, h);
+        if (!Frame::scroll(x, y, w, h, dx, dy, theme.bg))
+        {
+            // everything was refilled, the server redraws the whole page
+            pendingAssets.clear();
+            return;
+        }
+
+        // images still waiting for their DefineAsset move with the page; drop the ones that
+        // left it (the server draws them again if they come back)
+        if (viewportActive)
+        {
+            x = 0; // DrawAsset coordinates are relative to the viewport
+            y = 0;
+        }
+        for (auto it = pendingAssets.begin(); it != pendingAssets.end();)
+        {
+            it->x += dx;
+            it->y += dy;
+            if (it->x >= x + w || it->y >= y + h || it->x + it->w <= x || it->y + it->h <= y)
+                it = pendingAssets.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    static void setThemeColor(uint16_t &slot, uint16_t color)
+    {
+        slot = color;
+        if (loc.state == "home" || loc.state == "website")
+            ReRender();
+    }
+
     // ---------------------------
     // clamp helper
     // ---------------------------
@@ -389,36 +708,49 @@ namespace Browser
         return res;
     }
 
+    // "home" | domain[:port][@state]
+    static void navigateTo(String arg)
+    {
+        arg.trim();
+        if (arg == "home")
+        {
+            loc.state = "home";
+            ReRender();
+            return;
+        }
+        String domain = arg;
+        int port = 443;
+        String state = "startpage";
+        int at = arg.indexOf('@');
+        if (at >= 0)
+        {
+            domain = arg.substring(0, at);
+            state = arg.substring(at + 1);
+        }
+        int colon = domain.indexOf(':');
+        if (colon >= 0)
+        {
+            port = domain.substring(colon + 1).toInt();
+            domain = domain.substring(0, colon);
+        }
+        navigate(domain, port, state);
+    }
+
     // ---------------------------
     // Command handling (from server)
     // ---------------------------
     void handleCommand(const String &payload)
     {
-        Serial.printf("[Browser] handleCommand payload='%s'\n", payload.c_str());
+        handledCommands++;
+        if (!protoV2)
+            Serial.printf("[Browser] handleCommand payload='%s'\n", payload.c_str());
 
         if (payload.startsWith("FillRect"))
         {
             int x = 0, y = 0, w = 0, h = 0;
             unsigned int c = 0;
             if (sscanf(payload.c_str(), "FillRect %d %d %d %d %u", &x, &y, &w, &h, &c) == 5)
-            {
-                if (x < 0)
-                {
-                    w += x;
-                    x = 0;
-                }
-                if (y < 0)
-                {
-                    h += y;
-                    y = 0;
-                }
-                if (x + w > SCREEN_W)
-                    w = SCREEN_W - x;
-                if (y + h > SCREEN_H)
-                    h = SCREEN_H - y;
-                if (w > 0 && h > 0)
-                    Screen::tft.fillRect(x, y, w, h, (uint16_t)c);
-            }
+                fillRectClipped(x, y, w, h, (uint16_t)c);
             return;
         }
 
@@ -427,10 +759,7 @@ namespace Browser
             int x = 0, y = 0, r = 0;
             unsigned int c = 0;
             if (sscanf(payload.c_str(), "DrawCircle %d %d %d %u", &x, &y, &r, &c) == 4)
-            {
-                if (r > 0 && x >= -r && x <= SCREEN_W + r && y >= -r && y <= SCREEN_H + r)
-                    drawCircle(x, y, r, (uint16_t)c);
-            }
+                drawCircleClipped(x, y, r, (uint16_t)c);
             return;
         }
 
@@ -442,7 +771,7 @@ namespace Browser
             if (sscanf(payload.c_str(), "DrawText %d %d %d %u %[^\n]", &x, &y, &size, &c, buf) >= 5)
             {
                 String text = String(buf);
-                drawText(x, y, text, (uint16_t)c, size);
+                drawTextServer(x, y, text, (uint16_t)c, size);
             }
             return;
         }
@@ -465,31 +794,55 @@ namespace Browser
                     }
                 }
                 if (headerEnd >= 0 && headerEnd + 1 < (int)payload.length())
-                {
-                    String svg = payload.substring(headerEnd + 1);
-                    if (x < 0)
-                    {
-                        w += x;
-                        x = 0;
-                    }
-                    if (y < 0)
-                    {
-                        h += y;
-                        y = 0;
-                    }
-                    if (x >= SCREEN_W || y >= SCREEN_H)
-                        return;
-                    if (x + w > SCREEN_W)
-                        w = SCREEN_W - x;
-                    if (y + h > SCREEN_H)
-                        h = SCREEN_H - y;
-                    if (w > 0 && h > 0)
-                        drawSVG(svg, x, y, w, h, (uint16_t)c);
-                }
+                    drawSVGClipped(payload.substring(headerEnd + 1), x, y, w, h, (uint16_t)c);
             }
             return;
         }
 
+        if (payload.startsWith("DefineAsset "))
+        {
+            int idx = payload.indexOf(' ', 12);
+            if (idx > 0)
+                defineAsset(payload.substring(12, idx), payload.c_str() + idx + 1, payload.length() - idx - 1);
+            return;
+        }
+
+        if (payload.startsWith("DrawAsset "))
+        {
+            char hash[Assets::MAX_HASH_LEN + 1] = {0};
+            int x = 0, y = 0, w = 0, h = 0;
+            unsigned int c = 0;
+            if (sscanf(payload.c_str(), "DrawAsset %64s %d %d %d %d %u", hash, &x, &y, &w, &h, &c) == 6)
+                drawAsset(String(hash), x, y, w, h, (uint16_t)c);
+            return;
+        }
+
+        if (payload == "GetAssetStats")
+        {
+            webSocket.sendTXT("AssetStats " + assetStats());
+            return;
+        }
+
+        if (payload.startsWith("ScrollViewport "))
+        {
+            int dx = 0, dy = 0;
+            if (sscanf(payload.c_str(), "ScrollViewport %d %d", &dx, &dy) == 2)
+                scrollViewport(dx, dy);
+            return;
+        }
+
+        if (payload == "BeginFrame")
+        {
+            beginFrame();
+            return;
+        }
+
+        if (payload == "EndFrame")
+        {
+            Frame::end();
+            return;
+        }
+
         // Theme / storage / navigation
         if (payload.startsWith("SetThemeColor"))
         {
@@ -501,26 +854,9 @@ namespace Browser
                 if (colorValue.startsWith("0x"))
                     colorValue = colorValue.substring(2);
                 uint16_t color = (uint16_t)strtoul(colorValue.c_str(), nullptr, 16);
-                if (colorName == "bg")
-                    theme.bg = color;
-                else if (colorName == "text")
-                    theme.text = color;
-                else if (colorName == "primary")
-                    theme.primary = color;
-                else if (colorName == "accent")
-                    theme.accent = color;
-                else if (colorName == "accent2")
-                    theme.accent2 = color;
-                else if (colorName == "accentText")
-                    theme.accentText = color;
-                else if (colorName == "pressed")
-                    theme.pressed = color;
-                else if (colorName == "danger")
-                    theme.danger = color;
-                else if (colorName == "placeholder")
-                    theme.placeholder = color;
-                if (loc.state == "home" || loc.state == "website")
-                    ReRender();
+                uint16_t *slot = themeColor(colorName);
+                if (slot)
+                    setThemeColor(*slot, color);
             }
             return;
         }
@@ -528,25 +864,8 @@ namespace Browser
         if (payload.startsWith("GetThemeColor"))
         {
             String name = payload.substring(14);
-            uint16_t c = 0xFFFF;
-            if (name == "bg")
-                c = theme.bg;
-            else if (name == "text")
-                c = theme.text;
-            else if (name == "primary")
-                c = theme.primary;
-            else if (name == "accent")
-                c = theme.accent;
-            else if (name == "accent2")
-                c = theme.accent2;
-            else if (name == "accentText")
-                c = theme.accentText;
-            else if (name == "pressed")
-                c = theme.pressed;
-            else if (name == "danger")
-                c = theme.danger;
-            else if (name == "placeholder")
-                c = theme.placeholder;
+            uint16_t *slot = themeColor(name);
+            uint16_t c = slot ? *slot : 0xFFFF;
             webSocket.sendTXT("ThemeColor " + name + " " + String(c, HEX));
             return;
         }
@@ -575,30 +894,7 @@ namespace Browser
 
         if (payload.startsWith("Navigate"))
         {
-            String arg = payload.substring(9);
-            arg.trim();
-            if (arg == "home")
-            {
-                loc.state = "home";
-                ReRender();
-                return;
-            }
-            String domain = arg;
-            int port = 443;
-            String state = "startpage";
-            int at = arg.indexOf('@');
-            if (at >= 0)
-            {
-                domain = arg.substring(0, at);
-                state = arg.substring(at + 1);
-            }
-            int colon = domain.indexOf(':');
-            if (colon >= 0)
-            {
-                port = domain.substring(colon + 1).toInt();
-                domain = domain.substring(0, colon);
-            }
-            navigate(domain, port, state);
+            navigateTo(payload.substring(9));
             return;
         }
 
@@ -641,19 +937,294 @@ namespace Browser
         Serial.println("[Browser] Unhandled command");
     }
 
+    // ---------------------------
+    // MWOSP-v2 binary commands (see mwosp.hpp)
+    // ---------------------------
+    namespace V2
+    {
+        using MWOSP::Reader;
+
+        static void fillRect(Reader &r)
+        {
+            int x = r.i16(), y = r.i16(), w = r.i16(), h = r.i16();
+            fillRectClipped(x, y, w, h, r.u16());
+        }
+
+        static void circle(Reader &r)
+        {
+            int x = r.i16(), y = r.i16(), rad = r.i16();
+            drawCircleClipped(x, y, rad, r.u16());
+        }
+
+        static void text(Reader &r)
+        {
+            int x = r.i16(), y = r.i16();
+            uint8_t size = r.u8();
+            uint16_t c = r.u16();
+            drawTextServer(x, y, r.rest(), c, size);
+        }
+
+        static void svg(Reader &r)
+        {
+            int x = r.i16(), y = r.i16(), w = r.i16(), h = r.i16();
+            uint16_t c = r.u16();
+            drawSVGClipped(r.rest(), x, y, w, h, c);
+        }
+
+        static void themeSlot(Reader &r)
+        {
+            uint8_t slot = r.u8();
+            uint16_t c = r.u16();
+            if (slot < THEME_SLOT_COUNT)
+                setThemeColor(theme.*THEME_SLOTS[slot].color, c);
+        }
+
+        static void title(Reader &r)
+        {
+            loc.title = r.rest();
+            ReRender();
+        }
+
+        static void defineAssetOp(Reader &r)
+        {
+            String hash = r.str(r.u8());
+            defineAsset(hash, (const char *)r.p, r.left);
+        }
+
+        static void drawAssetOp(Reader &r)
+        {
+            int x = r.i16(), y = r.i16(), w = r.i16(), h = r.i16();
+            uint16_t c = r.u16();
+            drawAsset(r.rest(), x, y, w, h, c);
+        }
+
+        static void scrollOp(Reader &r)
+        {
+            int dx = r.i16();
+            scrollViewport(dx, r.i16());
+        }
+
+        static void compressedOp(Reader &r)
+        {
+            uint8_t epoch = r.u8();
+            uint8_t kind = r.u8();
+            // a compressed message never contains another one
+            if (inflating || !ZStream::active())
+                return;
+            if (epoch != ZStream::epoch())
+            {
+                ZStream::countDropped(); // sent before the server saw our ZReset
+                return;
+            }
+            if (!ZStream::inflate(r.p, r.left, inflated))
+            {
+                ZStream::reset();
+                webSocket.sendTXT("ZReset " + String(ZStream::epoch()));
+                return;
+            }
+            inflating = true;
+            if (kind == 'B')
+                handleBinary(inflated.data(), inflated.size());
+            else
+            {
+                String msg;
+                msg.concat((const char *)inflated.data(), inflated.size());
+                handleCommand(msg);
+            }
+            inflating = false;
+        }
+
+        static void beginFrameOp(Reader &) { beginFrame(); }
+        static void endFrameOp(Reader &) { Frame::end(); }
+        static void navigateOp(Reader &r) { navigateTo(r.rest()); }
+        static void exitOp(Reader &) { Exit(); }
+        static void textOp(Reader &r) { handleCommand(r.rest()); }
+
+        // indexed by opcode; minLen is the fixed part of the payload
+        static const struct
+        {
+            uint8_t minLen;
+            void (*fn)(Reader &);
+        } OPS[MWOSP::OP_COUNT] = {
+            {0, nullptr},
+            {10, fillRect},     // OP_FILL_RECT
+            {8, circle},        // OP_DRAW_CIRCLE
+            {7, text},          // OP_DRAW_TEXT
+            {10, svg},          // OP_DRAW_SVG
+            {3, themeSlot},     // OP_THEME_COLOR
+            {0, title},         // OP_TITLE
+            {0, navigateOp},    // OP_NAVIGATE
+            {0, exitOp},        // OP_EXIT
+            {0, textOp},        // OP_TEXT
+            {0, beginFrameOp},  // OP_BEGIN_FRAME
+            {0, endFrameOp},    // OP_END_FRAME
+            {1, defineAssetOp}, // OP_DEFINE_ASSET
+            {10, drawAssetOp},  // OP_DRAW_ASSET
+            {4, scrollOp},      // OP_SCROLL
+            {2, compressedOp},  // OP_COMPRESSED
+        };
+    }
+
+    void handleBinary(const uint8_t *data, size_t length)
+    {
+        size_t pos = 0;
+        while (pos + MWOSP::HEADER <= length)
+        {
+            uint8_t op = data[pos];
+            size_t len = data[pos + 1] | (data[pos + 2] << 8);
+            pos += MWOSP::HEADER;
+            if (len > length - pos)
+            {
+                Serial.println("[Browser] MWOSP-v2: truncated frame");
+                return;
+            }
+            if (op < MWOSP::OP_COUNT && V2::OPS[op].fn && len >= V2::OPS[op].minLen)
+            {
+                // wrapped messages count themselves
+                if (op != MWOSP::OP_COMPRESSED && op != MWOSP::OP_TEXT)
+                    handledCommands++;
+                MWOSP::Reader r{data + pos, len};
+                V2::OPS[op].fn(r);
+                // Exit/Navigate tear down the page, the rest of the batch belongs to it
+                if (op == MWOSP::OP_EXIT || op == MWOSP::OP_NAVIGATE || !isRunning)
+                    return;
+            }
+            pos += len;
+        }
+    }
+
+    // ---------------------------
+    // Session recording / replay
+    // ---------------------------
+    // Record file: per server message  u8 'T' (text) | 'B' (binary), u32 LE length, payload
+    static void recordMessage(char kind, const uint8_t *data, size_t length)
+    {
+        if (!recordFile)
+            return;
+        uint8_t head[5] = {(uint8_t)kind, (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)(length >> 16), (uint8_t)(length >> 24)};
+        recordFile.write(head, sizeof(head));
+        if (length)
+            recordFile.write(data, length);
+    }
+
+    bool startRecording(const String &path)
+    {
+        stopRecording();
+        LocalStorage::ensureDir(path);
+        recordFile = LittleFS.open(path, "w");
+        Serial.printf("[Browser] recording to '%s' %s\n", path.c_str(), recordFile ? "ok" : "failed");
+        return (bool)recordFile;
+    }
+
+    void stopRecording()
+    {
+        if (recordFile)
+            recordFile.close();
+    }
+
+    void replayMessage(char kind, const uint8_t *data, size_t length)
+    {
+        bool was = replaying;
+        replaying = true;
+        if (kind == 'B')
+            handleBinary(data, length);
+        else
+        {
+            String msg;
+            msg.concat((const char *)data, length);
+            if (msg == "MWOSP-v2" || msg == "MWOSP-v2 z")
+            {
+                protoV2 = true;
+                // recordings start at the handshake, so the deflate stream starts fresh here too
+                ZStream::stop();
+                ZStream::resetStats();
+                if (msg.endsWith(" z"))
+                    ZStream::start();
+            }
+            else
+                handleCommand(msg);
+        }
+        replaying = was;
+    }
+
+    uint32_t commandCount()
+    {
+        return handledCommands;
+    }
+
+    bool replaySession(const String &path)
+    {
+        File f = LittleFS.open(path, "r");
+        if (!f)
+        {
+            Serial.printf("[Browser] replay: cannot open '%s'\n", path.c_str());
+            return false;
+        }
+
+        Frame::resetStats();
+        bool v2 = protoV2;
+        std::vector<uint8_t> buf;
+        uint32_t messages = 0, frames = 0;
+        uint32_t commands = handledCommands;
+        uint32_t t0 = millis();
+
+        uint8_t head[5];
+        while (f.read(head, sizeof(head)) == sizeof(head))
+        {
+            size_t len = head[1] | (head[2] << 8) | (head[3] << 16) | ((size_t)head[4] << 24);
+            buf.resize(len);
+            if (len && f.read(buf.data(), len) != len)
+                break;
+            messages++;
+            replayMessage((char)head[0], buf.data(), len);
+
+            Frame::Stats st = Frame::stats();
+            if (st.frames != frames)
+            {
+                frames = st.frames;
+                Serial.printf("[Browser] replay frame %u: %u us\n", (unsigned)frames, (unsigned)st.lastUs);
+            }
+        }
+        Frame::end();
+        f.close();
+        protoV2 = v2;
+
+        Frame::Stats st = Frame::stats();
+        Serial.printf("[Browser] replay '%s': %u messages, %u commands in %u ms\n", path.c_str(), (unsigned)messages,
+                      (unsigned)(handledCommands - commands), (unsigned)(millis() - t0));
+        Serial.printf("[Browser] frames=%u avg=%u us max=%u us commands=%u culled=%u bands=%u readbacks=%u direct=%u\n",
+                      (unsigned)st.frames, (unsigned)(st.frames ? st.totalUs / st.frames : 0), (unsigned)st.maxUs,
+                      (unsigned)st.commands, (unsigned)st.culled, (unsigned)st.bands, (unsigned)st.readbacks, (unsigned)st.direct);
+        Serial.printf("[Browser] scrolls=%u moved=%u px\n", (unsigned)st.scrolls, (unsigned)st.scrollPixels);
+        return true;
+    }
+
     // ---------------------------
     // WebSocket event wrapper
     // ---------------------------
     static void wsEvent(WStype_t type, uint8_t *payload, size_t length)
     {
+        if (type == WStype_TEXT || type == WStype_BIN)
+            recordMessage(type == WStype_BIN ? 'B' : 'T', payload, length);
+
+        if (type == WStype_BIN)
+        {
+            if (payload != nullptr && length > 0)
+                handleBinary(payload, length);
+            return;
+        }
+
         String msg = (payload != nullptr && length > 0) ? String((char *)payload) : String();
         switch (type)
         {
         case WStype_CONNECTED:
         {
             Serial.println("[Browser] WebSocket Connected");
+            protoV2 = false;
+            ZStream::resetStats();
             String sess = (loc.session.length() ? loc.session : Location::sessionId);
-            webSocket.sendTXT("MWOSP-v1 " + sess + " " + String(SCREEN_W) + " " + String(SCREEN_H));
+            // " v2": we also understand binary frames, " z": and compressed ones; old servers ignore the extra tokens
+            webSocket.sendTXT("MWOSP-v1 " + sess + " " + String(SCREEN_W) + " " + String(SCREEN_H) + " v2 z");
             // send theme
             String themeMsg = "ThemeColors";
             themeMsg += " bg:0x" + String(theme.bg, HEX);
@@ -670,10 +1241,29 @@ namespace Browser
             break;
         }
         case WStype_TEXT:
-            Serial.printf("[Browser] WebSocket TEXT: %s\n", msg.c_str());
+            if (msg == "MWOSP-v2" || msg == "MWOSP-v2 z")
+            {
+                protoV2 = true;
+                bool z = msg.endsWith(" z") && ZStream::start();
+                Serial.printf("[Browser] Server speaks MWOSP-v2%s\n", z ? " with compression" : "");
+                break;
+            }
+            if (!protoV2)
+                Serial.printf("[Browser] WebSocket TEXT: %s\n", msg.c_str());
             handleCommand(msg);
             break;
         case WStype_DISCONNECTED:
+            Frame::cancel();
+            pendingAssets.clear();
+            Serial.println("[Browser] assets: " + assetStats());
+            if (ZStream::active())
+            {
+                ZStream::Stats zs = ZStream::stats();
+                Serial.printf("[Browser] zstream: %u msgs, %u bytes on air, %u inflated, decode %u us (max %u), errors=%u dropped=%u\n",
+                              (unsigned)zs.messages, (unsigned)zs.wireBytes, (unsigned)zs.rawBytes, (unsigned)zs.decodeUs,
+                              (unsigned)zs.maxDecodeUs, (unsigned)zs.errors, (unsigned)zs.dropped);
+                ZStream::stop(); // the server starts a new stream per connection
+            }
             Serial.println("[Browser] WebSocket Disconnected");
             break;
         default:
@@ -694,6 +1284,10 @@ namespace Browser
 
     void navigate(const String &domain, int port, const String &state)
     {
+        if (replaying)
+            return;
+        Frame::cancel();
+        pendingAssets.clear();
         Serial.printf("[Browser] navigate domain='%s' port=%d state='%s'\n", domain.c_str(), port, state.c_str());
         loc.domain = domain;
         loc.port = port;
@@ -730,86 +1324,98 @@ namespace Browser
         drawText(bx + 8, by + 8, "Open Search", theme.accentText, 2);
     }
 
+    static constexpr int VISIT_LIST_H = SCREEN_H - VISIT_LIST_Y;
+
+    // One row of the visited list at viewport y localY. Rows are drawn at their real position and
+    // the panel viewport clips them, so a row cut by the list edge (or by a scroll strip) matches
+    // the pixels of a full redraw.
+    static void drawSiteRow(size_t i, const String &site, int localY)
+    {
+        uint16_t bgColor = (i % 2 == 0) ? theme.primary : theme.bg;
+        Screen::tft.fillRect(0, localY, vpW, VISIT_ITEM_H - 2, bgColor);
+
+        String domain = site;
+        int maxDomainWidth = vpW - 180;
+        if (domain.length() > maxDomainWidth / 6)
+            domain = domain.substring(0, maxDomainWidth / 6 - 3) + "...";
+        Screen::tft.setTextSize(1);
+        Screen::tft.setTextColor(theme.text);
+        Screen::tft.setCursor(10, localY + 6);
+        Screen::tft.print(domain);
+
+        int btnW = 56, btnGap = 4;
+        int xOpen = vpW - BUTTON_PADDING - btnW;
+        int xClear = xOpen - btnGap - btnW;
+        int xDelete = xClear - btnGap - btnW;
+        int btnY = localY + 4;
+        int btnH = VISIT_ITEM_H - 10;
+        const struct
+        {
+            int x, dx;
+            const char *label;
+            uint16_t color;
+        } buttons[] = {
+            {xDelete, 8, "Delete", theme.danger},
+            {xClear, 6, "Clear", theme.pressed},
+            {xOpen, 10, "Open", theme.accent},
+        };
+        Screen::tft.setTextColor(theme.accentText);
+        for (const auto &b : buttons)
+        {
+            Screen::tft.fillRoundRect(b.x, btnY, btnW, btnH, 4, b.color);
+            Screen::tft.setCursor(b.x + b.dx, btnY + 6);
+            Screen::tft.print(b.label);
+        }
+    }
+
+    // Rows that touch the list band [top, top + h) (list viewport coordinates)
+    static void drawSiteRows(int top, int h)
+    {
+        const std::vector<String> &sites = LocalStorage::listSites();
+        int first = (top + visitScrollOffset) / VISIT_ITEM_H;
+        int last = (top + h - 1 + visitScrollOffset) / VISIT_ITEM_H;
+        if (first < 0)
+            first = 0;
+        for (int i = first; i <= last && i < (int)sites.size(); ++i)
+            drawSiteRow(i, sites[i], i * VISIT_ITEM_H - visitScrollOffset - top);
+    }
+
     void showVisitedSites()
     {
-        std::vector<String> sites = LocalStorage::listSites();
+        const std::vector<String> &sites = LocalStorage::listSites();
         drawText(10, VISIT_LIST_Y - 18, "Visited Sites", theme.text, 2);
 
-        enterViewport(0, VISIT_LIST_Y, SCREEN_W, SCREEN_H - VISIT_LIST_Y);
-
         clampScrollForSites(sites);
 
-        int xText = 10;
-        for (size_t i = 0; i < sites.size(); ++i)
-        {
-            int localY = (int)i * VISIT_ITEM_H - visitScrollOffset;
-            if (localY + VISIT_ITEM_H < 0)
-                continue;
-            if (localY > vpH)
-                continue;
-            uint16_t bgColor = (i % 2 == 0) ? theme.primary : theme.bg;
-            int drawY = localY;
-            int drawH = VISIT_ITEM_H - 2;
-            if (drawY < 0)
-            {
-                drawH += drawY;
-                drawY = 0;
-            }
-            if (drawY + drawH > vpH)
-                drawH = vpH - drawY;
-            if (drawH > 0)
-                Screen::tft.fillRect(0, drawY, vpW, drawH, bgColor);
-            String domain = sites[i];
-            int maxDomainWidth = vpW - 180;
-            if (domain.length() > maxDomainWidth / 6)
-                domain = domain.substring(0, maxDomainWidth / 6 - 3) + "...";
-            int textY = localY + 6;
-            if (textY < 0)
-                textY = 0;
-            drawText(xText, textY, domain, theme.text, 1);
-            int btnW = 56, btnGap = 4;
-            int xOpen = vpW - BUTTON_PADDING - btnW;
-            int xClear = xOpen - btnGap - btnW;
-            int xDelete = xClear - btnGap - btnW;
-            int btnY = localY + 4;
-            int btnH = VISIT_ITEM_H - 10;
-            if (btnY < 0)
-            {
-                int visibleBtnH = btnH + btnY;
-                if (visibleBtnH > 0)
-                {
-                    Screen::tft.fillRoundRect(xDelete, 0, btnW, visibleBtnH, 4, theme.danger);
-                    drawText(xDelete + 8, 2, "Delete", theme.accentText, 1);
-                    Screen::tft.fillRoundRect(xClear, 0, btnW, visibleBtnH, 4, theme.pressed);
-                    drawText(xClear + 6, 2, "Clear", theme.accentText, 1);
-                    Screen::tft.fillRoundRect(xOpen, 0, btnW, visibleBtnH, 4, theme.accent);
-                    drawText(xOpen + 10, 2, "Open", theme.accentText, 1);
-                }
-            }
-            else if (btnY + btnH > vpH)
-            {
-                int visibleBtnH = vpH - btnY;
-                if (visibleBtnH > 0)
-                {
-                    Screen::tft.fillRoundRect(xDelete, btnY, btnW, visibleBtnH, 4, theme.danger);
-                    drawText(xDelete + 8, btnY + 2, "Delete", theme.accentText, 1);
-                    Screen::tft.fillRoundRect(xClear, btnY, btnW, visibleBtnH, 4, theme.pressed);
-                    drawText(xClear + 6, btnY + 2, "Clear", theme.accentText, 1);
-                    Screen::tft.fillRoundRect(xOpen, btnY, btnW, visibleBtnH, 4, theme.accent);
-                    drawText(xOpen + 10, btnY + 2, "Open", theme.accentText, 1);
-                }
-            }
-            else
-            {
-                Screen::tft.fillRoundRect(xDelete, btnY, btnW, btnH, 4, theme.danger);
-                drawText(xDelete + 8, btnY + 6, "Delete", theme.accentText, 1);
-                Screen::tft.fillRoundRect(xClear, btnY, btnW, btnH, 4, theme.pressed);
-                drawText(xClear + 6, btnY + 6, "Clear", theme.accentText, 1);
-                Screen::tft.fillRoundRect(xOpen, btnY, btnW, btnH, 4, theme.accent);
-                drawText(xOpen + 10, btnY + 6, "Open", theme.accentText, 1);
-            }
+        enterViewport(0, VISIT_LIST_Y, SCREEN_W, VISIT_LIST_H);
+        drawSiteRows(0, vpH);
+        exitViewport();
+    }
+
+    // Scroll the list by dy pixels: move what is on screen and draw only the rows that come in
+    static void scrollVisitedSites(int dy)
+    {
+        int old = visitScrollOffset;
+        visitScrollOffset += dy;
+        clampScrollForSites(LocalStorage::listSites());
+        int delta = visitScrollOffset - old;
+        if (delta == 0)
+            return;
+
+        if (!Frame::scroll(0, VISIT_LIST_Y, SCREEN_W, VISIT_LIST_H, 0, -delta, theme.bg) || abs(delta) >= VISIT_LIST_H)
+        {
+            enterViewport(0, VISIT_LIST_Y, SCREEN_W, VISIT_LIST_H);
+            Screen::tft.fillRect(0, 0, vpW, vpH, theme.bg);
+            drawSiteRows(0, vpH);
+            exitViewport();
+            return;
         }
 
+        // exposed strip at the bottom (list moved up) or at the top
+        int top = delta > 0 ? VISIT_LIST_H - delta : 0;
+        int h = abs(delta);
+        enterViewport(0, VISIT_LIST_Y + top, SCREEN_W, h);
+        drawSiteRows(top, h);
         exitViewport();
     }
 
@@ -856,16 +1462,29 @@ namespace Browser
 
         webSocket.onEvent(wsEvent);
         isRunning = true;
+#ifdef BROWSER_REPLAY_PATH
+        replaySession(BROWSER_REPLAY_PATH);
+#endif
+#ifdef BROWSER_RECORD_PATH
+        startRecording(BROWSER_RECORD_PATH);
+#endif
     }
 
     void OnExit()
     {
         Serial.println("[Browser] OnExit - disconnecting websocket");
         webSocket.disconnect();
+        Frame::release();
+        ZStream::stop();
+        Assets::clear();
+        pendingAssets.clear();
+        stopRecording();
     }
 
     void Exit()
     {
+        if (replaying)
+            return;
         Serial.println("[Browser] Exit");
         isRunning = false;
         OnExit();
@@ -943,24 +1562,12 @@ namespace Browser
             {
                 int16_t prevLastY = lastY;
                 onTouchMove(absX, absY);
-                int listOriginY = viewportActive ? vpY : VISIT_LIST_Y;
-                if (dragging && startY >= listOriginY && inViewport && loc.state == "home")
+                // the list viewport is only entered while drawing, so test the list area itself
+                if (dragging && startY >= VISIT_LIST_Y && absY >= VISIT_LIST_Y && (loc.state == "home" || loc.state == ""))
                 {
                     int dy = prevLastY - lastY;
                     if (dy != 0)
-                    {
-                        std::vector<String> sites = LocalStorage::listSites();
-                        clampScrollForSites(sites);
-                        int totalHeight = (int)sites.size() * VISIT_ITEM_H;
-                        int visible = vpH;
-                        int maxOffset = totalHeight > visible ? totalHeight - visible : 0;
-                        visitScrollOffset += dy;
-                        if (visitScrollOffset < 0)
-                            visitScrollOffset = 0;
-                        if (visitScrollOffset > maxOffset)
-                            visitScrollOffset = maxOffset;
-                        ReRender();
-                    }
+                        scrollVisitedSites(dy);
                 }
                 return;
             }
@@ -1040,7 +1647,7 @@ namespace Browser
 
                     if (loc.state == "home" && clickInViewport)
                     {
-                        std::vector<String> sites = LocalStorage::listSites();
+                        const std::vector<String> &sites = LocalStorage::listSites();
                         if (!sites.empty())
                         {
                             int idx = (clickLocalY + visitScrollOffset) / VISIT_ITEM_H;
@@ -1080,7 +1687,7 @@ namespace Browser
                     }
                     else if (loc.state == "home" && clickY >= VISIT_LIST_Y)
                     {
-                        std::vector<String> sites = LocalStorage::listSites();
+                        const std::vector<String> &sites = LocalStorage::listSites();
                         int idx = (clickY - VISIT_LIST_Y + visitScrollOffset) / VISIT_ITEM_H;
                         if (idx >= 0 && idx < (int)sites.size())
                         {
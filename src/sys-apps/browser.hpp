@@ -34,6 +34,17 @@ namespace Browser
     void Exit();
     void OnExit();
     void handleCommand(const String &payload);
+    void handleBinary(const uint8_t *data, size_t length); // MWOSP-v2 frame
+
+    // ---- Session recording (build with -DBROWSER_RECORD_PATH="\"/browser/rec.mwr\"") ----
+    bool startRecording(const String &path);
+    void stopRecording();
+    // Feed a recorded session through the command handlers and print frame times (-DBROWSER_REPLAY_PATH runs it on Start)
+    bool replaySession(const String &path);
+    // One recorded server message ('T' text, 'B' binary), as replaySession feeds it (tools/browser-replay)
+    void replayMessage(char kind, const uint8_t *data, size_t length);
+    // Text commands and v2 ops handled so far
+    uint32_t commandCount();
 
     // ---- Utilities ----
     void drawText(int x, int y, const String &text, uint16_t color, int size = 2);
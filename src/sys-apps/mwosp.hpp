@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Arduino.h>
+
+// MWOSP-v2: binary framing for the browser protocol.
+//
+// Negotiation: the client appends the capability "v2" to its text handshake
+// ("MWOSP-v1 <session> <w> <h> v2"). Servers that understand it answer with the text message
+// "MWOSP-v2" and may send binary frames from then on; older servers ignore the extra token and
+// keep talking v1 text, which the client still accepts.
+//
+// A binary WebSocket frame holds any number of commands back to back:
+//     u8 opcode | u16 payload length | payload
+// All integers are little-endian, coordinates are i16, colors RGB565 u16. Text fields run to the
+// end of the payload (UTF-8, no terminator). Unknown opcodes are skipped by their length, so new
+// commands can be added without breaking older clients.
+namespace MWOSP
+{
+    constexpr size_t HEADER = 3;
+
+    enum Op : uint8_t
+    {
+        OP_FILL_RECT = 0x01,   // x, y, w, h, color
+        OP_DRAW_CIRCLE = 0x02, // x, y, r, color
+        OP_DRAW_TEXT = 0x03,   // x, y, u8 size, color, text
+        OP_DRAW_SVG = 0x04,    // x, y, w, h, color, svg
+        OP_THEME_COLOR = 0x05, // u8 slot (see THEME_SLOTS in browser.cpp), color
+        OP_TITLE = 0x06,       // text
+        OP_NAVIGATE = 0x07,    // text, same argument as the v1 "Navigate" command
+        OP_EXIT = 0x08,        // -
+        OP_TEXT = 0x09,        // a complete v1 text command, for everything without an opcode
+        OP_BEGIN_FRAME = 0x0A, // -, like v1 "BeginFrame"
+        OP_END_FRAME = 0x0B,   // -, like v1 "EndFrame"
+        OP_DEFINE_ASSET = 0x0C, // u8 hash length, hash, asset bytes (see browser-assets.hpp)
+        OP_DRAW_ASSET = 0x0D,   // x, y, w, h, color, hash
+        OP_SCROLL = 0x0E,       // dx, dy, like v1 "ScrollViewport"
+        OP_COMPRESSED = 0x0F,   // u8 epoch, u8 kind, deflate bytes (see browser-zstream.hpp)
+        OP_COUNT
+    };
+
+    // Bounds-checked little-endian cursor over one command payload
+    struct Reader
+    {
+        const uint8_t *p;
+        size_t left;
+
+        uint8_t u8()
+        {
+            if (left < 1)
+                return 0;
+            left--;
+            return *p++;
+        }
+        uint16_t u16()
+        {
+            if (left < 2)
+            {
+                left = 0;
+                return 0;
+            }
+            uint16_t v = (uint16_t)(p[0] | (p[1] << 8));
+            p += 2;
+            left -= 2;
+            return v;
+        }
+        int16_t i16() { return (int16_t)u16(); }
+        String str(size_t n)
+        {
+            if (n > left)
+                n = left;
+            String s;
+            s.concat((const char *)p, n);
+            p += n;
+            left -= n;
+            return s;
+        }
+        String rest()
+        {
+            String s;
+            s.concat((const char *)p, left);
+            p += left;
+            left = 0;
+            return s;
+        }
+    };
+}
@@ -0,0 +1,220 @@
+#include "pkg-archive.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#include "esp32/rom/miniz.h"
+
+namespace PkgArchive
+{
+    static constexpr size_t HEADER_SIZE = 8;
+    static constexpr size_t ENTRY_HEAD_SIZE = 2 + 1 + 1 + 4 + 4 + 32;
+
+    static inline uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+    static inline uint32_t rd32(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+    Unpacker::Unpacker() {}
+
+    Unpacker::~Unpacker()
+    {
+        if (writer)
+        {
+            writer->abort();
+            delete writer;
+        }
+        free(inflator);
+        free(window);
+    }
+
+    bool Unpacker::fail(const String &why)
+    {
+        if (state != State::Failed)
+        {
+            err = why;
+            Serial.println("[MWPK] " + why);
+        }
+        state = State::Failed;
+        if (writer)
+        {
+            writer->abort();
+            delete writer;
+            writer = nullptr;
+        }
+        return false;
+    }
+
+    // Collect `want` bytes into `head`; true once complete.
+    bool Unpacker::need(const uint8_t *&data, size_t &len, size_t want)
+    {
+        size_t take = std::min(len, want - head.size());
+        head.insert(head.end(), data, data + take);
+        data += take;
+        len -= take;
+        return head.size() == want;
+    }
+
+    bool Unpacker::beginEntry()
+    {
+        if (path.length() == 0 || path.startsWith("/") || path.indexOf("..") >= 0 || path.indexOf('\\') >= 0)
+            return fail("bad entry path: " + path);
+        if (ENC_FS::BlobStore::isReserved(path))
+            return fail("reserved entry path: " + path);
+        if (method != METHOD_STORE && method != METHOD_DEFLATE)
+            return fail("unsupported method for " + path);
+
+        writer = new ENC_FS::BlobStore::Writer();
+        rawDone = 0;
+
+        if (method == METHOD_DEFLATE)
+        {
+            if (!inflator)
+                inflator = malloc(sizeof(tinfl_decompressor));
+            if (!window)
+                window = (uint8_t *)malloc(TINFL_LZ_DICT_SIZE);
+            if (!inflator || !window)
+                return fail("out of memory");
+            tinfl_init((tinfl_decompressor *)inflator);
+            windowOfs = 0;
+        }
+
+        state = State::EntryData;
+        if (packedLeft == 0)
+            return endEntry();
+        return true;
+    }
+
+    bool Unpacker::entryData(const uint8_t *data, size_t len)
+    {
+        packedLeft -= len;
+
+        if (method == METHOD_STORE)
+        {
+            rawDone += len;
+            if (rawDone > rawSize || !writer->write(data, len))
+                return fail("write failed: " + path);
+            return true;
+        }
+
+        // inflate into the circular window, flushing every produced span to the writer
+        while (true)
+        {
+            size_t inBytes = len;
+            size_t outBytes = TINFL_LZ_DICT_SIZE - windowOfs;
+            mz_uint32 flags = packedLeft > 0 ? TINFL_FLAG_HAS_MORE_INPUT : 0;
+            tinfl_status st = tinfl_decompress((tinfl_decompressor *)inflator, data, &inBytes,
+                                               window, window + windowOfs, &outBytes, flags);
+            data += inBytes;
+            len -= inBytes;
+
+            if (outBytes)
+            {
+                rawDone += outBytes;
+                if (rawDone > rawSize || !writer->write(window + windowOfs, outBytes))
+                    return fail("write failed: " + path);
+                windowOfs = (windowOfs + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+            }
+
+            if (st < TINFL_STATUS_DONE)
+                return fail("corrupt deflate data: " + path);
+            if (st == TINFL_STATUS_DONE)
+                return true;
+            if (st == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0)
+                return true;
+            // TINFL_STATUS_HAS_MORE_OUTPUT: window wrapped, keep going
+        }
+    }
+
+    bool Unpacker::endEntry()
+    {
+        if (rawDone != rawSize)
+            return fail("size mismatch: " + path);
+
+        String stored;
+        bool ok = writer->commitBlob(stored, nullptr, hash);
+        delete writer;
+        writer = nullptr;
+        if (!ok)
+            return fail("hash mismatch or write error: " + path);
+
+        ENC_FS::BlobStore::Entry e;
+        e.path = path;
+        e.hash = stored;
+        e.size = rawSize;
+        done.push_back(e);
+        rawTotal += rawSize;
+
+        head.clear();
+        state = --entriesLeft ? State::EntryHead : State::Done;
+        return true;
+    }
+
+    bool Unpacker::feed(const uint8_t *data, size_t len)
+    {
+        while (len)
+        {
+            switch (state)
+            {
+            case State::Header:
+                if (!need(data, len, HEADER_SIZE))
+                    return true;
+                if (memcmp(head.data(), "MWPK", 4) != 0 || head[4] != MWPK_VERSION)
+                    return fail("not an MWPK v1 archive");
+                headerOk = true;
+                entriesLeft = rd16(head.data() + 6);
+                head.clear();
+                state = entriesLeft ? State::EntryHead : State::Done;
+                break;
+
+            case State::EntryHead:
+                if (!need(data, len, ENTRY_HEAD_SIZE))
+                    return true;
+                pathLen = rd16(head.data());
+                method = head[2];
+                rawSize = rd32(head.data() + 4);
+                packedLeft = rd32(head.data() + 8);
+                {
+                    static const char *hex = "0123456789abcdef";
+                    hash = "";
+                    for (int i = 0; i < 32; ++i)
+                    {
+                        hash += hex[head[12 + i] >> 4];
+                        hash += hex[head[12 + i] & 0x0F];
+                    }
+                }
+                if (pathLen == 0 || pathLen > 255)
+                    return fail("bad path length");
+                head.clear();
+                state = State::EntryPath;
+                break;
+
+            case State::EntryPath:
+                if (!need(data, len, pathLen))
+                    return true;
+                path = String((const char *)head.data(), head.size());
+                head.clear();
+                if (!beginEntry())
+                    return false;
+                break;
+
+            case State::EntryData:
+            {
+                size_t take = std::min((size_t)packedLeft, len);
+                if (!entryData(data, take))
+                    return false;
+                data += take;
+                len -= take;
+                if (packedLeft == 0 && !endEntry())
+                    return false;
+                break;
+            }
+
+            case State::Done:
+                return true; // trailing bytes are ignored
+
+            case State::Failed:
+                return false;
+            }
+        }
+        return state != State::Failed;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+#include "../fs/blob-store.hpp"
+
+// Single-file app packages (app.mwpk), produced by app-pack.js.
+//
+// Layout (little-endian):
+//   "MWPK" u8 version (1) u8 flags (0) u16 entryCount
+//   per entry:
+//     u16 pathLen  u8 method (0 = stored, 1 = raw deflate)  u8 reserved
+//     u32 rawSize  u32 packedSize  u8 sha256[32] of the raw data
+//     path[pathLen]  data[packedSize]
+//
+// The Unpacker is fed the archive as it arrives from the network and writes each entry straight
+// into the blob store; RAM use is one inflate window (32 KB) plus the blob writer.
+namespace PkgArchive
+{
+    constexpr uint8_t MWPK_VERSION = 1;
+    constexpr uint8_t METHOD_STORE = 0;
+    constexpr uint8_t METHOD_DEFLATE = 1;
+
+    class Unpacker
+    {
+    public:
+        Unpacker();
+        ~Unpacker();
+
+        // Feed the next bytes of the archive; false on a malformed archive or a write/hash error.
+        bool feed(const uint8_t *data, size_t len);
+        // True once every entry announced in the header has been stored.
+        bool complete() const { return state == State::Done; }
+        // True once the first bytes were an MWPK v1 header; false means the response is not an
+        // archive at all (e.g. an HTML page served for a missing file).
+        bool sawHeader() const { return headerOk; }
+
+        // Entries stored so far (paths relative to the app folder), ready for BlobStore::replace.
+        const std::vector<ENC_FS::BlobStore::Entry> &entries() const { return done; }
+        uint64_t rawBytes() const { return rawTotal; }
+        const String &error() const { return err; }
+
+    private:
+        enum class State
+        {
+            Header,
+            EntryHead,
+            EntryPath,
+            EntryData,
+            Done,
+            Failed
+        };
+
+        bool fail(const String &why);
+        bool need(const uint8_t *&data, size_t &len, size_t want);
+        bool beginEntry();
+        bool entryData(const uint8_t *data, size_t len);
+        bool endEntry();
+
+        State state = State::Header;
+        ENC_FS::Buffer head; // partial fixed-size header being collected
+        uint16_t entriesLeft = 0;
+        bool headerOk = false;
+
+        // current entry
+        uint16_t pathLen = 0;
+        uint8_t method = 0;
+        uint32_t rawSize = 0;
+        uint32_t packedLeft = 0;
+        uint32_t rawDone = 0;
+        String hash;
+        String path;
+        ENC_FS::BlobStore::Writer *writer = nullptr;
+
+        void *inflator = nullptr; // tinfl_decompressor
+        uint8_t *window = nullptr;
+        size_t windowOfs = 0;
+
+        std::vector<ENC_FS::BlobStore::Entry> done;
+        uint64_t rawTotal = 0;
+        String err;
+    };
+}
@@ -0,0 +1,207 @@
+#include "pkg-downloader.hpp"
+
+#include <WiFi.h>
+#include <mutex>
+#include <algorithm>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "../fs/blob-store.hpp"
+#include "../wifi/http-pool.hpp"
+
+namespace PkgDownloader
+{
+    // ---------- shared state ----------
+
+    struct Shared
+    {
+        const std::vector<Job> *jobs;
+        String app;
+        std::vector<Result> results;
+        Progress progress;
+        size_t next = 0;
+        int running = 0;
+        bool abort = false;
+        std::mutex lock;   // everything above
+        std::mutex sdLock; // serialises ENC_FS writes of the workers
+    };
+
+    // GET `url` through the shared pool (redirects are followed) and read the response head.
+    // Anything but 200 is drained and reported as failure; `status` is the last HTTP status.
+    static bool request(const String &url, HttpPool::Lease &lease, HttpPool::Response &r, int &status)
+    {
+        HttpPool::Request req;
+        req.url = url;
+        req.timeoutMs = DL_IDLE_TIMEOUT_MS;
+        req.maxRedirects = DL_MAX_REDIRECTS;
+        bool ok = HttpPool::open(req, r, lease);
+        status = r.status;
+        if (!ok)
+            return false;
+        if (r.status != 200)
+        {
+            HttpPool::readBody(lease, r, nullptr, DL_IDLE_TIMEOUT_MS);
+            return false;
+        }
+        return true;
+    }
+
+    // GET job `i` into a BlobStore writer.
+    static bool fetch(Shared &s, size_t i, Result &res)
+    {
+        const Job &job = (*s.jobs)[i];
+
+        HttpPool::Lease lease;
+        HttpPool::Response r;
+        if (!request(job.url, lease, r, res.status))
+            return false;
+
+        if (r.contentLength > 0)
+        {
+            std::lock_guard<std::mutex> g(s.lock);
+            s.progress.bytesTotal += (uint64_t)r.contentLength;
+        }
+
+        ENC_FS::BlobStore::Writer writer;
+        bool ok = HttpPool::readBody(lease, r, [&](const uint8_t *d, size_t n)
+                                     {
+                                         {
+                                             std::lock_guard<std::mutex> g(s.sdLock);
+                                             if (!writer.write(d, n))
+                                                 return false;
+                                         }
+                                         std::lock_guard<std::mutex> g(s.lock);
+                                         s.progress.bytesDone += n;
+                                         return true;
+                                     },
+                                     DL_IDLE_TIMEOUT_MS);
+
+        // request() already required HTTP 200 and readBody() a complete body, so an empty file is valid
+        std::lock_guard<std::mutex> g(s.sdLock);
+        if (!ok)
+        {
+            writer.abort();
+            return false;
+        }
+        res.bytes = writer.size();
+        if (!writer.commitBlob(res.hash, &res.written, job.sha256))
+            return false;
+        return job.sha256.length() || ENC_FS::BlobStore::link(s.app, job.relPath, res.hash, res.bytes);
+    }
+
+    static void workerTask(void *param)
+    {
+        Shared &s = *(Shared *)param;
+
+        while (true)
+        {
+            size_t i;
+            {
+                std::lock_guard<std::mutex> g(s.lock);
+                if (s.abort || s.next >= s.jobs->size())
+                    break;
+                i = s.next++;
+                s.progress.current = (*s.jobs)[i].relPath;
+            }
+
+            Result res;
+            res.ok = fetch(s, i, res);
+            Serial.printf("[DL] %s -> %s (%u bytes, HTTP %d%s)\n", (*s.jobs)[i].relPath.c_str(),
+                          res.ok ? "OK" : "FAILED", (unsigned)res.bytes, res.status, res.ok && !res.written ? ", dedup" : "");
+
+            std::lock_guard<std::mutex> g(s.lock);
+            s.results[i] = res;
+            s.progress.filesDone++;
+            if (!res.ok && (*s.jobs)[i].required)
+                s.abort = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> g(s.lock);
+            s.running--;
+        }
+        vTaskDelete(NULL);
+    }
+
+    bool run(const std::vector<Job> &jobs, const String &app, ProgressFn onProgress, std::vector<Result> *results)
+    {
+        if (jobs.empty())
+            return true;
+        if (WiFi.status() != WL_CONNECTED)
+            return false;
+
+        Shared s;
+        s.jobs = &jobs;
+        s.app = app;
+        s.results.resize(jobs.size());
+        s.progress.filesTotal = jobs.size();
+
+        int workers = std::min((int)jobs.size(), DL_WORKERS);
+        for (int w = 0; w < workers; ++w)
+        {
+            {
+                std::lock_guard<std::mutex> g(s.lock);
+                s.running++;
+            }
+            if (xTaskCreate(workerTask, "PkgDownload", 10240, &s, 1, NULL) != pdPASS)
+            {
+                std::lock_guard<std::mutex> g(s.lock);
+                s.running--;
+            }
+        }
+
+        // UI updates stay on the calling task
+        size_t lastFiles = (size_t)-1;
+        uint64_t lastBytes = (uint64_t)-1;
+        while (true)
+        {
+            Progress snap;
+            int running;
+            {
+                std::lock_guard<std::mutex> g(s.lock);
+                snap = s.progress;
+                running = s.running;
+            }
+            if (onProgress && (snap.filesDone != lastFiles || snap.bytesDone != lastBytes))
+            {
+                onProgress(snap);
+                lastFiles = snap.filesDone;
+                lastBytes = snap.bytesDone;
+            }
+            if (running == 0)
+                break;
+            delay(100);
+        }
+
+        bool ok = true;
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            if (jobs[i].required && !s.results[i].ok)
+                ok = false;
+        }
+        if (results)
+            *results = s.results;
+        return ok;
+    }
+
+    bool stream(const String &url, const StreamSink &sink, int *status, long *contentLength)
+    {
+        if (status)
+            *status = 0;
+        if (WiFi.status() != WL_CONNECTED)
+            return false;
+
+        HttpPool::Lease lease;
+        HttpPool::Response r;
+        int st = 0;
+        bool ok = request(url, lease, r, st);
+        if (status)
+            *status = st;
+        if (!ok)
+            return false;
+        if (contentLength)
+            *contentLength = r.contentLength;
+        return HttpPool::readBody(lease, r, sink, DL_IDLE_TIMEOUT_MS);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+// Concurrent package downloader used by the AppManager.
+//
+// DL_WORKERS tasks pull the next file from a shared job list and fetch it over keep-alive
+// connections from the shared HttpPool, so a multi-file app costs a handful of TLS handshakes
+// instead of one per file. Response bodies (Content-Length or chunked) are streamed straight into
+// ENC_FS::BlobStore writers, there is no size limit and no full-file buffer.
+namespace PkgDownloader
+{
+    constexpr int DL_WORKERS = 2;              // matches HttpPool::POOL_MAX_TLS
+    constexpr uint32_t DL_IDLE_TIMEOUT_MS = 8000;
+    constexpr int DL_MAX_REDIRECTS = 3;
+
+    struct Job
+    {
+        String url;
+        String relPath; // destination below programs/<app>/
+        bool required;
+        // Expected SHA-256 (from manifest.txt). When set the body is verified while streaming and
+        // only the blob is stored; the caller swaps in the whole manifest (BlobStore::replace).
+        String sha256 = "";
+    };
+
+    struct Result
+    {
+        bool ok = false;
+        int status = 0;    // last HTTP status, 0 on connection errors
+        size_t bytes = 0;
+        bool written = false; // false if the blob already existed (deduplicated)
+        String hash;
+    };
+
+    struct Progress
+    {
+        size_t filesDone = 0;
+        size_t filesTotal = 0;
+        uint64_t bytesDone = 0;
+        uint64_t bytesTotal = 0; // sum of known Content-Lengths, grows while downloading
+        String current;          // relPath of the most recently started file
+    };
+
+    using ProgressFn = std::function<void(const Progress &)>;
+
+    // Download all jobs into programs/<app>/. onProgress runs on the calling task (safe for UI).
+    // Returns false if a required job failed; per-job results are written to `results` if given.
+    bool run(const std::vector<Job> &jobs, const String &app, ProgressFn onProgress = nullptr,
+             std::vector<Result> *results = nullptr);
+
+    using StreamSink = std::function<bool(const uint8_t *, size_t)>;
+
+    // GET `url` (pooled connection) and hand the body to `sink` chunk by chunk
+    // (sink returns false to abort). `contentLength` is -1 if the server did not send one.
+    bool stream(const String &url, const StreamSink &sink, int *status = nullptr, long *contentLength = nullptr);
+}
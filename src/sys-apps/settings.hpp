@@ -8,6 +8,7 @@
 #include "../utils/shutdown.hpp"
 #include "../screen/index.hpp"
 #include "../screen/svg.hpp"
+#include "../screen/icon-cache.hpp"
 #include "./designer.hpp"
 
 namespace SettingsMenu
@@ -51,7 +52,7 @@ namespace SettingsMenu
         tft.setTextSize(2);
 
         // Back icon (30x30)
-        drawSVGString(SVG::back, 20, 21, 26, 26, TEXT);
+        IconCache::draw(SVG::back, 20, 21, 26, 26, TEXT, BG);
 
         tft.setCursor(60, 25);
         tft.print("Settings");
@@ -65,7 +66,7 @@ namespace SettingsMenu
         int iconX = s.x - 35;
         int iconY = s.y - 6;
 
-        drawSVGString(s.svg, iconX, iconY, 20, 20, TEXT);
+        IconCache::draw(s.svg, iconX, iconY, 20, 20, TEXT, BG);
 
         // label
         tft.setTextColor(TEXT, BG);
@@ -100,7 +101,7 @@ namespace SettingsMenu
 
             // icon
             if (opt.svg)
-                drawSVGString(opt.svg, bx, y - 20, 28, 28, opt.color);
+                IconCache::draw(opt.svg, bx, y - 20, 28, 28, opt.color, BG);
 
             // label
             tft.setTextColor(TEXT, BG);
@@ -3,6 +3,8 @@
 #include <Arduino.h>
 #include "freertos/FreeRTOS.h"
 #include "../apps/index.hpp"
+#include "../wifi/http-pool.hpp"
+#include "../screen/svg.hpp"
 
 // ---------------------- Debug (single-shot) ----------------------
 void debugTaskLog()
@@ -56,5 +58,10 @@ void monitor()
         heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
         uxTaskGetNumberOfTasks());
 
+    // idle keep-alive sockets hold TLS heap, drop them once they time out
+    HttpPool::expireIdle();
+    HttpPool::printStats();
+    printSVGStats();
+
     debugTaskLog();
 }
\ No newline at end of file
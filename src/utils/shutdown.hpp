@@ -5,6 +5,7 @@
 
 #include "../anim/entry.hpp"
 #include "../io/read-string.hpp"
+#include "../fs/enc-fs.hpp"
 
 inline void shutdown()
 {
@@ -13,6 +14,9 @@ inline void shutdown()
     {
         const auto ANIM_TIME = 1500;
 
+        // write pending ENC_FS write-back data before power goes away
+        ENC_FS::sync();
+
         startAnimationMWOS();
 
         unsigned long start = millis();
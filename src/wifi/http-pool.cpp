@@ -0,0 +1,658 @@
+#include "http-pool.hpp"
+
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+namespace HttpPool
+{
+    bool parseUrl(const String &url, Url &out)
+    {
+        int rest;
+        if (url.startsWith("https://"))
+        {
+            out.tls = true;
+            out.port = 443;
+            rest = 8;
+        }
+        else if (url.startsWith("http://"))
+        {
+            out.tls = false;
+            out.port = 80;
+            rest = 7;
+        }
+        else
+            return false;
+
+        int slash = url.indexOf('/', rest);
+        String hostPort = slash < 0 ? url.substring(rest) : url.substring(rest, slash);
+        out.path = slash < 0 ? String("/") : url.substring(slash);
+
+        int colon = hostPort.indexOf(':');
+        if (colon >= 0)
+        {
+            out.port = (uint16_t)hostPort.substring(colon + 1).toInt();
+            hostPort = hostPort.substring(0, colon);
+        }
+        out.host = hostPort;
+        return out.host.length() > 0 && out.port > 0;
+    }
+
+    // ---------- pool ----------
+
+    struct Idle
+    {
+        WiFiClient *client;
+        bool tls;
+        String host;
+        uint16_t port;
+        uint32_t since;
+    };
+
+    static std::mutex g_lock;
+    static std::vector<Idle> g_idle; // oldest first
+    static Stats g_stats;
+
+    // Sockets are closed outside the lock, a TLS close can take a while.
+    static void closeClients(std::vector<WiFiClient *> &dead)
+    {
+        for (WiFiClient *c : dead)
+        {
+            c->stop();
+            delete c;
+        }
+        dead.clear();
+    }
+
+    static void evictLocked(size_t i, std::vector<WiFiClient *> &dead)
+    {
+        if (g_idle[i].tls)
+            g_stats.tlsLive--;
+        dead.push_back(g_idle[i].client);
+        g_idle.erase(g_idle.begin() + i);
+        g_stats.evictions++;
+    }
+
+    static void expireLocked(bool all, std::vector<WiFiClient *> &dead)
+    {
+        uint32_t now = millis();
+        for (size_t i = 0; i < g_idle.size();)
+        {
+            if (all || now - g_idle[i].since > POOL_IDLE_TIMEOUT_MS || !g_idle[i].client->connected())
+                evictLocked(i, dead);
+            else
+                ++i;
+        }
+    }
+
+    void expireIdle(bool all)
+    {
+        std::vector<WiFiClient *> dead;
+        {
+            std::lock_guard<std::mutex> g(g_lock);
+            expireLocked(all, dead);
+        }
+        closeClients(dead);
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> g(g_lock);
+        Stats s = g_stats;
+        s.idle = (int)g_idle.size();
+        return s;
+    }
+
+    void printStats()
+    {
+        Stats s = stats();
+        Serial.printf("[HttpPool] req=%u hit=%u connect=%u tls=%u fail=%u evict=%u wait=%u | idle=%d busy=%d tlsLive=%d\n",
+                      s.requests, s.hits, s.connects, s.handshakes, s.failures, s.evictions, s.tlsWaits,
+                      s.idle, s.inUse, s.tlsLive);
+    }
+
+    Lease acquire(const Url &u, uint32_t timeoutMs, bool fresh)
+    {
+        Lease lease;
+        std::vector<WiFiClient *> dead;
+
+        if (WiFi.status() != WL_CONNECTED)
+        {
+            expireIdle(true);
+            return lease;
+        }
+
+        std::unique_lock<std::mutex> g(g_lock);
+        g_stats.requests++;
+        expireLocked(false, dead);
+
+        // newest matching idle socket first
+        for (size_t i = g_idle.size(); !fresh && i-- > 0;)
+        {
+            Idle &it = g_idle[i];
+            if (it.tls != u.tls || it.port != u.port || it.host != u.host)
+                continue;
+            lease.client = it.client;
+            lease.wasIdle = true;
+            g_idle.erase(g_idle.begin() + i);
+            g_stats.hits++;
+            g_stats.inUse++;
+            break;
+        }
+
+        if (!lease.client && u.tls)
+        {
+            uint32_t start = millis();
+            bool waited = false;
+            while (g_stats.tlsLive >= POOL_MAX_TLS)
+            {
+                auto oldest = std::find_if(g_idle.begin(), g_idle.end(), [](const Idle &it)
+                                           { return it.tls; });
+                if (oldest != g_idle.end())
+                {
+                    evictLocked(oldest - g_idle.begin(), dead);
+                    continue;
+                }
+                if (millis() - start > POOL_TLS_WAIT_MS)
+                {
+                    g_stats.failures++;
+                    g.unlock();
+                    closeClients(dead);
+                    Serial.println("[HttpPool] no free TLS slot for " + u.host);
+                    return lease;
+                }
+                if (!waited)
+                    g_stats.tlsWaits++;
+                waited = true;
+                g.unlock();
+                closeClients(dead);
+                delay(20);
+                g.lock();
+            }
+        }
+
+        if (!lease.client)
+        {
+            // reserve the slot before connecting so concurrent callers respect the TLS cap
+            if (u.tls)
+                g_stats.tlsLive++;
+            g_stats.inUse++;
+            g_stats.connects++;
+            if (u.tls)
+                g_stats.handshakes++;
+        }
+        g.unlock();
+        closeClients(dead);
+
+        lease.tls = u.tls;
+        lease.host = u.host;
+        lease.port = u.port;
+        if (lease.client)
+            return lease;
+
+        // the timeout overloads of connect() are not virtual, call them on the concrete type
+        WiFiClient *c;
+        bool ok;
+        if (u.tls)
+        {
+            WiFiClientSecure *s = new WiFiClientSecure();
+            s->setInsecure(); // no CA store on the device, same policy as before
+            ok = s->connect(u.host.c_str(), u.port, (int32_t)timeoutMs);
+            c = s;
+        }
+        else
+        {
+            c = new WiFiClient();
+            ok = c->connect(u.host.c_str(), u.port, (int32_t)timeoutMs);
+        }
+
+        if (!ok)
+        {
+            Serial.println("[HttpPool] connect failed: " + u.host + ":" + String(u.port));
+            c->stop();
+            delete c;
+            std::lock_guard<std::mutex> lg(g_lock);
+            if (u.tls)
+                g_stats.tlsLive--;
+            g_stats.inUse--;
+            g_stats.failures++;
+            return lease;
+        }
+        lease.client = c;
+        return lease;
+    }
+
+    Lease &Lease::operator=(Lease &&o)
+    {
+        if (this == &o)
+            return *this;
+        release(false);
+        client = o.client;
+        tls = o.tls;
+        host = o.host;
+        port = o.port;
+        wasIdle = o.wasIdle;
+        o.client = nullptr;
+        return *this;
+    }
+
+    void Lease::release(bool keepAlive)
+    {
+        if (!client)
+            return;
+        WiFiClient *c = client;
+        client = nullptr;
+
+        std::vector<WiFiClient *> dead;
+        {
+            std::lock_guard<std::mutex> g(g_lock);
+            g_stats.inUse--;
+            if (keepAlive && c->connected() && WiFi.status() == WL_CONNECTED)
+            {
+                g_idle.push_back(Idle{c, tls, host, port, (uint32_t)millis()});
+                if ((int)g_idle.size() > POOL_MAX_IDLE)
+                    evictLocked(0, dead);
+            }
+            else
+            {
+                if (tls)
+                    g_stats.tlsLive--;
+                dead.push_back(c);
+            }
+        }
+        closeClients(dead);
+    }
+
+    // ---------- HTTP/1.1 ----------
+
+    static bool readLine(WiFiClient &c, String &line, uint32_t timeoutMs)
+    {
+        line = "";
+        unsigned long last = millis();
+        while (true)
+        {
+            int ch = c.read();
+            if (ch < 0)
+            {
+                if (!c.connected() && !c.available())
+                    return false;
+                if (millis() - last > timeoutMs)
+                    return false;
+                delay(1);
+                continue;
+            }
+            last = millis();
+            if (ch == '\n')
+            {
+                line.trim();
+                return true;
+            }
+            line += (char)ch;
+        }
+    }
+
+    // Read up to `len` bytes (at least 1); 0 on timeout/close.
+    static size_t readSome(WiFiClient &c, uint8_t *buf, size_t len, uint32_t timeoutMs)
+    {
+        unsigned long last = millis();
+        while (true)
+        {
+            int avail = c.available();
+            if (avail > 0)
+            {
+                int r = c.read(buf, std::min((size_t)avail, len));
+                if (r > 0)
+                    return (size_t)r;
+            }
+            else if (!c.connected())
+                return 0;
+            if (millis() - last > timeoutMs)
+                return 0;
+            delay(1);
+        }
+    }
+
+    static bool readHead(WiFiClient &c, Response &r, uint32_t timeoutMs)
+    {
+        String line;
+        if (!readLine(c, line, timeoutMs) || !line.startsWith("HTTP/"))
+            return false;
+        int sp = line.indexOf(' ');
+        r.status = sp < 0 ? 0 : line.substring(sp + 1).toInt();
+        if (line.startsWith("HTTP/1.0"))
+            r.close = true;
+
+        while (readLine(c, line, timeoutMs))
+        {
+            if (line.length() == 0)
+                return r.status > 0;
+            int colon = line.indexOf(':');
+            if (colon < 0)
+                continue;
+            String name = line.substring(0, colon);
+            String val = line.substring(colon + 1);
+            val.trim();
+            r.headers[name] = val;
+
+            String key = name;
+            key.toLowerCase();
+            if (key == "content-length")
+                r.contentLength = val.toInt();
+            else if (key == "transfer-encoding")
+            {
+                val.toLowerCase();
+                r.chunked = val.indexOf("chunked") >= 0;
+            }
+            else if (key == "connection")
+            {
+                val.toLowerCase();
+                if (val.indexOf("close") >= 0)
+                    r.close = true;
+            }
+            else if (key == "location")
+                r.location = val;
+        }
+        return false;
+    }
+
+    // `sentAny` tells whether any byte reached the socket, i.e. whether the server may have seen the request.
+    static bool sendRequest(WiFiClient &c, const String &method, const Url &u, const Request &req, const String &body,
+                            bool &sentAny)
+    {
+        sentAny = false;
+        // RFC 7230 5.4: the port is part of Host unless it is the scheme's default
+        String host = u.host;
+        if (u.port != (u.tls ? 443 : 80))
+            host += ":" + String(u.port);
+        String head = method + " " + u.path + " HTTP/1.1\r\n" +
+                      "Host: " + host + "\r\n";
+        bool hasAgent = false, hasEncoding = false;
+        for (const auto &h : req.headers)
+        {
+            String k = h.first;
+            k.toLowerCase();
+            if (k == "host" || k == "connection" || k == "content-length")
+                continue; // managed here
+            hasAgent |= k == "user-agent";
+            hasEncoding |= k == "accept-encoding";
+            head += h.first + ": " + h.second + "\r\n";
+        }
+        if (!hasAgent)
+            head += "User-Agent: MWOS\r\n";
+        if (!hasEncoding)
+            head += "Accept-Encoding: identity\r\n";
+        if (body.length() || method == "POST" || method == "PUT")
+            head += "Content-Length: " + String(body.length()) + "\r\n";
+        head += "Connection: keep-alive\r\n\r\n";
+
+        size_t w = c.write((const uint8_t *)head.c_str(), head.length());
+        sentAny = w > 0;
+        if (w != head.length())
+            return false;
+        size_t sent = 0;
+        while (sent < body.length())
+        {
+            w = c.write((const uint8_t *)body.c_str() + sent, body.length() - sent);
+            if (w == 0)
+                return false;
+            sent += w;
+        }
+        return true;
+    }
+
+    // Methods that can be sent again when a reused connection turns out to be dead after the request left
+    static bool safeToResend(const String &method)
+    {
+        return method == "GET" || method == "HEAD" || method == "OPTIONS";
+    }
+
+    // RFC 3986 5.2.4 on an absolute path
+    static String removeDotSegments(const String &path)
+    {
+        std::vector<String> segs;
+        int i = 1;
+        while (true)
+        {
+            int j = path.indexOf('/', i);
+            bool last = j < 0;
+            String seg = last ? path.substring(i) : path.substring(i, j);
+            if (seg == "." || seg == "..")
+            {
+                if (seg == ".." && !segs.empty())
+                    segs.pop_back();
+                if (last)
+                    segs.push_back(""); // "/a/b/.." -> "/a/"
+            }
+            else
+                segs.push_back(seg);
+            if (last)
+                break;
+            i = j + 1;
+        }
+
+        String out;
+        for (const String &seg : segs)
+            out += "/" + seg;
+        return out.length() ? out : String("/");
+    }
+
+    // Redirect target: `location` resolved against the request URL `u` (RFC 3986 5.2)
+    static String resolveLocation(const Url &u, String location)
+    {
+        int hash = location.indexOf('#');
+        if (hash >= 0)
+            location = location.substring(0, hash); // fragments are never sent
+        if (location.startsWith("http://") || location.startsWith("https://"))
+            return location;
+        if (location.startsWith("//"))
+            return String(u.tls ? "https:" : "http:") + location;
+
+        String origin = String(u.tls ? "https://" : "http://") + u.host + ":" + String(u.port);
+        int q = u.path.indexOf('?');
+        String basePath = q < 0 ? u.path : u.path.substring(0, q);
+        if (location.length() == 0)
+            return origin + u.path;
+        if (location.startsWith("?"))
+            return origin + basePath + location;
+
+        q = location.indexOf('?');
+        String path = q < 0 ? location : location.substring(0, q);
+        String query = q < 0 ? String() : location.substring(q);
+        if (!path.startsWith("/"))
+            path = basePath.substring(0, basePath.lastIndexOf('/') + 1) + path;
+        return origin + removeDotSegments(path) + query;
+    }
+
+    bool open(const Request &req, Response &res, Lease &lease)
+    {
+        String url = req.url;
+        String method = req.method;
+        String body = req.body;
+        method.toUpperCase();
+
+        for (int hop = 0; hop <= req.maxRedirects; ++hop)
+        {
+            Url u;
+            res = Response();
+            res.url = url;
+            if (!parseUrl(url, u))
+            {
+                res.error = "bad url: " + url;
+                return false;
+            }
+
+            bool headOk = false;
+            for (int attempt = 0; attempt < 2 && !headOk; ++attempt)
+            {
+                lease = acquire(u, req.timeoutMs, attempt > 0);
+                if (!lease)
+                {
+                    res.error = "connect failed";
+                    return false;
+                }
+                bool sentAny = false;
+                headOk = sendRequest(*lease, method, u, req, body, sentAny) && readHead(*lease, res, req.timeoutMs);
+                if (!headOk)
+                {
+                    bool stale = lease.reused();
+                    lease.release(false);
+                    res = Response();
+                    res.url = url;
+                    if (!stale)
+                        break; // fresh connection failed, no point retrying
+                    if (sentAny && !safeToResend(method))
+                        break; // the server may have acted on it, never send a POST/PUT twice
+                }
+            }
+            if (!headOk)
+            {
+                res.error = "no response";
+                return false;
+            }
+            res.head = method == "HEAD";
+
+            bool redirect = (res.status == 301 || res.status == 302 || res.status == 303 ||
+                             res.status == 307 || res.status == 308) &&
+                            res.location.length() && hop < req.maxRedirects;
+            if (!redirect)
+                return true;
+
+            readBody(lease, res, nullptr, req.timeoutMs);
+            url = resolveLocation(u, res.location);
+            if (res.status == 303 || ((res.status == 301 || res.status == 302) && method != "GET" && method != "HEAD"))
+            {
+                method = "GET";
+                body = "";
+            }
+        }
+        res.error = "too many redirects";
+        return false;
+    }
+
+    BodyReader::BodyReader(WiFiClient &c, Response &r, uint32_t timeoutMs)
+        : c(c), r(r), timeoutMs(timeoutMs)
+    {
+        if (r.head || r.status == 204 || r.status == 304 || (r.status >= 100 && r.status < 200))
+            state = DONE;
+        else if (r.chunked)
+            state = CHUNK_HEAD;
+        else if (r.contentLength >= 0)
+        {
+            left = (size_t)r.contentLength;
+            state = left ? DATA : DONE;
+        }
+        else
+        {
+            // no length: body ends when the server closes the connection
+            r.close = true;
+            state = UNTIL_CLOSE;
+        }
+    }
+
+    size_t BodyReader::read(uint8_t *buf, size_t len)
+    {
+        if (len == 0)
+            return 0;
+        while (true)
+        {
+            switch (state)
+            {
+            case CHUNK_HEAD:
+            {
+                String line;
+                if (!readLine(c, line, timeoutMs))
+                {
+                    state = FAILED;
+                    return 0;
+                }
+                if (line.length() == 0)
+                    continue; // CRLF after the previous chunk's data
+                left = strtoul(line.c_str(), nullptr, 16); // ignores ";ext"
+                if (left == 0)
+                {
+                    // trailer headers until the empty line
+                    while (readLine(c, line, timeoutMs) && line.length())
+                        ;
+                    state = DONE;
+                    return 0;
+                }
+                state = DATA;
+                break;
+            }
+            case DATA:
+            {
+                size_t n = readSome(c, buf, std::min(left, len), timeoutMs);
+                if (!n)
+                {
+                    state = FAILED;
+                    return 0;
+                }
+                left -= n;
+                if (!left)
+                    state = r.chunked ? CHUNK_HEAD : DONE;
+                return n;
+            }
+            case UNTIL_CLOSE:
+            {
+                size_t n = readSome(c, buf, len, timeoutMs);
+                if (!n)
+                    state = DONE;
+                return n;
+            }
+            default:
+                return 0;
+            }
+        }
+    }
+
+    static bool readBodyInner(WiFiClient &c, Response &r, const Sink &sink, uint32_t timeoutMs)
+    {
+        uint8_t buf[HTTP_CHUNK];
+        BodyReader body(c, r, timeoutMs);
+        while (size_t n = body.read(buf, sizeof(buf)))
+        {
+            if (sink && !sink(buf, n))
+                return false;
+        }
+        return body.done();
+    }
+
+    bool readBody(Lease &lease, Response &res, const Sink &sink, uint32_t timeoutMs)
+    {
+        if (!lease)
+            return false;
+        bool ok = readBodyInner(*lease, res, sink, timeoutMs);
+        lease.release(ok && !res.close);
+        return ok;
+    }
+
+    bool fetch(const Request &req, Response &res, String &body, size_t maxSize)
+    {
+        body = "";
+        Lease lease;
+        if (!open(req, res, lease))
+            return false;
+        if (res.contentLength > 0 && (size_t)res.contentLength <= maxSize)
+            body.reserve(res.contentLength);
+
+        bool tooBig = false;
+        bool ok = readBody(lease, res, [&](const uint8_t *d, size_t n)
+                           {
+                               if (body.length() + n > maxSize)
+                               {
+                                   tooBig = true;
+                                   return false;
+                               }
+                               body.concat((const char *)d, n);
+                               return true;
+                           },
+                           req.timeoutMs);
+        if (tooBig)
+            res.error = "body exceeds " + String((unsigned)maxSize) + " bytes";
+        else if (!ok)
+            res.error = "body read failed";
+        return ok;
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <functional>
+#include <map>
+
+// Process-wide HTTP(S) connection pool plus a small HTTP/1.1 client on top of it.
+//
+// Connections are keyed by (tls, host, port). When a response allows keep-alive the socket goes
+// back into the pool and the next request to the same origin reuses it instead of opening a new
+// TCP connection and doing a TLS handshake. Idle sockets are closed after POOL_IDLE_TIMEOUT_MS.
+// At most POOL_MAX_TLS TLS contexts (~40 KB heap each) exist at once, counting idle ones; a caller
+// that needs another one first evicts an idle TLS socket or waits for a busy one to come back.
+//
+// TLS session resumption: the WiFiClientSecure of the Arduino core 2.x keeps its mbedtls session
+// private, so a session cannot be carried over to a new socket. The pool keeps the TLS socket
+// itself alive instead, which saves the whole handshake for back-to-back requests to one host.
+namespace HttpPool
+{
+    constexpr int POOL_MAX_TLS = 2;
+    constexpr int POOL_MAX_IDLE = 4;
+    constexpr uint32_t POOL_IDLE_TIMEOUT_MS = 15000;
+    constexpr uint32_t POOL_TLS_WAIT_MS = 10000; // max wait for a free TLS slot
+
+    constexpr uint32_t HTTP_TIMEOUT_MS = 15000; // connect and per-read idle timeout
+    constexpr int HTTP_MAX_REDIRECTS = 5;
+    constexpr size_t HTTP_CHUNK = 2048;
+
+    struct Url
+    {
+        bool tls = true;
+        String host;
+        uint16_t port = 443;
+        String path = "/";
+    };
+
+    // http:// and https:// only
+    bool parseUrl(const String &url, Url &out);
+
+    struct Stats
+    {
+        uint32_t requests = 0;   // acquire() calls
+        uint32_t hits = 0;       // served from an idle keep-alive socket
+        uint32_t connects = 0;   // new TCP connections
+        uint32_t handshakes = 0; // of those, TLS handshakes
+        uint32_t failures = 0;   // connect or handshake errors
+        uint32_t evictions = 0;  // idle sockets closed (timeout, limits, dead)
+        uint32_t tlsWaits = 0;   // acquire() had to wait for a TLS slot
+        int idle = 0;
+        int inUse = 0;
+        int tlsLive = 0;
+    };
+
+    Stats stats();
+    void printStats();
+    // Close idle sockets past POOL_IDLE_TIMEOUT_MS; `all` closes every idle socket.
+    void expireIdle(bool all = false);
+
+    class Lease;
+
+    // A connected socket for the origin of `u`: a pooled idle one if possible, else a new connection
+    // (`fresh` skips the pool). The returned lease is empty on failure.
+    Lease acquire(const Url &u, uint32_t timeoutMs = HTTP_TIMEOUT_MS, bool fresh = false);
+
+    // A checked-out connection. release(true) hands it back to the pool; a lease destroyed without
+    // release() closes its socket.
+    class Lease
+    {
+    public:
+        Lease() {}
+        Lease(Lease &&o) { *this = std::move(o); }
+        Lease &operator=(Lease &&o);
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        ~Lease() { release(false); }
+
+        explicit operator bool() const { return client != nullptr; }
+        WiFiClient *operator->() const { return client; }
+        WiFiClient &operator*() const { return *client; }
+        // true if the socket came from the pool (a failure may just mean the server dropped it)
+        bool reused() const { return wasIdle; }
+
+        void release(bool keepAlive);
+
+    private:
+        friend Lease acquire(const Url &, uint32_t, bool);
+
+        WiFiClient *client = nullptr;
+        bool tls = false;
+        String host;
+        uint16_t port = 0;
+        bool wasIdle = false;
+    };
+
+    // ---------- HTTP/1.1 ----------
+
+    struct Request
+    {
+        String method = "GET";
+        String url;
+        std::map<String, String> headers;
+        String body;
+        uint32_t timeoutMs = HTTP_TIMEOUT_MS;
+        int maxRedirects = HTTP_MAX_REDIRECTS;
+    };
+
+    struct Response
+    {
+        int status = 0; // 0 = no HTTP response, see `error`
+        long contentLength = -1;
+        bool chunked = false;
+        bool close = false;
+        bool head = false; // answer to HEAD: no body, whatever Content-Length says
+        String location;
+        std::map<String, String> headers; // names as sent by the server
+        String url;                       // final URL after redirects
+        String error;
+    };
+
+    using Sink = std::function<bool(const uint8_t *, size_t)>;
+
+    // Pull-side body decoder for a response opened with open(): hands out the payload in pieces
+    // of at most `len` bytes and strips the chunked framing on the way. read() returns 0 at the end
+    // of the body or on an error, see done()/failed(). The reader keeps references to the socket
+    // and the response, both must outlive it.
+    class BodyReader
+    {
+    public:
+        BodyReader(WiFiClient &c, Response &r, uint32_t timeoutMs = HTTP_TIMEOUT_MS);
+
+        size_t read(uint8_t *buf, size_t len);
+        bool done() const { return state == DONE; }
+        bool failed() const { return state == FAILED; }
+
+    private:
+        enum State
+        {
+            CHUNK_HEAD, // expecting a chunk size line
+            DATA,       // `left` payload bytes of the current chunk / of Content-Length
+            UNTIL_CLOSE,
+            DONE,
+            FAILED
+        };
+
+        WiFiClient &c;
+        Response &r;
+        uint32_t timeoutMs;
+        State state;
+        size_t left = 0;
+    };
+
+    // Send `req` (following redirects) and read the head of the final response. On success the body
+    // is still unread on `lease`; finish it with readBody() (or drop the lease to close the socket).
+    // A dead keep-alive socket is retried on a new connection only for GET/HEAD/OPTIONS or when
+    // nothing of the request was written.
+    bool open(const Request &req, Response &res, Lease &lease);
+
+    // Stream the body into `sink` (nullptr discards it; the sink returns false to abort), then hand
+    // the socket back to the pool if the response allows keep-alive.
+    bool readBody(Lease &lease, Response &res, const Sink &sink, uint32_t timeoutMs = HTTP_TIMEOUT_MS);
+
+    // open() + readBody() into `body`. Any HTTP status counts as success; false on transport
+    // errors or when the body exceeds `maxSize`.
+    bool fetch(const Request &req, Response &res, String &body, size_t maxSize = 256 * 1024);
+}
@@ -0,0 +1,294 @@
+#include "net-reactor.hpp"
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <condition_variable>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace NetReactor
+{
+    struct Watch
+    {
+        int fd;
+        uint8_t events;
+        Callback cb;
+    };
+
+    struct Waiter
+    {
+        std::vector<WaitFd> *fds;
+        bool done;
+    };
+
+    static std::mutex g_lock;             // everything below
+    static std::recursive_mutex g_cbLock; // held while a watch callback runs, see unwatch()
+    static std::condition_variable g_cv;  // waiters
+    static std::map<int, Watch> g_watches;
+    static std::vector<Waiter *> g_waiters;
+    static int g_nextId = 1;
+    static Stats g_stats;
+
+    static bool g_started = false;
+    static int g_wakeFd = -1;
+    static sockaddr_in g_wakeAddr;
+
+    static void wake()
+    {
+        uint8_t b = 1;
+        sendto(g_wakeFd, &b, 1, 0, (sockaddr *)&g_wakeAddr, sizeof(g_wakeAddr));
+    }
+
+    static bool isValid(int fd)
+    {
+        return fd >= 0 && fd < FD_SETSIZE && fcntl(fd, F_GETFL, 0) >= 0;
+    }
+
+    struct FdSets
+    {
+        fd_set r, w, e;
+        int maxFd = -1;
+
+        FdSets()
+        {
+            FD_ZERO(&r);
+            FD_ZERO(&w);
+            FD_ZERO(&e);
+        }
+
+        void add(int fd, uint8_t events)
+        {
+            if (fd < 0 || fd >= FD_SETSIZE)
+                return;
+            if (events & EV_READ)
+                FD_SET(fd, &r);
+            if (events & EV_WRITE)
+                FD_SET(fd, &w);
+            FD_SET(fd, &e);
+            maxFd = std::max(maxFd, fd);
+        }
+
+        // `failed`: select() itself failed (usually EBADF), the sets are meaningless then
+        uint8_t ready(int fd, uint8_t events, bool failed) const
+        {
+            if (fd < 0 || fd >= FD_SETSIZE)
+                return EV_ERROR;
+            if (failed)
+                return isValid(fd) ? 0 : EV_ERROR;
+            uint8_t out = 0;
+            if ((events & EV_READ) && FD_ISSET(fd, &r))
+                out |= EV_READ;
+            if ((events & EV_WRITE) && FD_ISSET(fd, &w))
+                out |= EV_WRITE;
+            if (FD_ISSET(fd, &e))
+                out |= EV_ERROR;
+            return out;
+        }
+    };
+
+    static void reactorTask(void *)
+    {
+        std::vector<std::pair<int, uint8_t>> fire;
+        while (true)
+        {
+            FdSets s;
+            s.add(g_wakeFd, EV_READ);
+            {
+                std::lock_guard<std::mutex> g(g_lock);
+                for (auto &w : g_watches)
+                    s.add(w.second.fd, w.second.events);
+                for (Waiter *wt : g_waiters)
+                    for (auto &f : *wt->fds)
+                        s.add(f.fd, f.events);
+            }
+
+            timeval tv;
+            tv.tv_sec = REACTOR_MAX_SLEEP_MS / 1000;
+            tv.tv_usec = (REACTOR_MAX_SLEEP_MS % 1000) * 1000;
+            int n = select(s.maxFd + 1, &s.r, &s.w, &s.e, &tv);
+            bool failed = n < 0;
+            if (failed)
+                delay(10); // a socket was closed while registered, don't spin on it
+
+            if (n > 0 && FD_ISSET(g_wakeFd, &s.r))
+            {
+                uint8_t drain[16];
+                while (recv(g_wakeFd, drain, sizeof(drain), MSG_DONTWAIT) > 0)
+                    ;
+            }
+
+            fire.clear();
+            {
+                std::lock_guard<std::mutex> g(g_lock);
+                g_stats.loops++;
+                if (n > 0 && FD_ISSET(g_wakeFd, &s.r))
+                    g_stats.wakeups++;
+                if (n == 0 && !failed)
+                    continue;
+                for (auto &w : g_watches)
+                {
+                    uint8_t r = s.ready(w.second.fd, w.second.events, failed);
+                    if (r)
+                        fire.push_back({w.first, r});
+                }
+            }
+
+            // callbacks first, so a woken waiter already sees their effect (e.g. an accepted client)
+            for (auto &f : fire)
+            {
+                std::lock_guard<std::recursive_mutex> cg(g_cbLock);
+                Callback cb;
+                int fd;
+                {
+                    std::lock_guard<std::mutex> g(g_lock);
+                    auto it = g_watches.find(f.first);
+                    if (it == g_watches.end())
+                        continue; // unwatched meanwhile
+                    cb = it->second.cb;
+                    fd = it->second.fd;
+                    // a dead socket would fire forever, the owner gets one EV_ERROR
+                    if (f.second & EV_ERROR)
+                        g_watches.erase(it);
+                    g_stats.fired++;
+                }
+                cb(fd, f.second);
+            }
+
+            std::lock_guard<std::mutex> g(g_lock);
+            bool any = false;
+            for (Waiter *wt : g_waiters)
+            {
+                for (auto &f : *wt->fds)
+                {
+                    f.ready = s.ready(f.fd, f.events, failed);
+                    wt->done |= f.ready != 0;
+                }
+                if (wt->done)
+                {
+                    g_stats.woken++;
+                    any = true;
+                }
+            }
+            if (any)
+            {
+                g_waiters.erase(std::remove_if(g_waiters.begin(), g_waiters.end(), [](Waiter *wt)
+                                               { return wt->done; }),
+                                g_waiters.end());
+                g_cv.notify_all();
+            }
+        }
+    }
+
+    static bool ensureStartedLocked()
+    {
+        if (g_started)
+            return true;
+
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0)
+            return false;
+        sockaddr_in a = {};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        a.sin_port = 0;
+        socklen_t len = sizeof(a);
+        if (bind(fd, (sockaddr *)&a, sizeof(a)) < 0 || getsockname(fd, (sockaddr *)&a, &len) < 0)
+        {
+            Serial.println("[NetReactor] wake socket failed");
+            close(fd);
+            return false;
+        }
+        g_wakeFd = fd;
+        g_wakeAddr = a;
+
+        if (xTaskCreate(reactorTask, "NetReactor", REACTOR_STACK, nullptr, 2, nullptr) != pdPASS)
+        {
+            Serial.println("[NetReactor] task create failed");
+            close(fd);
+            g_wakeFd = -1;
+            return false;
+        }
+        g_started = true;
+        return true;
+    }
+
+    int watch(int fd, uint8_t events, Callback cb)
+    {
+        if (fd < 0 || fd >= FD_SETSIZE || !cb)
+            return -1;
+        std::lock_guard<std::mutex> g(g_lock);
+        if (!ensureStartedLocked())
+            return -1;
+        int id = g_nextId++;
+        g_watches[id] = Watch{fd, events, cb};
+        wake();
+        return id;
+    }
+
+    void unwatch(int id)
+    {
+        if (id < 0)
+            return;
+        std::lock_guard<std::recursive_mutex> cg(g_cbLock);
+        std::lock_guard<std::mutex> g(g_lock);
+        if (g_watches.erase(id) && g_started)
+            wake();
+    }
+
+    // select() with a zero timeout on the calling task
+    static int pollNow(std::vector<WaitFd> &fds)
+    {
+        FdSets s;
+        for (auto &f : fds)
+            s.add(f.fd, f.events);
+        timeval tv = {0, 0};
+        int n = s.maxFd < 0 ? 0 : select(s.maxFd + 1, &s.r, &s.w, &s.e, &tv);
+        int ready = 0;
+        for (auto &f : fds)
+        {
+            f.ready = n == 0 ? (f.fd < 0 || f.fd >= FD_SETSIZE ? EV_ERROR : 0) : s.ready(f.fd, f.events, n < 0);
+            ready += f.ready != 0;
+        }
+        return ready;
+    }
+
+    int wait(std::vector<WaitFd> &fds, uint32_t timeoutMs)
+    {
+        int ready = pollNow(fds);
+        if (ready || timeoutMs == 0 || fds.empty())
+            return ready;
+
+        Waiter w{&fds, false};
+        {
+            std::unique_lock<std::mutex> g(g_lock);
+            if (!ensureStartedLocked())
+                return 0;
+            g_waiters.push_back(&w);
+            wake();
+            g_cv.wait_for(g, std::chrono::milliseconds(timeoutMs), [&]
+                          { return w.done; });
+            if (!w.done)
+                g_waiters.erase(std::remove(g_waiters.begin(), g_waiters.end(), &w), g_waiters.end());
+        }
+
+        ready = 0;
+        for (auto &f : fds)
+            ready += f.ready != 0;
+        return ready;
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> g(g_lock);
+        Stats s = g_stats;
+        s.watches = (int)g_watches.size();
+        s.waiters = (int)g_waiters.size();
+        return s;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+// Socket readiness reactor.
+//
+// One task blocks in lwIP select() over every registered socket and
+//  - runs `watch` callbacks while their socket is ready (level-triggered, the callback has to
+//    consume the readiness, e.g. accept() the pending connection), and
+//  - wakes tasks blocked in wait() as soon as one of their sockets is ready.
+// Registrations wake the reactor through a loopback UDP socket, so nothing polls on a timer.
+namespace NetReactor
+{
+    constexpr uint8_t EV_READ = 1;
+    constexpr uint8_t EV_WRITE = 2;
+    constexpr uint8_t EV_ERROR = 4; // socket invalid or in error state
+
+    constexpr uint32_t REACTOR_STACK = 4096;
+    constexpr uint32_t REACTOR_MAX_SLEEP_MS = 1000; // safety net if a wake-up datagram is lost
+
+    using Callback = std::function<void(int fd, uint8_t events)>;
+
+    // Runs `cb` on the reactor task whenever `fd` is ready for `events`. Returns a watch id (<0 on error).
+    int watch(int fd, uint8_t events, Callback cb);
+    // After unwatch() returns the callback is not running and will not run again.
+    void unwatch(int id);
+
+    struct WaitFd
+    {
+        int fd;
+        uint8_t events; // EV_READ / EV_WRITE
+        uint8_t ready;  // out
+    };
+
+    // Block the calling task until at least one entry is ready or `timeoutMs` passes.
+    // Returns the number of ready entries (0 on timeout).
+    int wait(std::vector<WaitFd> &fds, uint32_t timeoutMs);
+
+    struct Stats
+    {
+        uint32_t loops = 0;   // select() returns
+        uint32_t wakeups = 0; // wake datagrams (registration changes)
+        uint32_t fired = 0;   // watch callbacks run
+        uint32_t woken = 0;   // waiters released by readiness
+        int watches = 0;
+        int waiters = 0;
+    };
+
+    Stats stats();
+}
@@ -0,0 +1,81 @@
+#include "net-workers.hpp"
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace NetWorkers
+{
+    static std::mutex g_lock;
+    static std::condition_variable g_cv;
+    static std::deque<Job> g_jobs;
+    static Stats g_stats;
+
+    static void workerTask(void *)
+    {
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> g(g_lock);
+                g_cv.wait(g, []
+                          { return !g_jobs.empty(); });
+                job = std::move(g_jobs.front());
+                g_jobs.pop_front();
+                g_stats.busy++;
+            }
+
+            job();
+            job = nullptr; // drop captures before the job counts as done
+
+            std::lock_guard<std::mutex> g(g_lock);
+            g_stats.busy--;
+            g_stats.done++;
+        }
+    }
+
+    static bool ensureStartedLocked()
+    {
+        while (g_stats.workers < NET_WORKERS)
+        {
+            String name = String("NetWorker") + String(g_stats.workers);
+            // same priority as the app tasks, a download must not starve the UI
+            if (xTaskCreate(workerTask, name.c_str(), WORKER_STACK, nullptr, 1, nullptr) != pdPASS)
+            {
+                Serial.println("[NetWorkers] task create failed");
+                break;
+            }
+            g_stats.workers++;
+        }
+        return g_stats.workers > 0;
+    }
+
+    bool post(Job job)
+    {
+        if (!job)
+            return false;
+        std::lock_guard<std::mutex> g(g_lock);
+        if (!ensureStartedLocked())
+            return false;
+        if (g_jobs.size() >= WORKER_QUEUE_MAX)
+        {
+            g_stats.rejected++;
+            return false;
+        }
+        g_jobs.push_back(std::move(job));
+        g_stats.posted++;
+        g_cv.notify_one();
+        return true;
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> g(g_lock);
+        Stats s = g_stats;
+        s.queued = (int)g_jobs.size();
+        return s;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+// Small pool of native tasks for blocking network jobs (HTTP requests, TLS handshakes).
+//
+// Jobs run in FIFO order on NET_WORKERS tasks that are started on the first post(). A job must not
+// touch a lua_State: it hands its result to whoever owns the state (see net.await in apps/network.cpp).
+namespace NetWorkers
+{
+    constexpr int NET_WORKERS = 2;
+    constexpr uint32_t WORKER_STACK = 8192; // TLS handshakes run on it
+    constexpr size_t WORKER_QUEUE_MAX = 16;
+
+    using Job = std::function<void()>;
+
+    // Queue a job. false if the queue is full or the workers could not be started.
+    bool post(Job job);
+
+    struct Stats
+    {
+        uint32_t posted = 0;
+        uint32_t done = 0;
+        uint32_t rejected = 0; // queue full
+        int queued = 0;
+        int busy = 0;
+        int workers = 0;
+    };
+
+    Stats stats();
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+# Builds the host replay harness (see main.cpp) into tools/browser-replay/_build.
+#
+# The browser sources are compiled unchanged. A mirror of src/ under _build/tree links them next
+# to the harness versions of the headers that pull in hardware (screen/index.hpp, fs/enc-fs.hpp,
+# io/read-string.hpp, utils/time.hpp), so their relative #includes resolve to the stubs.
+#
+#   NANOSVG_DIR  directory with nanosvg.h (default: the PlatformIO checkout in .pio/libdeps)
+#   CXX          host compiler (default g++), needs zlib
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(cd "$HERE/../.." && pwd)
+OUT="$HERE/_build"
+TREE="$OUT/tree/src"
+NANOSVG_DIR=${NANOSVG_DIR:-$ROOT/.pio/libdeps/esp32dev/nanosvg/src}
+CXX=${CXX:-g++}
+
+if [ ! -f "$NANOSVG_DIR/nanosvg.h" ]; then
+    echo "nanosvg.h not found in $NANOSVG_DIR (run a PlatformIO build once or set NANOSVG_DIR)" >&2
+    exit 1
+fi
+
+rm -rf "$OUT/tree"
+mkdir -p "$TREE/sys-apps" "$TREE/screen" "$TREE/styles" "$TREE/utils" "$TREE/fs" "$TREE/io" "$TREE/icons"
+for f in "$ROOT"/src/sys-apps/browser*.cpp "$ROOT"/src/sys-apps/browser*.hpp "$ROOT"/src/sys-apps/mwosp.hpp; do
+    ln -s "$f" "$TREE/sys-apps/"
+done
+ln -s "$ROOT/src/screen/svg.cpp" "$ROOT/src/screen/svg.hpp" "$ROOT"/src/screen/icon-cache.* "$TREE/screen/"
+ln -s "$ROOT/src/styles/global.cpp" "$ROOT/src/styles/global.hpp" "$TREE/styles/"
+ln -s "$ROOT/src/utils/vec.hpp" "$TREE/utils/"
+ln -s "$ROOT/src/icons/index.cpp" "$ROOT/src/icons/index.hpp" "$TREE/icons/"
+ln -s "$HERE/shadow/screen/index.hpp" "$TREE/screen/"
+ln -s "$HERE/shadow/fs/enc-fs.hpp" "$TREE/fs/"
+ln -s "$HERE/shadow/io/read-string.hpp" "$TREE/io/"
+ln -s "$HERE/shadow/utils/time.hpp" "$TREE/utils/"
+
+# -w as in platformio.ini; the allocator wrappers live in main.cpp
+$CXX -std=gnu++17 -O2 -g -w \
+    -I"$HERE/host" -I"$TREE" -I"$NANOSVG_DIR" \
+    "$TREE"/sys-apps/browser*.cpp "$TREE/screen/svg.cpp" "$TREE/screen/icon-cache.cpp" "$TREE/styles/global.cpp" "$TREE/icons/index.cpp" \
+    "$HERE"/host/*.cpp "$HERE/main.cpp" \
+    -o "$OUT/browser-replay" \
+    -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc -lz
+
+echo "built $OUT/browser-replay"
@@ -0,0 +1,302 @@
+#pragma once
+
+// Host stand-in for the parts of the ESP32 Arduino core the browser uses.
+// String keeps the Arduino interface on top of std::string, so allocation counts are close to
+// but not the same as on the device (different small string buffer).
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cstdarg>
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define F(s) (s)
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+inline void vTaskDelay(uint32_t) {}
+
+class String
+{
+public:
+    String() {}
+    String(const char *s) : s_(s ? s : "") {}
+    String(const char *s, unsigned int len) : s_(s ? std::string(s, len) : std::string()) {}
+    String(const std::string &s) : s_(s) {}
+    String(char c) : s_(1, c) {}
+    String(unsigned char v, unsigned char base = 10) : s_(num((unsigned long)v, base)) {}
+    String(int v, unsigned char base = 10) : s_(base == 10 ? std::to_string(v) : num((unsigned long)(unsigned int)v, base)) {}
+    String(unsigned int v, unsigned char base = 10) : s_(num((unsigned long)v, base)) {}
+    String(long v, unsigned char base = 10) : s_(base == 10 ? std::to_string(v) : num((unsigned long)v, base)) {}
+    String(unsigned long v, unsigned char base = 10) : s_(num(v, base)) {}
+    String(long long v) : s_(std::to_string(v)) {}
+    String(unsigned long long v) : s_(std::to_string(v)) {}
+    String(float v, unsigned int decimals = 2) : s_(fixed(v, decimals)) {}
+    String(double v, unsigned int decimals = 2) : s_(fixed(v, decimals)) {}
+
+    unsigned int length() const { return (unsigned int)s_.size(); }
+    bool isEmpty() const { return s_.empty(); }
+    void clear() { s_.clear(); }
+    const char *c_str() const { return s_.c_str(); }
+    bool reserve(unsigned int n)
+    {
+        s_.reserve(n);
+        return true;
+    }
+
+    bool concat(const String &s)
+    {
+        s_ += s.s_;
+        return true;
+    }
+    bool concat(const char *s)
+    {
+        if (!s)
+            return false;
+        s_ += s;
+        return true;
+    }
+    bool concat(const char *s, unsigned int len)
+    {
+        if (!s)
+            return false;
+        s_.append(s, len);
+        return true;
+    }
+    bool concat(char c)
+    {
+        s_ += c;
+        return true;
+    }
+    template <typename T>
+    bool concat(T v) { return concat(String(v)); }
+
+    template <typename T>
+    String &operator+=(const T &v)
+    {
+        concat(v);
+        return *this;
+    }
+
+    char charAt(unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+    void setCharAt(unsigned int i, char c)
+    {
+        if (i < s_.size())
+            s_[i] = c;
+    }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char &operator[](unsigned int i) { return s_[i]; }
+    char *begin() { return &s_[0]; }
+    char *end() { return &s_[0] + s_.size(); }
+    const char *begin() const { return s_.data(); }
+    const char *end() const { return s_.data() + s_.size(); }
+
+    bool equals(const String &o) const { return s_ == o.s_; }
+    bool equalsIgnoreCase(const String &o) const
+    {
+        if (s_.size() != o.s_.size())
+            return false;
+        for (size_t i = 0; i < s_.size(); i++)
+            if (tolower((unsigned char)s_[i]) != tolower((unsigned char)o.s_[i]))
+                return false;
+        return true;
+    }
+    int compareTo(const String &o) const { return s_.compare(o.s_); }
+    bool operator==(const String &o) const { return s_ == o.s_; }
+    bool operator==(const char *o) const { return s_ == (o ? o : ""); }
+    bool operator!=(const String &o) const { return s_ != o.s_; }
+    bool operator!=(const char *o) const { return !(*this == o); }
+    bool operator<(const String &o) const { return s_ < o.s_; }
+    bool operator>(const String &o) const { return s_ > o.s_; }
+
+    bool startsWith(const String &p, unsigned int offset = 0) const
+    {
+        return offset + p.s_.size() <= s_.size() && s_.compare(offset, p.s_.size(), p.s_) == 0;
+    }
+    bool endsWith(const String &p) const
+    {
+        return p.s_.size() <= s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return pos(s_.find(c, from)); }
+    int indexOf(const String &p, unsigned int from = 0) const { return pos(s_.find(p.s_, from)); }
+    int lastIndexOf(char c) const { return pos(s_.rfind(c)); }
+    int lastIndexOf(char c, unsigned int from) const { return pos(s_.rfind(c, from)); }
+    int lastIndexOf(const String &p) const { return pos(s_.rfind(p.s_)); }
+    int lastIndexOf(const String &p, unsigned int from) const { return pos(s_.rfind(p.s_, from)); }
+
+    String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from > to)
+            std::swap(from, to);
+        if (from >= s_.size())
+            return String();
+        return String(s_.substr(from, std::min<size_t>(to, s_.size()) - from));
+    }
+
+    void replace(char a, char b) { std::replace(s_.begin(), s_.end(), a, b); }
+    void replace(const String &a, const String &b)
+    {
+        if (a.s_.empty())
+            return;
+        for (size_t p = s_.find(a.s_); p != std::string::npos; p = s_.find(a.s_, p + b.s_.size()))
+            s_.replace(p, a.s_.size(), b.s_);
+    }
+    void remove(unsigned int index) { remove(index, (unsigned int)-1); }
+    void remove(unsigned int index, unsigned int count)
+    {
+        if (index < s_.size())
+            s_.erase(index, count);
+    }
+    void toLowerCase()
+    {
+        for (auto &c : s_)
+            c = tolower((unsigned char)c);
+    }
+    void toUpperCase()
+    {
+        for (auto &c : s_)
+            c = toupper((unsigned char)c);
+    }
+    void trim()
+    {
+        size_t b = s_.find_first_not_of(" \t\r\n");
+        size_t e = s_.find_last_not_of(" \t\r\n");
+        s_ = b == std::string::npos ? std::string() : s_.substr(b, e - b + 1);
+    }
+    long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s_.c_str(), nullptr); }
+    double toDouble() const { return strtod(s_.c_str(), nullptr); }
+    void getBytes(unsigned char *buf, unsigned int size, unsigned int index = 0) const
+    {
+        toCharArray((char *)buf, size, index);
+    }
+    void toCharArray(char *buf, unsigned int size, unsigned int index = 0) const
+    {
+        if (!size)
+            return;
+        size_t n = index < s_.size() ? std::min<size_t>(size - 1, s_.size() - index) : 0;
+        memcpy(buf, s_.data() + index, n);
+        buf[n] = 0;
+    }
+
+private:
+    std::string s_;
+
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    static std::string num(unsigned long v, unsigned char base)
+    {
+        if (base < 2 || base > 16)
+            base = 10;
+        char buf[8 * sizeof(v) + 1];
+        char *p = buf + sizeof(buf) - 1;
+        *p = 0;
+        do
+        {
+            *--p = "0123456789abcdef"[v % base];
+            v /= base;
+        } while (v);
+        return p;
+    }
+    static std::string fixed(double v, unsigned int decimals)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        return buf;
+    }
+};
+
+inline String operator+(const String &a, const String &b)
+{
+    String r(a);
+    r.concat(b);
+    return r;
+}
+inline String operator+(const String &a, const char *b)
+{
+    String r(a);
+    r.concat(b);
+    return r;
+}
+inline String operator+(const char *a, const String &b)
+{
+    String r(a);
+    r.concat(b);
+    return r;
+}
+inline String operator+(const String &a, char b)
+{
+    String r(a);
+    r.concat(b);
+    return r;
+}
+inline String operator+(const String &a, int b) { return a + String(b); }
+inline String operator+(const String &a, unsigned int b) { return a + String(b); }
+inline String operator+(const String &a, long b) { return a + String(b); }
+inline String operator+(const String &a, unsigned long b) { return a + String(b); }
+inline String operator+(const String &a, float b) { return a + String(b); }
+inline String operator+(const String &a, double b) { return a + String(b); }
+
+// Serial output is dropped unless the harness runs with --verbose
+class HardwareSerial
+{
+public:
+    bool enabled = false;
+
+    void begin(unsigned long) {}
+    int available() { return 0; }
+    int read() { return -1; }
+
+    size_t write(uint8_t c)
+    {
+        if (enabled)
+            fputc(c, stderr);
+        return 1;
+    }
+    size_t print(const String &s)
+    {
+        if (enabled)
+            fputs(s.c_str(), stderr);
+        return s.length();
+    }
+    size_t print(const char *s) { return print(String(s)); }
+    template <typename T>
+    size_t print(T v) { return print(String(v)); }
+    size_t println() { return print("\n"); }
+    template <typename T>
+    size_t println(T v) { return print(v) + println(); }
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        if (!enabled)
+            return 0;
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vfprintf(stderr, fmt, ap);
+        va_end(ap);
+        return n < 0 ? 0 : n;
+    }
+};
+
+extern HardwareSerial Serial;
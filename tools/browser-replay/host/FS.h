@@ -0,0 +1,86 @@
+#pragma once
+
+// Host stand-in for the ESP32 FS layer: an in-memory tree, so replays never touch the host disk.
+// File::name() is the full path, which is what the browser code expects.
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace fs
+{
+    struct Node
+    {
+        bool dir = false;
+        std::vector<uint8_t> data;
+    };
+
+    class FS;
+
+    class File
+    {
+    public:
+        File() {}
+        File(FS *fs, const String &path, std::shared_ptr<Node> node, bool append)
+            : fs_(fs), path_(path), node_(node), pos_(append ? node->data.size() : 0) {}
+
+        explicit operator bool() const { return (bool)node_; }
+        const char *name() const { return path_.c_str(); }
+        const char *path() const { return path_.c_str(); }
+        bool isDirectory() const { return node_ && node_->dir; }
+        size_t size() const { return node_ ? node_->data.size() : 0; }
+        size_t position() const { return pos_; }
+        int available() const { return node_ ? (int)(node_->data.size() - pos_) : 0; }
+        bool seek(size_t pos)
+        {
+            if (!node_ || pos > node_->data.size())
+                return false;
+            pos_ = pos;
+            return true;
+        }
+
+        size_t write(const uint8_t *buf, size_t len);
+        size_t write(uint8_t c) { return write(&c, 1); }
+        size_t print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+        size_t read(uint8_t *buf, size_t len);
+        int read()
+        {
+            uint8_t c;
+            return read(&c, 1) == 1 ? c : -1;
+        }
+        size_t readBytes(char *buf, size_t len) { return read((uint8_t *)buf, len); }
+        String readString();
+        File openNextFile();
+        void close() { node_.reset(); }
+
+    private:
+        FS *fs_ = nullptr;
+        String path_;
+        std::shared_ptr<Node> node_;
+        size_t pos_ = 0;
+        std::vector<String> listing_; // directory entries, filled on the first openNextFile()
+        size_t next_ = 0;
+        bool listed_ = false;
+    };
+
+    class FS
+    {
+    public:
+        bool begin(bool = false) { return true; }
+        File open(const String &path, const char *mode = "r");
+        bool exists(const String &path) const { return nodes_.count(path) != 0; }
+        bool mkdir(const String &path);
+        bool remove(const String &path);
+        bool rmdir(const String &path) { return remove(path); }
+
+        // Paths directly below dir, in name order
+        std::vector<String> list(const String &dir) const;
+
+    private:
+        std::map<String, std::shared_ptr<Node>> nodes_;
+    };
+}
+
+using fs::File;
+using fs::FS;
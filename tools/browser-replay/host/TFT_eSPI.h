@@ -0,0 +1,170 @@
+#pragma once
+
+// Host stand-in for TFT_eSPI: the panel is a 16-bit framebuffer.
+//
+// Viewports, clipping, the swapped byte order of readRect/pushRect/sprite buffers and the 6x8 text
+// cell of font 1 follow the library, so code that works here behaves the same on the panel.
+// Glyph shapes are made up (one fixed 5x7 pattern per character), good enough for golden frames.
+// Every object counts the calls that reached it and the pixels it wrote.
+
+#include <Arduino.h>
+#include <vector>
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_MAROON 0x7800
+#define TFT_DARKGREY 0x7BEF
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+class TFT_eSPI
+{
+public:
+    TFT_eSPI(int16_t w = 320, int16_t h = 240);
+    virtual ~TFT_eSPI() {}
+
+    void init() {}
+    void begin() {}
+    void setRotation(uint8_t) {}
+    void startWrite() {}
+    void endWrite() {}
+
+    int16_t width() const { return _vpDatum ? _xWidth : _width; }
+    int16_t height() const { return _vpDatum ? _yHeight : _height; }
+
+    void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum = true);
+    void resetViewport() { setViewport(0, 0, _width, _height, false); }
+    int32_t getViewportX() const { return _xDatum; }
+    int32_t getViewportY() const { return _yDatum; }
+    int32_t getViewportWidth() const { return _xWidth; }
+    int32_t getViewportHeight() const { return _yHeight; }
+    bool getViewportDatum() const { return _vpDatum; }
+
+    void setSwapBytes(bool swap) { _swapBytes = swap; }
+    bool getSwapBytes() const { return _swapBytes; }
+
+    void fillScreen(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+    void drawPixel(int32_t x, int32_t y, uint32_t color);
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fillRect(x, y, w, 1, color); }
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { fillRect(x, y, 1, h, color); }
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+    void drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+    void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+
+    // Pixels in the transfer byte order whatever setSwapBytes() says, so the two round-trip
+    void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data);
+    void pushRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data);
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+    uint16_t readPixel(int32_t x, int32_t y);
+
+    void setTextColor(uint16_t fg) { setTextColor(fg, fg); }
+    void setTextColor(uint16_t fg, uint16_t bg)
+    {
+        _textFg = fg;
+        _textBg = bg;
+    }
+    void setTextSize(uint8_t s) { _textSize = s ? s : 1; }
+    void setTextDatum(uint8_t d) { _textDatum = d; }
+    void setTextWrap(bool wrapX, bool = false) { _textWrap = wrapX; }
+    void setCursor(int16_t x, int16_t y)
+    {
+        _cursorX = x;
+        _cursorY = y;
+    }
+    int16_t getCursorX() const { return _cursorX; }
+    int16_t getCursorY() const { return _cursorY; }
+    int16_t textWidth(const String &s) const { return s.length() * 6 * _textSize; }
+    int16_t fontHeight() const { return 8 * _textSize; }
+    int16_t drawString(const String &s, int32_t x, int32_t y);
+    size_t print(const String &s);
+    size_t print(const char *s) { return print(String(s)); }
+    template <typename T>
+    size_t print(T v) { return print(String(v)); }
+    template <typename T>
+    size_t println(T v) { return print(v) + print("\n"); }
+
+    static uint16_t color565(uint8_t r, uint8_t g, uint8_t b) { return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3); }
+    static uint16_t alphaBlend(uint8_t alpha, uint16_t fg, uint16_t bg);
+
+    // Raw framebuffer, native byte order, row major
+    const uint16_t *frameBuffer() const { return _fb.data(); }
+
+    struct Stats
+    {
+        uint64_t calls = 0;  // drawing calls that reached this target
+        uint64_t pixels = 0; // pixels written after clipping
+    };
+    Stats stats;
+
+protected:
+    int32_t _width, _height;
+    std::vector<uint16_t> _fb; // native order for the panel, swapped for sprites
+
+    int32_t _xDatum = 0, _yDatum = 0, _xWidth, _yHeight;
+    int32_t _vpX = 0, _vpY = 0, _vpW, _vpH; // clip rect, right/bottom exclusive
+    bool _vpDatum = false;
+    bool _vpOoB = false;
+    bool _swapBytes = false;
+
+    uint16_t _textFg = TFT_WHITE, _textBg = TFT_WHITE;
+    uint8_t _textSize = 1;
+    uint8_t _textDatum = TL_DATUM;
+    bool _textWrap = true;
+    int32_t _cursorX = 0, _cursorY = 0;
+
+    void resize(int32_t w, int32_t h);
+    // Screen coordinates, already clipped
+    void span(int32_t x, int32_t y, int32_t w, uint16_t color);
+    virtual uint16_t toStored(uint16_t color) const { return color; }
+    virtual uint16_t fromStored(uint16_t stored) const { return stored; }
+
+    // Clip (x, y, w, h) given in datum coordinates; false if nothing is left
+    bool clip(int32_t &x, int32_t &y, int32_t &w, int32_t &h, int32_t *dx = nullptr, int32_t *dy = nullptr) const;
+    void pixel(int32_t x, int32_t y, uint16_t color);
+    void circleQuadrants(int32_t x, int32_t y, int32_t r, uint8_t corners, int32_t delta, uint16_t color);
+    void drawChar(int32_t x, int32_t y, char c);
+};
+
+class TFT_eSprite : public TFT_eSPI
+{
+public:
+    explicit TFT_eSprite(TFT_eSPI *tft) : TFT_eSPI(0, 0), _tft(tft) {}
+
+    void setColorDepth(int8_t bpp) { _bpp = bpp; }
+    int8_t getColorDepth() const { return _bpp; }
+    void *createSprite(int16_t w, int16_t h);
+    void deleteSprite() { resize(0, 0); }
+    bool created() const { return !_fb.empty(); }
+    void fillSprite(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+    void *getPointer() { return _fb.empty() ? nullptr : _fb.data(); }
+    void pushSprite(int32_t x, int32_t y);
+
+protected:
+    TFT_eSPI *_tft;
+    int8_t _bpp = 16; // storage stays 16-bit, only reported back
+
+    uint16_t toStored(uint16_t color) const override { return (color >> 8) | (color << 8); }
+    uint16_t fromStored(uint16_t stored) const override { return (stored >> 8) | (stored << 8); }
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+// Host stand-in for links2004/WebSockets: nothing is connected, sent messages are only counted.
+
+#include <Arduino.h>
+#include <functional>
+
+typedef enum
+{
+    WStype_ERROR,
+    WStype_DISCONNECTED,
+    WStype_CONNECTED,
+    WStype_TEXT,
+    WStype_BIN,
+    WStype_FRAGMENT_TEXT_START,
+    WStype_FRAGMENT_BIN_START,
+    WStype_FRAGMENT,
+    WStype_FRAGMENT_FIN,
+    WStype_PING,
+    WStype_PONG,
+} WStype_t;
+
+class WebSocketsClient
+{
+public:
+    typedef std::function<void(WStype_t type, uint8_t *payload, size_t length)> WebSocketClientEvent;
+
+    void begin(const char *, uint16_t, const char * = "/") {}
+    void beginSSL(const char *, uint16_t, const char * = "/") {}
+    void setReconnectInterval(unsigned long) {}
+    void onEvent(WebSocketClientEvent cb) { event = cb; }
+    void loop() {}
+    void disconnect() {}
+    bool isConnected() { return false; }
+
+    bool sendTXT(const String &payload) { return sendTXT(payload.c_str(), payload.length()); }
+    bool sendTXT(const char *, size_t length)
+    {
+        sentMessages++;
+        sentBytes += length;
+        return true;
+    }
+    bool sendBIN(const uint8_t *, size_t length)
+    {
+        sentMessages++;
+        sentBytes += length;
+        return true;
+    }
+
+    WebSocketClientEvent event;
+    uint32_t sentMessages = 0;
+    uint64_t sentBytes = 0;
+};
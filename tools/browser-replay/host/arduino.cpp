@@ -0,0 +1,38 @@
+#include <Arduino.h>
+
+#include <chrono>
+#include <random>
+
+HardwareSerial Serial;
+
+static const auto g_boot = std::chrono::steady_clock::now();
+static std::mt19937 g_rng(1); // fixed seed, replays are deterministic
+
+unsigned long millis()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - g_boot).count();
+}
+
+unsigned long micros()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_boot).count();
+}
+
+// replays run as fast as possible
+void delay(unsigned long) {}
+void yield() {}
+
+long random(long max)
+{
+    return max > 0 ? (long)(g_rng() % (unsigned long)max) : 0;
+}
+
+long random(long min, long max)
+{
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed)
+{
+    g_rng.seed(seed);
+}
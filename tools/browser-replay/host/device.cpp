@@ -0,0 +1,35 @@
+#include "screen/index.hpp"
+#include "io/read-string.hpp"
+#include "utils/time.hpp"
+
+namespace Screen
+{
+    TFT_eSPI tft(320, 240);
+
+    bool isTouched() { return false; }
+
+    TouchPos getTouchPos()
+    {
+        TouchPos p{};
+        p.x = -1;
+        p.y = -1;
+        return p;
+    }
+}
+
+String readString(const String &, const String &defaultValue)
+{
+    return defaultValue;
+}
+
+namespace UserTime
+{
+    int isConfigured = 0;
+
+    void set(int) {}
+
+    tm get()
+    {
+        return tm{};
+    }
+}
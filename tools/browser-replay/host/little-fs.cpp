@@ -0,0 +1,100 @@
+#include <LittleFS.h>
+
+fs::FS LittleFS;
+
+namespace fs
+{
+    size_t File::write(const uint8_t *buf, size_t len)
+    {
+        if (!node_ || node_->dir)
+            return 0;
+        if (node_->data.size() < pos_ + len)
+            node_->data.resize(pos_ + len);
+        memcpy(node_->data.data() + pos_, buf, len);
+        pos_ += len;
+        return len;
+    }
+
+    size_t File::read(uint8_t *buf, size_t len)
+    {
+        if (!node_ || node_->dir)
+            return 0;
+        len = std::min(len, node_->data.size() - pos_);
+        memcpy(buf, node_->data.data() + pos_, len);
+        pos_ += len;
+        return len;
+    }
+
+    String File::readString()
+    {
+        String s;
+        if (node_ && !node_->dir)
+        {
+            s.concat((const char *)node_->data.data() + pos_, node_->data.size() - pos_);
+            pos_ = node_->data.size();
+        }
+        return s;
+    }
+
+    File File::openNextFile()
+    {
+        if (!node_ || !node_->dir)
+            return File();
+        if (!listed_)
+        {
+            listing_ = fs_->list(path_);
+            listed_ = true;
+        }
+        while (next_ < listing_.size())
+        {
+            File f = fs_->open(listing_[next_++], "r");
+            if (f)
+                return f;
+        }
+        return File();
+    }
+
+    File FS::open(const String &path, const char *mode)
+    {
+        auto it = nodes_.find(path);
+        if (mode[0] == 'r')
+            return it == nodes_.end() ? File() : File(this, path, it->second, false);
+
+        int slash = path.lastIndexOf('/');
+        if (slash > 0 && !exists(path.substring(0, slash)))
+            return File();
+        if (it != nodes_.end() && it->second->dir)
+            return File();
+        if (it == nodes_.end())
+            it = nodes_.emplace(path, std::make_shared<Node>()).first;
+        else if (mode[0] == 'w')
+            it->second->data.clear();
+        return File(this, path, it->second, mode[0] == 'a');
+    }
+
+    bool FS::mkdir(const String &path)
+    {
+        auto it = nodes_.find(path);
+        if (it != nodes_.end())
+            return it->second->dir;
+        auto node = std::make_shared<Node>();
+        node->dir = true;
+        nodes_.emplace(path, node);
+        return true;
+    }
+
+    bool FS::remove(const String &path)
+    {
+        return nodes_.erase(path) != 0;
+    }
+
+    std::vector<String> FS::list(const String &dir) const
+    {
+        std::vector<String> out;
+        String prefix = dir.endsWith("/") ? dir : dir + "/";
+        for (auto it = nodes_.lower_bound(prefix); it != nodes_.end() && it->first.startsWith(prefix); ++it)
+            if (it->first.indexOf('/', prefix.length()) < 0)
+                out.push_back(it->first);
+        return out;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+// Host stand-in for the tinfl part of the ESP32 ROM miniz, on top of zlib.
+// Only the streaming mode ZStream uses: TINFL_FLAG_HAS_MORE_INPUT, raw deflate, output into a
+// caller owned ring. zlib keeps its own history window, so the ring is only written, never read.
+
+#include <zlib.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+typedef enum
+{
+    TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+enum
+{
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+struct tinfl_decompressor
+{
+    uint8_t opaque[16];
+};
+
+// The zlib state lives beside the decompressor, keyed by its address: ZStream frees the struct
+// without telling us, and a later malloc() may hand out the same address again.
+inline z_stream *tinfl_host_stream(const tinfl_decompressor *r)
+{
+    static std::map<const tinfl_decompressor *, std::unique_ptr<z_stream>> streams;
+    std::unique_ptr<z_stream> &z = streams[r];
+    if (!z)
+    {
+        z.reset(new z_stream());
+        if (inflateInit2(z.get(), -15) != Z_OK)
+            return nullptr;
+    }
+    return z.get();
+}
+
+inline void tinfl_init(tinfl_decompressor *r)
+{
+    if (z_stream *z = tinfl_host_stream(r))
+        inflateReset(z);
+}
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor *r, const uint8_t *in, size_t *inSize,
+                                     uint8_t *, uint8_t *out, size_t *outSize, uint32_t)
+{
+    z_stream *z = tinfl_host_stream(r);
+    if (!z)
+        return TINFL_STATUS_BAD_PARAM;
+    const size_t inAvail = *inSize, outAvail = *outSize;
+    z->next_in = (Bytef *)in;
+    z->avail_in = (uInt)inAvail;
+    z->next_out = out;
+    z->avail_out = (uInt)outAvail;
+    int rc = inflate(z, Z_SYNC_FLUSH);
+    *inSize = inAvail - z->avail_in;
+    *outSize = outAvail - z->avail_out;
+    if (rc == Z_STREAM_END)
+        return TINFL_STATUS_DONE;
+    if (rc != Z_OK && rc != Z_BUF_ERROR)
+        return TINFL_STATUS_FAILED;
+    if (z->avail_out == 0)
+        return TINFL_STATUS_HAS_MORE_OUTPUT;
+    return TINFL_STATUS_NEEDS_MORE_INPUT;
+}
@@ -0,0 +1,435 @@
+#include <TFT_eSPI.h>
+
+static inline uint16_t swap16(uint16_t v) { return (v >> 8) | (v << 8); }
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h)
+{
+    resize(w, h);
+}
+
+void TFT_eSPI::resize(int32_t w, int32_t h)
+{
+    _width = w;
+    _height = h;
+    _fb.assign((size_t)w * h, toStored(TFT_BLACK));
+    if (_fb.empty())
+        _fb.shrink_to_fit();
+    resetViewport();
+}
+
+void TFT_eSPI::setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum)
+{
+    // same bookkeeping as the library: the datum metrics stay unclipped
+    _xDatum = x;
+    _yDatum = y;
+    _xWidth = w;
+    _yHeight = h;
+
+    _vpDatum = false;
+    _vpOoB = false;
+    _vpX = 0;
+    _vpY = 0;
+    _vpW = _width;
+    _vpH = _height;
+
+    if (x < 0)
+    {
+        w += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        h += y;
+        y = 0;
+    }
+    if (x + w > _width)
+        w = _width - x;
+    if (y + h > _height)
+        h = _height - y;
+
+    if (w < 1 || h < 1)
+    {
+        _xDatum = 0;
+        _yDatum = 0;
+        _xWidth = _width;
+        _yHeight = _height;
+        _vpOoB = true;
+        return;
+    }
+
+    if (!vpDatum)
+    {
+        _xDatum = 0;
+        _yDatum = 0;
+        _xWidth = _width;
+        _yHeight = _height;
+    }
+
+    _vpX = x;
+    _vpY = y;
+    _vpW = x + w;
+    _vpH = y + h;
+    _vpDatum = vpDatum;
+}
+
+bool TFT_eSPI::clip(int32_t &x, int32_t &y, int32_t &w, int32_t &h, int32_t *dx, int32_t *dy) const
+{
+    if (_vpOoB)
+        return false;
+    x += _xDatum;
+    y += _yDatum;
+    int32_t x0 = std::max(x, _vpX), y0 = std::max(y, _vpY);
+    int32_t x1 = std::min(x + w, _vpW), y1 = std::min(y + h, _vpH);
+    if (x1 <= x0 || y1 <= y0)
+        return false;
+    if (dx)
+        *dx = x0 - x;
+    if (dy)
+        *dy = y0 - y;
+    x = x0;
+    y = y0;
+    w = x1 - x0;
+    h = y1 - y0;
+    return true;
+}
+
+void TFT_eSPI::span(int32_t x, int32_t y, int32_t w, uint16_t color)
+{
+    uint16_t stored = toStored(color);
+    std::fill_n(_fb.begin() + (size_t)y * _width + x, w, stored);
+    stats.pixels += w;
+}
+
+void TFT_eSPI::pixel(int32_t x, int32_t y, uint16_t color)
+{
+    int32_t w = 1, h = 1;
+    if (clip(x, y, w, h))
+        span(x, y, 1, color);
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color)
+{
+    stats.calls++;
+    pixel(x, y, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    stats.calls++;
+    if (!clip(x, y, w, h))
+        return;
+    for (int32_t row = 0; row < h; row++)
+        span(x, y + row, w, color);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+    stats.calls++;
+    int32_t dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int32_t dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    while (true)
+    {
+        pixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1)
+            break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color)
+{
+    stats.calls++;
+    int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+    pixel(x0, y0 + r, color);
+    pixel(x0, y0 - r, color);
+    pixel(x0 + r, y0, color);
+    pixel(x0 - r, y0, color);
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddy += 2;
+            f += ddy;
+        }
+        x++;
+        ddx += 2;
+        f += ddx;
+        pixel(x0 + x, y0 + y, color);
+        pixel(x0 - x, y0 + y, color);
+        pixel(x0 + x, y0 - y, color);
+        pixel(x0 - x, y0 - y, color);
+        pixel(x0 + y, y0 + x, color);
+        pixel(x0 - y, y0 + x, color);
+        pixel(x0 + y, y0 - x, color);
+        pixel(x0 - y, y0 - x, color);
+    }
+}
+
+// Filled circle halves (corners bit 0: right, bit 1: left), stretched by delta rows
+void TFT_eSPI::circleQuadrants(int32_t x0, int32_t y0, int32_t r, uint8_t corners, int32_t delta, uint16_t color)
+{
+    int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddy += 2;
+            f += ddy;
+        }
+        x++;
+        ddx += 2;
+        f += ddx;
+        for (int32_t side = 0; side < 2; side++)
+        {
+            if (!(corners & (1 << side)))
+                continue;
+            int32_t sx = side ? -1 : 1;
+            int32_t cx = x0 + sx * x, cy = y0 - y, ch = 2 * y + 1 + delta;
+            int32_t w = 1;
+            if (clip(cx, cy, w, ch))
+                for (int32_t i = 0; i < ch; i++)
+                    span(cx, cy + i, 1, color);
+            cx = x0 + sx * y;
+            cy = y0 - x;
+            ch = 2 * x + 1 + delta;
+            w = 1;
+            if (clip(cx, cy, w, ch))
+                for (int32_t i = 0; i < ch; i++)
+                    span(cx, cy + i, 1, color);
+        }
+    }
+}
+
+void TFT_eSPI::fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color)
+{
+    stats.calls++;
+    int32_t cx = x, cy = y - r, w = 1, h = 2 * r + 1;
+    if (clip(cx, cy, w, h))
+        for (int32_t i = 0; i < h; i++)
+            span(cx, cy + i, 1, color);
+    circleQuadrants(x, y, r, 3, 0, color);
+}
+
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color)
+{
+    // the corners are drawn as full circle outlines clipped to their quadrant
+    r = std::min(r, std::min(w, h) / 2);
+    drawFastHLine(x + r, y, w - 2 * r, color);
+    drawFastHLine(x + r, y + h - 1, w - 2 * r, color);
+    drawFastVLine(x, y + r, h - 2 * r, color);
+    drawFastVLine(x + w - 1, y + r, h - 2 * r, color);
+    int32_t f = 1 - r, ddx = 1, ddy = -2 * r, px = 0, py = r;
+    while (px < py)
+    {
+        if (f >= 0)
+        {
+            py--;
+            ddy += 2;
+            f += ddy;
+        }
+        px++;
+        ddx += 2;
+        f += ddx;
+        const int32_t cxl = x + r, cxr = x + w - r - 1, cyt = y + r, cyb = y + h - r - 1;
+        pixel(cxr + px, cyb + py, color);
+        pixel(cxr + py, cyb + px, color);
+        pixel(cxl - px, cyb + py, color);
+        pixel(cxl - py, cyb + px, color);
+        pixel(cxr + px, cyt - py, color);
+        pixel(cxr + py, cyt - px, color);
+        pixel(cxl - px, cyt - py, color);
+        pixel(cxl - py, cyt - px, color);
+    }
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color)
+{
+    stats.calls++;
+    r = std::min(r, std::min(w, h) / 2);
+    int32_t cx = x + r, cy = y, cw = w - 2 * r, ch = h;
+    if (clip(cx, cy, cw, ch))
+        for (int32_t i = 0; i < ch; i++)
+            span(cx, cy + i, cw, color);
+    circleQuadrants(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+    circleQuadrants(x + r, y + r, r, 2, h - 2 * r - 1, color);
+}
+
+void TFT_eSPI::readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
+{
+    stats.calls++;
+    const int32_t stride = w;
+    int32_t dx = 0, dy = 0;
+    if (!clip(x, y, w, h, &dx, &dy))
+        return;
+    data += dy * stride + dx;
+    for (int32_t row = 0; row < h; row++, data += stride)
+    {
+        const uint16_t *src = &_fb[(size_t)(y + row) * _width + x];
+        for (int32_t i = 0; i < w; i++)
+        {
+            uint16_t c = fromStored(src[i]);
+            data[i] = swap16(c);
+        }
+    }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data)
+{
+    stats.calls++;
+    const int32_t stride = w;
+    int32_t dx = 0, dy = 0;
+    if (!clip(x, y, w, h, &dx, &dy))
+        return;
+    data += dy * stride + dx;
+    for (int32_t row = 0; row < h; row++, data += stride)
+    {
+        uint16_t *dst = &_fb[(size_t)(y + row) * _width + x];
+        for (int32_t i = 0; i < w; i++)
+            dst[i] = toStored(_swapBytes ? data[i] : swap16(data[i]));
+        stats.pixels += w;
+    }
+}
+
+void TFT_eSPI::pushRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
+{
+    bool swap = _swapBytes;
+    _swapBytes = false;
+    pushImage(x, y, w, h, data);
+    _swapBytes = swap;
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y)
+{
+    int32_t w = 1, h = 1;
+    if (!clip(x, y, w, h))
+        return 0;
+    return fromStored(_fb[(size_t)y * _width + x]);
+}
+
+uint16_t TFT_eSPI::alphaBlend(uint8_t alpha, uint16_t fg, uint16_t bg)
+{
+    uint16_t a = alpha + 1;
+    uint16_t r = (((fg >> 11) * a) + ((bg >> 11) * (256 - a))) >> 8;
+    uint16_t g = ((((fg >> 5) & 0x3F) * a) + (((bg >> 5) & 0x3F) * (256 - a))) >> 8;
+    uint16_t b = (((fg & 0x1F) * a) + ((bg & 0x1F) * (256 - a))) >> 8;
+    return (r << 11) | (g << 5) | b;
+}
+
+// 5x7 glyph, one bit per pixel, column major; stable per character
+static uint64_t glyphBits(char c)
+{
+    if (c == ' ')
+        return 0;
+    uint64_t z = (uint8_t)c * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (z ^ (z >> 31)) | 1; // never blank
+}
+
+void TFT_eSPI::drawChar(int32_t x, int32_t y, char c)
+{
+    const int32_t s = _textSize;
+    const bool opaque = _textFg != _textBg;
+    uint64_t bits = glyphBits(c);
+    for (int32_t col = 0; col < 6; col++)
+    {
+        for (int32_t row = 0; row < 8; row++)
+        {
+            bool on = col < 5 && row < 7 && ((bits >> (col * 7 + row)) & 1);
+            if (!on && !opaque)
+                continue;
+            int32_t px = x + col * s, py = y + row * s, w = s, h = s;
+            if (clip(px, py, w, h))
+                for (int32_t i = 0; i < h; i++)
+                    span(px, py + i, w, on ? _textFg : _textBg);
+        }
+    }
+}
+
+size_t TFT_eSPI::print(const String &s)
+{
+    stats.calls++;
+    const int32_t cw = 6 * _textSize, ch = 8 * _textSize;
+    for (unsigned int i = 0; i < s.length(); i++)
+    {
+        char c = s[i];
+        if (c == '\n')
+        {
+            _cursorX = 0;
+            _cursorY += ch;
+            continue;
+        }
+        if (c == '\r')
+            continue;
+        if (_textWrap && _cursorX + cw > width())
+        {
+            _cursorX = 0;
+            _cursorY += ch;
+        }
+        drawChar(_cursorX, _cursorY, c);
+        _cursorX += cw;
+    }
+    return s.length();
+}
+
+int16_t TFT_eSPI::drawString(const String &s, int32_t x, int32_t y)
+{
+    int32_t w = textWidth(s), h = fontHeight();
+    switch (_textDatum)
+    {
+    case TC_DATUM: case MC_DATUM: case BC_DATUM: x -= w / 2; break;
+    case TR_DATUM: case MR_DATUM: case BR_DATUM: x -= w; break;
+    }
+    switch (_textDatum)
+    {
+    case ML_DATUM: case MC_DATUM: case MR_DATUM: y -= h / 2; break;
+    case BL_DATUM: case BC_DATUM: case BR_DATUM: y -= h; break;
+    }
+    int32_t cx = _cursorX, cy = _cursorY;
+    bool wrap = _textWrap;
+    _textWrap = false;
+    setCursor(x, y);
+    print(s);
+    _textWrap = wrap;
+    setCursor(cx, cy);
+    return w;
+}
+
+void *TFT_eSprite::createSprite(int16_t w, int16_t h)
+{
+    if (w < 1 || h < 1)
+        return nullptr;
+    resize(w, h);
+    return _fb.data();
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y)
+{
+    if (_fb.empty())
+        return;
+    bool swap = _tft->getSwapBytes();
+    _tft->setSwapBytes(false);
+    _tft->pushImage(x, y, _width, _height, _fb.data());
+    _tft->setSwapBytes(swap);
+}
@@ -0,0 +1,493 @@
+// Host replay of recorded MWOSP sessions through the real browser code (src/sys-apps/browser*.cpp,
+// src/screen/svg.cpp) against a framebuffer panel and in-memory storage.
+//
+//   tools/browser-replay/build.sh
+//   tools/browser-replay/_build/browser-replay [options] session.mwr...
+//   tools/browser-replay/_build/browser-replay --icons [--repeat N] [--golden DIR [--update]]
+//
+//   --golden DIR   compare every composed frame and the final screen with DIR/<session>-<n>.ppm
+//                  (default for sessions: golden/ next to the session file, where frames that
+//                  have no golden copy yet are reported but do not fail the run)
+//   --update       write the golden frames instead of comparing them
+//   --no-golden    timings only, skip the comparison
+//   --repeat N     replay every session N times; timings are the best run, golden checks the first
+//   --verbose      show the browser's Serial output
+//   --icons        benchmark drawSVGString over the built-in SVG:: icons instead of replaying
+//
+// Sessions come from the device (-DBROWSER_RECORD_PATH) or from the test server
+// (MWOSP_RECORD=<dir> node browser-server/1/index.js); both write, per server message,
+// u8 'T' | 'B', u32 LE length, payload. sessions/ holds the demo page in v1, v2 and v2 + z, and the
+// scrolling list (MWOSP_DEMO=list, recorded with browser-server/1/record.js), which spans
+// several frames, scrolls both ways and redefines an asset that is already on screen.
+//
+// As a gate for a protocol or renderer change: write the golden frames with --update before the
+// change, then replay after it. Golden frames depend on the rasterizer, so record them from a
+// build against the PlatformIO nanosvg, not a stand-in. Exit code 1 if a session cannot be read,
+// a golden frame named by --golden is missing or a frame differs from its golden copy (the
+// differing screen is written next to it as *.actual.ppm).
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <vector>
+
+#include "sys-apps/browser.hpp"
+#include "sys-apps/browser-frame.hpp"
+#include "sys-apps/browser-assets.hpp"
+#include "icons/index.hpp"
+#include "screen/icon-cache.hpp"
+
+// ---------------------------
+// Allocation counting
+// ---------------------------
+// operator new and the C allocator as called from the browser, svg and nanosvg objects
+// (linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc)
+static uint64_t g_allocs = 0;
+static uint64_t g_allocBytes = 0;
+
+extern "C"
+{
+    void *__real_malloc(size_t n);
+    void *__real_calloc(size_t n, size_t size);
+    void *__real_realloc(void *p, size_t n);
+
+    void *__wrap_malloc(size_t n)
+    {
+        g_allocs++;
+        g_allocBytes += n;
+        return __real_malloc(n);
+    }
+
+    void *__wrap_calloc(size_t n, size_t size)
+    {
+        g_allocs++;
+        g_allocBytes += n * size;
+        return __real_calloc(n, size);
+    }
+
+    void *__wrap_realloc(void *p, size_t n)
+    {
+        g_allocs++;
+        g_allocBytes += n;
+        return __real_realloc(p, n);
+    }
+}
+
+void *operator new(size_t n)
+{
+    g_allocs++;
+    g_allocBytes += n;
+    if (void *p = __real_malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+// ---------------------------
+// Golden frames (binary PPM, 565 expanded to 888 so it converts back exactly)
+// ---------------------------
+static bool writePPM(const String &path, const uint16_t *fb, int w, int h)
+{
+    std::ofstream f(path.c_str(), std::ios::binary);
+    if (!f)
+        return false;
+    f << "P6\n" << w << " " << h << "\n255\n";
+    std::vector<uint8_t> row(w * 3);
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            uint16_t c = fb[y * w + x];
+            uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+            row[x * 3 + 0] = (r << 3) | (r >> 2);
+            row[x * 3 + 1] = (g << 2) | (g >> 4);
+            row[x * 3 + 2] = (b << 3) | (b >> 2);
+        }
+        f.write((const char *)row.data(), row.size());
+    }
+    return (bool)f;
+}
+
+static bool readPPM(const String &path, std::vector<uint16_t> &out, int w, int h)
+{
+    std::ifstream f(path.c_str(), std::ios::binary);
+    std::string magic;
+    int fw = 0, fh = 0, maxval = 0;
+    if (!(f >> magic >> fw >> fh >> maxval) || magic != "P6" || fw != w || fh != h || maxval != 255)
+        return false;
+    f.get();
+    std::vector<uint8_t> rgb(w * h * 3);
+    if (!f.read((char *)rgb.data(), rgb.size()))
+        return false;
+    out.resize(w * h);
+    for (int i = 0; i < w * h; i++)
+        out[i] = TFT_eSPI::color565(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+    return true;
+}
+
+struct Options
+{
+    String golden;
+    bool noGolden = false;
+    bool update = false;
+    int repeat = 1;
+    bool icons = false;
+};
+
+struct Golden
+{
+    const Options &opt;
+    String dir; // empty: no comparison
+    String base;
+    bool required; // a missing golden frame is a failure
+    int checked = 0;
+    int failed = 0;
+    int missing = 0;
+
+    // Compare (or write) the current screen as golden frame `name`
+    void check(const String &name)
+    {
+        if (!dir.length())
+            return;
+        const int w = Screen::tft.width(), h = Screen::tft.height();
+        const uint16_t *fb = Screen::tft.frameBuffer();
+        String path = dir + "/" + base + "-" + name + ".ppm";
+        checked++;
+        if (opt.update)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(dir.c_str(), ec);
+            if (!writePPM(path, fb, w, h))
+            {
+                printf("  cannot write %s\n", path.c_str());
+                failed++;
+            }
+            return;
+        }
+
+        std::vector<uint16_t> ref;
+        if (!readPPM(path, ref, w, h))
+        {
+            if (required)
+            {
+                printf("  frame %s: no golden copy %s\n", name.c_str(), path.c_str());
+                failed++;
+            }
+            missing++;
+            return;
+        }
+        int diff = 0, x0 = w, y0 = h, x1 = -1, y1 = -1;
+        for (int y = 0; y < h; y++)
+            for (int x = 0; x < w; x++)
+                if (fb[y * w + x] != ref[y * w + x])
+                {
+                    diff++;
+                    x0 = std::min(x0, x), y0 = std::min(y0, y);
+                    x1 = std::max(x1, x), y1 = std::max(y1, y);
+                }
+        if (!diff)
+            return;
+        failed++;
+        String actual = dir + "/" + base + "-" + name + ".actual.ppm";
+        writePPM(actual, fb, w, h);
+        printf("  frame %s: %d px differ in (%d,%d)-(%d,%d), see %s\n", name.c_str(), diff, x0, y0, x1, y1, actual.c_str());
+    }
+};
+
+// ---------------------------
+// Replay
+// ---------------------------
+struct Message
+{
+    char kind;
+    std::vector<uint8_t> data;
+};
+
+static bool loadSession(const char *path, std::vector<Message> &out)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+        return false;
+    uint8_t head[5];
+    while (f.read((char *)head, sizeof(head)))
+    {
+        size_t len = head[1] | (head[2] << 8) | (head[3] << 16) | ((size_t)head[4] << 24);
+        if (head[0] != 'T' && head[0] != 'B')
+            return false;
+        Message m{(char)head[0], std::vector<uint8_t>(len)};
+        if (len && !f.read((char *)m.data.data(), len))
+            return false;
+        out.push_back(std::move(m));
+    }
+    return f.eof();
+}
+
+struct Run
+{
+    uint64_t us = 0;
+    uint32_t commands = 0;
+    uint64_t pixels = 0;
+    uint64_t calls = 0;
+    uint64_t allocs = 0;
+    uint64_t allocBytes = 0;
+    uint32_t sent = 0;
+    uint32_t slowestUs = 0;
+    size_t slowest = 0;
+    Browser::Frame::Stats frame;
+};
+
+// The page as the device shows it right after connecting
+static void resetBrowser()
+{
+    Browser::OnExit();
+    Browser::loc = Browser::Location();
+    Browser::loc.domain = "replay.local";
+    Browser::isRunning = true;
+    Browser::Frame::resetStats();
+    Screen::tft.fillScreen(TFT_BLACK);
+    Browser::ReRender();
+}
+
+static Run replay(const std::vector<Message> &msgs, Golden *golden)
+{
+    using Clock = std::chrono::steady_clock;
+    resetBrowser();
+
+    Run run;
+    const uint32_t commands0 = Browser::commandCount();
+    const TFT_eSPI::Stats panel0 = Screen::tft.stats;
+    const uint64_t allocs0 = g_allocs, allocBytes0 = g_allocBytes;
+    const uint32_t sent0 = Browser::webSocket.sentMessages;
+    uint32_t frames = 0;
+
+    for (size_t i = 0; i < msgs.size(); i++)
+    {
+        auto t0 = Clock::now();
+        Browser::replayMessage(msgs[i].kind, msgs[i].data.data(), msgs[i].data.size());
+        uint32_t us = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count();
+        run.us += us;
+        if (us > run.slowestUs)
+        {
+            run.slowestUs = us;
+            run.slowest = i;
+        }
+
+        uint32_t f = Browser::Frame::stats().frames;
+        if (golden && f != frames)
+            golden->check(String(f));
+        frames = f;
+    }
+    Browser::Frame::end();
+    if (golden)
+        golden->check("final");
+
+    run.commands = Browser::commandCount() - commands0;
+    run.pixels = Screen::tft.stats.pixels - panel0.pixels;
+    run.calls = Screen::tft.stats.calls - panel0.calls;
+    run.allocs = g_allocs - allocs0;
+    run.allocBytes = g_allocBytes - allocBytes0;
+    run.sent = Browser::webSocket.sentMessages - sent0;
+    run.frame = Browser::Frame::stats();
+    return run;
+}
+
+static String dirName(const char *path)
+{
+    String s(path);
+    int slash = s.lastIndexOf('/');
+    return slash >= 0 ? s.substring(0, slash) : String(".");
+}
+
+static String baseName(const char *path)
+{
+    String s(path);
+    int slash = s.lastIndexOf('/');
+    if (slash >= 0)
+        s = s.substring(slash + 1);
+    int dot = s.lastIndexOf('.');
+    return dot > 0 ? s.substring(0, dot) : s;
+}
+
+// ---------------------------
+// Icon benchmark
+// ---------------------------
+// Every SVG:: icon at the sizes the UI uses: lines the old fixed 4-lines-per-curve stroker drew
+// against the adaptive outline, the first draw (outline built) against cached redraws, and the
+// same through IconCache, where a redraw is one pushRect of the stored bitmap.
+static int benchIcons(const Options &opt)
+{
+    using Clock = std::chrono::steady_clock;
+    struct Icon
+    {
+        const char *name;
+        const String &svg;
+    };
+    const Icon icons[] = {{"settings", SVG::settings}, {"wifi", SVG::wifi}, {"design", SVG::design},
+                          {"folder", SVG::folder}, {"browser", SVG::browser}, {"shutdown", SVG::shutdown},
+                          {"login", SVG::login}, {"signin", SVG::signin}, {"apps", SVG::apps},
+                          {"volume", SVG::volume}, {"brightness", SVG::brightness}, {"back", SVG::back}};
+    const int sizes[] = {20, 28, 48};
+    const int repeat = std::max(opt.repeat, 20);
+
+    Screen::tft.fillScreen(TFT_WHITE);
+    printf("%-11s %4s %8s %8s %9s %9s %6s %9s\n", "icon", "px", "fixed-4", "adaptive", "first us", "cached us", "calls",
+           "bitmap us");
+    uint32_t fixedTotal = 0, adaptiveTotal = 0;
+    double firstTotal = 0, cachedTotal = 0, bitmapTotal = 0;
+    int n = 0;
+    for (const Icon &icon : icons)
+    {
+        NSVGimage *image = createSVG(icon.svg);
+        if (!image)
+        {
+            printf("%-11s cannot parse\n", icon.name);
+            return 1;
+        }
+        uint32_t fixed = 0;
+        for (NSVGshape *shape = image->shapes; shape; shape = shape->next)
+            for (NSVGpath *path = shape->paths; path; path = path->next)
+                fixed += (path->npts - 1) / 3 * 4;
+
+        for (int size : sizes)
+        {
+            const int x = (n % 12) * 26, y = (n / 12) * 50;
+            const uint64_t calls0 = Screen::tft.stats.calls;
+            auto t0 = Clock::now();
+            drawSVGImage(Screen::tft, image, x, y, size, size, TFT_BLACK);
+            double first = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+            const uint64_t calls = Screen::tft.stats.calls - calls0;
+            const uint32_t adaptive = svgStats().segments;
+
+            t0 = Clock::now();
+            for (int r = 0; r < repeat; r++)
+                drawSVGImage(Screen::tft, image, x, y, size, size, TFT_BLACK);
+            double cached = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / repeat;
+
+            IconCache::draw(icon.svg, x, y + 150, size, size, TFT_BLACK, TFT_WHITE);
+            t0 = Clock::now();
+            for (int r = 0; r < repeat; r++)
+                IconCache::draw(icon.svg, x, y + 150, size, size, TFT_BLACK, TFT_WHITE);
+            double bitmap = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / repeat;
+
+            printf("%-11s %4d %8u %8u %9.1f %9.1f %6llu %9.1f\n", icon.name, size, (unsigned)fixed, (unsigned)adaptive,
+                   first, cached, (unsigned long long)calls, bitmap);
+            bitmapTotal += bitmap;
+            fixedTotal += fixed;
+            adaptiveTotal += adaptive;
+            firstTotal += first;
+            cachedTotal += cached;
+            n++;
+        }
+    }
+    printf("%-11s %4s %8u %8u %9.1f %9.1f %6s %9.1f\n", "total", "", (unsigned)fixedTotal, (unsigned)adaptiveTotal,
+           firstTotal, cachedTotal, "", bitmapTotal);
+    const SVGStats st = svgStats();
+    printf("outlines: %u built, %u reused\n", (unsigned)st.outlineMisses, (unsigned)st.outlineHits);
+    printf("parse cache: %u hits, %u misses, %u evictions, %u images, %u bytes, %.1f ms parsing\n", (unsigned)st.hits,
+           (unsigned)st.misses, (unsigned)st.evictions, (unsigned)st.entries, (unsigned)st.bytes, st.parseUs / 1e3);
+    const IconCache::Stats ic = IconCache::stats();
+    printf("icon cache: %u hits, %u misses, %u evictions, %u entries, %u bytes\n", (unsigned)ic.hits,
+           (unsigned)ic.misses, (unsigned)ic.evictions, (unsigned)ic.entries, (unsigned)ic.ramBytes);
+
+    Golden golden{opt, opt.golden, "icons", true};
+    golden.check("sheet");
+    if (opt.golden.length())
+        printf("golden: %s, %d failed\n", opt.update ? "written" : "checked", golden.failed);
+    return golden.failed ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    std::vector<const char *> sessions;
+    for (int i = 1; i < argc; i++)
+    {
+        String a(argv[i]);
+        if (a == "--golden" && i + 1 < argc)
+            opt.golden = argv[++i];
+        else if (a == "--no-golden")
+            opt.noGolden = true;
+        else if (a == "--update")
+            opt.update = true;
+        else if (a == "--repeat" && i + 1 < argc)
+            opt.repeat = std::max(1, atoi(argv[++i]));
+        else if (a == "--verbose")
+            Serial.enabled = true;
+        else if (a == "--icons")
+            opt.icons = true;
+        else if (a.startsWith("--"))
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        else
+            sessions.push_back(argv[i]);
+    }
+    if (opt.icons)
+        return benchIcons(opt);
+    if (sessions.empty())
+    {
+        fprintf(stderr, "usage: browser-replay [--golden DIR] [--update | --no-golden] [--repeat N] [--verbose] session.mwr...\n"
+                        "       browser-replay --icons [--golden DIR [--update]] [--repeat N]\n");
+        return 2;
+    }
+
+    int failures = 0, missing = 0;
+    for (const char *path : sessions)
+    {
+        std::vector<Message> msgs;
+        if (!loadSession(path, msgs))
+        {
+            printf("%s: cannot read session\n", path);
+            failures++;
+            continue;
+        }
+        size_t bytes = 0;
+        for (auto &m : msgs)
+            bytes += m.data.size();
+
+        printf("%s: %zu messages, %zu bytes\n", path, msgs.size(), bytes);
+        String dir = opt.noGolden ? String() : opt.golden.length() ? opt.golden : dirName(path) + "/golden";
+        Golden golden{opt, dir, baseName(path), opt.golden.length() > 0};
+        Run best = replay(msgs, &golden);
+        for (int r = 1; r < opt.repeat; r++)
+        {
+            Run run = replay(msgs, nullptr);
+            if (run.us < best.us)
+                best = run;
+        }
+
+        const double s = best.us ? best.us / 1e6 : 1e-6;
+        const double perCmd = best.commands ? 1.0 / best.commands : 0;
+        const Browser::Frame::Stats &fs = best.frame;
+        printf("  %u commands in %.2f ms: %.0f commands/s, %.1f Mpx/s (%llu px, %llu panel calls)\n",
+               (unsigned)best.commands, best.us / 1e3, best.commands / s, best.pixels / s / 1e6,
+               (unsigned long long)best.pixels, (unsigned long long)best.calls);
+        printf("  %.2f allocations and %.0f bytes per command, %u messages sent back\n",
+               best.allocs * perCmd, best.allocBytes * perCmd, (unsigned)best.sent);
+        printf("  frames=%u avg=%u us bands=%u readbacks=%u direct=%u culled=%u scrolls=%u\n",
+               (unsigned)fs.frames, (unsigned)(fs.frames ? fs.totalUs / fs.frames : 0), (unsigned)fs.bands,
+               (unsigned)fs.readbacks, (unsigned)fs.direct, (unsigned)fs.culled, (unsigned)fs.scrolls);
+        if (!msgs.empty())
+            printf("  slowest message #%zu ('%c', %zu bytes): %u us\n", best.slowest, msgs[best.slowest].kind,
+                   msgs[best.slowest].data.size(), (unsigned)best.slowestUs);
+        if (dir.length())
+            printf("  golden: %d frames %s, %d failed, %d without golden copy\n", golden.checked,
+                   opt.update ? "written" : "checked", golden.failed, golden.missing);
+        failures += golden.failed;
+        missing += golden.missing;
+    }
+    if (missing)
+        printf("%d golden frames missing: record them with --update (against the PlatformIO nanosvg)\n",
+               missing);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// Harness replacement for src/fs/enc-fs.hpp: only what the browser uses, kept in memory.
+
+#include <Arduino.h>
+#include <vector>
+
+namespace ENC_FS
+{
+    using Buffer = std::vector<uint8_t>;
+
+    Buffer sha256(const String &s);
+
+    namespace BrowserStorage
+    {
+        Buffer get(const String &domain);
+        bool del(const String &domain);
+        bool set(const String &domain, const Buffer &data);
+        bool clearAll();
+        std::vector<String> listSites();
+        // content-addressed assets of a site (browser/assets/<domain>/<hash>)
+        Buffer getAsset(const String &domain, const String &hash);
+        bool setAsset(const String &domain, const String &hash, const Buffer &data);
+    }
+} // namespace ENC_FS
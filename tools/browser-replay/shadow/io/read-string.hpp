@@ -0,0 +1,10 @@
+#pragma once
+
+// Harness replacement for src/io/read-string.hpp: prompts answer with their default value.
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+#include "../styles/global.hpp"
+
+String readString(const String &question = "", const String &defaultValue = "");
@@ -0,0 +1,26 @@
+#pragma once
+
+// Harness replacement for src/screen/index.hpp: the panel is a TFT_eSPI framebuffer stub and
+// there is no touch input.
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+#include "../utils/vec.hpp"
+#include "svg.hpp"
+
+namespace Screen
+{
+    extern TFT_eSPI tft;
+
+    struct TouchPos : Vec
+    {
+        bool clicked;
+        Vec move;
+    };
+
+    bool isTouched();
+    TouchPos getTouchPos();
+}
+
+using Screen::tft;
@@ -0,0 +1,13 @@
+#pragma once
+
+// Harness replacement for src/utils/time.hpp
+
+#include <time.h>
+
+namespace UserTime
+{
+    extern int isConfigured;
+
+    void set(int off = 3600);
+    tm get();
+}
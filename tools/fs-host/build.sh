@@ -0,0 +1,41 @@
+#!/bin/sh
+# Builds the host filesystem runner (see main.cpp) into tools/fs-host/_build.
+#
+# src/fs and src/utils/crypto.cpp are compiled unchanged against host stand-ins for FreeRTOS
+# (std::thread), mbedtls (OpenSSL libcrypto) and the ESP-IDF headers. As in browser-replay, a
+# mirror of src/ under _build/tree links the sources next to the harness versions of auth/auth.hpp
+# and fs/index.hpp, which on the device pull in the screen and the login UI.
+# The Arduino core stand-in (String, Serial, millis) is shared with tools/browser-replay/host.
+#
+#   CXX  host compiler (default g++), needs OpenSSL (libcrypto) headers
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(cd "$HERE/../.." && pwd)
+OUT="$HERE/_build"
+TREE="$OUT/tree/src"
+CORE="$ROOT/tools/browser-replay/host"
+CXX=${CXX:-g++}
+
+rm -rf "$OUT/tree"
+mkdir -p "$TREE/fs" "$TREE/utils" "$TREE/auth"
+for f in "$ROOT"/src/fs/*.cpp "$ROOT"/src/fs/*.hpp; do
+    case "$(basename "$f")" in
+    index.cpp | index.hpp) ;;
+    *) ln -s "$f" "$TREE/fs/" ;;
+    esac
+done
+ln -s "$ROOT/src/utils/crypto.cpp" "$ROOT/src/utils/crypto.hpp" "$TREE/utils/"
+# crypto.cpp includes "Crypto.hpp" (case-insensitive on the original dev machine)
+ln -s "$ROOT/src/utils/crypto.hpp" "$TREE/utils/Crypto.hpp"
+ln -s "$HERE/shadow/auth/auth.hpp" "$TREE/auth/"
+ln -s "$HERE/shadow/fs/index.hpp" "$TREE/fs/"
+
+$CXX -std=gnu++17 -O2 -g -w -pthread \
+    -I"$HERE/host" -I"$CORE" -I"$TREE" \
+    "$TREE"/fs/*.cpp "$TREE/utils/crypto.cpp" \
+    "$HERE"/host/*.cpp "$CORE/arduino.cpp" "$HERE/main.cpp" \
+    -o "$OUT/fs-host" \
+    -lcrypto
+
+echo "built $OUT/fs-host"
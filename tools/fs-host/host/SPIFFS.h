@@ -0,0 +1,5 @@
+#pragma once
+
+// Only included for its types by src/fs/enc-fs.hpp; the host runs on FsBackend::PosixDir
+
+#include <FS.h>
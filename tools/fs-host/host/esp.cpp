@@ -0,0 +1,9 @@
+#include "esp_random.h"
+
+#include <random>
+
+uint32_t esp_random()
+{
+    static std::random_device rd;
+    return rd();
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <stdint.h>
+
+// Host stand-in: std::random_device (esp.cpp)
+uint32_t esp_random();
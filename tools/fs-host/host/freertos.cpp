@@ -0,0 +1,144 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct HostTask
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    uint32_t notified = 0;
+    UBaseType_t priority = 1;
+};
+
+struct HostQueue
+{
+    std::mutex lock;
+    std::condition_variable changed;
+    size_t length;
+    size_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+// Tasks are never freed: on the device they run until reboot, and a handle may still be
+// notified after its function returned
+static thread_local HostTask *t_self = nullptr;
+
+static HostTask *self()
+{
+    if (!t_self)
+        t_self = new HostTask(); // a thread not started by xTaskCreate, e.g. main()
+    return t_self;
+}
+
+// Waits on cv until pred() holds; portMAX_DELAY waits forever. Returns pred().
+template <typename Pred>
+static bool waitTicks(std::condition_variable &cv, std::unique_lock<std::mutex> &g, TickType_t ticks, Pred pred)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        cv.wait(g, pred);
+        return true;
+    }
+    return cv.wait_for(g, std::chrono::milliseconds(ticks), pred);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, UBaseType_t priority, TaskHandle_t *created)
+{
+    (void)name;
+    (void)stackDepth;
+    HostTask *task = new HostTask();
+    task->priority = priority;
+    if (created)
+        *created = task;
+    std::thread([fn, arg, task]
+                {
+        t_self = task;
+        fn(arg); })
+        .detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, UBaseType_t priority, TaskHandle_t *created, BaseType_t core)
+{
+    (void)core;
+    return xTaskCreate(fn, name, stackDepth, arg, priority, created);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    (void)task;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return (task ? task : self())->priority;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait)
+{
+    HostTask *t = self();
+    std::unique_lock<std::mutex> g(t->lock);
+    waitTicks(t->cv, g, ticksToWait, [t]
+              { return t->notified != 0; });
+    uint32_t value = t->notified;
+    if (value)
+        t->notified = clearOnExit ? 0 : value - 1;
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    {
+        std::lock_guard<std::mutex> g(task->lock);
+        task->notified++;
+    }
+    task->cv.notify_all();
+    return pdPASS;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    HostQueue *q = new HostQueue();
+    q->length = length;
+    q->itemSize = itemSize;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    delete q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> g(q->lock);
+    if (!waitTicks(q->changed, g, ticksToWait, [q]
+                   { return q->items.size() < q->length; }))
+        return pdFAIL;
+    const uint8_t *p = (const uint8_t *)item;
+    q->items.emplace_back(p, p + q->itemSize);
+    g.unlock();
+    q->changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> g(q->lock);
+    if (!waitTicks(q->changed, g, ticksToWait, [q]
+                   { return !q->items.empty(); }))
+        return pdFAIL;
+    memcpy(item, q->items.front().data(), q->itemSize);
+    q->items.pop_front();
+    g.unlock();
+    q->changed.notify_all();
+    return pdPASS;
+}
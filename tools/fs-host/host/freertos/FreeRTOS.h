@@ -0,0 +1,18 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS kernel as used by src/fs: tasks are std::threads, queues and task
+// notifications are built on a mutex and a condition variable (freertos.cpp). One tick is 1 ms.
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xffffffffu)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct HostQueue;
+typedef HostQueue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t q);
+
+// Items are copied in and out by value, as in FreeRTOS
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticksToWait);
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticksToWait);
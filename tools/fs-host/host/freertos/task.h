@@ -0,0 +1,20 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// vTaskDelay comes with the Arduino stand-in
+
+struct HostTask;
+typedef HostTask *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+// Stack size, priority and core are ignored; the task runs on a detached thread.
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, UBaseType_t priority, TaskHandle_t *created);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, UBaseType_t priority, TaskHandle_t *created, BaseType_t core);
+
+// vTaskDelete(NULL) marks the calling task as finished; its thread ends when the function returns.
+void vTaskDelete(TaskHandle_t task);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
@@ -0,0 +1,62 @@
+#pragma once
+
+// Host stand-in for the mbedtls AES calls used by src/fs and src/utils/crypto.cpp, on top of
+// OpenSSL's AES block functions. Host throughput is OpenSSL's, not the ESP32's: compare host runs
+// with each other, not with the device.
+
+#include <openssl/aes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MBEDTLS_AES_ENCRYPT 1
+#define MBEDTLS_AES_DECRYPT 0
+
+typedef struct
+{
+    AES_KEY enc;
+    AES_KEY dec;
+} mbedtls_aes_context;
+
+inline void mbedtls_aes_init(mbedtls_aes_context *ctx) { memset(ctx, 0, sizeof(*ctx)); }
+inline void mbedtls_aes_free(mbedtls_aes_context *ctx) { memset(ctx, 0, sizeof(*ctx)); }
+
+inline int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits)
+{
+    return AES_set_encrypt_key(key, (int)keybits, &ctx->enc) == 0 ? 0 : -1;
+}
+
+inline int mbedtls_aes_setkey_dec(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits)
+{
+    return AES_set_decrypt_key(key, (int)keybits, &ctx->dec) == 0 ? 0 : -1;
+}
+
+inline int mbedtls_aes_crypt_ecb(mbedtls_aes_context *ctx, int mode, const unsigned char input[16], unsigned char output[16])
+{
+    if (mode == MBEDTLS_AES_ENCRYPT)
+        AES_encrypt(input, output, &ctx->enc);
+    else
+        AES_decrypt(input, output, &ctx->dec);
+    return 0;
+}
+
+// Same stream state handling as mbedtls: nc_off is the position inside stream_block
+inline int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length, size_t *nc_off, unsigned char nonce_counter[16],
+                                 unsigned char stream_block[16], const unsigned char *input, unsigned char *output)
+{
+    size_t n = *nc_off;
+    while (length--)
+    {
+        if (n == 0)
+        {
+            AES_encrypt(nonce_counter, stream_block, &ctx->enc);
+            for (int i = 16; i > 0; i--)
+                if (++nonce_counter[i - 1] != 0)
+                    break;
+        }
+        *output++ = *input++ ^ stream_block[n];
+        n = (n + 1) & 0x0F;
+    }
+    *nc_off = n;
+    return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// Host stand-in for the mbedtls HMAC-SHA256 calls in src/fs/enc-fs.cpp over OpenSSL.
+// The message is collected and hashed in one go on finish.
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <stddef.h>
+#include <vector>
+
+typedef enum
+{
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_SHA256 = 6
+} mbedtls_md_type_t;
+
+typedef struct
+{
+    mbedtls_md_type_t type;
+} mbedtls_md_info_t;
+
+typedef struct
+{
+    const mbedtls_md_info_t *info;
+    std::vector<unsigned char> key;
+    std::vector<unsigned char> message;
+} mbedtls_md_context_t;
+
+inline const mbedtls_md_info_t *mbedtls_md_info_from_type(mbedtls_md_type_t type)
+{
+    static const mbedtls_md_info_t sha256 = {MBEDTLS_MD_SHA256};
+    return type == MBEDTLS_MD_SHA256 ? &sha256 : nullptr;
+}
+
+inline void mbedtls_md_init(mbedtls_md_context_t *ctx) { ctx->info = nullptr; }
+inline void mbedtls_md_free(mbedtls_md_context_t *ctx)
+{
+    ctx->key.clear();
+    ctx->message.clear();
+}
+
+inline int mbedtls_md_setup(mbedtls_md_context_t *ctx, const mbedtls_md_info_t *info, int hmac)
+{
+    ctx->info = info;
+    return info && hmac ? 0 : -1;
+}
+
+inline int mbedtls_md_hmac_starts(mbedtls_md_context_t *ctx, const unsigned char *key, size_t keylen)
+{
+    ctx->key.assign(key, key + keylen);
+    ctx->message.clear();
+    return 0;
+}
+
+inline int mbedtls_md_hmac_update(mbedtls_md_context_t *ctx, const unsigned char *input, size_t ilen)
+{
+    ctx->message.insert(ctx->message.end(), input, input + ilen);
+    return 0;
+}
+
+inline int mbedtls_md_hmac_finish(mbedtls_md_context_t *ctx, unsigned char *output)
+{
+    unsigned int len = 0;
+    return HMAC(EVP_sha256(), ctx->key.data(), (int)ctx->key.size(), ctx->message.data(), ctx->message.size(), output, &len) ? 0 : -1;
+}
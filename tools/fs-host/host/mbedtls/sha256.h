@@ -0,0 +1,39 @@
+#pragma once
+
+// Host stand-in for mbedtls SHA-256 (mbedtls 2.x names, as in the ESP32 Arduino core) over OpenSSL.
+
+#include <openssl/sha.h>
+#include <stddef.h>
+
+typedef struct
+{
+    SHA256_CTX ctx;
+    int is224;
+} mbedtls_sha256_context;
+
+inline void mbedtls_sha256_init(mbedtls_sha256_context *ctx) { ctx->is224 = 0; }
+inline void mbedtls_sha256_free(mbedtls_sha256_context *ctx) { (void)ctx; }
+
+inline int mbedtls_sha256_starts_ret(mbedtls_sha256_context *ctx, int is224)
+{
+    ctx->is224 = is224;
+    return (is224 ? SHA224_Init(&ctx->ctx) : SHA256_Init(&ctx->ctx)) == 1 ? 0 : -1;
+}
+
+inline int mbedtls_sha256_update_ret(mbedtls_sha256_context *ctx, const unsigned char *input, size_t ilen)
+{
+    return SHA256_Update(&ctx->ctx, input, ilen) == 1 ? 0 : -1;
+}
+
+inline int mbedtls_sha256_finish_ret(mbedtls_sha256_context *ctx, unsigned char output[32])
+{
+    return (ctx->is224 ? SHA224_Final(output, &ctx->ctx) : SHA256_Final(output, &ctx->ctx)) == 1 ? 0 : -1;
+}
+
+inline void mbedtls_sha256(const unsigned char *input, size_t ilen, unsigned char output[32], int is224)
+{
+    if (is224)
+        SHA224(input, ilen, output);
+    else
+        SHA256(input, ilen, output);
+}
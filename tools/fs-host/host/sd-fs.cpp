@@ -0,0 +1,26 @@
+#include "fs/index.hpp"
+
+#include <utility>
+
+namespace SD_FS
+{
+    // same walk as src/fs/index.cpp
+    bool deleteDir(const String &path)
+    {
+        FsBackend::Backend &disk = FsBackend::active();
+        std::vector<std::pair<String, bool>> entries;
+        if (!disk.list(path.c_str(), [&](const FsBackend::DirEntry &e)
+                       { entries.push_back({path + "/" + e.name, e.isDir}); }))
+            return false;
+
+        for (const auto &e : entries)
+        {
+            if (e.second)
+                deleteDir(e.first);
+            else
+                disk.remove(e.first.c_str());
+        }
+        disk.rmdir(path.c_str());
+        return true;
+    }
+}
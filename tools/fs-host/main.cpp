@@ -0,0 +1,613 @@
+// Host runner for the filesystem layer (src/fs) with a local directory standing in for the SD card.
+//
+//   tools/fs-host/build.sh
+//   tools/fs-host/_build/fs-host [options] fs|crypto|import|test
+//
+//   crypto            AES-CTR throughput of the ENC_FS crypto engine (ctr-engine.cpp) per chunk size
+//   fs                FsBench ops/s (read, write, append, readDir, exists) on FsBackend::PosixDir, then
+//                     joinEncPath / writeFile / readFile of ENC_FS on top of it
+//   import            Import::benchmark() MB/s over a generated /import-src tree of 4 * N files
+//                     (512 B to 300 KB, three directory levels); also on Faulty(PosixDir) with fault options
+//   test              write-back cache checks: after a simulated power cut (pending cache content dropped
+//                     unwritten) every file reads back as a complete version, and reads never return
+//                     content older than the last write; KvStore (ENC_FS::Storage) migration, torn
+//                     segment tails, power cuts around compaction and empty values; BlobStore
+//                     zero-byte blobs, reserved names and blobs freed on uninstall
+//   --root DIR        use DIR as the SD card (kept afterwards); default: a fresh directory in $TMPDIR
+//   --iterations N    ops per bench case (default 16); crypto encrypts N * 64 KB per chunk size
+//   --op-us N         with any of the fault options the bench also runs on Faulty(PosixDir):
+//   --read-us-kb N      latency per metadata op, per KB read and per KB written,
+//   --write-us-kb N     and a failure probability of 1/N per op
+//   --fail-one-in N
+//   --verbose         show the fs layer's Serial output
+//
+// Exit code 1 if the SD stand-in cannot be set up, an import copies less than its source or a test fails.
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <filesystem>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#include "fs/backend.hpp"
+#include "fs/blob-store.hpp"
+#include "fs/bench.hpp"
+#include "fs/ctr-engine.hpp"
+#include "fs/enc-fs.hpp"
+#include "fs/import.hpp"
+#include "fs/kv-store.hpp"
+#include "fs/write-cache.hpp"
+#include "auth/auth.hpp"
+
+namespace Auth
+{
+    String username;
+    String name;
+    String password;
+}
+
+struct Options
+{
+    String root;
+    uint32_t iterations = 16;
+    FsBackend::FaultConfig faults;
+};
+
+static bool faulty(const Options &o)
+{
+    return o.faults.opLatencyUs || o.faults.readUsPerKB || o.faults.writeUsPerKB || o.faults.failOneIn;
+}
+
+// ---------------------------
+// fs
+// ---------------------------
+
+static void printFsBench(const char *label, FsBackend::Backend &b, uint32_t iterations)
+{
+    printf("%s\n", label);
+    for (const FsBench::Result &r : FsBench::run(b, "/.fsbench", iterations))
+        printf("  %-8s %7u: %5u ops in %8u us -> %9.1f ops/s\n",
+               FsBench::opName(r.op), (unsigned)r.param, (unsigned)r.ops, (unsigned)r.micros, r.opsPerSec);
+}
+
+static void printEncFsBench(uint32_t iterations)
+{
+    printf("ENC_FS\n");
+    const size_t sizes[] = {64, 1024, 16 * 1024};
+    for (size_t size : sizes)
+    {
+        ENC_FS::Path p = {"fsbench", "depth1", "depth2", "f" + String((unsigned)size)};
+        ENC_FS::Buffer data(size, 0x5A);
+
+        uint32_t start = micros();
+        for (uint32_t i = 0; i < iterations; ++i)
+            ENC_FS::joinEncPath(p);
+        uint32_t tJoin = micros() - start;
+
+        start = micros();
+        for (uint32_t i = 0; i < iterations; ++i)
+            ENC_FS::writeFile(p, 0, 0, data);
+        ENC_FS::sync();
+        uint32_t tWrite = micros() - start;
+
+        start = micros();
+        for (uint32_t i = 0; i < iterations; ++i)
+            ENC_FS::readFileFull(p);
+        uint32_t tRead = micros() - start;
+
+        printf("  %6u B: joinEncPath %7u us, write %8u us, read %8u us (x%u)\n",
+               (unsigned)size, (unsigned)tJoin, (unsigned)tWrite, (unsigned)tRead, (unsigned)iterations);
+    }
+    ENC_FS::rmDir({"fsbench"});
+}
+
+static void runFs(const Options &o, FsBackend::Backend &disk)
+{
+    printFsBench("PosixDir", disk, o.iterations);
+    printEncFsBench(o.iterations);
+
+    if (!faulty(o))
+        return;
+    FsBackend::Faulty sd(disk, o.faults);
+    printFsBench("Faulty(PosixDir)", sd, o.iterations);
+    FsBackend::setActive(&sd);
+    printEncFsBench(o.iterations);
+    FsBackend::setActive(&disk);
+    printf("injected failures: %u\n", (unsigned)sd.injectedFailures);
+}
+
+// ---------------------------
+// crypto
+// ---------------------------
+
+static void runCrypto(const Options &o)
+{
+    // same chunk sizes as fs/debug/crypto-bench.hpp on the device
+    const size_t bytes = (size_t)o.iterations * 64 * 1024;
+    const size_t chunks[] = {64, 512, 4096, 32768};
+    for (size_t chunk : chunks)
+    {
+        ENC_FS::CtrBenchResult r = ENC_FS::benchmarkCtr(bytes, chunk);
+        printf("chunk %6u: %u bytes in %u us -> %.2f MB/s\n",
+               (unsigned)chunk, (unsigned)r.bytes, (unsigned)r.micros, r.mbPerSec);
+    }
+}
+
+// ---------------------------
+// import
+// ---------------------------
+
+static const char *IMPORT_SRC = "/import-src";
+
+// Source tree like a /public folder: mixed file sizes, nested directories
+static uint64_t writeImportSource(FsBackend::Backend &disk, uint32_t files)
+{
+    const size_t sizes[] = {512, 4 * 1024, 37 * 1024, 300 * 1024};
+    const char *dirs[] = {"", "/icons", "/icons/apps"};
+    disk.mkdir(IMPORT_SRC);
+    for (const char *d : dirs)
+        if (*d)
+            disk.mkdir((String(IMPORT_SRC) + d).c_str());
+
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < files; ++i)
+    {
+        std::vector<uint8_t> data(sizes[i % 4]);
+        for (size_t j = 0; j < data.size(); ++j)
+            data[j] = (uint8_t)(i * 31 + j);
+        String path = String(IMPORT_SRC) + dirs[i % 3] + "/f" + String((unsigned)i) + ".bin";
+        FsBackend::Handle f = disk.open(path.c_str(), FsBackend::OpenMode::Write);
+        if (f)
+            total += f->write(data.data(), data.size());
+    }
+    return total;
+}
+
+static bool printImportBench(const char *label, uint32_t files, uint64_t bytes)
+{
+    ENC_FS::Import::BenchResult r = ENC_FS::Import::benchmark(IMPORT_SRC);
+    printf("%-16s %u files, %llu bytes in %u ms -> %.3f MB/s\n",
+           label, (unsigned)r.files, (unsigned long long)r.bytes, (unsigned)r.millis, r.mbPerSec);
+    return r.files == files && r.bytes == bytes;
+}
+
+static bool runImport(const Options &o, FsBackend::Backend &disk)
+{
+    const uint32_t files = 4 * (o.iterations ? o.iterations : 1);
+    uint64_t bytes = writeImportSource(disk, files);
+    bool ok = printImportBench("PosixDir", files, bytes);
+
+    if (faulty(o))
+    {
+        FsBackend::Faulty sd(disk, o.faults);
+        FsBackend::setActive(&sd);
+        // injected failures make files fail on purpose; only the clean run is checked
+        bool clean = printImportBench("Faulty(PosixDir)", files, bytes);
+        ok = ok && (clean || o.faults.failOneIn);
+        FsBackend::setActive(&disk);
+        printf("injected failures: %u\n", (unsigned)sd.injectedFailures);
+    }
+
+    SD_FS::deleteDir(IMPORT_SRC);
+    if (!ok)
+        fprintf(stderr, "import: copied less than the %u source files (%llu bytes)\n", (unsigned)files, (unsigned long long)bytes);
+    return ok;
+}
+
+// ---------------------------
+// test
+// ---------------------------
+
+static int g_failures = 0;
+
+static void check(bool ok, const char *test, const char *what)
+{
+    if (ok)
+        return;
+    printf("FAIL %s: %s\n", test, what);
+    g_failures++;
+}
+
+static ENC_FS::Buffer content(size_t size, uint8_t seed)
+{
+    ENC_FS::Buffer b(size);
+    for (size_t i = 0; i < size; ++i)
+        b[i] = (uint8_t)(seed + i * 7);
+    return b;
+}
+
+// Power cut: everything still pending in the write-back cache is lost, SD keeps what was flushed
+static void powerCut()
+{
+    ENC_FS::WriteCache::discardPrefix(ENC_FS::Path());
+}
+
+// Written but not flushed: the previous version survives, complete
+static void testCrashBeforeFlush()
+{
+    const char *t = "crash-before-flush";
+    ENC_FS::Path p = {"t", "crash", "file"};
+    ENC_FS::Buffer v1 = content(3000, 1), v2 = content(5000, 2);
+    check(ENC_FS::writeFile(p, 0, 0, v1) && ENC_FS::fsync(p), t, "write v1");
+    check(ENC_FS::writeFile(p, 0, 0, v2), t, "write v2");
+    check(ENC_FS::readFileFull(p) == v2, t, "v2 visible before the cut");
+    powerCut();
+    check(ENC_FS::readFileFull(p) == v1, t, "v1 intact after the cut");
+}
+
+// The flush task writes a quiet file without an explicit sync
+static void testBackgroundFlush()
+{
+    const char *t = "background-flush";
+    ENC_FS::Path p = {"t", "background", "nested", "file"};
+    ENC_FS::Buffer v = content(2000, 3);
+    check(ENC_FS::writeFile(p, 0, 0, v), t, "write");
+    std::this_thread::sleep_for(std::chrono::milliseconds(ENC_FS::WriteCache::WB_FLUSH_DELAY_MS * 4));
+    check(!ENC_FS::WriteCache::contains(p), t, "flushed after the coalescing window");
+    powerCut();
+    check(ENC_FS::readFileFull(p) == v, t, "on SD after the cut");
+}
+
+// Repeated writes and appends coalesce; SD ends up with the last state
+static void testCoalesce()
+{
+    const char *t = "coalesce";
+    ENC_FS::Path p = {"t", "coalesce"};
+    ENC_FS::Buffer expect;
+    for (int i = 0; i < 50; ++i)
+    {
+        ENC_FS::Buffer chunk = content(37, (uint8_t)i);
+        check(ENC_FS::appendFile(p, chunk), t, "append");
+        expect.insert(expect.end(), chunk.begin(), chunk.end());
+    }
+    check(ENC_FS::readFileFull(p) == expect, t, "cached content");
+    check(ENC_FS::sync(), t, "sync");
+    powerCut();
+    check(ENC_FS::readFileFull(p) == expect, t, "SD content");
+}
+
+// More files than the cache holds: backpressure flushes, nothing is lost
+static void testBackpressure()
+{
+    const char *t = "backpressure";
+    const int files = (int)ENC_FS::WriteCache::WB_MAX_ENTRIES + 8;
+    for (int i = 0; i < files; ++i)
+        check(ENC_FS::writeFile({"t", "many", "f" + String(i)}, 0, 0, content(3000, (uint8_t)i)), t, "write");
+    check(ENC_FS::sync(), t, "sync");
+    powerCut();
+    for (int i = 0; i < files; ++i)
+        check(ENC_FS::readFileFull({"t", "many", "f" + String(i)}) == content(3000, (uint8_t)i), t, "SD content");
+}
+
+// A failed flush keeps the data cached and is retried by the next sync
+static void testFailedFlush(FsBackend::Backend &disk)
+{
+    const char *t = "failed-flush";
+    ENC_FS::Path p = {"t", "failing"};
+    ENC_FS::Buffer v1 = content(1000, 4), v2 = content(1500, 5);
+    check(ENC_FS::writeFile(p, 0, 0, v1) && ENC_FS::fsync(p), t, "write v1");
+
+    FsBackend::FaultConfig cfg;
+    cfg.failOneIn = 1; // SD gone
+    FsBackend::Faulty dead(disk, cfg);
+    FsBackend::setActive(&dead);
+    check(ENC_FS::writeFile(p, 0, 0, v2), t, "write v2 into the cache");
+    check(!ENC_FS::sync(), t, "sync reports the failure");
+    check(ENC_FS::readFileFull(p) == v2, t, "v2 still readable");
+    FsBackend::setActive(&disk);
+
+    check(ENC_FS::sync(), t, "sync after recovery");
+    powerCut();
+    check(ENC_FS::readFileFull(p) == v2, t, "v2 on SD");
+}
+
+// A file that outgrows the cache is written through; the older cached version must go
+static void testGrowPastCache()
+{
+    const char *t = "grow-past-cache";
+    ENC_FS::Path p = {"t", "grow"};
+    ENC_FS::Buffer small = content(100, 6);
+    ENC_FS::Buffer large = content(ENC_FS::WriteCache::WB_MAX_BYTES, 7);
+    check(ENC_FS::writeFile(p, 0, 0, small), t, "small write cached");
+    check(ENC_FS::writeFile(p, 0, 0, large), t, "large write");
+    check(ENC_FS::readFileFull(p) == large, t, "no stale read");
+    check(ENC_FS::sync(), t, "sync");
+    check(ENC_FS::readFileFull(p) == large, t, "flush did not overwrite the large file");
+    powerCut();
+    check(ENC_FS::readFileFull(p) == large, t, "large file on SD");
+}
+
+// Streaming a file (HTTP save_to, import) replaces a version still pending in the cache
+static void testStreamOverCached()
+{
+    const char *t = "stream-over-cached";
+    ENC_FS::Path p = {"t", "streamed"};
+    ENC_FS::Buffer cached = content(500, 8), streamed = content(9000, 9);
+    check(ENC_FS::writeFile(p, 0, 0, cached), t, "cached write");
+    ENC_FS::FileWriter w;
+    check(w.open(p), t, "open");
+    for (size_t off = 0; off < streamed.size(); off += 1000)
+        check(w.write(streamed.data() + off, 1000), t, "write chunk");
+    check(w.close(), t, "close");
+    check(ENC_FS::readFileFull(p) == streamed, t, "no stale read");
+    check(ENC_FS::sync(), t, "sync");
+    powerCut();
+    check(ENC_FS::readFileFull(p) == streamed, t, "flush did not overwrite the streamed file");
+}
+
+// Legacy per-key files move into the segment on first use and are removed
+static void testKvMigration()
+{
+    const char *t = "kv-migration";
+    const String app = "kv-legacy";
+    for (int i = 0; i < 5; ++i)
+        check(ENC_FS::writeFile(ENC_FS::storagePath(app, "k" + String(i)), 0, 0, content(100 + i, (uint8_t)i)), t, "legacy write");
+    check(ENC_FS::sync(), t, "sync");
+
+    for (int i = 0; i < 5; ++i)
+    {
+        check(ENC_FS::Storage::get(app, "k" + String(i)) == content(100 + i, (uint8_t)i), t, "migrated value");
+        check(!ENC_FS::exists(ENC_FS::storagePath(app, "k" + String(i))), t, "legacy file removed");
+    }
+    ENC_FS::rmDir({"programms", app});
+}
+
+// Garbage after the last record (power loss mid-append) is cut off before the next append
+static void testKvTornTail(FsBackend::Backend &disk)
+{
+    const char *t = "kv-torn-tail";
+    const String app = "kv-torn";
+    check(ENC_FS::Storage::set(app, "a", content(300, 1)), t, "set a");
+    check(ENC_FS::Storage::set(app, "b", content(400, 2)), t, "set b");
+
+    ENC_FS::Path segment = {"programms", app, "data", "store.kv"};
+    String full = ENC_FS::joinEncPath(segment);
+    FsBackend::Handle f = disk.open(full.c_str(), FsBackend::OpenMode::Append);
+    const uint8_t torn[] = {1, 0x40, 0, 0, 0, 0xde, 0xad}; // header of a record that never finished
+    check(f && f->write(torn, sizeof(torn)) == sizeof(torn), t, "append torn record");
+    f.reset();
+
+    check(ENC_FS::Storage::set(app, "c", content(500, 3)), t, "set c after the torn tail");
+    check(ENC_FS::KvStore::compact(app), t, "compact");
+    check(ENC_FS::Storage::get(app, "a") == content(300, 1), t, "a intact");
+    check(ENC_FS::Storage::get(app, "b") == content(400, 2), t, "b intact");
+    check(ENC_FS::Storage::get(app, "c") == content(500, 3), t, "c readable");
+    ENC_FS::rmDir({"programms", app});
+}
+
+// Copy of a compacted segment claiming the next generation, cut to `keep` bytes: what a power cut
+// leaves in the other slot during (keep < size) or right after (keep == size) a compaction
+static ENC_FS::Buffer nextGeneration(ENC_FS::Buffer seg, size_t keep)
+{
+    const size_t header = 1 + 4 + 4 + 32;
+    if (seg.size() < header + 8 || seg[0] != 3)
+        return ENC_FS::Buffer();
+    seg[header]++;
+    uint32_t h = 2166136261u;
+    auto fnv = [&](const uint8_t *p, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            h = (h ^ p[i]) * 16777619u;
+    };
+    fnv(seg.data(), 5);
+    fnv(seg.data() + 9, 32 + 8);
+    for (int i = 0; i < 4; ++i)
+        seg[5 + i] = (uint8_t)(h >> (8 * i));
+    seg.resize(std::min(keep, seg.size()));
+    return seg;
+}
+
+// A power cut during or right after compaction leaves the old or the new segment, never neither
+static void testKvCompactionCrash(FsBackend::Backend &disk)
+{
+    const char *t = "kv-compaction-crash";
+    const String app = "kv-crash";
+    ENC_FS::Path slot0 = {"programms", app, "data", "store.kv"};
+    ENC_FS::Path slot1 = {"programms", app, "data", "store.kv.new"};
+    const uint8_t torn[] = {1, 0x40, 0, 0, 0, 0xde, 0xad};
+    auto tear = [&](const ENC_FS::Path &p)
+    {
+        String full = ENC_FS::joinEncPath(p);
+        FsBackend::Handle f = disk.open(full.c_str(), FsBackend::OpenMode::Append);
+        check(f && f->write(torn, sizeof(torn)) == sizeof(torn), t, "append torn record");
+    };
+    auto intact = [&](const char *what)
+    {
+        for (int i = 0; i < 20; ++i)
+            check(ENC_FS::Storage::get(app, "k" + String(i)) == content(200 + i, (uint8_t)i), t, what);
+    };
+
+    for (int i = 0; i < 20; ++i)
+        check(ENC_FS::Storage::set(app, "k" + String(i), content(200 + i, (uint8_t)i)), t, "set");
+    check(ENC_FS::KvStore::compact(app), t, "compact");
+    check(ENC_FS::getFileSize(slot0) == 0 && ENC_FS::getFileSize(slot1) > 0, t, "compacted into the other slot");
+    ENC_FS::Buffer seg = ENC_FS::readFileFull(slot1);
+
+    // cut mid-compaction: half of a newer segment in store.kv, the one in use ends torn
+    check(ENC_FS::writeFile(slot0, 0, 0, nextGeneration(seg, seg.size() / 2)) && ENC_FS::sync(), t, "half segment");
+    tear(slot1);
+    check(ENC_FS::Storage::set(app, "extra", content(10, 9)), t, "set after the cut");
+    intact("values after an interrupted compaction");
+
+    // cut before the old slot was emptied: the complete newer segment wins
+    ENC_FS::Path active = ENC_FS::getFileSize(slot0) > 0 ? slot0 : slot1;
+    ENC_FS::Path spare = active == slot0 ? slot1 : slot0;
+    seg = ENC_FS::readFileFull(active);
+    check(ENC_FS::writeFile(spare, 0, 0, nextGeneration(seg, seg.size())) && ENC_FS::sync(), t, "complete segment");
+    tear(active);
+    check(ENC_FS::Storage::set(app, "extra", content(10, 9)), t, "set after the cut");
+    check(ENC_FS::getFileSize(active) == 0, t, "older slot emptied");
+    intact("values from the newer segment");
+    ENC_FS::rmDir({"programms", app});
+}
+
+// getMany tells empty values from missing keys
+static void testKvEmptyValues()
+{
+    const char *t = "kv-empty-values";
+    const String app = "kv-empty";
+    check(ENC_FS::Storage::setMany(app, {{"empty", ENC_FS::Buffer()}, {"full", content(10, 4)}}), t, "setMany");
+    std::vector<bool> found;
+    std::vector<ENC_FS::Buffer> v = ENC_FS::Storage::getMany(app, {"empty", "full", "missing"}, &found);
+    check(found.size() == 3 && found[0] && found[1] && !found[2], t, "found flags");
+    check(v.size() == 3 && v[0].empty() && v[1] == content(10, 4) && v[2].empty(), t, "values");
+    ENC_FS::rmDir({"programms", app});
+}
+
+// a downloaded zero-byte file is a valid blob and manifest entry
+static void testEmptyBlob()
+{
+    const char *t = "empty-blob";
+    const String app = "fshost-blob";
+    ENC_FS::BlobStore::Writer w;
+    String hash;
+    check(w.commitBlob(hash), t, "commit");
+    check(ENC_FS::BlobStore::hasBlob(hash, 0), t, "blob stored");
+    check(ENC_FS::BlobStore::link(app, "empty.txt", hash, 0), t, "link");
+    std::vector<ENC_FS::BlobStore::Entry> e = ENC_FS::BlobStore::entries(app);
+    check(e.size() == 1 && e[0].path == "empty.txt" && e[0].size == 0, t, "manifest entry");
+    ENC_FS::rmDir({"programs", app});
+}
+
+// a package entry named like the manifest must not replace or delete it
+static void testReservedNames()
+{
+    const char *t = "reserved-names";
+    const String app = "fshost-reserved";
+    String hash;
+    check(ENC_FS::BlobStore::put(content(50, 5), hash), t, "put");
+    check(ENC_FS::BlobStore::link(app, "main.lua", hash, 50), t, "link");
+    check(!ENC_FS::BlobStore::link(app, ENC_FS::BlobStore::MANIFEST_NAME, hash, 50), t, "link refuses the manifest");
+    check(!ENC_FS::BlobStore::replace(app, {{ENC_FS::BlobStore::MANIFEST_NAME, hash, 50}}), t, "replace refuses the manifest");
+    check(ENC_FS::readFileFull({"programs", app, "main.lua"}) == content(50, 5), t, "manifest intact");
+    ENC_FS::rmDir({"programs", app});
+}
+
+// uninstalling an app (rmDir of its folder) frees the blobs no other app uses
+static void testUninstallReleasesBlobs()
+{
+    const char *t = "uninstall-blobs";
+    const String a = "fshost-uninstall-a", b = "fshost-uninstall-b";
+    String shared, own;
+    check(ENC_FS::BlobStore::put(content(70, 6), shared), t, "put shared");
+    check(ENC_FS::BlobStore::put(content(80, 7), own), t, "put own");
+    check(ENC_FS::BlobStore::link(a, "lib.lua", shared, 70), t, "link a/lib");
+    check(ENC_FS::BlobStore::link(a, "main.lua", own, 80), t, "link a/main");
+    check(ENC_FS::BlobStore::link(b, "lib.lua", shared, 70), t, "link b/lib");
+
+    ENC_FS::rmDir({"programs", a}); // false if the folder never left the write cache
+    check(!ENC_FS::BlobStore::hasBlob(own, 80), t, "blob only a used is gone");
+    check(ENC_FS::readFileFull({"programs", b, "lib.lua"}) == content(70, 6), t, "shared blob kept");
+
+    ENC_FS::rmDir({"programs", b});
+    check(!ENC_FS::BlobStore::hasBlob(shared, 70), t, "last user gone");
+}
+
+static bool runTests(FsBackend::Backend &disk)
+{
+    testCrashBeforeFlush();
+    testBackgroundFlush();
+    testCoalesce();
+    testBackpressure();
+    testFailedFlush(disk);
+    testGrowPastCache();
+    testStreamOverCached();
+    testKvMigration();
+    testKvTornTail(disk);
+    testKvCompactionCrash(disk);
+    testKvEmptyValues();
+    testEmptyBlob();
+    testReservedNames();
+    testUninstallReleasesBlobs();
+    ENC_FS::rmDir({"t"});
+
+    printf("%s (%d failed checks)\n", g_failures ? "FAILED" : "ok", g_failures);
+    return g_failures == 0;
+}
+
+// ---------------------------
+// main
+// ---------------------------
+
+static void usage()
+{
+    fprintf(stderr, "usage: fs-host [--root DIR] [--iterations N] [--op-us N] [--read-us-kb N] [--write-us-kb N]\n"
+                    "               [--fail-one-in N] [--verbose] fs|crypto|import|test\n");
+}
+
+int main(int argc, char **argv)
+{
+    Options o;
+    String mode;
+    for (int i = 1; i < argc; ++i)
+    {
+        String a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--root" && hasValue)
+            o.root = argv[++i];
+        else if (a == "--iterations" && hasValue)
+            o.iterations = (uint32_t)atoi(argv[++i]);
+        else if (a == "--op-us" && hasValue)
+            o.faults.opLatencyUs = (uint32_t)atoi(argv[++i]);
+        else if (a == "--read-us-kb" && hasValue)
+            o.faults.readUsPerKB = (uint32_t)atoi(argv[++i]);
+        else if (a == "--write-us-kb" && hasValue)
+            o.faults.writeUsPerKB = (uint32_t)atoi(argv[++i]);
+        else if (a == "--fail-one-in" && hasValue)
+            o.faults.failOneIn = (uint32_t)atoi(argv[++i]);
+        else if (a == "--verbose")
+            Serial.enabled = true;
+        else if (!a.startsWith("--") && mode.isEmpty())
+            mode = a;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (mode != "fs" && mode != "crypto" && mode != "import" && mode != "test")
+    {
+        usage();
+        return 1;
+    }
+
+    bool scratch = o.root.isEmpty();
+    if (scratch)
+    {
+        const char *tmp = getenv("TMPDIR");
+        String tmpl = String(tmp && *tmp ? tmp : "/tmp") + "/fs-host-XXXXXX";
+        std::vector<char> buf(tmpl.c_str(), tmpl.c_str() + tmpl.length() + 1);
+        if (!mkdtemp(buf.data()))
+        {
+            perror("mkdtemp");
+            return 1;
+        }
+        o.root = buf.data();
+    }
+    else
+        std::filesystem::create_directories(o.root.c_str());
+
+    FsBackend::PosixDir disk(o.root.c_str());
+    FsBackend::setActive(&disk);
+    Auth::username = "fshost";
+    Auth::password = "fshost";
+    disk.mkdir(("/" + Auth::username).c_str());
+
+    bool ok = true;
+    if (mode == "fs")
+        runFs(o, disk);
+    else if (mode == "crypto")
+        runCrypto(o);
+    else if (mode == "import")
+        ok = runImport(o, disk);
+    else
+        ok = runTests(disk);
+
+    ENC_FS::sync();
+    FsBackend::setActive(nullptr);
+    if (scratch)
+        std::filesystem::remove_all(o.root.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Harness replacement for src/auth/auth.hpp: the fs layer only needs the logged-in user,
+// which main.cpp sets before touching ENC_FS.
+
+#include <Arduino.h>
+#include "../utils/crypto.hpp"
+#include "../fs/index.hpp"
+
+namespace Auth
+{
+    extern String username;
+    extern String name;
+    extern String password;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// Harness replacement for src/fs/index.hpp: the SD_FS calls made by the fs layer, implemented
+// over the active FsBackend in host/sd-fs.cpp (the device version also drives the screen).
+
+#include <Arduino.h>
+#include <vector>
+
+#include "backend.hpp"
+
+using std::vector;
+
+namespace SD_FS
+{
+    bool deleteDir(const String &path);
+}